@@ -19,44 +19,44 @@ unsigned int SF::Sensor2DPose::getNumOfNoises() const {
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getAs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(0, 5);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(0, 5);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getAs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(0, 0);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(0, 0);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getBs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(0, 2);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(0, 2);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getBs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(0, 0);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(0, 0);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getCs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
 	for (int i = 0; i < 3; i++)
 		out(i, i) = 1;
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getCs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getDs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPose::getDs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3);
 	return out;
 }
 
@@ -74,3 +74,25 @@ const Eigen::VectorXi & SF::Sensor2DPose::getIfOutputIsRad() const {
 	static Eigen::VectorXi out = ZZO1();
 	return out;
 }
+
+CachingPolicy SF::Sensor2DPose::getCachingPolicy() const {
+	return CACHE_CONSTANT;
+}
+
+MatrixStructure SF::Sensor2DPose::getMatrixStructure(ModelMatrix matrix) const {
+	switch (matrix) {
+	case MATRIX_A:
+	case MATRIX_B:
+	case MATRIX_D:
+		return IDENTITY;
+	case MATRIX_C_BS:
+		return SELECTION;
+	case MATRIX_C:
+	case MATRIX_A_BS:
+	case MATRIX_B_BS:
+	case MATRIX_D_BS:
+		return ZERO;
+	default:
+		return DENSE;
+	}
+}
@@ -46,5 +46,9 @@ namespace SF {
 		bool isCompatible(BaseSystem::BaseSystemPtr ptr) const;
 
 		const Eigen::VectorXi& getIfOutputIsRad() const override;
+
+		CachingPolicy getCachingPolicy() const override;
+
+		MatrixStructure getMatrixStructure(ModelMatrix matrix) const override;
 	};
 }
\ No newline at end of file
@@ -19,45 +19,45 @@ unsigned int SF::Sensor2DPosewCalibration::getNumOfNoises() const {
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getAs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getAs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getBs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 2);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 2);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getBs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3)*Ts;
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3)*Ts;
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getCs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
 	for (int i = 0; i < 3; i++)
 		out(i, i) = 1;
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getCs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 3);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 3);
 	out(2, 2) = 1;
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getDs_bs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
 	return out;
 }
 
 Eigen::MatrixXd SF::Sensor2DPosewCalibration::getDs(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(3, 3);
 	return out;
 }
 
@@ -76,7 +76,7 @@ const Eigen::VectorXi & SF::Sensor2DPosewCalibration::getIfOutputIsRad() const {
 	return out;
 }
 
-Eigen::VectorXd SF::Sensor2DPosewCalibration::EvalOutputUpdateNonlinearPart(double Ts, const Eigen::VectorXd & baseSystemState, const Eigen::VectorXd & baseSystemNoise, const Eigen::VectorXd & sensorState, const Eigen::VectorXd & sensorNoise) const {
+Eigen::VectorXd SF::Sensor2DPosewCalibration::EvalOutputUpdateNonlinearPartView(double Ts, const VectorView & baseSystemState, const VectorView & baseSystemNoise, const VectorView & sensorState, const VectorView & sensorNoise) const {
 	double c = cos(baseSystemState(2)), s = sin(baseSystemState(2));
 	Eigen::VectorXd out(3);
 	out(0) = c * sensorState(0) - s * sensorState(1);
@@ -97,3 +97,26 @@ Eigen::VectorXi SF::Sensor2DPosewCalibration::getOutputUpdateNonlinXsDep() const
 	out(1) = 1;
 	return out;
 }
+
+CachingPolicy SF::Sensor2DPosewCalibration::getCachingPolicy() const {
+	return CACHE_BY_TS;
+}
+
+MatrixStructure SF::Sensor2DPosewCalibration::getMatrixStructure(ModelMatrix matrix) const {
+	switch (matrix) {
+	case MATRIX_A:
+	case MATRIX_D:
+		return IDENTITY;
+	case MATRIX_B:
+		return DIAGONAL;
+	case MATRIX_C:
+	case MATRIX_C_BS:
+		return SELECTION;
+	case MATRIX_A_BS:
+	case MATRIX_B_BS:
+	case MATRIX_D_BS:
+		return ZERO;
+	default:
+		return DENSE;
+	}
+}
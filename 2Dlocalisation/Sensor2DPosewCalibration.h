@@ -63,9 +63,13 @@ namespace SF {
 
 		const Eigen::VectorXi& getIfOutputIsRad() const override;
 
-		Eigen::VectorXd EvalOutputUpdateNonlinearPart(double Ts, const Eigen::VectorXd& baseSystemState,
-			const Eigen::VectorXd& baseSystemNoise, const Eigen::VectorXd& sensorState,
-			const Eigen::VectorXd& sensorNoise) const override;
+		CachingPolicy getCachingPolicy() const override;
+
+		MatrixStructure getMatrixStructure(ModelMatrix matrix) const override;
+
+		Eigen::VectorXd EvalOutputUpdateNonlinearPartView(double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemNoise, const VectorView& sensorState,
+			const VectorView& sensorNoise) const override;
 
 		Eigen::VectorXi getOutputUpdateNonlinXbsDep() const override;
 
@@ -50,9 +50,9 @@ namespace SF {
 
 		Eigen::MatrixXd getBs(double Ts) const;
 
-		Eigen::VectorXd EvalStateUpdateNonlinearPart(double Ts, const Eigen::VectorXd& baseSystemState,
-			const Eigen::VectorXd& baseSystemDisturbance, const Eigen::VectorXd& sensorState,
-			const Eigen::VectorXd& sensorDisturbance) const;
+		Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemDisturbance, const VectorView& sensorState,
+			const VectorView& sensorDisturbance) const;
 
 		Eigen::VectorXi getStateUpdateNonlinXbsDep() const;
 		
@@ -69,6 +69,10 @@ namespace SF {
 		bool isCompatible(BaseSystem::BaseSystemPtr ptr) const;
 
 		const Eigen::VectorXi& getIfOutputIsRad() const override;
+
+		CachingPolicy getCachingPolicy() const override;
+
+		MatrixStructure getMatrixStructure(ModelMatrix matrix) const override;
 	};
 
 }
\ No newline at end of file
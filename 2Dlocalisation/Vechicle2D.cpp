@@ -3,13 +3,13 @@
 using namespace SF;
 
 Eigen::MatrixXd SF::Vechicle2D::getA(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Identity(5, 5);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Identity(5, 5);
 	out(2, 4) = Ts;
 	return out;
 }
 
 Eigen::MatrixXd SF::Vechicle2D::getB(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(5, 2);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(5, 2);
 	out(3, 0) = Ts;
 	out(4, 1) = Ts;
 #ifdef use_Ts2_coeffs
@@ -18,8 +18,8 @@ Eigen::MatrixXd SF::Vechicle2D::getB(double Ts) const {
 	return out;
 }
 
-Eigen::VectorXd SF::Vechicle2D::EvalStateUpdateNonlinearPart(double Ts, const Eigen::VectorXd & state, const Eigen::VectorXd & disturbance) const {
-	static Eigen::VectorXd out = Eigen::VectorXd::Zero(5);
+Eigen::VectorXd SF::Vechicle2D::EvalStateUpdateNonlinearPartView(double Ts, const VectorView & state, const VectorView & disturbance) const {
+	Eigen::VectorXd out = Eigen::VectorXd::Zero(5);
 	double ds = Ts * state(3);
 #ifdef use_Ts2_coeffs
 	ds += Ts * Ts / 2.*disturbance(0);
@@ -32,7 +32,7 @@ Eigen::VectorXd SF::Vechicle2D::EvalStateUpdateNonlinearPart(double Ts, const Ei
 // The nonlinear parts and the dependencies are by default zeros
 
 Eigen::VectorXi SF::Vechicle2D::getStateUpdateNonlinXDep() const {
-	static Eigen::VectorXi out = Eigen::VectorXi::Zero(5);
+	Eigen::VectorXi out = Eigen::VectorXi::Zero(5);
 	out(2) = 1;
 	out(3) = 1;
 	return out;
@@ -40,21 +40,21 @@ Eigen::VectorXi SF::Vechicle2D::getStateUpdateNonlinXDep() const {
 
 #ifdef use_Ts2_coeffs
 Eigen::VectorXi SF::VelocityBased_2DBase::getStateUpdateNonlinWDep() const {
-	static Eigen::VectorXi out = Eigen::VectorXi::Zero(2);
+	Eigen::VectorXi out = Eigen::VectorXi::Zero(2);
 	out(0) = 1;
 	return out;
 }
 #endif
 
 Eigen::MatrixXd SF::Vechicle2D::getC(double Ts) const {
-	static Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 5);
 	for (int i = 0; i < 3; i++)
 		out(i, i) = 1.;
 	return out;
 }
 
 Eigen::MatrixXd SF::Vechicle2D::getD(double Ts) const {
-	static auto out = Eigen::MatrixXd::Zero(3, 0);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(3, 0);
 	return out;
 }
 
@@ -84,3 +84,18 @@ const Eigen::VectorXi & SF::Vechicle2D::getIfStateIsRad() const {
 	static Eigen::VectorXi out = ZZOZZ();
 	return out;
 }
+
+CachingPolicy SF::Vechicle2D::getCachingPolicy() const {
+	return CACHE_BY_TS;
+}
+
+MatrixStructure SF::Vechicle2D::getMatrixStructure(ModelMatrix matrix) const {
+	switch (matrix) {
+	case MATRIX_C:
+		return SELECTION;
+	case MATRIX_D:
+		return ZERO;
+	default:
+		return DENSE;
+	}
+}
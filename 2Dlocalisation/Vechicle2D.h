@@ -69,8 +69,8 @@ namespace SF {
 
 		Eigen::MatrixXd getB(double Ts) const;
 
-		Eigen::VectorXd EvalStateUpdateNonlinearPart(double Ts,
-			const Eigen::VectorXd& state, const Eigen::VectorXd& disturbance) const;
+		Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts,
+			const VectorView& state, const VectorView& disturbance) const override;
 
 		Eigen::VectorXi getStateUpdateNonlinXDep() const override;
 
@@ -91,5 +91,9 @@ namespace SF {
 		unsigned int getNumOfNoises() const;
 
 		const Eigen::VectorXi& getIfStateIsRad() const override;
+
+		CachingPolicy getCachingPolicy() const override;
+
+		MatrixStructure getMatrixStructure(ModelMatrix matrix) const override;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+# automatically generated by the FlatBuffers compiler, do not modify
+
+# namespace: DataMsgContentNameSpace
+
+import flatbuffers
+
+class Batch(object):
+    __slots__ = ['_tab']
+
+    @classmethod
+    def GetRootAsBatch(cls, buf, offset):
+        n = flatbuffers.encode.Get(flatbuffers.packer.uoffset, buf, offset)
+        x = Batch()
+        x.Init(buf, n + offset)
+        return x
+
+    # Batch
+    def Init(self, buf, pos):
+        self._tab = flatbuffers.table.Table(buf, pos)
+
+    # Batch
+    def Records(self, j):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(4))
+        if o != 0:
+            x = self._tab.Vector(o)
+            x += flatbuffers.number_types.UOffsetTFlags.py_type(j) * 4
+            x = self._tab.Indirect(x)
+            from .Record import Record
+            obj = Record()
+            obj.Init(self._tab.Bytes, x)
+            return obj
+        return None
+
+    # Batch
+    def RecordsLength(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(4))
+        if o != 0:
+            return self._tab.VectorLen(o)
+        return 0
+
+def BatchStart(builder): builder.StartObject(1)
+def BatchAddRecords(builder, records): builder.PrependUOffsetTRelativeSlot(0, flatbuffers.number_types.UOffsetTFlags.py_type(records), 0)
+def BatchStartRecordsVector(builder, numElems): return builder.StartVector(4, numElems, 4)
+def BatchEnd(builder): return builder.EndObject()
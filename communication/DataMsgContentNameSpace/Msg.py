@@ -69,10 +69,130 @@ class Msg(object):
             return self._tab.Get(flatbuffers.number_types.Int64Flags, o + self._tab.Pos)
         return 0
 
-def MsgStart(builder): builder.StartObject(3)
+    # Msg
+    def VarianceDiagonal(self, j):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(10))
+        if o != 0:
+            a = self._tab.Vector(o)
+            return self._tab.Get(flatbuffers.number_types.Float32Flags, a + flatbuffers.number_types.UOffsetTFlags.py_type(j * 4))
+        return 0
+
+    # Msg
+    def VarianceDiagonalAsNumpy(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(10))
+        if o != 0:
+            return self._tab.GetVectorAsNumpy(flatbuffers.number_types.Float32Flags, o)
+        return 0
+
+    # Msg
+    def VarianceDiagonalLength(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(10))
+        if o != 0:
+            return self._tab.VectorLen(o)
+        return 0
+
+    # Msg
+    def ValueQuantised(self, j):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(12))
+        if o != 0:
+            a = self._tab.Vector(o)
+            return self._tab.Get(flatbuffers.number_types.Int16Flags, a + flatbuffers.number_types.UOffsetTFlags.py_type(j * 2))
+        return 0
+
+    # Msg
+    def ValueQuantisedAsNumpy(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(12))
+        if o != 0:
+            return self._tab.GetVectorAsNumpy(flatbuffers.number_types.Int16Flags, o)
+        return 0
+
+    # Msg
+    def ValueQuantisedLength(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(12))
+        if o != 0:
+            return self._tab.VectorLen(o)
+        return 0
+
+    # Msg
+    def ValueScale(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(14))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Float32Flags, o + self._tab.Pos)
+        return 0.0
+
+    # Msg
+    def VarianceQuantised(self, j):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(16))
+        if o != 0:
+            a = self._tab.Vector(o)
+            return self._tab.Get(flatbuffers.number_types.Int16Flags, a + flatbuffers.number_types.UOffsetTFlags.py_type(j * 2))
+        return 0
+
+    # Msg
+    def VarianceQuantisedAsNumpy(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(16))
+        if o != 0:
+            return self._tab.GetVectorAsNumpy(flatbuffers.number_types.Int16Flags, o)
+        return 0
+
+    # Msg
+    def VarianceQuantisedLength(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(16))
+        if o != 0:
+            return self._tab.VectorLen(o)
+        return 0
+
+    # Msg
+    def VarianceScale(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(18))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Float32Flags, o + self._tab.Pos)
+        return 0.0
+
+    # Msg
+    def VarianceIsDiagonal(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(20))
+        if o != 0:
+            return bool(self._tab.Get(flatbuffers.number_types.BoolFlags, o + self._tab.Pos))
+        return False
+
+    # Msg
+    def VarianceSameAsLast(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(22))
+        if o != 0:
+            return bool(self._tab.Get(flatbuffers.number_types.BoolFlags, o + self._tab.Pos))
+        return False
+
+    # Msg
+    def VarianceReference(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(24))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Uint32Flags, o + self._tab.Pos)
+        return 0
+
+    # Msg
+    def Sequence(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(26))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Uint32Flags, o + self._tab.Pos)
+        return 0
+
+def MsgStart(builder): builder.StartObject(12)
 def MsgAddValueVector(builder, valueVector): builder.PrependUOffsetTRelativeSlot(0, flatbuffers.number_types.UOffsetTFlags.py_type(valueVector), 0)
 def MsgStartValueVectorVector(builder, numElems): return builder.StartVector(4, numElems, 4)
 def MsgAddVarianceMatrix(builder, varianceMatrix): builder.PrependUOffsetTRelativeSlot(1, flatbuffers.number_types.UOffsetTFlags.py_type(varianceMatrix), 0)
 def MsgStartVarianceMatrixVector(builder, numElems): return builder.StartVector(4, numElems, 4)
 def MsgAddTimestampInUs(builder, timestampInUs): builder.PrependInt64Slot(2, timestampInUs, 0)
+def MsgAddVarianceDiagonal(builder, varianceDiagonal): builder.PrependUOffsetTRelativeSlot(3, flatbuffers.number_types.UOffsetTFlags.py_type(varianceDiagonal), 0)
+def MsgStartVarianceDiagonalVector(builder, numElems): return builder.StartVector(4, numElems, 4)
+def MsgAddValueQuantised(builder, valueQuantised): builder.PrependUOffsetTRelativeSlot(4, flatbuffers.number_types.UOffsetTFlags.py_type(valueQuantised), 0)
+def MsgStartValueQuantisedVector(builder, numElems): return builder.StartVector(2, numElems, 2)
+def MsgAddValueScale(builder, valueScale): builder.PrependFloat32Slot(5, valueScale, 0.0)
+def MsgAddVarianceQuantised(builder, varianceQuantised): builder.PrependUOffsetTRelativeSlot(6, flatbuffers.number_types.UOffsetTFlags.py_type(varianceQuantised), 0)
+def MsgStartVarianceQuantisedVector(builder, numElems): return builder.StartVector(2, numElems, 2)
+def MsgAddVarianceScale(builder, varianceScale): builder.PrependFloat32Slot(7, varianceScale, 0.0)
+def MsgAddVarianceIsDiagonal(builder, varianceIsDiagonal): builder.PrependBoolSlot(8, varianceIsDiagonal, 0)
+def MsgAddVarianceSameAsLast(builder, varianceSameAsLast): builder.PrependBoolSlot(9, varianceSameAsLast, 0)
+def MsgAddVarianceReference(builder, varianceReference): builder.PrependUint32Slot(10, varianceReference, 0)
+def MsgAddSequence(builder, sequence): builder.PrependUint32Slot(11, sequence, 0)
 def MsgEnd(builder): return builder.EndObject()
@@ -0,0 +1,58 @@
+# automatically generated by the FlatBuffers compiler, do not modify
+
+# namespace: DataMsgContentNameSpace
+
+import flatbuffers
+
+class Record(object):
+    __slots__ = ['_tab']
+
+    @classmethod
+    def GetRootAsRecord(cls, buf, offset):
+        n = flatbuffers.encode.Get(flatbuffers.packer.uoffset, buf, offset)
+        x = Record()
+        x.Init(buf, n + offset)
+        return x
+
+    # Record
+    def Init(self, buf, pos):
+        self._tab = flatbuffers.table.Table(buf, pos)
+
+    # Record
+    def Source(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(4))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Uint8Flags, o + self._tab.Pos)
+        return 0
+
+    # Record
+    def Id(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(6))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Uint8Flags, o + self._tab.Pos)
+        return 0
+
+    # Record
+    def Type(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(8))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.Uint8Flags, o + self._tab.Pos)
+        return 0
+
+    # Record
+    def Msg(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(10))
+        if o != 0:
+            x = self._tab.Indirect(o + self._tab.Pos)
+            from .Msg import Msg
+            obj = Msg()
+            obj.Init(self._tab.Bytes, x)
+            return obj
+        return None
+
+def RecordStart(builder): builder.StartObject(4)
+def RecordAddSource(builder, source): builder.PrependUint8Slot(0, source, 0)
+def RecordAddId(builder, id): builder.PrependUint8Slot(1, id, 0)
+def RecordAddType(builder, type): builder.PrependUint8Slot(2, type, 0)
+def RecordAddMsg(builder, msg): builder.PrependUOffsetTRelativeSlot(3, flatbuffers.number_types.UOffsetTFlags.py_type(msg), 0)
+def RecordEnd(builder): return builder.EndObject()
@@ -12,9 +12,11 @@ SF::Filter::Filter(FilterCore::FilterCorePtr filterCore_)
 
 void SF::Filter::SamplingTimeOver(const Time & currentTime) {
 	filterCore->SamplingTimeOver(currentTime);
-	// forward filtered state
+	// forward filtered state (in one batch if it is set)
+	results.clear();
 	for (int i = 0; i < filterCore->nSensors() + 1; i++)
-		ForwardDataMsg(filterCore->GetDataByIndex(i - 1, DataType::STATE, OperationType::FILTER_MEAS_UPDATE, currentTime), currentTime);
+		results.push_back(filterCore->GetDataByIndex(i - 1, DataType::STATE, OperationType::FILTER_MEAS_UPDATE, currentTime));
+	ForwardDataMsgs(std::move(results), currentTime);
 }
 
 bool SF::Filter::SaveDataMsg(const DataMsg & msg, const Time & currentTime) {
@@ -23,6 +25,13 @@ bool SF::Filter::SaveDataMsg(const DataMsg & msg, const Time & currentTime) {
 	return out;
 }
 
+bool SF::Filter::SaveDataMsg(const DataMsgView & msg, const Time & currentTime) {
+	bool out = filterCore->SaveDataMsg(msg, currentTime);
+	if (IsForwarding())
+		ForwardDataMsg(msg.ToDataMsg(), currentTime);
+	return out;
+}
+
 /*!< Must called if the DataMsgs in the queue were read */
 
 void SF::Filter::MsgQueueEmpty(const Time & currentTime) {
@@ -32,3 +41,7 @@ void SF::Filter::MsgQueueEmpty(const Time & currentTime) {
 void SF::Filter::SaveString(const std::string & msg, const Time & currentTime) {
 	ForwardString(msg, currentTime);
 }
+
+void SF::Filter::Idle(const Time & nextStepTime) {
+	filterCore->PrepareStep(nextStepTime);
+}
@@ -16,10 +16,14 @@ namespace SF {
 	class Filter : public Forwarder, public ZMQReciever {
 		using Forwarder::ForwardDataMsg;
 
+		using Forwarder::ForwardDataMsgs;
+
 		using Forwarder::ForwardString;
 
 		FilterCore::FilterCorePtr filterCore;
 
+		std::vector<DataMsg> results; // filtered states forwarded after the step (reused)
+
 	public:
 		Filter(FilterCore::FilterCorePtr filterCore_);
 
@@ -30,9 +34,15 @@ namespace SF {
 		/*!< Must called if new DataMsg recieved */
 		bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override;
 
+		/*!< Called if new DataMsg recieved and read in place: it is copied only if it is forwarded */
+		bool SaveDataMsg(const DataMsgView& msg, const Time& currentTime) override;
+
 		/*!< Must called if the DataMsgs in the queue were read */
 		void MsgQueueEmpty(const Time& currentTime) override;
 
 		void SaveString(const std::string& msg, const Time& currentTime) override;
+
+		/*!< Lets the FilterCore prepare the next step */
+		void Idle(const Time& nextStepTime) override;
 	};
 }
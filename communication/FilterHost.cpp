@@ -0,0 +1,162 @@
+#include "FilterHost.h"
+#include <algorithm>
+
+using namespace SF;
+
+SF::FilterHost::HostedFilter::HostedFilter(FilterCore::FilterCorePtr filterCore_, DTime Ts_, unsigned char IDOffset_)
+	: filterCore(filterCore_), Ts(Ts_), IDOffset(IDOffset_) {}
+
+SF::FilterHost::FilterHost(unsigned int nThreads)
+	: Forwarder(), ZMQReciever(), pool(nThreads) {}
+
+SF::FilterHost::~FilterHost() {
+	Stop();
+}
+
+size_t SF::FilterHost::AddFilter(FilterCore::FilterCorePtr filterCore, DTime Ts, const std::vector<unsigned char>& IDs,
+	unsigned char IDOffset) {
+	if (!filterCore)
+		throw std::runtime_error(std::string("FilterHost::AddFilter(): filterCore is NULL"));
+	if (Ts <= DTime::zero())
+		throw std::runtime_error(std::string("FilterHost::AddFilter(): Ts must be positive"));
+	if (IDOffset != 0 && IDs.empty())
+		throw std::runtime_error(std::string("FilterHost::AddFilter(): IDs must be given with IDOffset"));
+	for (unsigned char ID : IDs)
+		if (ID + IDOffset > 255)
+			throw std::runtime_error(std::string("FilterHost::AddFilter(): IDOffset + ID is out of range"));
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	size_t index = filters.size();
+	filters.push_back(HostedFilter(filterCore, Ts, IDOffset));
+	if (IDs.empty())
+		broadcastFilters.push_back(index);
+	else
+		for (unsigned char ID : IDs) {
+			std::vector<Route>& route = routes[ID + IDOffset];
+			if (std::find_if(route.begin(), route.end(), [index](const Route& r) { return r.filter == index; }) == route.end())
+				route.push_back(Route{ index, ID });
+		}
+	return index;
+}
+
+size_t SF::FilterHost::GetNumOfFilters() {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	return filters.size();
+}
+
+unsigned long long SF::FilterHost::GetNumOfSteps(size_t n) {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	return filters.at(n).nSteps;
+}
+
+unsigned long long SF::FilterHost::GetNumOfMissedDeadlines(size_t n) {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	return filters.at(n).nMissedDeadlines;
+}
+
+void SF::FilterHost::_Step(HostedFilter& filter, const Time& currentTime) {
+	filter.filterCore->SamplingTimeOver(currentTime);
+	filter.results.clear();
+	for (int i = 0; i < filter.filterCore->nSensors() + 1; i++)
+		filter.results.push_back(filter.filterCore->GetDataByIndex(i - 1, DataType::STATE, OperationType::FILTER_MEAS_UPDATE, currentTime));
+	if (filter.IDOffset != 0)
+		for (DataMsg& msg : filter.results)
+			msg.SetSourceID(msg.GetSourceID() + filter.IDOffset);
+	filter.nSteps++;
+	if (Now() > filter.tNext)
+		filter.nMissedDeadlines++;
+}
+
+void SF::FilterHost::SamplingTimeOver(const Time & currentTime) {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	// Collect the due filters
+	std::vector<size_t> due;
+	for (size_t i = 0; i < filters.size(); i++) {
+		HostedFilter& filter = filters[i];
+		if (!filter.initialized) {
+			filter.tNext = currentTime;
+			filter.initialized = true;
+		}
+		if (filter.tNext > currentTime)
+			continue;
+		// Skipped sampling instants are missed deadlines too
+		filter.tNext += filter.Ts;
+		while (filter.tNext <= currentTime) {
+			filter.tNext += filter.Ts;
+			filter.nMissedDeadlines++;
+		}
+		due.push_back(i);
+	}
+	if (due.empty())
+		return;
+	// Earliest deadline first: the workers pop their own queue from the back, the thieves from the front
+	std::stable_sort(due.begin(), due.end(), [this](size_t a, size_t b) { return filters[a].tNext > filters[b].tNext; });
+	for (size_t i : due) {
+		HostedFilter* filter = &filters[i];
+		pool.Submit([this, filter, currentTime]() { _Step(*filter, currentTime); });
+	}
+	pool.WaitAll();
+	// Forward the results in the order of the filters
+	std::sort(due.begin(), due.end());
+	for (size_t i : due)
+		ForwardDataMsgs(std::move(filters[i].results), currentTime);
+}
+
+template<class Msg>
+bool SF::FilterHost::_Route(const Msg & msg, const Time & currentTime) {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	bool out = false;
+	for (const Route& route : routes[msg.GetSourceID()]) {
+		HostedFilter& filter = filters[route.filter];
+		if (route.ID == msg.GetSourceID())
+			out |= filter.filterCore->SaveDataMsg(msg, currentTime);
+		else {
+			// The msg of a filter with ID offset: relabelled copy (for a view only the header is copied)
+			Msg relabelled = msg;
+			relabelled.SetSourceID(route.ID);
+			out |= filter.filterCore->SaveDataMsg(relabelled, currentTime);
+		}
+		filter.gotDataMsg = true;
+	}
+	for (size_t i : broadcastFilters) {
+		out |= filters[i].filterCore->SaveDataMsg(msg, currentTime);
+		filters[i].gotDataMsg = true;
+	}
+	return out;
+}
+
+bool SF::FilterHost::SaveDataMsg(const DataMsg & msg, const Time & currentTime) {
+	bool out = _Route(msg, currentTime);
+	ForwardDataMsg(msg, currentTime);
+	return out;
+}
+
+bool SF::FilterHost::SaveDataMsg(const DataMsgView & msg, const Time & currentTime) {
+	bool out = _Route(msg, currentTime);
+	if (IsForwarding())
+		ForwardDataMsg(msg.ToDataMsg(), currentTime);
+	return out;
+}
+
+void SF::FilterHost::MsgQueueEmpty(const Time & currentTime) {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	for (auto& filter : filters)
+		if (filter.gotDataMsg) {
+			filter.filterCore->MsgQueueEmpty(currentTime);
+			filter.gotDataMsg = false;
+		}
+}
+
+void SF::FilterHost::SaveString(const std::string & msg, const Time & currentTime) {
+	ForwardString(msg, currentTime);
+}
+
+void SF::FilterHost::Idle(const Time & nextStepTime) {
+	std::lock_guard<std::mutex> lock(filtersMutex);
+	for (auto& filter : filters)
+		if (filter.initialized) {
+			FilterCore* filterCore = filter.filterCore.get();
+			Time tNext = filter.tNext;
+			pool.Submit([filterCore, tNext]() { filterCore->PrepareStep(tNext); });
+		}
+	pool.WaitAll();
+}
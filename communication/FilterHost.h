@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include "FilterCore.h"
+#include "Forwarder.h"
+#include "ZMQReciever.h"
+#include "WorkStealingPool.h"
+
+namespace SF {
+
+	/*! \brief Class for realtime filtering with many FilterCore instances in one process
+	*
+	* The data is collected from zmq by a single ZMQReciever thread and it is routed to the hosted filters
+	* according to the source IDs given in AddFilter(). A filter without IDs gets every DataMsg. Filters using the
+	* same sensor IDs (e.g. the same model for several robots) are told apart by their ID offsets: the peripheries
+	* of each filter send with shifted source IDs, and the results of each filter are forwarded with shifted IDs.
+	*
+	* Every filter has its own sampling time. In each tick of the reciever (the Ts given to Start() - it should divide
+	* the sampling times of the filters) the due filters are executed on a work-stealing thread pool in earliest deadline
+	* first order. The deadline of a step is the next sampling instant of the filter, missed deadlines are counted.
+	*
+	* The filtered states of the executed filters are forwarded via inherited methods of class Forwarder after the step.
+	*/
+	class FilterHost : public Forwarder, public ZMQReciever {
+		using Forwarder::ForwardDataMsg;
+
+		using Forwarder::ForwardDataMsgs;
+
+		using Forwarder::ForwardString;
+
+	public:
+		FilterHost(unsigned int nThreads = 0); //!< Constructor - with nThreads = 0 the number of hardware threads is used
+
+		~FilterHost(); //!< Destructor - stops the reciever thread before the filters are destroyed
+
+		/*! \brief Add a filter to be hosted, returns its index
+		*
+		* The filter gets the DataMsgs with source ID listed in IDs (or every DataMsg if IDs is empty)
+		* and it is stepped with sampling time Ts.
+		*
+		* With nonzero IDOffset the filter gets the DataMsgs with source ID IDOffset + k as k for every k in IDs,
+		* and its results are forwarded with source ID IDOffset + k. IDs must be given in this case.
+		*/
+		size_t AddFilter(FilterCore::FilterCorePtr filterCore, DTime Ts,
+			const std::vector<unsigned char>& IDs = std::vector<unsigned char>(), unsigned char IDOffset = 0);
+
+		size_t GetNumOfFilters(); //!< Number of hosted filters
+
+		unsigned long long GetNumOfSteps(size_t n); //!< Number of steps done by the n-th filter
+
+		unsigned long long GetNumOfMissedDeadlines(size_t n); //!< Number of steps of the n-th filter finished or started too late
+
+	protected:
+		/*!< Must called in each sampling time - input: time */
+		void SamplingTimeOver(const Time& currentTime) override;
+
+		/*!< Must called if new DataMsg recieved */
+		bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override;
+
+		/*!< Called if new DataMsg recieved and read in place: it is copied only if it is forwarded */
+		bool SaveDataMsg(const DataMsgView& msg, const Time& currentTime) override;
+
+		/*!< Must called if the DataMsgs in the queue were read */
+		void MsgQueueEmpty(const Time& currentTime) override;
+
+		void SaveString(const std::string& msg, const Time& currentTime) override;
+
+		/*!< Lets the hosted filters prepare their next steps (on the thread pool) */
+		void Idle(const Time& nextStepTime) override;
+
+	private:
+		struct HostedFilter {
+			FilterCore::FilterCorePtr filterCore; /*!< The hosted filter */
+			DTime Ts; /*!< Sampling time of the filter */
+			Time tNext; /*!< Next sampling instant (the deadline of the running step) */
+			bool initialized = false; /*!< If tNext is set */
+			bool gotDataMsg = false; /*!< If DataMsg was saved since the last MsgQueueEmpty call */
+			unsigned long long nSteps = 0; /*!< Number of steps done */
+			unsigned long long nMissedDeadlines = 0; /*!< Number of steps finished/started too late */
+			unsigned char IDOffset; /*!< Added to the IDs of the filter on the wire */
+			std::vector<DataMsg> results; /*!< Filtered states of the last step to be forwarded */
+			HostedFilter(FilterCore::FilterCorePtr filterCore_, DTime Ts_, unsigned char IDOffset_);
+		};
+
+		struct Route {
+			size_t filter; /*!< Index of the filter */
+			unsigned char ID; /*!< Source ID as seen by the filter */
+		};
+
+		std::vector<HostedFilter> filters;
+
+		std::array<std::vector<Route>, 256> routes; // source ID on the wire -> (filter, ID) pairs
+
+		std::vector<size_t> broadcastFilters; // indices of the filters getting every DataMsg
+
+		std::mutex filtersMutex;
+
+		WorkStealingPool pool;
+
+		void _Step(HostedFilter& filter, const Time& currentTime);
+
+		template<class Msg>
+		bool _Route(const Msg& msg, const Time& currentTime);
+	};
+}
@@ -11,14 +11,29 @@ using namespace SF;
 #include"msgcontent2buf.h"
 #include"zmq_addon.hpp"
 
-SF::Forwarder::Forwarder() : spd_logger(NULL), zmq_context(NULL), zmq_socket(NULL) {}
+namespace {
+	// the frame of a 'p' msg is a shared_ptr of the DataMsg, it is released by zmq when every reciever has read it
+	void _ReleaseShared(void* data, void* hint) {
+		delete static_cast<std::shared_ptr<const DataMsg>*>(hint);
+	}
+
+	void _DataMsgTopic(const DataMsg& msg, unsigned char topicbuf[4], char kind) {
+		topicbuf[0] = kind;
+		topicbuf[1] = to_underlying<OperationType>(msg.GetDataSourceType());
+		topicbuf[2] = msg.GetSourceID();
+		topicbuf[3] = to_underlying<DataType>(msg.GetDataType());
+	}
+}
+
+SF::Forwarder::Forwarder() : spd_logger(NULL), zmq_context(NULL), zmq_socket(NULL), batchOutput(false), inprocOutput(false) {}
 
 SF::Forwarder::~Forwarder() {
 	if (spd_logger)
 		spdlog::drop(spd_logger->name());
 	if (zmq_socket) {
 		zmq_socket->close();
-		zmq_context->close();
+		if (!inprocOutput) // the inproc context is shared
+			zmq_context->close();
 	}
 }
 
@@ -31,9 +46,16 @@ void SF::Forwarder::SetLogger(const std::string& filename) {
 	}
 }
 
-void SF::Forwarder::SetZMQOutput(const std::string & address, int hwm) {
-	if (!zmq_socket) {
-		zmq_context = std::make_shared<zmq::context_t>(2);
+void SF::Forwarder::SetZMQOutput(const std::string & address, int hwm, size_t slotSize) {
+	if (IsShmAddress(address)) {
+		if (!shm_writer && !zmq_socket)
+			shm_writer = std::make_shared<ShmRingWriter>(address, hwm > 0 ? hwm : 1024,
+				slotSize > 0 ? slotSize : ShmRingWriter::defaultSlotSize);
+		return;
+	}
+	if (!zmq_socket && !shm_writer) {
+		inprocOutput = IsInprocAddress(address);
+		zmq_context = inprocOutput ? GetInprocContext() : std::make_shared<zmq::context_t>(2);
 		zmq_socket = std::make_shared<zmq::socket_t>(*zmq_context, ZMQ_PUB);
 		zmq_socket->setsockopt(ZMQ_SNDHWM, &hwm, sizeof(hwm));
 		try {
@@ -41,7 +63,8 @@ void SF::Forwarder::SetZMQOutput(const std::string & address, int hwm) {
 		}
 		catch (const zmq::error_t& t) {
 			zmq_socket->close();
-			zmq_context->close();
+			if (!inprocOutput)
+				zmq_context->close();
 			zmq_socket.reset();
 			zmq_context.reset();
 			zmq_socket = NULL;
@@ -51,7 +74,11 @@ void SF::Forwarder::SetZMQOutput(const std::string & address, int hwm) {
 	}
 }
 
-void SF::Forwarder::ForwardDataMsg(const DataMsg & msg, const Time & currentTime) {
+bool SF::Forwarder::IsForwarding() const {
+	return spd_logger || zmq_socket || shm_writer;
+}
+
+void SF::Forwarder::_LogDataMsg(const DataMsg & msg) {
 	if (spd_logger) {
 		spd_buf.clear();
 		fmt::format_to(spd_buf, "MSG [ ");
@@ -110,7 +137,7 @@ void SF::Forwarder::ForwardDataMsg(const DataMsg & msg, const Time & currentTime
 		spdlog::details::fmt_helper::pad6(static_cast<unsigned int>(micros), spd_buf);
 		fmt::format_to(spd_buf, " ");
 		if (msg.HasValue()) {
-			Eigen::VectorXd v = msg.GetValue();
+			const Eigen::VectorXd& v = msg.GetValue();
 			fmt::format_to(spd_buf, "VAL {} ", v.size());
 			for (int i = 0; i < v.size(); i++)
 				fmt::format_to(spd_buf, "{} ", v[i]);
@@ -118,7 +145,7 @@ void SF::Forwarder::ForwardDataMsg(const DataMsg & msg, const Time & currentTime
 		else
 			fmt::format_to(spd_buf, "NOVAL ");
 		if (msg.HasVariance()) {
-			Eigen::MatrixXd m = msg.GetVariance();
+			const Eigen::MatrixXd& m = msg.GetVariance();
 			fmt::format_to(spd_buf, "VAR {} ", m.rows());
 			for (int i = 0; i < m.cols(); i++)
 				for (int j = i; j < m.rows(); j++)
@@ -130,32 +157,132 @@ void SF::Forwarder::ForwardDataMsg(const DataMsg & msg, const Time & currentTime
 		spd_logger->info(spdlog::string_view_t(spd_buf.data(), spd_buf.size()));
 		spd_buf.clear();
 	}
-	if (zmq_socket) {
-		zmq::multipart_t zmq_msg;
-		unsigned char topicbuf[4];
-		topicbuf[0] = 'd';
-		topicbuf[1] = to_underlying<OperationType>(msg.GetDataSourceType());
-		topicbuf[2] = msg.GetSourceID();
-		topicbuf[3] = to_underlying<DataType>(msg.GetDataType());
-		zmq_msg.addmem(topicbuf, 4);
-		unsigned char* buf;
-		int bufsize;
-		SerializeDataMsg(msg, buf, bufsize);
-		zmq_msg.addmem((void*)buf, bufsize);
+}
+
+void SF::Forwarder::_Send(const unsigned char * topic, size_t topicLength, DataMsgSerializer::Buffer * buf) {
+	if (shm_writer) {
+		// copied into the ring, the buffer can be reused at once
 		try {
-			zmq_msg.send(*zmq_socket, ZMQ_DONTWAIT);
+			shm_writer->Write(topic, topicLength, DataMsgSerializer::Data(buf), DataMsgSerializer::Size(buf));
 		}
 		catch (...) {
-			std::throw_with_nested(std::runtime_error("FATAL ERROR: sending ZMQ msg (MQSender::CallbackGotDataMsg)"));
+			DataMsgSerializer::Release(const_cast<void*>(DataMsgSerializer::Data(buf)), buf);
+			throw;
+		}
+		DataMsgSerializer::Release(const_cast<void*>(DataMsgSerializer::Data(buf)), buf);
+		return;
+	}
+	// the buffer is given back to the pool by zmq when it is sent (or dropped)
+	zmq::message_t zmq_msg(const_cast<void*>(DataMsgSerializer::Data(buf)), DataMsgSerializer::Size(buf),
+		DataMsgSerializer::Release, buf);
+	try {
+		zmq_socket->send(topic, topicLength, ZMQ_SNDMORE | ZMQ_DONTWAIT);
+		zmq_socket->send(zmq_msg, ZMQ_DONTWAIT);
+	}
+	catch (...) {
+		std::throw_with_nested(std::runtime_error("FATAL ERROR: sending ZMQ msg (MQSender::CallbackGotDataMsg)"));
+	}
+}
+
+void SF::Forwarder::_SendShared(const std::shared_ptr<const DataMsg>& msg) {
+	unsigned char topicbuf[4];
+	_DataMsgTopic(*msg, topicbuf, 'p');
+	// the recievers are in the same context: the frame is not copied, they read the shared_ptr in place
+	auto shared = new std::shared_ptr<const DataMsg>(msg);
+	zmq::message_t zmq_msg(shared, sizeof(*shared), _ReleaseShared, shared);
+	try {
+		zmq_socket->send(topicbuf, 4, ZMQ_SNDMORE | ZMQ_DONTWAIT);
+		zmq_socket->send(zmq_msg, ZMQ_DONTWAIT);
+	}
+	catch (...) {
+		std::throw_with_nested(std::runtime_error("FATAL ERROR: sending ZMQ msg (Forwarder::_SendShared)"));
+	}
+}
+
+void SF::Forwarder::ForwardDataMsg(const DataMsg & msg, const Time & currentTime) {
+	if (inprocOutput) {
+		ForwardDataMsg(std::make_shared<const DataMsg>(msg), currentTime);
+		return;
+	}
+	_LogDataMsg(msg);
+	if (zmq_socket || shm_writer) {
+		unsigned char topicbuf[4];
+		_DataMsgTopic(msg, topicbuf, 'd');
+		_Send(topicbuf, 4, serializer.Serialize(msg));
+	}
+}
+
+void SF::Forwarder::ForwardDataMsg(DataMsg && msg, const Time & currentTime) {
+	if (inprocOutput)
+		ForwardDataMsg(std::make_shared<const DataMsg>(std::move(msg)), currentTime);
+	else
+		ForwardDataMsg(static_cast<const DataMsg&>(msg), currentTime);
+}
+
+void SF::Forwarder::ForwardDataMsg(const std::shared_ptr<const DataMsg>& msg, const Time & currentTime) {
+	if (!inprocOutput) {
+		ForwardDataMsg(*msg, currentTime);
+		return;
+	}
+	_LogDataMsg(*msg);
+	_SendShared(msg);
+}
+
+void SF::Forwarder::ForwardDataMsgs(std::vector<DataMsg>&& msgs, const Time & currentTime) {
+	if (!inprocOutput) {
+		ForwardDataMsgs(static_cast<const std::vector<DataMsg>&>(msgs), currentTime);
+		return;
+	}
+	for (DataMsg& msg : msgs)
+		ForwardDataMsg(std::make_shared<const DataMsg>(std::move(msg)), currentTime);
+}
+
+void SF::Forwarder::ForwardDataMsgs(const std::vector<DataMsg>& msgs, const Time & currentTime) {
+	if (!batchOutput || inprocOutput) { // nothing to gain by batching the shared msgs
+		for (const DataMsg& msg : msgs)
+			ForwardDataMsg(msg, currentTime);
+		return;
+	}
+	for (const DataMsg& msg : msgs)
+		_LogDataMsg(msg);
+	if (zmq_socket || shm_writer) {
+		// one batch for the consecutive msgs with the same source (as many as surely fit into a slot of the shm ring)
+		const size_t topicLength = 2;
+		auto first = msgs.begin();
+		while (first != msgs.end()) {
+			auto last = first + 1;
+			size_t maxSize = topicLength + DataMsgSerializer::maxBatchOverhead + DataMsgSerializer::MaxBatchRecordSize(*first);
+			while (last != msgs.end() && last->GetDataSourceType() == first->GetDataSourceType()) {
+				if (shm_writer) {
+					maxSize += DataMsgSerializer::MaxBatchRecordSize(*last);
+					if (maxSize > shm_writer->GetSlotSize())
+						break;
+				}
+				last++;
+			}
+			unsigned char topicbuf[topicLength];
+			topicbuf[0] = 'b';
+			topicbuf[1] = to_underlying<OperationType>(first->GetDataSourceType());
+			_Send(topicbuf, topicLength, serializer.SerializeBatch(first, last));
+			first = last;
 		}
-		delete buf;
 	}
 }
 
+void SF::Forwarder::SetBatchOutput(bool batch) {
+	batchOutput = batch;
+}
+
+void SF::Forwarder::SetEncoding(const DataMsgEncoding & encoding) {
+	serializer.SetEncoding(encoding);
+}
+
 void SF::Forwarder::ForwardString(const std::string & msg, const Time & currentTime) {
 	if (spd_logger) {
 		spd_logger->info(("STR " + msg).c_str());
 	}
+	if (shm_writer)
+		shm_writer->Write("i", 1, msg.c_str(), msg.length());
 	if (zmq_socket) {
 		zmq::multipart_t zmq_msg;
 		char i = 'i';
@@ -2,6 +2,9 @@
 #include "spdlog/logger.h"
 #include <zmq.hpp>
 #include "DataMsg.h"
+#include "msgcontent2buf.h"
+#include "comm_defs.h"
+#include "ShmRing.h"
 
 namespace SF {
 
@@ -12,11 +15,25 @@ namespace SF {
 		// ZMQout
 		std::shared_ptr<zmq::socket_t> zmq_socket;
 		std::shared_ptr<zmq::context_t> zmq_context;
+		DataMsgSerializer serializer; // the serialized buffers are handed over to zmq without copying
+
+		// shm ring instead of the ZMQ socket
+		std::shared_ptr<ShmRingWriter> shm_writer;
 
 		// SPDlog
 		std::shared_ptr<spdlog::logger> spd_logger;
 		spdlog::memory_buf_t spd_buf;
 
+		bool batchOutput; // if the msgs forwarded together are sent in one batch
+
+		bool inprocOutput; // if the DataMsgs are shared via an inproc:// socket instead of serializing them
+
+		void _LogDataMsg(const DataMsg& msg);
+
+		void _Send(const unsigned char* topic, size_t topicLength, DataMsgSerializer::Buffer* buf);
+
+		void _SendShared(const std::shared_ptr<const DataMsg>& msg); // with a 'p' topic
+
 	public:
 		Forwarder(); //!< Constructor
 
@@ -24,10 +41,54 @@ namespace SF {
 
 		void SetLogger(const std::string& filename); //!< Set logfile to forward into
 
-		void SetZMQOutput(const std::string & address, int hwm); //!< Set ZMQ socket to forward the data into
+		/*! \brief Set ZMQ socket to forward the data into
+		*
+		* With an inproc:// address the DataMsgs are not serialized: the ZMQRecievers of the process get the pointers of
+		* them (with a 'p' topic, see msgstructure.txt).
+		*
+		* With a shm:// address (e.g. "shm://imu") the msgs are written into a ring in shared memory (see ShmRingWriter)
+		* with hwm slots (1024 if it is 0) of slotSize bytes (ShmRingWriter::defaultSlotSize if it is 0): the ZMQRecievers on
+		* the same host read them without syscalls. A msg larger than a slot throws, the batches are split to fit.
+		*/
+		void SetZMQOutput(const std::string & address, int hwm, size_t slotSize = 0);
 
 		void ForwardDataMsg(const DataMsg& msg, const Time& currentTime); //!< Forward DataMsg to the set channels
 
+		void ForwardDataMsg(DataMsg&& msg, const Time& currentTime); //!< The same for a temporary msg: the inproc recievers get it moved, without copying
+
+		/*! \brief Forward a shared DataMsg to the set channels
+		*
+		* The inproc recievers get the msg itself without copying it, so it must not be modified after forwarding.
+		*/
+		void ForwardDataMsg(const std::shared_ptr<const DataMsg>& msg, const Time& currentTime);
+
+		/*! \brief Forward several DataMsgs to the set channels
+		*
+		* If batch output is set, they are sent in batches (see SetBatchOutput()), otherwise one by one. Into a shm ring a
+		* batch is split if it may not fit into a slot (see DataMsgSerializer::MaxBatchRecordSize()).
+		*/
+		void ForwardDataMsgs(const std::vector<DataMsg>& msgs, const Time& currentTime);
+
+		/*! \brief The same, but the inproc recievers get the msgs moved out of the vector without copying
+		*
+		* With inproc output the msgs of the vector are left moved-from (they can be assigned again), otherwise they are unchanged.
+		*/
+		void ForwardDataMsgs(std::vector<DataMsg>&& msgs, const Time& currentTime);
+
+		/*! \brief Send the DataMsgs forwarded together in one msg with a 'b' topic (see msgstructure.txt)
+		*
+		* One batch is sent for the consecutive msgs with the same source. The ZMQReciever unpacks them.
+		*/
+		void SetBatchOutput(bool batch);
+
+		/*! \brief Allow compact encodings of the sent DataMsgs (see DataMsgEncoding)
+		*
+		* They are all off by default. The ZMQRecievers decode them, the logged msgs are not affected.
+		*/
+		void SetEncoding(const DataMsgEncoding& encoding);
+
+		bool IsForwarding() const; //!< To check if there is any channel set to forward into
+
 		void ForwardString(const std::string& msg, const Time& currentTime); //!< Forward string to the set channels
 	};
 }
@@ -6,17 +6,25 @@
 using namespace SF;
 
 NetworkConfig::ConnectionData::ConnectionData(const std::string & type, const std::string & address_, const std::string & port_) :
-	commType(type), address(address_), port(port_), hwm(-1) {}
+	commType(type), address(address_), port(port_), hwm(-1), slotSize(0) {}
 
 void SF::NetworkConfig::ConnectionData::SetHWM(int hwm_) {
 	hwm = hwm_;
 }
 
+void SF::NetworkConfig::ConnectionData::SetSlotSize(size_t slotSize_) {
+	slotSize = slotSize_;
+}
+
 std::string NetworkConfig::ConnectionData::RecieverAddress() const {
 	if (commType.compare("tcp") == 0)
 		return "tcp://" + address + ":" + port;
 	if (commType.compare("ipc") == 0)
 		return "ipc:///" + address;
+	if (commType.compare("inproc") == 0)
+		return "inproc://" + address;
+	if (commType.compare("shm") == 0)
+		return "shm://" + address;
 	throw std::runtime_error("FATAL ERROR: not iplemented communication protocol '" + commType + "' (in NetworkConfig::ConnectionData::RecieverAddress)");
 }
 
@@ -25,6 +33,10 @@ std::string NetworkConfig::ConnectionData::SenderAddress() const {
 		return "tcp://*:" + port;
 	if (commType.compare("ipc") == 0)
 		return "ipc:///" + address;
+	if (commType.compare("inproc") == 0)
+		return "inproc://" + address;
+	if (commType.compare("shm") == 0)
+		return "shm://" + address;
 	throw std::runtime_error("FATAL ERROR: not iplemented communication protocol '" + commType + "' (in NetworkConfig::ConnectionData::SenderAddress)");
 }
 
@@ -72,12 +84,14 @@ void NetworkConfig::Add(const std::string& filename) {
 				address = "localhost";
 				port = periphery.value().at("address");
 			}
-			if (type.compare("ipc") == 0)
+			if (type.compare("ipc") == 0 || type.compare("inproc") == 0 || type.compare("shm") == 0)
 				address = periphery.value().at("address");
 			peripheryData.insert(std::pair<std::string, ConnectionData>(periphery.key(),
 				ConnectionData(type, address, port)));
 			if (periphery.value().find("hwm") != periphery.value().end())
 				peripheryData.at(periphery.key()).SetHWM(periphery.value().at("hwm"));
+			if (periphery.value().find("slotSize") != periphery.value().end())
+				peripheryData.at(periphery.key()).SetSlotSize(periphery.value().at("slotSize"));
 		}
 }
 
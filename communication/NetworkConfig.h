@@ -15,13 +15,15 @@ namespace SF {
 		*
 		*/
 		struct ConnectionData {
-			std::string commType; //!< tcp or ipc
-			std::string address; //!< IP or ipc_name
+			std::string commType; //!< tcp, ipc, inproc (in the same process) or shm (ring in shared memory)
+			std::string address; //!< IP, ipc_name, inproc_name or shm_name
 			std::string port; //!< port for TCP
 			int hwm; //!< -1: not defined, 0: infinite, >0: the given value...
+			size_t slotSize; //!< for shm: maximal size of a msg in bytes, 0: the default (see ShmRingWriter)
 			ConnectionData(const std::string& type, const std::string& address_, const std::string& port_ = "");
 			//!< Constructor
 			void SetHWM(int hwm_);  //!< to modify hwm settings
+			void SetSlotSize(size_t slotSize_);  //!< to modify the slot size of a shm ring
 			std::string RecieverAddress() const; //!< get address can be used for the reciever
 			std::string SenderAddress() const; //!< get address can be used for the sender
 		};
@@ -1,29 +1,41 @@
 #include "Periphery.h"
 
-SF::Periphery::Periphery(const std::string& address, int hwm) {
-	SetZMQOutput(address, hwm);
+SF::Periphery::Periphery(const std::string& address, int hwm, size_t slotSize) {
+	SetZMQOutput(address, hwm, slotSize);
 }
 
 SF::Periphery::Periphery(const NetworkConfig::ConnectionData & config) {
-	SetZMQOutput(config.SenderAddress(), config.hwm != -1 ? config.hwm : 10);
+	SetZMQOutput(config.SenderAddress(), config.hwm != -1 ? config.hwm : 10, config.slotSize);
 }
 
 void SF::Periphery::SendValue(unsigned char sensorID, const Eigen::VectorXd & value, DataType type, Time t, OperationType source) {
-	DataMsg msg(sensorID, type, source, t);
-	msg.SetValueVector(value);
+	auto msg = std::make_shared<DataMsg>(sensorID, type, source, t);
+	msg->SetValueVector(value);
 	ForwardDataMsg(msg, Now());
 }
 
 void SF::Periphery::SendVariance(unsigned char sensorID, const Eigen::MatrixXd & variance, DataType type, Time t, OperationType source) {
-	DataMsg msg(sensorID, type, source, t);
-	msg.SetVarianceMatrix(variance);
+	auto msg = std::make_shared<DataMsg>(sensorID, type, source, t);
+	msg->SetVarianceMatrix(variance);
 	ForwardDataMsg(msg, Now());
 }
 
 void SF::Periphery::SendValueAndVariance(unsigned char sensorID, const Eigen::VectorXd & value,
 	const Eigen::MatrixXd & variance, DataType type,Time t, OperationType source) {
-	DataMsg msg(sensorID, type, source, t);
-	msg.SetValueVector(value);
-	msg.SetVarianceMatrix(variance);
+	auto msg = std::make_shared<DataMsg>(sensorID, type, source, t);
+	msg->SetValueVector(value);
+	msg->SetVarianceMatrix(variance);
 	ForwardDataMsg(msg, Now());
 }
+
+void SF::Periphery::SendDataMsg(const std::shared_ptr<const DataMsg>& msg) {
+	ForwardDataMsg(msg, Now());
+}
+
+void SF::Periphery::SendDataMsgs(const std::vector<DataMsg>& msgs) {
+	ForwardDataMsgs(msgs, Now());
+}
+
+void SF::Periphery::SendDataMsgs(std::vector<DataMsg>&& msgs) {
+	ForwardDataMsgs(std::move(msgs), Now());
+}
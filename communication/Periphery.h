@@ -5,13 +5,16 @@ namespace SF {
 
 	/*! \brief Class to send datamsgs from sensors, basesystem, etc.
 	*
+	* With an inproc:// address (e.g. "inproc://gps") the ZMQRecievers of the same process get the sent DataMsgs
+	* without serializing or copying them.
+	*
 	* The class is NOT thread safe! The same thread must initialize the class and call its methods.
 	*/
 	class Periphery : public Forwarder {
 		using Forwarder::SetZMQOutput;
 
 	public:
-		Periphery(const std::string& address, int hwm = 10); /*!< Constructor, address e.g..: "tcp://*:5678" */
+		Periphery(const std::string& address, int hwm = 10, size_t slotSize = 0); /*!< Constructor, address e.g..: "tcp://*:5678" (slotSize: see Forwarder::SetZMQOutput) */
 
 		Periphery(const NetworkConfig::ConnectionData& config); //!< Constructor
 
@@ -24,6 +27,12 @@ namespace SF {
 		void SendValueAndVariance(unsigned char sensorID, const Eigen::VectorXd& value,
 			const Eigen::MatrixXd& variance, DataType type,
 			Time t = Now(), OperationType source = OperationType::SENSOR); /*!< Publish a DataMsg with a given values */
+
+		void SendDataMsg(const std::shared_ptr<const DataMsg>& msg); /*!< Publish a DataMsg (it must not be modified after it) */
+
+		void SendDataMsgs(const std::vector<DataMsg>& msgs); /*!< Publish several DataMsgs (in batches if SetBatchOutput() is set) */
+
+		void SendDataMsgs(std::vector<DataMsg>&& msgs); /*!< The same, the inproc recievers get the msgs moved out of the vector (see Forwarder::ForwardDataMsgs()) */
 	};
 
 }
@@ -0,0 +1,250 @@
+#include "PipelinedFilter.h"
+#include "PrintNestedException.h"
+#include <iostream>
+
+using namespace SF;
+
+namespace {
+	// spin, then yield, then sleep while a queue is empty/full
+	void _Backoff(unsigned int& nTries) {
+		if (nTries > 200)
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		else if (nTries > 100)
+			std::this_thread::yield();
+		nTries++;
+	}
+
+	template<class F>
+	void _RunStage(const char* name, F run) {
+		try {
+			run();
+		}
+		catch (std::exception& e) {
+			std::cout << "PipelinedFilter " << name << " thread has stopped because of an unhandled exception:" << std::endl;
+			print_exception(e);
+		}
+	}
+}
+
+SF::PipelinedFilter::PipelinedFilter(FilterCore::FilterCorePtr filterCore_, size_t queueCapacity, unsigned int nRecieverThreads)
+	: Forwarder(), ZMQReciever(), filterCore(filterCore_), inputQueue(queueCapacity), outputQueue(queueCapacity),
+	stopFiltering(false), stopForwarding(false) {
+	if (!filterCore)
+		throw std::runtime_error(std::string("PipelinedFilter::PipelinedFilter(): Invalid FilterCore!"));
+	SetNumOfRecieverThreads(nRecieverThreads);
+	filterThread = std::thread([this]() { _RunStage("filter", [this]() { _RunFiltering(); }); });
+	forwarderThread = std::thread([this]() { _RunStage("forwarder", [this]() { _RunForwarding(); }); });
+}
+
+SF::PipelinedFilter::~PipelinedFilter() {
+	// the producers are stopped first, so the queues can be drained
+	Stop();
+	stopFiltering = true;
+	filterThread.join();
+	stopForwarding = true;
+	forwarderThread.join();
+}
+
+PipelinedFilter::StageStatistics SF::PipelinedFilter::GetStageStatistics(Stage stage) const {
+	const StageCounters& c = counters[stage];
+	StageStatistics s;
+	switch (stage) {
+	case FILTERING:
+		s.queueSize = inputQueue.Size();
+		s.queueCapacity = inputQueue.Capacity();
+		break;
+	case FORWARDING:
+		s.queueSize = outputQueue.Size();
+		s.queueCapacity = outputQueue.Capacity();
+		break;
+	default:
+		s.queueSize = 0;
+		s.queueCapacity = 0;
+	}
+	s.maxQueueSize = c.maxQueueSize;
+	s.nProcessed = c.nProcessed;
+	s.nDropped = c.nDropped;
+	s.nUnknownIDs = c.nUnknownIDs;
+	s.meanLatency = DTime(s.nProcessed ? c.sumLatency / static_cast<long long>(s.nProcessed) : 0);
+	s.maxLatency = DTime(c.maxLatency);
+	return s;
+}
+
+void SF::PipelinedFilter::SamplingTimeOver(const Time & currentTime) {
+	// the step must not be lost: wait for room in the queue
+	unsigned int nTries = 0;
+	while (!inputQueue.TryWrite([&](Item& item) {
+		item.kind = Item::SAMPLING_TIME_OVER;
+		item.time = currentTime;
+		item.pushed = Now();
+	}) && !MustStop())
+		_Backoff(nTries);
+}
+
+bool SF::PipelinedFilter::SaveDataMsg(const DataMsg & msg, const Time & currentTime) {
+	Time entered = Now();
+	_Push(inputQueue, FILTERING, [&](Item& item) {
+		item.kind = Item::DATAMSG;
+		item.msg = msg;
+		item.time = currentTime;
+	});
+	_Processed(RECIEVING, entered);
+	return true; // a dropped msg is counted by _Push(), a rejected one by the filter thread
+}
+
+bool SF::PipelinedFilter::SaveDataMsg(const DataMsgView & msg, const Time & currentTime) {
+	Time entered = Now();
+	_Push(inputQueue, FILTERING, [&](Item& item) {
+		item.kind = Item::DATAMSG;
+		msg.CopyTo(item.msg);
+		item.time = currentTime;
+	});
+	_Processed(RECIEVING, entered);
+	return true;
+}
+
+void SF::PipelinedFilter::MsgQueueEmpty(const Time & currentTime) {
+	_Push(inputQueue, FILTERING, [&](Item& item) {
+		item.kind = Item::MSG_QUEUE_EMPTY;
+		item.time = currentTime;
+	});
+}
+
+void SF::PipelinedFilter::SaveString(const std::string & msg, const Time & currentTime) {
+	_Push(inputQueue, FILTERING, [&](Item& item) {
+		item.kind = Item::STRING;
+		item.str = msg;
+		item.time = currentTime;
+	});
+}
+
+void SF::PipelinedFilter::Idle(const Time & nextStepTime) {
+	_Push(inputQueue, FILTERING, [&](Item& item) {
+		item.kind = Item::IDLE;
+		item.time = nextStepTime;
+	});
+}
+
+template<class Queue, class Writer>
+bool SF::PipelinedFilter::_Push(Queue & queue, Stage stage, Writer write) {
+	if (queue.TryWrite([&](Item& item) {
+		write(item);
+		item.pushed = Now();
+	}))
+		return true;
+	counters[stage].nDropped.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+void SF::PipelinedFilter::_Processed(Stage stage, const Time & entered) {
+	// the RECIEVING stage may run on several threads
+	StageCounters& c = counters[stage];
+	long long latency = duration_cast(Now() - entered).count();
+	c.nProcessed.fetch_add(1, std::memory_order_relaxed);
+	c.sumLatency.fetch_add(latency, std::memory_order_relaxed);
+	long long maxLatency = c.maxLatency.load(std::memory_order_relaxed);
+	while (latency > maxLatency && !c.maxLatency.compare_exchange_weak(maxLatency, latency, std::memory_order_relaxed));
+}
+
+void SF::PipelinedFilter::_RunFiltering() {
+	unsigned int nTries = 0;
+	for (;;) {
+		Item* item = inputQueue.Front();
+		if (!item) {
+			if (stopFiltering)
+				return;
+			_Backoff(nTries);
+			continue;
+		}
+		nTries = 0;
+		size_t queueSize = inputQueue.Size();
+		if (queueSize > counters[FILTERING].maxQueueSize.load(std::memory_order_relaxed))
+			counters[FILTERING].maxQueueSize.store(queueSize, std::memory_order_relaxed);
+		switch (item->kind) {
+		case Item::DATAMSG:
+			if (!filterCore->SaveDataMsg(item->msg, item->time))
+				counters[FILTERING].nUnknownIDs.fetch_add(1, std::memory_order_relaxed);
+			if (IsForwarding())
+				_Push(outputQueue, FORWARDING, [item](Item& out) {
+					out.kind = Item::DATAMSG;
+					out.msg = item->msg;
+					out.time = item->time;
+				});
+			break;
+		case Item::STRING:
+			_Push(outputQueue, FORWARDING, [item](Item& out) {
+				out.kind = Item::STRING;
+				out.str = item->str;
+				out.time = item->time;
+			});
+			break;
+		case Item::SAMPLING_TIME_OVER:
+			filterCore->SamplingTimeOver(item->time);
+			// the filtered states, closed by the event (forwarded in one batch if it is set)
+			for (int i = 0; i < filterCore->nSensors() + 1; i++)
+				_Push(outputQueue, FORWARDING, [this, item, i](Item& out) {
+					out.kind = Item::RESULT;
+					out.msg = filterCore->GetDataByIndex(i - 1, DataType::STATE, OperationType::FILTER_MEAS_UPDATE, item->time);
+					out.time = item->time;
+				});
+			_Push(outputQueue, FORWARDING, [item](Item& out) {
+				out.kind = Item::SAMPLING_TIME_OVER;
+				out.time = item->time;
+			});
+			break;
+		case Item::MSG_QUEUE_EMPTY:
+			filterCore->MsgQueueEmpty(item->time);
+			break;
+		case Item::IDLE:
+			filterCore->PrepareStep(item->time);
+			break;
+		default:
+			break;
+		}
+		_Processed(FILTERING, item->pushed);
+		inputQueue.Pop();
+	}
+}
+
+void SF::PipelinedFilter::_RunForwarding() {
+	unsigned int nTries = 0;
+	size_t nResults = 0;
+	for (;;) {
+		Item* item = outputQueue.Front();
+		if (!item) {
+			if (stopForwarding)
+				return;
+			_Backoff(nTries);
+			continue;
+		}
+		nTries = 0;
+		size_t queueSize = outputQueue.Size();
+		if (queueSize > counters[FORWARDING].maxQueueSize.load(std::memory_order_relaxed))
+			counters[FORWARDING].maxQueueSize.store(queueSize, std::memory_order_relaxed);
+		switch (item->kind) {
+		case Item::DATAMSG:
+			ForwardDataMsg(std::move(item->msg), item->time);
+			break;
+		case Item::STRING:
+			ForwardString(item->str, item->time);
+			break;
+		case Item::RESULT:
+			// the DataMsgs of the results are reused too (swapped with the item, no copy)
+			if (nResults < results.size())
+				std::swap(results[nResults], item->msg);
+			else
+				results.push_back(std::move(item->msg));
+			nResults++;
+			break;
+		case Item::SAMPLING_TIME_OVER:
+			results.resize(nResults);
+			ForwardDataMsgs(std::move(results), item->time);
+			nResults = 0;
+			break;
+		default:
+			break;
+		}
+		_Processed(FORWARDING, item->pushed);
+		outputQueue.Pop();
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include "FilterCore.h"
+#include "Forwarder.h"
+#include "ZMQReciever.h"
+#include "LockFreeQueue.h"
+
+namespace SF {
+
+	/*! \brief Class for realtime filtering in a pipeline of three threads
+	*
+	* It works as Filter, but the stages run on their own threads, connected by bounded lock-free queues of reused
+	* DataMsg-s (the Eigen storages of the queue slots are reused, so there is no allocation in steady state):
+	* - the reciever threads (see ZMQReciever) decode the recieved msgs and push them into the input queue (MPSC) together
+	*   with the events of the sampling times,
+	* - the filter thread saves them into the FilterCore and steps it, then it pushes the filtered states (and the recieved
+	*   msgs if there is a channel to forward into) into the output queue (SPSC),
+	* - the forwarder thread serializes and sends them via the inherited methods of class Forwarder.
+	*
+	* So a long step does not stall the recieving and slow sending does not stall the filter. If a queue is full, the items
+	* are dropped and counted, except the sampling time events in the input queue: the reciever waits for the room for them.
+	* The depths of the queues and the latencies of the stages can be checked with GetStageStatistics().
+	*/
+	class PipelinedFilter : public Forwarder, public ZMQReciever {
+		using Forwarder::ForwardDataMsg;
+
+		using Forwarder::ForwardDataMsgs;
+
+		using Forwarder::ForwardString;
+
+	public:
+		enum Stage { RECIEVING, FILTERING, FORWARDING }; //!< The stages of the pipeline
+
+		/*! \brief Statistics of a stage - the queue is the input queue of the stage (the RECIEVING stage has none) */
+		struct StageStatistics {
+			size_t queueSize; /*!< Number of the items waiting in the queue */
+			size_t maxQueueSize; /*!< Maximal number of the waiting items seen */
+			size_t queueCapacity; /*!< Capacity of the queue */
+			unsigned long long nProcessed; /*!< Number of the processed items (the recieved DataMsgs for the RECIEVING stage) */
+			unsigned long long nDropped; /*!< Number of the items dropped because the queue was full */
+			unsigned long long nUnknownIDs; /*!< Number of the DataMsgs the FilterCore did not save, e.g. because of an unknown source ID (only for the FILTERING stage) */
+			DTime meanLatency; /*!< Mean time from entering the stage (pushed into the queue, or recieved) until the item is processed */
+			DTime maxLatency; /*!< Maximal time from entering the stage until the item is processed */
+		};
+
+		/*! \brief Constructor: it starts the filter and the forwarder threads, the reciever is started by Start()
+		*
+		* The sockets can be sharded across several reciever threads, all of them push into the input queue.
+		*/
+		PipelinedFilter(FilterCore::FilterCorePtr filterCore, size_t queueCapacity = 1024, unsigned int nRecieverThreads = 1);
+
+		~PipelinedFilter(); //!< Destructor - stops the reciever threads, then the stages after processing the queued items
+
+		StageStatistics GetStageStatistics(Stage stage) const; //!< Statistics of the stage (it can be called from any thread)
+
+	protected:
+		/*!< Must called in each sampling time - input: time */
+		void SamplingTimeOver(const Time& currentTime) override;
+
+		/*! \brief Must called if new DataMsg recieved - it is pushed into the input queue
+		*
+		* It returns true even if the queue is full: the dropped msgs and the ones the FilterCore rejects on the filter thread
+		* are counted in the statistics of the FILTERING stage (nDropped and nUnknownIDs), not as unknown IDs of the periphery.
+		*/
+		bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override;
+
+		/*!< Called if new DataMsg recieved and read in place: it is copied into the input queue (see above) */
+		bool SaveDataMsg(const DataMsgView& msg, const Time& currentTime) override;
+
+		/*!< Must called if the DataMsgs in the queue were read */
+		void MsgQueueEmpty(const Time& currentTime) override;
+
+		void SaveString(const std::string& msg, const Time& currentTime) override;
+
+		/*!< Lets the FilterCore prepare the next step (on the filter thread) */
+		void Idle(const Time& nextStepTime) override;
+
+	private:
+		struct Item {
+			enum Kind { DATAMSG, STRING, SAMPLING_TIME_OVER, MSG_QUEUE_EMPTY, IDLE, RESULT } kind; /*!< RESULT is a filtered state, SAMPLING_TIME_OVER closes the results of a step in the output queue */
+			DataMsg msg; /*!< Reused */
+			std::string str; /*!< Reused */
+			Time time; /*!< Time of the event */
+			Time pushed; /*!< When it was pushed into the queue */
+		};
+
+		struct StageCounters {
+			std::atomic<size_t> maxQueueSize{ 0 };
+			std::atomic<unsigned long long> nProcessed{ 0 };
+			std::atomic<unsigned long long> nDropped{ 0 };
+			std::atomic<unsigned long long> nUnknownIDs{ 0 }; // written by the filter thread only
+			std::atomic<long long> sumLatency{ 0 }; // in DTime
+			std::atomic<long long> maxLatency{ 0 };
+		};
+
+		FilterCore::FilterCorePtr filterCore;
+
+		MPSCQueue<Item> inputQueue;
+		SPSCQueue<Item> outputQueue;
+
+		std::array<StageCounters, 3> counters;
+
+		std::vector<DataMsg> results; // filtered states of a step, collected by the forwarder thread (reused)
+
+		std::atomic<bool> stopFiltering, stopForwarding;
+		std::thread filterThread, forwarderThread;
+
+		template<class Queue, class Writer>
+		bool _Push(Queue& queue, Stage stage, Writer write); // false if it is dropped
+
+		void _Processed(Stage stage, const Time& entered);
+
+		void _RunFiltering();
+
+		void _RunForwarding();
+	};
+}
@@ -0,0 +1,234 @@
+#include "ShmRing.h"
+#include <cstring>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SF;
+using namespace SF::ShmRingDetail;
+
+namespace {
+	const uint64_t magicValue = 0x534653484d52494eULL; // "SFSHMRIN"
+	const size_t headerSize = 64; // the slots start in a new cache line
+
+	size_t _SlotStride(size_t slotSize) {
+		return (sizeof(Slot) + slotSize + 63) / 64 * 64;
+	}
+
+	size_t _RingSize(size_t nSlots, size_t slotSize) {
+		return headerSize + nSlots * _SlotStride(slotSize);
+	}
+
+	std::string _Name(const std::string& address) {
+		if (!IsShmAddress(address) || address.size() == 6 || address.find('/', 6) != std::string::npos)
+			throw std::runtime_error("FATAL ERROR: invalid shm address '" + address + "' (in ShmRing)");
+		return "/" + address.substr(6);
+	}
+
+	void _Unmap(Mapping& mapping) {
+#ifndef _WIN32
+		if (mapping.data)
+			munmap(mapping.data, mapping.size);
+#endif
+		mapping.data = nullptr;
+		mapping.size = 0;
+	}
+}
+
+Slot * SF::ShmRingDetail::Mapping::slot(uint64_t index) const {
+	const Header* h = header();
+	return reinterpret_cast<Slot*>(static_cast<char*>(data) + headerSize + (index % h->nSlots) * _SlotStride(h->slotSize));
+}
+
+const size_t SF::ShmRingWriter::defaultSlotSize;
+
+SF::ShmRingWriter::ShmRingWriter(const std::string & address, size_t nSlots, size_t slotSize) {
+	static_assert(sizeof(Header) <= headerSize, "The header must fit into its cache line");
+#ifdef _WIN32
+	throw std::runtime_error(std::string("FATAL ERROR: shm:// addresses are not supported on Windows (in ShmRingWriter::ShmRingWriter)"));
+#else
+	std::string name = _Name(address);
+	if (nSlots == 0 || slotSize == 0)
+		throw std::runtime_error("FATAL ERROR: empty ring for '" + address + "' (in ShmRingWriter::ShmRingWriter)");
+	size_t size = _RingSize(nSlots, slotSize);
+	int fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd >= 0) {
+		struct stat st;
+		void* data = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= headerSize)
+			data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data != MAP_FAILED) {
+			mapping.data = data;
+			mapping.size = st.st_size;
+			Header* header = mapping.header();
+			if (mapping.size == size && header->magic.load(std::memory_order_acquire) == magicValue
+				&& header->nSlots == nSlots && header->slotSize == slotSize)
+				return; // continue the ring of the previous writer
+			// retire the old ring: the attached readers see it and attach to the new one
+			header->magic.store(0, std::memory_order_release);
+			_Unmap(mapping);
+		}
+		shm_unlink(name.c_str());
+	}
+	// a new ring: it is published by the magic value
+	fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+	if (fd < 0)
+		throw std::runtime_error("FATAL ERROR: cannot create shared memory '" + address + "' (in ShmRingWriter::ShmRingWriter)");
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		throw std::runtime_error("FATAL ERROR: cannot resize shared memory '" + address + "' (in ShmRingWriter::ShmRingWriter)");
+	}
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		throw std::runtime_error("FATAL ERROR: cannot map shared memory '" + address + "' (in ShmRingWriter::ShmRingWriter)");
+	mapping.data = data;
+	mapping.size = size;
+	Header* header = mapping.header();
+	header->nSlots = nSlots;
+	header->slotSize = slotSize;
+	header->writeIndex.store(0, std::memory_order_relaxed);
+	for (uint64_t i = 0; i < nSlots; i++)
+		mapping.slot(i)->sequence.store(0, std::memory_order_relaxed);
+	header->magic.store(magicValue, std::memory_order_release);
+#endif
+}
+
+SF::ShmRingWriter::~ShmRingWriter() {
+	_Unmap(mapping);
+}
+
+void SF::ShmRingWriter::Write(const void * topic, size_t topicSize, const void * data, size_t size) {
+	Header* header = mapping.header();
+	if (topicSize + size > header->slotSize)
+		throw std::runtime_error("FATAL ERROR: msg of " + std::to_string(topicSize + size) + " bytes does not fit into the slot of "
+			+ std::to_string(header->slotSize) + " bytes (in ShmRingWriter::Write)");
+	uint64_t w = header->writeIndex.load(std::memory_order_relaxed);
+	Slot* slot = mapping.slot(w);
+	slot->sequence.store(2 * w + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot->topicSize = static_cast<uint32_t>(topicSize);
+	slot->size = static_cast<uint32_t>(size);
+	char* content = reinterpret_cast<char*>(slot + 1);
+	std::memcpy(content, topic, topicSize);
+	std::memcpy(content + topicSize, data, size);
+	slot->sequence.store(2 * w + 2, std::memory_order_release);
+	header->writeIndex.store(w + 1, std::memory_order_release);
+}
+
+size_t SF::ShmRingWriter::GetSlotSize() const {
+	return mapping.header()->slotSize;
+}
+
+void SF::ShmRingWriter::Unlink(const std::string & address) {
+	std::string name = _Name(address);
+#ifndef _WIN32
+	// retire it as a new writer with another geometry does: the attached readers detach
+	int fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd >= 0) {
+		struct stat st;
+		void* data = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= headerSize)
+			data = mmap(nullptr, headerSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data != MAP_FAILED) {
+			static_cast<Header*>(data)->magic.store(0, std::memory_order_release);
+			munmap(data, headerSize);
+		}
+	}
+	shm_unlink(name.c_str());
+#endif
+}
+
+SF::ShmRingReader::ShmRingReader(const std::string & address) : name(_Name(address)), next(0), nLost(0), nReadsToAttach(0) {
+#ifdef _WIN32
+	throw std::runtime_error(std::string("FATAL ERROR: shm:// addresses are not supported on Windows (in ShmRingReader::ShmRingReader)"));
+#else
+	_Attach();
+#endif
+}
+
+SF::ShmRingReader::~ShmRingReader() {
+	_Unmap(mapping);
+}
+
+bool SF::ShmRingReader::_Attach() {
+#ifndef _WIN32
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	void* data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > headerSize)
+		data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+	mapping.data = data;
+	mapping.size = st.st_size;
+	// it is used only if the writer has initialised it
+	Header* header = mapping.header();
+	if (header->magic.load(std::memory_order_acquire) != magicValue
+		|| _RingSize(header->nSlots, header->slotSize) != mapping.size) {
+		_Unmap(mapping);
+		return false;
+	}
+	next = header->writeIndex.load(std::memory_order_acquire);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool SF::ShmRingReader::Read(zmq::message_t & topic, zmq::message_t & msg) {
+	if (!mapping.data) {
+		if (nReadsToAttach > 0) {
+			nReadsToAttach--;
+			return false;
+		}
+		nReadsToAttach = 100;
+		if (!_Attach())
+			return false;
+	}
+	const Header* header = mapping.header();
+	if (header->magic.load(std::memory_order_acquire) != magicValue) {
+		// retired by a new writer with another geometry: attach to the new ring
+		_Unmap(mapping);
+		nReadsToAttach = 0;
+		return false;
+	}
+	for (;;) {
+		uint64_t w = header->writeIndex.load(std::memory_order_acquire);
+		if (next == w)
+			return false;
+		// overrun: the oldest msgs are overwritten already
+		if (w - next > header->nSlots) {
+			nLost += w - next - header->nSlots;
+			next = w - header->nSlots;
+		}
+		const Slot* slot = mapping.slot(next);
+		uint64_t sequence = 2 * next + 2;
+		if (slot->sequence.load(std::memory_order_acquire) == sequence) {
+			uint32_t topicSize = slot->topicSize;
+			uint32_t size = slot->size;
+			if (topicSize + static_cast<uint64_t>(size) <= header->slotSize) { // the sizes may be torn by the writer
+				const char* content = reinterpret_cast<const char*>(slot + 1);
+				topic.rebuild(content, topicSize);
+				msg.rebuild(content + topicSize, size);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (slot->sequence.load(std::memory_order_relaxed) == sequence) {
+					next++;
+					return true;
+				}
+			}
+		}
+		// overwritten before or while it was copied
+		nLost++;
+		next++;
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <zmq.hpp>
+
+namespace SF {
+
+	inline bool IsShmAddress(const std::string& address) { return address.compare(0, 6, "shm://") == 0; } //!< If it is a shm:// address
+
+	namespace ShmRingDetail {
+		static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The atomics in the shared memory must be lock-free");
+
+		struct Header {
+			std::atomic<uint64_t> magic; // written last by the writer: the ring can be read if it is set
+			uint64_t nSlots;
+			uint64_t slotSize; // maximal size of the topic and the content of a msg
+			std::atomic<uint64_t> writeIndex; // number of the msgs written
+		};
+
+		struct Slot {
+			std::atomic<uint64_t> sequence; // 2 * index + 1 while writing the index-th msg, 2 * index + 2 when it is written
+			uint32_t topicSize;
+			uint32_t size;
+			// followed by the topic and the content
+		};
+
+		struct Mapping {
+			void* data = nullptr;
+			size_t size = 0;
+			Header* header() const { return static_cast<Header*>(data); }
+			Slot* slot(uint64_t index) const; // the slot of the index-th msg
+		};
+	}
+
+	/*! \brief Writer of a single-producer/multi-consumer ring of msgs in shared memory (for shm:// addresses)
+	*
+	* The ring is a file in /dev/shm (shm://imu -> /dev/shm/imu) with a fixed number of fixed size slots. Every slot has a
+	* sequence number (a seqlock): the writer never waits for the readers, a reader checks if the slot was overwritten while
+	* copying it. So there is no syscall and only one copy per msg on both sides.
+	*
+	* The file is kept after the writer is destroyed: a restarted writer with the same geometry continues the ring, the attached
+	* readers go on reading it. It is removed by Unlink() (the attached readers detach). There must be only one writer of a ring.
+	*/
+	class ShmRingWriter {
+	public:
+		static const size_t defaultSlotSize = 4096; //!< Default maximal size of a msg in bytes
+
+		/*! \brief Constructor: it creates the ring (or opens it if it exists with the same geometry) */
+		ShmRingWriter(const std::string& address, size_t nSlots, size_t slotSize = defaultSlotSize);
+
+		ShmRingWriter(const ShmRingWriter&) = delete;
+
+		ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+		~ShmRingWriter(); //!< Destructor
+
+		/*! \brief Write a msg with the given topic into the next slot (it throws if it is larger than the slot) */
+		void Write(const void* topic, size_t topicSize, const void* data, size_t size);
+
+		size_t GetSlotSize() const; //!< Maximal size of the topic and the content of a msg in bytes
+
+		/*! \brief Remove the file of the ring (if it exists)
+		*
+		* The ring is retired first: the attached readers detect it and wait for a new ring, as the new readers do. A writer
+		* that has mapped it keeps writing into the removed ring (nobody reads it), the new ones create a new ring.
+		*/
+		static void Unlink(const std::string& address);
+
+	private:
+		ShmRingDetail::Mapping mapping;
+	};
+
+	/*! \brief Reader of a ring written by a ShmRingWriter (see there)
+	*
+	* It can be attached any time, even before the ring is created: it gets the msgs written after it was attached.
+	* If the writer overruns the reader, the overwritten msgs are skipped and counted (see GetNumOfLostMsgs()).
+	*
+	* Known limitation: the writer does not signal the new msgs, so Read() must be called periodically. The ZMQReciever
+	* checks its rings after every poll of its sockets, with a poll timeout of at most 1 ms while it has a ring: a msg
+	* written into an idle ring may wait up to ~1 ms (plus the scheduling delay of the thread) before it is read. The
+	* msgs of a busy ring are read without this delay, as the poll does not wait while msgs are got.
+	*/
+	class ShmRingReader {
+	public:
+		ShmRingReader(const std::string& address); //!< Constructor - it does not throw if the ring does not exist yet
+
+		ShmRingReader(const ShmRingReader&) = delete;
+
+		ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+		~ShmRingReader(); //!< Destructor
+
+		/*! \brief Copy the next msg into the frames - returns false if there is no new msg (or the ring is not created yet) */
+		bool Read(zmq::message_t& topic, zmq::message_t& msg);
+
+		bool IsAttached() const { return mapping.data != nullptr; } //!< If the ring was found
+
+		unsigned long long GetNumOfLostMsgs() const { return nLost; } //!< Number of the msgs overwritten before they were read
+
+	private:
+		std::string name;
+		ShmRingDetail::Mapping mapping;
+		uint64_t next; // index of the next msg to read
+		unsigned long long nLost;
+		unsigned int nReadsToAttach; // the attaching is retried only after a number of reads
+
+		bool _Attach();
+	};
+}
@@ -1,8 +1,9 @@
 #include "ZMQReciever.h"
 #include "PrintNestedException.h"
-#include "msgcontent2buf.h"
 #include "ClockSynchronizer.h"
-#include "zmq_addon.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
 
 using namespace SF;
 
@@ -50,8 +51,14 @@ SF::ZMQReciever::PeripheryProperties::PeripheryProperties(OperationType source_,
 	unsigned char ID_, DataType type_, const std::string& address_, bool getinfos_) :
 	source(source_), ID(ID_), address(address_), getstrings(getinfos_), type(type_), nparam(3) {}
 
-SF::ZMQReciever::SocketHandler::SocketHandler(const PeripheryProperties& prop, zmq::context_t& context) :
-	socket(std::make_shared<zmq::socket_t>(context, ZMQ_SUB)) {
+SF::ZMQReciever::SocketHandler::SocketHandler(const PeripheryProperties& prop_, std::shared_ptr<PeripheryCounters> counters_,
+	zmq::context_t& context) : inprocContext(IsInprocAddress(prop_.address) ? GetInprocContext() : nullptr),
+	socket(IsShmAddress(prop_.address) ? nullptr : std::make_shared<zmq::socket_t>(inprocContext ? *inprocContext : context, ZMQ_SUB)),
+	ring(IsShmAddress(prop_.address) ? std::make_shared<ShmRingReader>(prop_.address) : nullptr), prop(prop_), counters(counters_) {
+	if (prop.trusted && prop.address.compare(0, 6, "ipc://") != 0 && prop.address.compare(0, 9, "inproc://") != 0 && !ring)
+		throw std::runtime_error("FATAL ERROR: only local links can be trusted, address: " + prop.address + " (in ZMQReciever::SocketHandler)");
+	if (ring)
+		return; // the subscriptions are checked by IsSubscribed()
 	char topic[4];
 	topic[0] = 'd';
 	topic[1] = to_underlying<OperationType>(prop.source);
@@ -59,8 +66,17 @@ SF::ZMQReciever::SocketHandler::SocketHandler(const PeripheryProperties& prop, z
 	topic[3] = to_underlying<DataType>(prop.type);
 	if (prop.getstrings)
 		socket->setsockopt(ZMQ_SUBSCRIBE, "", 0);
-	else
+	else {
 		socket->setsockopt(ZMQ_SUBSCRIBE, &topic[0], prop.nparam + 1);
+		// shared DataMsgs in the same process
+		if (inprocContext) {
+			topic[0] = 'p';
+			socket->setsockopt(ZMQ_SUBSCRIBE, &topic[0], prop.nparam + 1);
+		}
+		// batches: only the source is in the topic, the ID and the DataType are checked by _ProcessMsg
+		topic[0] = 'b';
+		socket->setsockopt(ZMQ_SUBSCRIBE, &topic[0], prop.nparam > 0 ? 2 : 1);
+	}
 	//if (prop.getstrings)
 	//	socket->setsockopt(ZMQ_SUBSCRIBE, "i", 1);
 	try {
@@ -75,16 +91,52 @@ SF::ZMQReciever::SocketHandler::SocketHandler(const PeripheryProperties& prop, z
 	}
 }
 
+std::shared_ptr<zmq::message_t> SF::ZMQReciever::SocketHandler::Keep(zmq::message_t & msg) {
+	const size_t maxKeptMsgs = 16; // more are kept only if the derived class holds the views
+	for (auto& kept : keptMsgs)
+		if (kept.use_count() == 1) {
+			*kept = std::move(msg);
+			return kept;
+		}
+	auto kept = std::make_shared<zmq::message_t>(std::move(msg));
+	if (keptMsgs.size() < maxKeptMsgs)
+		keptMsgs.push_back(kept);
+	return kept;
+}
+
+bool SF::ZMQReciever::SocketHandler::IsSubscribed(const zmq::message_t & topic) const {
+	if (prop.getstrings)
+		return true;
+	const unsigned char* t = static_cast<const unsigned char*>(topic.data());
+	if (topic.size() == 0)
+		return false;
+	switch (t[0]) {
+	case 'd':
+		return topic.size() == 4 && (prop.nparam < 1 || t[1] == to_underlying<OperationType>(prop.source))
+			&& (prop.nparam < 2 || t[2] == prop.ID) && (prop.nparam < 3 || t[3] == to_underlying<DataType>(prop.type));
+	case 'b':
+		return topic.size() == 2 && (prop.nparam < 1 || t[1] == to_underlying<OperationType>(prop.source));
+	default:
+		return false;
+	}
+}
+
 SF::ZMQReciever::~ZMQReciever() {
 	Stop();
 }
 
 SF::ZMQReciever::ZMQReciever(std::vector<PeripheryProperties> periferies)
-	: peripheryProperties(periferies), pause(false), isRunning(false) {}
+	: peripheryProperties(periferies), pause(false), isRunning(false), nPeripheries(periferies.size()),
+	nRecieverThreads(1), recieveBatchSize(16), shardsGotDataMsg(false) {
+	for (size_t i = 0; i < periferies.size(); i++)
+		peripheryCounters.push_back(std::make_shared<PeripheryCounters>());
+}
 
 void SF::ZMQReciever::AddPeriphery(const PeripheryProperties & prop) {
 	peripheryPropertiesMutex.lock();
 	peripheryProperties.push_back(prop);
+	peripheryCounters.push_back(std::make_shared<PeripheryCounters>());
+	nPeripheries = peripheryProperties.size();
 	peripheryPropertiesMutex.unlock();
 }
 
@@ -99,23 +151,80 @@ void SF::ZMQReciever::AddPeripheries(const NetworkConfig & config) {
 
 unsigned long long SF::ZMQReciever::GetNumOfRecievedMsgs(int n) {
 	peripheryPropertiesMutex.lock();
-	long long out = peripheryProperties[n].nRecieved;
+	std::shared_ptr<PeripheryCounters> counters = peripheryCounters[n];
+	peripheryPropertiesMutex.unlock();
+	return counters->nRecieved;
+}
+
+SF::ZMQReciever::PeripheryMetrics SF::ZMQReciever::GetPeripheryMetrics(size_t n) {
+	peripheryPropertiesMutex.lock();
+	std::shared_ptr<PeripheryCounters> counters = peripheryCounters[n];
 	peripheryPropertiesMutex.unlock();
-	return out;
+	PeripheryMetrics metrics;
+	metrics.nRecieved = counters->nRecieved;
+	metrics.nBytes = counters->nBytes;
+	metrics.nVerificationFailures = counters->nVerificationFailures;
+	metrics.nUnknownIDs = counters->nUnknownIDs;
+	metrics.nDropped = counters->nDropped;
+	for (size_t k = 0; k < PeripheryMetrics::nJitterBins; k++)
+		metrics.jitterHistogram[k] = counters->jitterHistogram[k];
+	long long lastMsgTime = counters->lastMsgTime;
+	metrics.lastMsgAge = lastMsgTime ? duration_since_epoch(Now()) - DTime(lastMsgTime) : DTime::max();
+	return metrics;
+}
+
+SF::ZMQReciever::PeripheryCounters::PeripheryCounters() {
+	for (auto& bin : jitterHistogram)
+		bin.store(0, std::memory_order_relaxed);
+}
+
+void SF::ZMQReciever::PeripheryCounters::Recieved(size_t bytes) {
+	long long t = duration_since_epoch(Now()).count();
+	nRecieved.fetch_add(1, std::memory_order_relaxed);
+	nBytes.fetch_add(bytes, std::memory_order_relaxed);
+	long long last = lastMsgTime.load(std::memory_order_relaxed);
+	if (last) {
+		long long interval = t - last;
+		if (lastInterval >= 0) {
+			// bin k: [2^(k-1), 2^k) us
+			unsigned long long jitter = static_cast<unsigned long long>(std::abs(interval - lastInterval));
+			size_t k = 0;
+			for (; jitter > 0 && k < PeripheryMetrics::nJitterBins - 1; k++)
+				jitter >>= 1;
+			jitterHistogram[k].fetch_add(1, std::memory_order_relaxed);
+		}
+		lastInterval = interval;
+	}
+	lastMsgTime.store(t, std::memory_order_relaxed);
 }
 
 void SF::ZMQReciever::Pause(bool pause_) {
 	pause = pause_;
 }
 
+void SF::ZMQReciever::SetRecieveBatchSize(unsigned int n) {
+	if (n == 0)
+		throw std::runtime_error(std::string("ZMQReciever::SetRecieveBatchSize(): At least one msg must be read!"));
+	recieveBatchSize = n;
+}
+
+void SF::ZMQReciever::SetNumOfRecieverThreads(unsigned int n) {
+	if (n == 0)
+		throw std::runtime_error(std::string("ZMQReciever::SetNumOfRecieverThreads(): At least one thread is needed!"));
+	if (isRunning)
+		throw std::runtime_error(std::string("ZMQReciever::SetNumOfRecieverThreads(): It cannot be changed while running!"));
+	nRecieverThreads = n;
+}
+
 #include "msg_old2buf.h"
-SF::MsgType SF::ZMQReciever::_ProcessMsg_old(zmq::message_t & msg, const std::string& address) {
+SF::MsgType SF::ZMQReciever::_ProcessMsg_old(zmq::message_t & msg, SocketHandler& handler) {
 	// If it is in the old msg format - for backward compatibility, clock offsetting is not applied
 	DataMsg dataMsg;
 	bool isDataMsg = ExtractBufIf(msg.data(), msg.size(), dataMsg);
 	if (isDataMsg) {
 		//if (!GetPeripheryClockSynchronizerPtr()->IsClockSynchronisationInProgress(address))
 		if (!SaveDataMsg(dataMsg, Now())) {
+			handler.counters->nUnknownIDs++;
 			return SF::MsgType::NOTHING;
 		}
 		// Warning msg
@@ -126,11 +235,15 @@ SF::MsgType SF::ZMQReciever::_ProcessMsg_old(zmq::message_t & msg, const std::st
 		}
 		return MsgType::DATAMSG;
 	}
-	printf("FLATC VERIFICATION ERROR (in ZMQReciever::_ProcessMsg_old, address: %s)\n", address.c_str());
+	handler.counters->nVerificationFailures++;
+	printf("FLATC VERIFICATION ERROR (in ZMQReciever::_ProcessMsg_old, address: %s)\n", handler.prop.address.c_str());
 	return SF::MsgType::NOTHING;
 }
 
-SF::MsgType SF::ZMQReciever::_ProcessMsg(zmq::message_t & topic, zmq::message_t & msg, const std::string& address) {
+SF::MsgType SF::ZMQReciever::_ProcessMsg(zmq::message_t & topic, zmq::message_t & msg, SocketHandler& handler) {
+	const PeripheryProperties& prop = handler.prop;
+	const std::string& address = prop.address;
+	DataMsgDecoder& decoder = handler.decoder;
 	char* t = static_cast<char*>(topic.data());
 	switch (t[0]) {
 	case 'd': {
@@ -140,17 +253,62 @@ SF::MsgType SF::ZMQReciever::_ProcessMsg(zmq::message_t & topic, zmq::message_t
 		// Apply offset
 		OperationType source = static_cast<OperationType>(t[1]);
 		DataType type = static_cast<DataType>(t[3]);
-		if (VerifyDataMsgContent(msg.data(), (int)msg.size())) {
-			if (!GetPeripheryClockSynchronizerPtr()->IsClockSynchronisationInProgress(address))
-				if (!SaveDataMsg(InitDataMsg(msg.data(), source, ID, type, GetPeripheryClockSynchronizerPtr()->GetOffset(address)), Now())) {
-					return SF::MsgType::NOTHING;
-				}
+		if (prop.trusted || VerifyDataMsgContent(msg.data(), (int)msg.size())) {
+			// the view reads the values from the recieved msg, that is kept alive while the view exists
+			// (it is viewed during the clock synchronisation too, so the decoder follows the sequence numbers)
+			std::shared_ptr<zmq::message_t> buf = handler.Keep(msg);
+			DataMsgView view = decoder.View(buf->data(), source, ID, type, GetPeripheryClockSynchronizerPtr()->GetOffset(address), buf);
+			if (!GetPeripheryClockSynchronizerPtr()->IsClockSynchronisationInProgress(address) && !SaveDataMsg(view, Now())) {
+				handler.counters->nUnknownIDs++;
+				return SF::MsgType::NOTHING;
+			}
 			return MsgType::DATAMSG;
 		}
-		else
-			printf("FLATC VERIFICATION ERROR (in ZMQReciever::_ProcessMsg, address: %s)\n", address.c_str());
+		handler.counters->nVerificationFailures++;
+		printf("FLATC VERIFICATION ERROR (in ZMQReciever::_ProcessMsg, address: %s)\n", address.c_str());
 		return SF::MsgType::NOTHING;
 	}
+	case 'b': {
+		if (topic.size() != 2)
+			throw std::runtime_error("FATAL ERROR: corrupted batch topic got (in ZMQReciever::_ProcessMsg)");
+		if (!prop.trusted && !VerifyDataMsgBatch(msg.data(), (int)msg.size())) {
+			handler.counters->nVerificationFailures++;
+			printf("FLATC VERIFICATION ERROR (in ZMQReciever::_ProcessMsg, address: %s)\n", address.c_str());
+			return SF::MsgType::NOTHING;
+		}
+		bool synchronising = GetPeripheryClockSynchronizerPtr()->IsClockSynchronisationInProgress(address);
+		// the views of the records read the values from the recieved msg, that is kept alive while they exist
+		std::shared_ptr<zmq::message_t> buf = handler.Keep(msg);
+		DTime offset = GetPeripheryClockSynchronizerPtr()->GetOffset(address);
+		bool saved = synchronising;
+		size_t n = GetNumOfBatchRecords(buf->data());
+		for (size_t k = 0; k < n; k++) {
+			DataMsgView view = decoder.ViewFromBatch(buf->data(), k, offset, buf);
+			if (synchronising || (prop.nparam > 1 && view.GetSourceID() != prop.ID) || (prop.nparam > 2 && view.GetDataType() != prop.type))
+				continue;
+			if (SaveDataMsg(view, Now()))
+				saved = true;
+			else
+				handler.counters->nUnknownIDs++;
+		}
+		return saved ? MsgType::DATAMSG : SF::MsgType::NOTHING;
+	}
+	case 'p': {
+		if (topic.size() != 4 || msg.size() != sizeof(std::shared_ptr<const DataMsg>))
+			throw std::runtime_error("FATAL ERROR: corrupted shared datamsg topic got (in ZMQReciever::_ProcessMsg)");
+		// the frame is the shared_ptr of the sender (see Forwarder), it can be read only in the same process
+		if (!IsInprocAddress(address)) {
+			handler.counters->nVerificationFailures++;
+			printf("SHARED DATAMSG FROM NOT INPROC ADDRESS (in ZMQReciever::_ProcessMsg, address: %s)\n", address.c_str());
+			return SF::MsgType::NOTHING;
+		}
+		const DataMsg& dataMsg = **static_cast<const std::shared_ptr<const DataMsg>*>(msg.data());
+		if (!SaveDataMsg(dataMsg, Now())) {
+			handler.counters->nUnknownIDs++;
+			return SF::MsgType::NOTHING;
+		}
+		return MsgType::DATAMSG;
+	}
 	case 'i':
 		if (topic.size() != 1)
 			throw std::runtime_error("FATAL ERROR: corrupted string topic got (in ZMQReciever::_ProcessMsg)");
@@ -161,81 +319,191 @@ SF::MsgType SF::ZMQReciever::_ProcessMsg(zmq::message_t & topic, zmq::message_t
 	}
 }
 
-void SF::ZMQReciever::_Run(DTime Ts) {
-	zmq::context_t context(2);
-	std::vector<SocketHandler> socketProperties = std::vector<SocketHandler>();
-	zmq::pollitem_t items[100];
-	Time tLast;
-	int nItems = 0;
-	int msToEllapse;
-	// For managing sampling time
-	Time tNext = Now() + Ts;
-	// Main iteration
-	bool gotDataMsg = false;
-	while (!MustStop()) {
-		// Create sockets if there are elements of socketproperties not set
-		peripheryPropertiesMutex.lock();
-		for (size_t i = socketProperties.size(); i < peripheryProperties.size(); i++) {
-			socketProperties.push_back(SocketHandler(peripheryProperties[i], context));
-			if (nItems == 100)
-				throw std::runtime_error("FATAL ERROR: too many sockets to be polled (>100) (in ZMQReciever::_Run) increase nItems_max!");
+void SF::ZMQReciever::_Register(Shard & shard, unsigned int k, zmq::context_t & context) {
+	size_t n = nPeripheries;
+	if (shard.nChecked == n)
+		return;
+	peripheryPropertiesMutex.lock();
+	for (size_t i = shard.nChecked; i < n; i++)
+		if (i % nRecieverThreads == k) {
+			SocketHandler handler(peripheryProperties[i], peripheryCounters[i], context);
+			if (handler.ring)
+				shard.rings.push_back(handler);
 			else {
-				items[nItems] = { *(socketProperties[i].socket), 0, ZMQ_POLLIN, 0 };
-				nItems++;
+				shard.sockets.push_back(handler);
+				shard.items.push_back({ *(shard.sockets.back().socket), 0, ZMQ_POLLIN, 0 });
 			}
 		}
-		peripheryPropertiesMutex.unlock();
-		// wait if pause
-		while (pause)
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
-		// handle step
-		if (Now() > tNext) {
-			SamplingTimeOver(Now());
-			tNext += Ts;
-			gotDataMsg = false;
+	peripheryPropertiesMutex.unlock();
+	shard.nChecked = n;
+}
+
+void SF::ZMQReciever::_Poll(Shard & shard, unsigned int k, zmq::context_t & context, long timeout, bool & gotSg, bool & gotDataMsg) {
+	_Register(shard, k, context);
+	// the rings cannot be polled: they are checked after a short timeout
+	if (!shard.rings.empty())
+		timeout = std::min(timeout, 1L);
+	unsigned int batchSize = recieveBatchSize;
+	for (auto& handler : shard.rings) {
+		MsgType type;
+		for (unsigned int b = 0; b < batchSize && _Recieve(shard, handler, type); b++) {
+			gotSg |= type != MsgType::NOTHING;
+			gotDataMsg |= type == MsgType::DATAMSG;
+		}
+	}
+	if (gotSg)
+		timeout = 0;
+	if (zmq::poll(shard.items.data(), shard.items.size(), timeout) <= 0)
+		return;
+	// drain the ready sockets up to the batch size, the first one is rotated
+	size_t n = shard.items.size();
+	for (size_t i = 0; i < n; i++) {
+		size_t j = (shard.first + i) % n;
+		if (!(shard.items[j].revents & ZMQ_POLLIN))
 			continue;
+		MsgType type;
+		for (unsigned int b = 0; b < batchSize && _Recieve(shard, shard.sockets[j], type); b++) {
+			gotSg |= type != MsgType::NOTHING;
+			gotDataMsg |= type == MsgType::DATAMSG;
 		}
-		// poll: time to compute it
-		if (gotDataMsg)
-			msToEllapse = 0;
-		else {
-			msToEllapse = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(tNext - Now()).count());
-			msToEllapse = msToEllapse < 0 ? 0 : msToEllapse;
+	}
+	shard.first = (shard.first + 1) % n;
+}
+
+bool SF::ZMQReciever::_Recieve(Shard & shard, SocketHandler & handler, MsgType& type) {
+	size_t nFrames = 1;
+	if (handler.ring) {
+		// the ring has the msgs of every topic: they are filtered here as the subscriptions of the sockets do
+		bool got;
+		do {
+			got = handler.ring->Read(shard.frames[0], shard.frames[1]);
+		} while (got && !handler.IsSubscribed(shard.frames[0]));
+		// the ring counts every overwritten msg (the gaps in the sequence numbers would count them again)
+		handler.counters->nDropped.store(handler.ring->GetNumOfLostMsgs(), std::memory_order_relaxed);
+		if (!got)
+			return false;
+		nFrames = 2;
+	}
+	else {
+		zmq::socket_t& socket = *handler.socket;
+		if (!socket.recv(&shard.frames[0], ZMQ_DONTWAIT))
+			return false;
+		if (shard.frames[0].more()) {
+			socket.recv(&shard.frames[1]); // the other frames of the msg are already recieved
+			nFrames++;
+			if (shard.frames[1].more()) {
+				zmq::message_t frame;
+				do {
+					socket.recv(&frame);
+				} while (frame.more());
+				nFrames++;
+			}
 		}
-		// poll
-		zmq::poll(&items[0], nItems, msToEllapse);
+	}
+	handler.counters->Recieved(shard.frames[0].size() + (nFrames > 1 ? shard.frames[1].size() : 0));
+	switch (nFrames)
+	{
+	case 1:
+		type = _ProcessMsg_old(shard.frames[0], handler);
+		break;
+	case 2:
+		type = _ProcessMsg(shard.frames[0], shard.frames[1], handler);
+		if (!handler.ring)
+			handler.counters->nDropped.store(handler.decoder.GetNumOfLostMsgs(), std::memory_order_relaxed);
+		break;
+	default:
+		throw std::runtime_error("not handled frame size of the zmq msg");
+	}
+	return true;
+}
+
+void SF::ZMQReciever::_RunShard(unsigned int k, zmq::context_t & context) {
+	Shard shard;
+	while (!MustStop()) {
+		while (pause && !MustStop())
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		bool gotSg = false;
-		bool gotDataMsgNow = false;
-		for (int i = 0; i < nItems; i++)
-			if (items[i].revents & ZMQ_POLLIN) {
-				auto socket = socketProperties[i].socket;
-				zmq::multipart_t t;
-				if (t.recv(*socket, ZMQ_DONTWAIT)) {
-					peripheryPropertiesMutex.lock();
-					peripheryProperties[i].nRecieved++;
-					peripheryPropertiesMutex.unlock();
-					MsgType type;
-					switch (t.size())
-					{
-					case 1:
-						type = _ProcessMsg_old(t[0], peripheryProperties[i].address);
-						break;
-					case 2:
-						type = _ProcessMsg(t[0], t[1], peripheryProperties[i].address);
-						break;
-					default:
-						throw std::runtime_error("not handled frame size of the zmq msg");
-					}
-					gotSg |= type != MsgType::NOTHING;
-					gotDataMsgNow |= type == MsgType::DATAMSG;
-				}
+		bool gotDataMsg = false;
+		_Poll(shard, k, context, 10, gotSg, gotDataMsg); // short timeout to check if it must stop
+		if (gotDataMsg)
+			shardsGotDataMsg = true;
+	}
+}
+
+void SF::ZMQReciever::_Run(DTime Ts) {
+	zmq::context_t context(std::max(2, static_cast<int>(nRecieverThreads)));
+	// the other reciever threads only recieve
+	shardsGotDataMsg = false;
+	std::vector<std::thread> shardThreads;
+	for (unsigned int k = 1; k < nRecieverThreads; k++)
+		shardThreads.push_back(std::thread([this, k, &context]() {
+			try {
+				_RunShard(k, context);
+			}
+			catch (std::exception& e) {
+				std::cout << "ZMQRecieving thread " << k << " has stopped because of an unhandled exception:" << std::endl;
+				print_exception(e);
+				toStop = true;
 			}
-		gotDataMsg |= gotDataMsgNow;
-		if (gotDataMsg && !gotSg && Now() > tLast + tWaitNextMsg) {
-			MsgQueueEmpty(Now()); // if there were msg read
-			gotDataMsg = false;
+		}));
+	std::exception_ptr exception;
+	try {
+		Shard shard;
+		Time tLast;
+		int msToEllapse;
+		// For managing sampling time
+		Time tNext = Now() + Ts;
+		// Main iteration
+		bool gotDataMsg = false;
+		bool idleCalled = false;
+		while (!MustStop()) {
+			// wait if pause
+			while (pause)
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			// handle step
+			if (Now() > tNext) {
+				SamplingTimeOver(Now());
+				tNext += Ts;
+				gotDataMsg = false;
+				idleCalled = false;
+				continue;
+			}
+			// prepare the next step while waiting
+			if (!idleCalled && !gotDataMsg) {
+				Idle(tNext);
+				idleCalled = true;
+				continue; // it may take long, the sampling time must be checked again
+			}
+			// poll: time to compute it
+			if (gotDataMsg)
+				msToEllapse = 0;
+			else {
+				msToEllapse = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(tNext - Now()).count());
+				msToEllapse = msToEllapse < 0 ? 0 : msToEllapse;
+			}
+			// poll (the new sockets are registered first)
+			bool gotSg = false;
+			bool gotDataMsgNow = false;
+			_Poll(shard, 0, context, msToEllapse, gotSg, gotDataMsgNow);
+			if (shardsGotDataMsg.exchange(false))
+				gotSg = gotDataMsgNow = true;
+			gotDataMsg |= gotDataMsgNow;
+			if (gotDataMsg && !gotSg && Now() > tLast + tWaitNextMsg) {
+				MsgQueueEmpty(Now()); // if there were msg read
+				gotDataMsg = false;
+				idleCalled = false;
+			}
+			if (gotDataMsgNow)
+				tLast = Now();
 		}
-		if (gotDataMsgNow)
-			tLast = Now();
 	}
-}
\ No newline at end of file
+	catch (...) {
+		exception = std::current_exception();
+	}
+	// the sockets must be closed before the context
+	toStop = true;
+	for (auto& thread : shardThreads)
+		thread.join();
+	if (exception)
+		std::rethrow_exception(exception);
+}
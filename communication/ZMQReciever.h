@@ -1,14 +1,23 @@
 #pragma once
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <array>
 #include "NetworkConfig.h"
 #include "comm_defs.h"
 #include "DataMsg.h"
+#include "DataMsgView.h"
+#include "msgcontent2buf.h"
+#include "ShmRing.h"
 #include <zmq.hpp>
 
 namespace SF {
 
 	/*! \brief Class to recieve msgs from peripheries and call the defined virtual functions with them
+	*
+	* The sockets of the peripheries can be sharded across several reciever threads (see SetNumOfRecieverThreads()).
+	* The first thread calls the sampling time related functions (SamplingTimeOver(), MsgQueueEmpty(), Idle()), every thread
+	* calls SaveDataMsg() and SaveString() with the msgs of its sockets.
 	*/
 	class ZMQReciever {
 		bool toStop;
@@ -20,7 +29,10 @@ namespace SF {
 	public:
 		/*! \brief Struct that describes data necessary to connect to peripheries
 		*
-		* The address of the Periphery must be specified and if it is subscribed to string msgs too.
+		* The address of the Periphery must be specified and if it is subscribed to string msgs too. From an inproc:// address
+		* the DataMsgs of a Periphery in the same process are got without deserializing or copying them. A shm:// address is
+		* read from a ring in shared memory (see ShmRingReader): it can be added before the Periphery is started. The rings
+		* are not polled but checked every ms, so their msgs may wait up to ~1 ms if they were idle (see ShmRingReader).
 		*
 		* Subscriptions can be specified to SF::OperationType, ID and SF::DataType - see the defined constructors.
 		*/
@@ -31,7 +43,7 @@ namespace SF {
 			std::string address; /*!< Address of the periphery */
 			bool getstrings; /*!< If the string msgs must be recieved too */
 			unsigned char nparam; /*!< how many parameters are checked in the datamsg topic - set by the constructors */
-			unsigned long long nRecieved = 0; /*!< Number of recieved msgs */
+			bool trusted = false; /*!< If the content of the datamsgs is not verified - allowed only for local (ipc:// or inproc://) addresses */
 			PeripheryProperties() = delete;
 			PeripheryProperties(const std::string& address_,
 				bool getstrings_ = false); /*!< To subscribe to the address to recieve arbitrary datamsgs */
@@ -52,10 +64,40 @@ namespace SF {
 
 		void AddPeripheries(const NetworkConfig& config); /*!< Add peripheries for networked recievers */
 
+		/*! \brief Ingest metrics of a periphery (see GetPeripheryMetrics()) */
+		struct PeripheryMetrics {
+			static const size_t nJitterBins = 16; /*!< Number of the bins of the jitter histogram */
+			unsigned long long nRecieved; /*!< Number of recieved msgs */
+			unsigned long long nBytes; /*!< Number of recieved bytes */
+			unsigned long long nVerificationFailures; /*!< Number of msgs failed the flatbuffers verification */
+			unsigned long long nUnknownIDs; /*!< Number of DataMsgs not saved, e.g. because of an unknown source ID (SaveDataMsg() returned false) */
+			unsigned long long nDropped; /*!< Number of DataMsgs lost before recieving them, e.g. by the HWM (detected by the gaps in their sequence numbers), or the msgs of a shm ring overwritten before they were read (of every topic) */
+			/*! \brief Histogram of the jitter: the change of the inter-arrival time between consecutive msgs
+			*
+			* The k-th bin counts the jitters in [2^(k-1), 2^k) us, the first one the jitters below 1 us, the last one all of the
+			* larger jitters too.
+			*/
+			std::array<unsigned long long, nJitterBins> jitterHistogram;
+			DTime lastMsgAge; /*!< Time since the last msg (DTime::max() if there was none) */
+		};
+
 		unsigned long long GetNumOfRecievedMsgs(int n); /*!< Get number of recieved msgs of the n-th periphery*/
 
+		/*! \brief Get the metrics of the n-th periphery
+		*
+		* The counters are atomic: it can be called from any thread without blocking the recieving.
+		*/
+		PeripheryMetrics GetPeripheryMetrics(size_t n);
+
 		void Pause(bool pause_); /*!< Pause the recieving and processing thread */
 
+		/*! \brief Set the maximal number of msgs read from a socket after a poll (16 by default)
+		*
+		* The ready sockets are drained one after the other up to this number, starting from the next socket in each round,
+		* so a busy periphery can neither starve the others nor force a poll per msg.
+		*/
+		void SetRecieveBatchSize(unsigned int n);
+
 		void Start(DTime Ts); /*!< Starts a reciever thread with given sampling time*/
 
 		void Stop(bool waitin = true); /*!< Stops the reciever thread*/
@@ -69,24 +111,83 @@ namespace SF {
 
 		virtual bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) = 0; /*!< Must called if new DataMsg recieved */
 
+		/*! \brief Called if new DataMsg recieved, with a view of the recieved buffer
+		*
+		* By default it is copied into a DataMsg: override it to avoid the copy.
+		*/
+		virtual bool SaveDataMsg(const DataMsgView& msg, const Time& currentTime) { return SaveDataMsg(msg.ToDataMsg(), currentTime); }
+
 		virtual void MsgQueueEmpty(const Time& currentTime) = 0; /*!< Must called if the DataMsgs in the queue were read */
 
 		virtual void SaveString(const std::string& msg, const Time& currentTime) = 0; /*!< Must called if string is recieved */
 
+		/*! \brief Is called before waiting for msgs after a sampling time or a read msg queue - input: the next sampling time
+		*
+		* The time until the next sampling time can be used to prepare the next step (by default it does nothing).
+		*/
+		virtual void Idle(const Time& nextStepTime) {}
+
+		/*! \brief Set the number of the reciever threads - before Start()
+		*
+		* The peripheries are distributed round-robin among the threads. With more threads SaveDataMsg() and SaveString()
+		* are called concurrently: the derived class must be prepared for it (e.g. PipelinedFilter).
+		*/
+		void SetNumOfRecieverThreads(unsigned int n);
+
 	private:
 		bool pause;
 
 		std::vector<PeripheryProperties> peripheryProperties;
 		std::mutex peripheryPropertiesMutex;
+		std::atomic<size_t> nPeripheries; // to check for new peripheries without locking
+
+		struct PeripheryCounters { // written by the reciever thread of the periphery, read by anyone
+			std::atomic<unsigned long long> nRecieved{ 0 }, nBytes{ 0 }, nVerificationFailures{ 0 }, nUnknownIDs{ 0 }, nDropped{ 0 };
+			std::array<std::atomic<unsigned long long>, PeripheryMetrics::nJitterBins> jitterHistogram;
+			std::atomic<long long> lastMsgTime{ 0 }; // in us since epoch, 0 if there was no msg
+			long long lastInterval = -1; // only for the reciever thread
+			PeripheryCounters();
+			void Recieved(size_t nBytes);
+		};
+		std::vector<std::shared_ptr<PeripheryCounters>> peripheryCounters; // by the index of the periphery (under peripheryPropertiesMutex)
+
+		unsigned int nRecieverThreads;
+		std::atomic<unsigned int> recieveBatchSize;
+		std::atomic<bool> shardsGotDataMsg; // if the other reciever threads got DataMsg since the first one checked it
 
 		struct SocketHandler {
-			SocketHandler(const PeripheryProperties& prop, zmq::context_t& context);
-			std::shared_ptr<zmq::socket_t> socket;
+			SocketHandler(const PeripheryProperties& prop, std::shared_ptr<PeripheryCounters> counters, zmq::context_t& context);
+			std::shared_ptr<zmq::context_t> inprocContext; // the shared context for inproc:// addresses (it must outlive the socket)
+			std::shared_ptr<zmq::socket_t> socket; // nullptr for shm:// addresses
+			std::shared_ptr<ShmRingReader> ring; // for shm:// addresses
+			DataMsgDecoder decoder; // keeps the variance references of the periphery
+			PeripheryProperties prop; // copy to be read without locking
+			std::shared_ptr<PeripheryCounters> counters;
+			std::vector<std::shared_ptr<zmq::message_t>> keptMsgs; // the msgs read in place by the views, reused when released
+			bool IsSubscribed(const zmq::message_t& topic) const; // the subscriptions of the socket, checked for the ring
+			std::shared_ptr<zmq::message_t> Keep(zmq::message_t& msg); // move the msg into a released kept one (no allocation in steady state)
 		};
 
-		MsgType _ProcessMsg_old(zmq::message_t& msg, const std::string& address); // returns if got DataMsg
+		struct Shard { // the sockets of a reciever thread
+			std::vector<SocketHandler> sockets;
+			std::vector<zmq::pollitem_t> items; // registered incrementally, in the order of sockets
+			std::vector<SocketHandler> rings; // the shm rings are checked after each poll
+			size_t nChecked = 0; // number of the peripheries checked if they belong to the shard
+			size_t first = 0; // the socket to be read first after the next poll (rotated for fairness)
+			zmq::message_t frames[2]; // reused for the recieved msgs
+		};
+
+		void _Register(Shard& shard, unsigned int k, zmq::context_t& context); // create the sockets of the new peripheries of the k-th shard
+
+		void _Poll(Shard& shard, unsigned int k, zmq::context_t& context, long timeout, bool& gotSg, bool& gotDataMsg); // at most 1 ms if there are rings
+
+		bool _Recieve(Shard& shard, SocketHandler& handler, MsgType& type); // read and process a msg, false if there was none
+
+		void _RunShard(unsigned int k, zmq::context_t& context); // the loop of the other reciever threads
+
+		MsgType _ProcessMsg_old(zmq::message_t& msg, SocketHandler& handler); // returns if got DataMsg
 
-		MsgType _ProcessMsg(zmq::message_t& topic, zmq::message_t& msg, const std::string& address); // returns if got DataMsg
+		MsgType _ProcessMsg(zmq::message_t& topic, zmq::message_t& msg, SocketHandler& handler); // returns if got DataMsg
 
 		void _Run(DTime Ts);
 	};
@@ -1,8 +1,19 @@
 #pragma once
+#include <memory>
+#include <string>
+#include <zmq.hpp>
 #include "defs.h"
 
 namespace SF {
 	enum MsgType { DATAMSG, TEXT, NOTHING };
 
 	const DTime tWaitNextMsg = DTime(150); // If no msg got within 150 us, msgqueueempty is called
+
+	/*! \brief The ZMQ context of the inproc:// sockets of the process (the inproc links work only within a context) */
+	inline std::shared_ptr<zmq::context_t> GetInprocContext() {
+		static std::shared_ptr<zmq::context_t> context = std::make_shared<zmq::context_t>(1);
+		return context;
+	}
+
+	inline bool IsInprocAddress(const std::string& address) { return address.compare(0, 9, "inproc://") == 0; } //!< If it is an inproc:// address
 }
@@ -28,6 +28,7 @@ Buffer_old::Buffer_old(const DataMsg & data) {
 		for (unsigned int i = 0; i < N; i++)
 			v[i] = (float)value[i];
 		fbb_value = fbb.CreateVector<float>(v, N);
+		delete[] v;
 	}
 
 	flatbuffers::Offset<flatbuffers::Vector<float>> fbb_variance;
@@ -43,6 +44,7 @@ Buffer_old::Buffer_old(const DataMsg & data) {
 				k++;
 			}
 		fbb_variance = fbb.CreateVector<float>(v, K);
+		delete[] v;
 	}
 
 	DataMsgNameSpace::MsgBuilder msgBuilder(fbb);
@@ -187,12 +189,12 @@ bool SF::ExtractBufIf(void* buf, size_t size, DataMsg& data) {
 	return true;
 }
 
-Buffer_old::~Buffer_old() { delete buf; }
+Buffer_old::~Buffer_old() { delete[] buf; }
 
 Buffer_old& Buffer_old::operator=(const Buffer_old& buf0) {
 	if (this != &buf0) {
 		if (!isNull())
-			delete buf;
+			delete[] buf;
 		size = buf0.size;
 		_allocandcopy(buf0.Buf());
 	}
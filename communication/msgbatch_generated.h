@@ -0,0 +1,171 @@
+// automatically generated by the FlatBuffers compiler, do not modify
+
+
+#ifndef FLATBUFFERS_GENERATED_MSGBATCH_DATAMSGCONTENTNAMESPACE_H_
+#define FLATBUFFERS_GENERATED_MSGBATCH_DATAMSGCONTENTNAMESPACE_H_
+
+#include "flatbuffers/flatbuffers.h"
+
+#include "msgcontent_generated.h"
+
+namespace DataMsgContentNameSpace {
+
+struct Record;
+
+struct Batch;
+
+struct Record FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_SOURCE = 4,
+    VT_ID = 6,
+    VT_TYPE = 8,
+    VT_MSG = 10
+  };
+  uint8_t source() const {
+    return GetField<uint8_t>(VT_SOURCE, 0);
+  }
+  uint8_t id() const {
+    return GetField<uint8_t>(VT_ID, 0);
+  }
+  uint8_t type() const {
+    return GetField<uint8_t>(VT_TYPE, 0);
+  }
+  const Msg *msg() const {
+    return GetPointer<const Msg *>(VT_MSG);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint8_t>(verifier, VT_SOURCE) &&
+           VerifyField<uint8_t>(verifier, VT_ID) &&
+           VerifyField<uint8_t>(verifier, VT_TYPE) &&
+           VerifyOffset(verifier, VT_MSG) &&
+           verifier.VerifyTable(msg()) &&
+           verifier.EndTable();
+  }
+};
+
+struct RecordBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_source(uint8_t source) {
+    fbb_.AddElement<uint8_t>(Record::VT_SOURCE, source, 0);
+  }
+  void add_id(uint8_t id) {
+    fbb_.AddElement<uint8_t>(Record::VT_ID, id, 0);
+  }
+  void add_type(uint8_t type) {
+    fbb_.AddElement<uint8_t>(Record::VT_TYPE, type, 0);
+  }
+  void add_msg(flatbuffers::Offset<Msg> msg) {
+    fbb_.AddOffset(Record::VT_MSG, msg);
+  }
+  explicit RecordBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  RecordBuilder &operator=(const RecordBuilder &);
+  flatbuffers::Offset<Record> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Record>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Record> CreateRecord(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint8_t source = 0,
+    uint8_t id = 0,
+    uint8_t type = 0,
+    flatbuffers::Offset<Msg> msg = 0) {
+  RecordBuilder builder_(_fbb);
+  builder_.add_msg(msg);
+  builder_.add_type(type);
+  builder_.add_id(id);
+  builder_.add_source(source);
+  return builder_.Finish();
+}
+
+struct Batch FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_RECORDS = 4
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<Record>> *records() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Record>> *>(VT_RECORDS);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_RECORDS) &&
+           verifier.VerifyVector(records()) &&
+           verifier.VerifyVectorOfTables(records()) &&
+           verifier.EndTable();
+  }
+};
+
+struct BatchBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_records(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Record>>> records) {
+    fbb_.AddOffset(Batch::VT_RECORDS, records);
+  }
+  explicit BatchBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  BatchBuilder &operator=(const BatchBuilder &);
+  flatbuffers::Offset<Batch> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Batch>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Batch> CreateBatch(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Record>>> records = 0) {
+  BatchBuilder builder_(_fbb);
+  builder_.add_records(records);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Batch> CreateBatchDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<Record>> *records = nullptr) {
+  auto records__ = records ? _fbb.CreateVector<flatbuffers::Offset<Record>>(*records) : 0;
+  return DataMsgContentNameSpace::CreateBatch(
+      _fbb,
+      records__);
+}
+
+inline const DataMsgContentNameSpace::Batch *GetBatch(const void *buf) {
+  return flatbuffers::GetRoot<DataMsgContentNameSpace::Batch>(buf);
+}
+
+inline const DataMsgContentNameSpace::Batch *GetSizePrefixedBatch(const void *buf) {
+  return flatbuffers::GetSizePrefixedRoot<DataMsgContentNameSpace::Batch>(buf);
+}
+
+inline bool VerifyBatchBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifyBuffer<DataMsgContentNameSpace::Batch>(nullptr);
+}
+
+inline bool VerifySizePrefixedBatchBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifySizePrefixedBuffer<DataMsgContentNameSpace::Batch>(nullptr);
+}
+
+inline void FinishBatchBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<DataMsgContentNameSpace::Batch> root) {
+  fbb.Finish(root);
+}
+
+inline void FinishSizePrefixedBatchBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<DataMsgContentNameSpace::Batch> root) {
+  fbb.FinishSizePrefixed(root);
+}
+
+}  // namespace DataMsgContentNameSpace
+
+#endif  // FLATBUFFERS_GENERATED_MSGBATCH_DATAMSGCONTENTNAMESPACE_H_
@@ -0,0 +1,260 @@
+// automatically generated by the FlatBuffers compiler, do not modify
+
+/**
+ * @const
+ * @namespace
+ */
+var DataMsgContentNameSpace = DataMsgContentNameSpace || {};
+
+/**
+ * @constructor
+ */
+DataMsgContentNameSpace.Record = function() {
+  /**
+   * @type {flatbuffers.ByteBuffer}
+   */
+  this.bb = null;
+
+  /**
+   * @type {number}
+   */
+  this.bb_pos = 0;
+};
+
+/**
+ * @param {number} i
+ * @param {flatbuffers.ByteBuffer} bb
+ * @returns {DataMsgContentNameSpace.Record}
+ */
+DataMsgContentNameSpace.Record.prototype.__init = function(i, bb) {
+  this.bb_pos = i;
+  this.bb = bb;
+  return this;
+};
+
+/**
+ * @param {flatbuffers.ByteBuffer} bb
+ * @param {DataMsgContentNameSpace.Record=} obj
+ * @returns {DataMsgContentNameSpace.Record}
+ */
+DataMsgContentNameSpace.Record.getRootAsRecord = function(bb, obj) {
+  return (obj || new DataMsgContentNameSpace.Record).__init(bb.readInt32(bb.position()) + bb.position(), bb);
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Record.prototype.source = function() {
+  var offset = this.bb.__offset(this.bb_pos, 4);
+  return offset ? this.bb.readUint8(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Record.prototype.id = function() {
+  var offset = this.bb.__offset(this.bb_pos, 6);
+  return offset ? this.bb.readUint8(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Record.prototype.type = function() {
+  var offset = this.bb.__offset(this.bb_pos, 8);
+  return offset ? this.bb.readUint8(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @param {DataMsgContentNameSpace.Msg=} obj
+ * @returns {DataMsgContentNameSpace.Msg|null}
+ */
+DataMsgContentNameSpace.Record.prototype.msg = function(obj) {
+  var offset = this.bb.__offset(this.bb_pos, 10);
+  return offset ? (obj || new DataMsgContentNameSpace.Msg).__init(this.bb.__indirect(this.bb_pos + offset), this.bb) : null;
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ */
+DataMsgContentNameSpace.Record.startRecord = function(builder) {
+  builder.startObject(4);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} source
+ */
+DataMsgContentNameSpace.Record.addSource = function(builder, source) {
+  builder.addFieldInt8(0, source, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} id
+ */
+DataMsgContentNameSpace.Record.addId = function(builder, id) {
+  builder.addFieldInt8(1, id, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} type
+ */
+DataMsgContentNameSpace.Record.addType = function(builder, type) {
+  builder.addFieldInt8(2, type, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} msgOffset
+ */
+DataMsgContentNameSpace.Record.addMsg = function(builder, msgOffset) {
+  builder.addFieldOffset(3, msgOffset, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Record.endRecord = function(builder) {
+  var offset = builder.endObject();
+  return offset;
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} source
+ * @param {number} id
+ * @param {number} type
+ * @param {flatbuffers.Offset} msgOffset
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Record.createRecord = function(builder, source, id, type, msgOffset) {
+  DataMsgContentNameSpace.Record.startRecord(builder);
+  DataMsgContentNameSpace.Record.addSource(builder, source);
+  DataMsgContentNameSpace.Record.addId(builder, id);
+  DataMsgContentNameSpace.Record.addType(builder, type);
+  DataMsgContentNameSpace.Record.addMsg(builder, msgOffset);
+  return DataMsgContentNameSpace.Record.endRecord(builder);
+}
+
+/**
+ * @constructor
+ */
+DataMsgContentNameSpace.Batch = function() {
+  /**
+   * @type {flatbuffers.ByteBuffer}
+   */
+  this.bb = null;
+
+  /**
+   * @type {number}
+   */
+  this.bb_pos = 0;
+};
+
+/**
+ * @param {number} i
+ * @param {flatbuffers.ByteBuffer} bb
+ * @returns {DataMsgContentNameSpace.Batch}
+ */
+DataMsgContentNameSpace.Batch.prototype.__init = function(i, bb) {
+  this.bb_pos = i;
+  this.bb = bb;
+  return this;
+};
+
+/**
+ * @param {flatbuffers.ByteBuffer} bb
+ * @param {DataMsgContentNameSpace.Batch=} obj
+ * @returns {DataMsgContentNameSpace.Batch}
+ */
+DataMsgContentNameSpace.Batch.getRootAsBatch = function(bb, obj) {
+  return (obj || new DataMsgContentNameSpace.Batch).__init(bb.readInt32(bb.position()) + bb.position(), bb);
+};
+
+/**
+ * @param {number} index
+ * @param {DataMsgContentNameSpace.Record=} obj
+ * @returns {DataMsgContentNameSpace.Record}
+ */
+DataMsgContentNameSpace.Batch.prototype.records = function(index, obj) {
+  var offset = this.bb.__offset(this.bb_pos, 4);
+  return offset ? (obj || new DataMsgContentNameSpace.Record).__init(this.bb.__indirect(this.bb.__vector(this.bb_pos + offset) + index * 4), this.bb) : null;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Batch.prototype.recordsLength = function() {
+  var offset = this.bb.__offset(this.bb_pos, 4);
+  return offset ? this.bb.__vector_len(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ */
+DataMsgContentNameSpace.Batch.startBatch = function(builder) {
+  builder.startObject(1);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} recordsOffset
+ */
+DataMsgContentNameSpace.Batch.addRecords = function(builder, recordsOffset) {
+  builder.addFieldOffset(0, recordsOffset, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {Array.<flatbuffers.Offset>} data
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Batch.createRecordsVector = function(builder, data) {
+  builder.startVector(4, data.length, 4);
+  for (var i = data.length - 1; i >= 0; i--) {
+    builder.addOffset(data[i]);
+  }
+  return builder.endVector();
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} numElems
+ */
+DataMsgContentNameSpace.Batch.startRecordsVector = function(builder, numElems) {
+  builder.startVector(4, numElems, 4);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Batch.endBatch = function(builder) {
+  var offset = builder.endObject();
+  return offset;
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} offset
+ */
+DataMsgContentNameSpace.Batch.finishBatchBuffer = function(builder, offset) {
+  builder.finish(offset);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} recordsOffset
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Batch.createBatch = function(builder, recordsOffset) {
+  DataMsgContentNameSpace.Batch.startBatch(builder);
+  DataMsgContentNameSpace.Batch.addRecords(builder, recordsOffset);
+  return DataMsgContentNameSpace.Batch.endBatch(builder);
+}
+
+// Exports for Node.js and RequireJS
+this.DataMsgContentNameSpace = DataMsgContentNameSpace;
@@ -1,6 +1,8 @@
 #include "msgcontent2buf.h"
 #include <flatbuffers/flatbuffers.h>
-#include "msgcontent_generated.h"
+#include "msgbatch_generated.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace SF;
 
@@ -11,85 +13,377 @@ bool SF::VerifyDataMsgContent(void * buf, int length) {
 }
 
 DataMsg SF::InitDataMsg(void* buf, OperationType source, unsigned char ID, DataType type, DTime offset) {
-	auto msg = DataMsgContentNameSpace::GetMsg(buf);
-	auto timestamp_in_us = msg->timestamp_in_us();
-	DataMsg data = DataMsg(ID, type, source, Time(std::chrono::microseconds(timestamp_in_us))+offset);
-	if (flatbuffers::IsFieldPresent(msg, DataMsgContentNameSpace::Msg::VT_VALUE_VECTOR)) {
-		auto v = msg->value_vector();
-		size_t N = v->size();
-		auto value = Eigen::VectorXd(N);
-		for (unsigned int n = 0; n < N; n++)
-			value[n] = v->Get(n);
-		data.SetValueVector(value);
-	}
-	if (flatbuffers::IsFieldPresent(msg, DataMsgContentNameSpace::Msg::VT_VARIANCE_MATRIX)) {
-		auto v = msg->variance_matrix();
-		size_t K = v->size();
-		size_t N = static_cast<size_t>((sqrt(8 * K + 1) - 1) / 2);
-		auto variance = Eigen::MatrixXd(N, N);
-		int k = 0;
-		for (unsigned int i = 0; i < N; i++)
-			for (unsigned int j = i; j < N; j++) {
-				variance(i, j) = v->Get(k);
-				variance(j, i) = variance(i, j);
-				k++;
+	return InitDataMsgView(buf, source, ID, type, offset).ToDataMsg();
+}
+
+namespace {
+	// The floats are stored little-endian in the flatbuffer, so they are mapped and written directly (on little-endian hosts)
+
+	unsigned int _StreamKey(OperationType source, unsigned char ID, DataType type) {
+		return (to_underlying<OperationType>(source) << 16) | (ID << 8) | to_underlying<DataType>(type);
+	}
+
+	// storage of n floats for decoding, a new one is allocated if the last one is still used by a view
+	float* _Writable(std::shared_ptr<std::vector<float>>& storage, size_t n) {
+		if (!storage || storage.use_count() > 1)
+			storage = std::make_shared<std::vector<float>>();
+		storage->reserve(n > 0 ? n : 1); // so data() is not null even for an empty (0x0) variance: it is present
+		storage->resize(n);
+		return storage->data();
+	}
+
+	// int16 values and their scale if the abs. error of the quantisation is not greater than tolerance
+	bool _Quantise(const Eigen::VectorXd& v, double tolerance, std::vector<int16_t>& q, float& scale) {
+		if (tolerance <= 0 || v.size() == 0)
+			return false;
+		double maxAbs = v.cwiseAbs().maxCoeff();
+		scale = maxAbs > 0 ? static_cast<float>(maxAbs / 32767.) : 1.f;
+		q.resize(v.size());
+		for (Eigen::Index i = 0; i < v.size(); i++) {
+			double qi = std::round(v[i] / scale);
+			if (std::abs(qi * scale - v[i]) > tolerance)
+				return false;
+			q[i] = static_cast<int16_t>(qi);
+		}
+		return true;
+	}
+
+	bool _IsDiagonal(const Eigen::MatrixXd& M) {
+		for (Eigen::Index j = 0; j < M.cols(); j++)
+			for (Eigen::Index i = 0; i < M.rows(); i++)
+				if (i != j && M(i, j) != 0)
+					return false;
+		return true;
+	}
+
+	// the upper triangle row by row (or the diagonal only)
+	void _Pack(const Eigen::MatrixXd& variance, bool diagonal, float* m) {
+		Eigen::Index N = variance.rows();
+		if (diagonal) {
+			Eigen::Map<Eigen::VectorXf>(m, N) = variance.diagonal().cast<float>();
+			return;
+		}
+		for (Eigen::Index i = 0; i < N; i++) {
+			// row i of the upper triangle is contiguous
+			Eigen::Map<Eigen::VectorXf>(m, N - i) = variance.row(i).tail(N - i).transpose().cast<float>();
+			m += N - i;
+		}
+	}
+}
+
+DataMsgView SF::InitDataMsgView(const void* buf, OperationType source, unsigned char ID, DataType type, DTime offset,
+	std::shared_ptr<const void> keepalive) {
+	return DataMsgDecoder().View(buf, source, ID, type, offset, keepalive);
+}
+
+bool SF::VerifyDataMsgBatch(void * buf, int length) {
+	flatbuffers::Verifier v((uint8_t*)buf, length);
+	return DataMsgContentNameSpace::VerifyBatchBuffer(v);
+}
+
+size_t SF::GetNumOfBatchRecords(const void * buf) {
+	auto records = DataMsgContentNameSpace::GetBatch(buf)->records();
+	return records ? records->size() : 0;
+}
+
+DataMsgView SF::InitDataMsgViewFromBatch(const void * buf, size_t k, DTime offset, std::shared_ptr<const void> keepalive) {
+	return DataMsgDecoder().ViewFromBatch(buf, k, offset, keepalive);
+}
+
+DataMsgView SF::DataMsgDecoder::View(const void * buf, OperationType source, unsigned char ID, DataType type, DTime offset,
+	std::shared_ptr<const void> keepalive) {
+	return _View(DataMsgContentNameSpace::GetMsg(buf), source, ID, type, offset, keepalive);
+}
+
+DataMsgView SF::DataMsgDecoder::ViewFromBatch(const void * buf, size_t k, DTime offset, std::shared_ptr<const void> keepalive) {
+	auto record = DataMsgContentNameSpace::GetBatch(buf)->records()->Get(static_cast<flatbuffers::uoffset_t>(k));
+	if (!record->msg())
+		throw std::runtime_error(std::string("DataMsgDecoder::ViewFromBatch(): Record without content!"));
+	return _View(record->msg(), static_cast<OperationType>(record->source()), record->id(),
+		static_cast<DataType>(record->type()), offset, keepalive);
+}
+
+unsigned long long SF::DataMsgDecoder::GetNumOfLostMsgs() const {
+	return nLost;
+}
+
+DataMsgView SF::DataMsgDecoder::_View(const DataMsgContentNameSpace::Msg * msg, OperationType source, unsigned char ID,
+	DataType type, DTime offset, std::shared_ptr<const void> keepalive) {
+	DataMsgView view(ID, type, source, Time(std::chrono::microseconds(msg->timestamp_in_us())) + offset,
+		nullptr, 0, nullptr, 0);
+	Stream* stream = nullptr; // looked up only for the sequence numbers and the compact encodings
+	auto getStream = [&]() -> Stream& {
+		if (!stream)
+			stream = &streams[_StreamKey(source, ID, type)];
+		return *stream;
+	};
+	if (msg->sequence()) {
+		Stream& s = getStream();
+		// the numbers skip 0 when they wrap around
+		uint32_t diff = msg->sequence() - s.sequence - (msg->sequence() < s.sequence ? 1 : 0);
+		if (s.sequence && diff > 1 && diff < 0x80000000u) // else it is a restarted sender
+			nLost += diff - 1;
+		s.sequence = msg->sequence();
+	}
+	// Value
+	if (msg->value_vector())
+		view.SetValue(msg->value_vector()->data(), msg->value_vector()->size(), keepalive);
+	else if (msg->value_quantised()) {
+		auto q = msg->value_quantised();
+		float* v = _Writable(getStream().value, q->size());
+		for (flatbuffers::uoffset_t k = 0; k < q->size(); k++)
+			v[k] = msg->value_scale() * q->Get(k);
+		view.SetValue(v, q->size(), getStream().value);
+	}
+	// Variance
+	if (msg->variance_same_as_last()) {
+		Stream& s = getStream();
+		// without the reference (e.g. it was sent before subscribing) the variance is unknown until the next one
+		if (s.reference && s.referenceNumber == msg->variance_reference())
+			view.SetVariance(s.reference->data(), s.reference->size(), s.reference);
+		return view;
+	}
+	const float* packed = nullptr;
+	size_t length = 0;
+	std::shared_ptr<const void> owner = keepalive;
+	if (msg->variance_matrix()) {
+		packed = msg->variance_matrix()->data();
+		length = msg->variance_matrix()->size();
+	}
+	else if (msg->variance_diagonal() || msg->variance_quantised()) {
+		bool isDiagonal = msg->variance_diagonal() || msg->variance_is_diagonal();
+		size_t n = msg->variance_diagonal() ? msg->variance_diagonal()->size() : msg->variance_quantised()->size();
+		size_t N = isDiagonal ? n : static_cast<size_t>((std::sqrt(8. * n + 1) - 1) / 2 + 0.5);
+		length = isDiagonal ? (N * (N + 1)) / 2 : n;
+		// the references are decoded directly into their place
+		std::shared_ptr<std::vector<float>>& storage = msg->variance_reference() ? getStream().reference : getStream().variance;
+		float* m = _Writable(storage, length);
+		if (isDiagonal)
+			std::fill(m, m + length, 0.f);
+		for (size_t k = 0, i = 0; k < n; k++) {
+			float x = msg->variance_diagonal() ? msg->variance_diagonal()->Get(static_cast<flatbuffers::uoffset_t>(k)) :
+				msg->variance_scale() * msg->variance_quantised()->Get(static_cast<flatbuffers::uoffset_t>(k));
+			if (isDiagonal) {
+				m[i] = x;
+				i += N - k; // the next diagonal element in the packed upper triangle
 			}
-		data.SetVarianceMatrix(variance);
+			else
+				m[k] = x;
+		}
+		packed = m;
+		owner = storage;
+	}
+	if (!packed)
+		return view;
+	if (msg->variance_reference()) {
+		Stream& s = getStream();
+		if (owner != s.reference) {
+			float* r = _Writable(s.reference, length);
+			std::copy(packed, packed + length, r);
+			packed = r;
+			owner = s.reference;
+		}
+		s.referenceNumber = msg->variance_reference();
 	}
-	return data;
+	view.SetVariance(packed, length, owner);
+	return view;
 }
 
 void SF::SerializeDataMsg(const DataMsg & dataMsg, unsigned char*& buf, int & length) {
-	flatbuffers::FlatBufferBuilder fbb(1024);
+	DataMsgSerializer serializer;
+	DataMsgSerializer::Buffer* serialized = serializer.Serialize(dataMsg);
+	length = static_cast<int>(DataMsgSerializer::Size(serialized));
+	buf = new unsigned char[length];
+	const unsigned char* data = static_cast<const unsigned char*>(DataMsgSerializer::Data(serialized));
+	std::copy(data, data + length, buf);
+	DataMsgSerializer::Release(nullptr, serialized);
+}
 
+struct SF::DataMsgSerializer::Buffer {
+	flatbuffers::FlatBufferBuilder fbb;
+	std::vector<flatbuffers::Offset<DataMsgContentNameSpace::Record>> records; // reused while building a batch
+	Eigen::VectorXd packed; // reused while trying to quantise
+	std::vector<int16_t> quantised;
+	DataMsgSerializer* pool;
+	Buffer(DataMsgSerializer* pool_) : fbb(1024), pool(pool_) {}
+};
+
+SF::DataMsgSerializer::DataMsgSerializer() : nextReference(1) {}
+
+SF::DataMsgSerializer::~DataMsgSerializer() {}
+
+void SF::DataMsgSerializer::SetEncoding(const DataMsgEncoding & encoding_) {
+	encoding = encoding_;
+	// the sequences go on
+	for (auto& stream : streams)
+		stream.second.reference = 0;
+}
+
+const DataMsgEncoding & SF::DataMsgSerializer::GetEncoding() const {
+	return encoding;
+}
+
+DataMsgSerializer::Buffer * SF::DataMsgSerializer::Serialize(const DataMsg & msg) {
+	Buffer* buf = _Acquire();
+	buf->fbb.Finish(flatbuffers::Offset<DataMsgContentNameSpace::Msg>(_BuildMsg(msg, *buf)));
+	return buf;
+}
+
+DataMsgSerializer::Buffer * SF::DataMsgSerializer::SerializeBatch(std::vector<DataMsg>::const_iterator first,
+	std::vector<DataMsg>::const_iterator last) {
+	Buffer* buf = _Acquire();
+	buf->records.clear();
+	for (auto it = first; it != last; it++) {
+		auto msg = flatbuffers::Offset<DataMsgContentNameSpace::Msg>(_BuildMsg(*it, *buf));
+		buf->records.push_back(DataMsgContentNameSpace::CreateRecord(buf->fbb, to_underlying<OperationType>(it->GetDataSourceType()),
+			it->GetSourceID(), to_underlying<DataType>(it->GetDataType()), msg));
+	}
+	auto records = buf->fbb.CreateVector(buf->records);
+	DataMsgContentNameSpace::FinishBatchBuffer(buf->fbb, DataMsgContentNameSpace::CreateBatch(buf->fbb, records));
+	return buf;
+}
+
+const size_t SF::DataMsgSerializer::maxBatchOverhead;
+
+size_t SF::DataMsgSerializer::MaxBatchRecordSize(const DataMsg & msg) {
+	// the full vectors are the largest encodings, the tables, the vtables and the paddings are below 256 bytes
+	size_t N = msg.HasVariance() ? static_cast<size_t>(msg.GetVariance().rows()) : 0;
+	size_t n = msg.HasValue() ? static_cast<size_t>(msg.GetValue().size()) : 0;
+	return 256 + sizeof(float) * (n + (N * (N + 1)) / 2);
+}
+
+const void * SF::DataMsgSerializer::Data(const Buffer * buf) {
+	return buf->fbb.GetBufferPointer();
+}
+
+size_t SF::DataMsgSerializer::Size(const Buffer * buf) {
+	return buf->fbb.GetSize();
+}
+
+void SF::DataMsgSerializer::Release(void * data, void * buf_) {
+	Buffer* buf = static_cast<Buffer*>(buf_);
+	std::lock_guard<std::mutex> lock(buf->pool->mutex);
+	buf->pool->freeBuffers.push_back(buf);
+}
+
+size_t SF::DataMsgSerializer::GetNumOfBuffers() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return buffers.size();
+}
+
+DataMsgSerializer::Buffer * SF::DataMsgSerializer::_Acquire() {
+	Buffer* buf;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (freeBuffers.empty()) {
+			buffers.push_back(std::unique_ptr<Buffer>(new Buffer(this)));
+			freeBuffers.reserve(buffers.size());
+			buf = buffers.back().get();
+		}
+		else {
+			buf = freeBuffers.back();
+			freeBuffers.pop_back();
+		}
+	}
+	buf->fbb.Clear(); // keeps the allocated memory
+	return buf;
+}
+
+uint32_t SF::DataMsgSerializer::_BuildMsg(const DataMsg & dataMsg, Buffer & buf) {
+	flatbuffers::FlatBufferBuilder& fbb = buf.fbb;
+	bool quantise = encoding.quantisationTolerance > 0;
+
+	// Value: quantised if it is precise enough
 	flatbuffers::Offset<flatbuffers::Vector<float>> fbb_value;
-	float* v;
+	flatbuffers::Offset<flatbuffers::Vector<int16_t>> fbb_valueQuantised;
+	float valueScale = 0;
 	if (dataMsg.HasValue()) {
-		auto value = dataMsg.GetValue();
-		size_t N = value.size();
-		v = new float[N];
-		for (unsigned int i = 0; i < N; i++)
-			v[i] = (float)value[i];
-		fbb_value = fbb.CreateVector<float>(v, N);
+		const Eigen::VectorXd& value = dataMsg.GetValue();
+		if (_Quantise(value, encoding.quantisationTolerance, buf.quantised, valueScale))
+			fbb_valueQuantised = fbb.CreateVector(buf.quantised);
+		else {
+			float* v;
+			fbb_value = fbb.CreateUninitializedVector<float>(value.size(), &v);
+			Eigen::Map<Eigen::VectorXf>(v, value.size()) = value.cast<float>();
+		}
 	}
 
+	// Variance: a reference to the last one, the diagonal or the upper triangle - quantised if it is precise enough
 	flatbuffers::Offset<flatbuffers::Vector<float>> fbb_variance;
-	float* m;
+	flatbuffers::Offset<flatbuffers::Vector<int16_t>> fbb_varianceQuantised;
+	float varianceScale = 0;
+	bool isDiagonal = false, sameAsLast = false;
+	uint32_t reference = 0;
+	Stream& stream = streams[_StreamKey(dataMsg.GetDataSourceType(), dataMsg.GetSourceID(), dataMsg.GetDataType())];
+	if (++stream.sequence == 0)
+		stream.sequence = 1;
 	if (dataMsg.HasVariance()) {
-		auto variance = dataMsg.GetVariance();
-		unsigned int N = static_cast<unsigned int>(variance.rows());
-		unsigned int K = static_cast<unsigned int>((N*(N + 1)) / 2);
-		m = new float[K];
-		int k = 0;
-		for (unsigned int i = 0; i < N; i++)
-			for (unsigned int j = i; j < N; j++) {
-				m[k] = (float)variance(i, j);
-				k++;
+		const Eigen::MatrixXd& variance = dataMsg.GetVariance();
+		Eigen::Index N = variance.rows();
+		if (encoding.referenceInterval > 0) {
+			if (stream.reference != 0 && stream.nSent < encoding.referenceInterval && stream.variance.rows() == N && stream.variance == variance) {
+				sameAsLast = true;
+				stream.nSent++;
+			}
+			else {
+				stream.variance = variance;
+				stream.nSent = 1;
+				stream.reference = nextReference++;
+				if (nextReference == 0)
+					nextReference = 1;
 			}
-		fbb_variance = fbb.CreateVector<float>(m, K);
+			reference = stream.reference;
+		}
+		if (!sameAsLast) {
+			isDiagonal = encoding.diagonal && _IsDiagonal(variance);
+			Eigen::Index K = isDiagonal ? N : (N*(N + 1)) / 2;
+			bool quantised = false;
+			if (quantise) {
+				buf.packed.resize(K);
+				if (isDiagonal)
+					buf.packed = variance.diagonal();
+				else
+					for (Eigen::Index i = 0, k = 0; i < N; k += N - i, i++)
+						buf.packed.segment(k, N - i) = variance.row(i).tail(N - i).transpose();
+				quantised = _Quantise(buf.packed, encoding.quantisationTolerance, buf.quantised, varianceScale);
+			}
+			if (quantised)
+				fbb_varianceQuantised = fbb.CreateVector(buf.quantised);
+			else {
+				float* m;
+				fbb_variance = fbb.CreateUninitializedVector<float>(K, &m);
+				_Pack(variance, isDiagonal, m);
+			}
+		}
 	}
 
 	DataMsgContentNameSpace::MsgBuilder msgBuilder(fbb);
 
-	if (dataMsg.HasValue())
+	if (fbb_value.o)
 		msgBuilder.add_value_vector(fbb_value);
+	if (fbb_valueQuantised.o) {
+		msgBuilder.add_value_quantised(fbb_valueQuantised);
+		msgBuilder.add_value_scale(valueScale);
+	}
 
-	if (dataMsg.HasVariance())
-		msgBuilder.add_variance_matrix(fbb_variance);
+	if (fbb_variance.o) {
+		if (isDiagonal)
+			msgBuilder.add_variance_diagonal(fbb_variance);
+		else
+			msgBuilder.add_variance_matrix(fbb_variance);
+	}
+	if (fbb_varianceQuantised.o) {
+		msgBuilder.add_variance_quantised(fbb_varianceQuantised);
+		msgBuilder.add_variance_scale(varianceScale);
+		msgBuilder.add_variance_is_diagonal(isDiagonal);
+	}
+	if (sameAsLast)
+		msgBuilder.add_variance_same_as_last(true);
+	if (reference)
+		msgBuilder.add_variance_reference(reference);
+	msgBuilder.add_sequence(stream.sequence);
 
 	msgBuilder.add_timestamp_in_us(duration_since_epoch(dataMsg.GetTime()).count());
 
-	auto msg = msgBuilder.Finish();
-	fbb.Finish(msg);
-
-	length = fbb.GetSize();
-
-	buf = new unsigned char[length];
-	for (size_t i = 0; i < length; i++)
-		buf[i] = fbb.GetBufferPointer()[i];
-
-	if (dataMsg.HasValue())
-		delete v;
-	if (dataMsg.HasVariance())
-		delete m;
+	return msgBuilder.Finish().o;
 }
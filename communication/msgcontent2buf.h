@@ -1,6 +1,13 @@
 #pragma once
 
 #include "DataMsg.h"
+#include "DataMsgView.h"
+#include <mutex>
+#include <map>
+
+namespace DataMsgContentNameSpace {
+	struct Msg;
+}
 
 namespace SF {
 
@@ -9,6 +16,139 @@ namespace SF {
 	DataMsg InitDataMsg(void* buf, OperationType source,
 		unsigned char ID, DataType type, DTime offset = DTime(0));
 
+	/*! \brief View of the content of a verified buffer without copying the values (see DataMsgView)
+	*
+	* The buffer must be kept alive by keepalive while the view is used.
+	*/
+	DataMsgView InitDataMsgView(const void* buf, OperationType source, unsigned char ID, DataType type,
+		DTime offset = DTime(0), std::shared_ptr<const void> keepalive = nullptr);
+
+	/*! \brief Decoder of the recieved DataMsg contents (see msgcontent.fbs)
+	*
+	* The float vectors are viewed in place. The compact encodings (diagonal, quantised) are decoded into buffers kept by
+	* the decoder, that are reused if no view refers to them anymore. The variances sent as references are kept for the
+	* msgs referring to them (variance_same_as_last), so one decoder must be used for the msgs of a sender.
+	*
+	* The gaps in the sequence numbers of the msgs are counted as lost msgs (e.g. dropped because of the HWM).
+	*/
+	class DataMsgDecoder {
+	public:
+		/*! \brief View of the content of a verified msg (with a 'd' topic) */
+		DataMsgView View(const void* buf, OperationType source, unsigned char ID, DataType type,
+			DTime offset = DTime(0), std::shared_ptr<const void> keepalive = nullptr);
+
+		/*! \brief View of the k-th DataMsg of a verified batch (with a 'b' topic) */
+		DataMsgView ViewFromBatch(const void* buf, size_t k, DTime offset = DTime(0),
+			std::shared_ptr<const void> keepalive = nullptr);
+
+		unsigned long long GetNumOfLostMsgs() const; /*!< Number of the msgs missing from the sequences of the viewed msgs */
+
+	private:
+		struct Stream {
+			std::shared_ptr<std::vector<float>> value, variance, reference; // decoded values
+			uint32_t referenceNumber = 0;
+			uint32_t sequence = 0; // of the last msg
+		};
+		unsigned long long nLost = 0;
+		std::map<unsigned int, Stream> streams; // by source, ID and DataType
+
+		DataMsgView _View(const DataMsgContentNameSpace::Msg* msg, OperationType source, unsigned char ID, DataType type,
+			DTime offset, std::shared_ptr<const void> keepalive);
+	};
+
+	bool VerifyDataMsgBatch(void* buf, int length); /*!< Verify a batch of DataMsgs (msg with a 'b' topic) */
+
+	size_t GetNumOfBatchRecords(const void* buf); /*!< Number of DataMsgs in a verified batch */
+
+	/*! \brief View of the k-th DataMsg of a verified batch (see InitDataMsgView())
+	*
+	* The source, the ID and the DataType are stored in the records of the batch.
+	*/
+	DataMsgView InitDataMsgViewFromBatch(const void* buf, size_t k, DTime offset = DTime(0),
+		std::shared_ptr<const void> keepalive = nullptr);
+
+	/*! \brief Serialize the msg into a new buffer (it must be deleted with delete[])
+	*
+	* See DataMsgSerializer to serialize without allocations. The default DataMsgEncoding is used.
+	*/
 	void SerializeDataMsg(const DataMsg& msg, unsigned char*& buf, int& length);
 
+	/*! \brief The encodings a DataMsgSerializer can choose from (see msgcontent.fbs)
+	*
+	* The receivers decode all of them (see DataMsgDecoder). Every compact encoding is opt-in: by default only the
+	* value_vector and the variance_matrix are sent, as the readers generated from the original msgcontent.fbs expect.
+	*/
+	struct DataMsgEncoding {
+		bool diagonal = false; /*!< Send only the diagonal of the diagonal variances */
+
+		/*! \brief If not 0: an unchanged variance is not sent again, only a reference to the last sent one
+		*
+		* Every referenceInterval-th msg of a stream still carries the variance (for the new subscribers and the lost msgs).
+		*/
+		unsigned int referenceInterval = 0;
+
+		double quantisationTolerance = 0; /*!< If positive: values and variances are sent as int16 with a scale if the abs. error is not greater */
+	};
+
+	/*! \brief Pool of reusable buffers to serialize DataMsg-s
+	*
+	* The values are written directly from the Eigen data into the reused builder of a free buffer, so no allocation
+	* is needed in steady state. The serialized buffer can be handed over to zmq without copying it: Release() is a valid
+	* zmq_free_fn with the buffer as the hint, it gives the buffer back to the pool when zmq does not need it anymore.
+	* Serialize() and Release() can be called from different threads.
+	*
+	* The encoding of each msg is chosen from the ones allowed by the set DataMsgEncoding. The msgs are numbered per topic
+	* (see the sequence field in msgcontent.fbs) and the last sent variances are kept for the references, so Serialize()
+	* must not be called from several threads at once.
+	*/
+	class DataMsgSerializer {
+	public:
+		struct Buffer; /*!< Serialized buffer with its builder */
+
+		DataMsgSerializer(); /*!< Constructor */
+
+		~DataMsgSerializer(); /*!< Destructor: all the buffers must have been released */
+
+		void SetEncoding(const DataMsgEncoding& encoding); /*!< Set the allowed encodings */
+
+		const DataMsgEncoding& GetEncoding() const; /*!< Get the allowed encodings */
+
+		Buffer* Serialize(const DataMsg& msg); /*!< Serialize into a free buffer of the pool (a new one is created only if all are in use) */
+
+		/*! \brief Serialize the msgs into one batch (sent with a 'b' topic, see msgstructure.txt) */
+		Buffer* SerializeBatch(std::vector<DataMsg>::const_iterator first, std::vector<DataMsg>::const_iterator last);
+
+		static const size_t maxBatchOverhead = 64; /*!< Upper bound of the size of an empty batch */
+
+		/*! \brief Upper bound of the size the msg adds to a batch, whatever encoding is chosen (e.g. to fit a batch into a slot) */
+		static size_t MaxBatchRecordSize(const DataMsg& msg);
+
+		static const void* Data(const Buffer* buf); /*!< The serialized data */
+
+		static size_t Size(const Buffer* buf); /*!< Size of the serialized data */
+
+		static void Release(void* data, void* buf); /*!< Give the buffer back to its pool (the signature is the one of zmq_free_fn) */
+
+		size_t GetNumOfBuffers() const; /*!< Number of allocated buffers */
+
+	private:
+		mutable std::mutex mutex;
+		std::vector<std::unique_ptr<Buffer>> buffers;
+		std::vector<Buffer*> freeBuffers;
+
+		DataMsgEncoding encoding;
+		struct Stream {
+			uint32_t sequence = 0; // of the last sent msg
+			Eigen::MatrixXd variance; // the last sent variance
+			unsigned int nSent = 0; // number of msgs since it was sent
+			uint32_t reference = 0; // its number, 0 if there is none
+		};
+		std::map<unsigned int, Stream> streams; // by source, ID and DataType
+		uint32_t nextReference;
+
+		Buffer* _Acquire(); // get a cleared free buffer
+
+		uint32_t _BuildMsg(const DataMsg& msg, Buffer& buf); // offset of the built msg table
+	};
+
 }
@@ -14,7 +14,16 @@ struct Msg FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_VALUE_VECTOR = 4,
     VT_VARIANCE_MATRIX = 6,
-    VT_TIMESTAMP_IN_US = 8
+    VT_TIMESTAMP_IN_US = 8,
+    VT_VARIANCE_DIAGONAL = 10,
+    VT_VALUE_QUANTISED = 12,
+    VT_VALUE_SCALE = 14,
+    VT_VARIANCE_QUANTISED = 16,
+    VT_VARIANCE_SCALE = 18,
+    VT_VARIANCE_IS_DIAGONAL = 20,
+    VT_VARIANCE_SAME_AS_LAST = 22,
+    VT_VARIANCE_REFERENCE = 24,
+    VT_SEQUENCE = 26
   };
   const flatbuffers::Vector<float> *value_vector() const {
     return GetPointer<const flatbuffers::Vector<float> *>(VT_VALUE_VECTOR);
@@ -25,6 +34,33 @@ struct Msg FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   int64_t timestamp_in_us() const {
     return GetField<int64_t>(VT_TIMESTAMP_IN_US, 0);
   }
+  const flatbuffers::Vector<float> *variance_diagonal() const {
+    return GetPointer<const flatbuffers::Vector<float> *>(VT_VARIANCE_DIAGONAL);
+  }
+  const flatbuffers::Vector<int16_t> *value_quantised() const {
+    return GetPointer<const flatbuffers::Vector<int16_t> *>(VT_VALUE_QUANTISED);
+  }
+  float value_scale() const {
+    return GetField<float>(VT_VALUE_SCALE, 0.0f);
+  }
+  const flatbuffers::Vector<int16_t> *variance_quantised() const {
+    return GetPointer<const flatbuffers::Vector<int16_t> *>(VT_VARIANCE_QUANTISED);
+  }
+  float variance_scale() const {
+    return GetField<float>(VT_VARIANCE_SCALE, 0.0f);
+  }
+  bool variance_is_diagonal() const {
+    return GetField<uint8_t>(VT_VARIANCE_IS_DIAGONAL, 0) != 0;
+  }
+  bool variance_same_as_last() const {
+    return GetField<uint8_t>(VT_VARIANCE_SAME_AS_LAST, 0) != 0;
+  }
+  uint32_t variance_reference() const {
+    return GetField<uint32_t>(VT_VARIANCE_REFERENCE, 0);
+  }
+  uint32_t sequence() const {
+    return GetField<uint32_t>(VT_SEQUENCE, 0);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_VALUE_VECTOR) &&
@@ -32,6 +68,18 @@ struct Msg FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyOffset(verifier, VT_VARIANCE_MATRIX) &&
            verifier.VerifyVector(variance_matrix()) &&
            VerifyField<int64_t>(verifier, VT_TIMESTAMP_IN_US) &&
+           VerifyOffset(verifier, VT_VARIANCE_DIAGONAL) &&
+           verifier.VerifyVector(variance_diagonal()) &&
+           VerifyOffset(verifier, VT_VALUE_QUANTISED) &&
+           verifier.VerifyVector(value_quantised()) &&
+           VerifyField<float>(verifier, VT_VALUE_SCALE) &&
+           VerifyOffset(verifier, VT_VARIANCE_QUANTISED) &&
+           verifier.VerifyVector(variance_quantised()) &&
+           VerifyField<float>(verifier, VT_VARIANCE_SCALE) &&
+           VerifyField<uint8_t>(verifier, VT_VARIANCE_IS_DIAGONAL) &&
+           VerifyField<uint8_t>(verifier, VT_VARIANCE_SAME_AS_LAST) &&
+           VerifyField<uint32_t>(verifier, VT_VARIANCE_REFERENCE) &&
+           VerifyField<uint32_t>(verifier, VT_SEQUENCE) &&
            verifier.EndTable();
   }
 };
@@ -48,6 +96,33 @@ struct MsgBuilder {
   void add_timestamp_in_us(int64_t timestamp_in_us) {
     fbb_.AddElement<int64_t>(Msg::VT_TIMESTAMP_IN_US, timestamp_in_us, 0);
   }
+  void add_variance_diagonal(flatbuffers::Offset<flatbuffers::Vector<float>> variance_diagonal) {
+    fbb_.AddOffset(Msg::VT_VARIANCE_DIAGONAL, variance_diagonal);
+  }
+  void add_value_quantised(flatbuffers::Offset<flatbuffers::Vector<int16_t>> value_quantised) {
+    fbb_.AddOffset(Msg::VT_VALUE_QUANTISED, value_quantised);
+  }
+  void add_value_scale(float value_scale) {
+    fbb_.AddElement<float>(Msg::VT_VALUE_SCALE, value_scale, 0.0f);
+  }
+  void add_variance_quantised(flatbuffers::Offset<flatbuffers::Vector<int16_t>> variance_quantised) {
+    fbb_.AddOffset(Msg::VT_VARIANCE_QUANTISED, variance_quantised);
+  }
+  void add_variance_scale(float variance_scale) {
+    fbb_.AddElement<float>(Msg::VT_VARIANCE_SCALE, variance_scale, 0.0f);
+  }
+  void add_variance_is_diagonal(bool variance_is_diagonal) {
+    fbb_.AddElement<uint8_t>(Msg::VT_VARIANCE_IS_DIAGONAL, static_cast<uint8_t>(variance_is_diagonal), 0);
+  }
+  void add_variance_same_as_last(bool variance_same_as_last) {
+    fbb_.AddElement<uint8_t>(Msg::VT_VARIANCE_SAME_AS_LAST, static_cast<uint8_t>(variance_same_as_last), 0);
+  }
+  void add_variance_reference(uint32_t variance_reference) {
+    fbb_.AddElement<uint32_t>(Msg::VT_VARIANCE_REFERENCE, variance_reference, 0);
+  }
+  void add_sequence(uint32_t sequence) {
+    fbb_.AddElement<uint32_t>(Msg::VT_SEQUENCE, sequence, 0);
+  }
   explicit MsgBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -64,11 +139,29 @@ inline flatbuffers::Offset<Msg> CreateMsg(
     flatbuffers::FlatBufferBuilder &_fbb,
     flatbuffers::Offset<flatbuffers::Vector<float>> value_vector = 0,
     flatbuffers::Offset<flatbuffers::Vector<float>> variance_matrix = 0,
-    int64_t timestamp_in_us = 0) {
+    int64_t timestamp_in_us = 0,
+    flatbuffers::Offset<flatbuffers::Vector<float>> variance_diagonal = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int16_t>> value_quantised = 0,
+    float value_scale = 0.0f,
+    flatbuffers::Offset<flatbuffers::Vector<int16_t>> variance_quantised = 0,
+    float variance_scale = 0.0f,
+    bool variance_is_diagonal = false,
+    bool variance_same_as_last = false,
+    uint32_t variance_reference = 0,
+    uint32_t sequence = 0) {
   MsgBuilder builder_(_fbb);
   builder_.add_timestamp_in_us(timestamp_in_us);
+  builder_.add_sequence(sequence);
+  builder_.add_variance_reference(variance_reference);
+  builder_.add_variance_scale(variance_scale);
+  builder_.add_variance_quantised(variance_quantised);
+  builder_.add_value_scale(value_scale);
+  builder_.add_value_quantised(value_quantised);
+  builder_.add_variance_diagonal(variance_diagonal);
   builder_.add_variance_matrix(variance_matrix);
   builder_.add_value_vector(value_vector);
+  builder_.add_variance_same_as_last(variance_same_as_last);
+  builder_.add_variance_is_diagonal(variance_is_diagonal);
   return builder_.Finish();
 }
 
@@ -76,14 +169,35 @@ inline flatbuffers::Offset<Msg> CreateMsgDirect(
     flatbuffers::FlatBufferBuilder &_fbb,
     const std::vector<float> *value_vector = nullptr,
     const std::vector<float> *variance_matrix = nullptr,
-    int64_t timestamp_in_us = 0) {
+    int64_t timestamp_in_us = 0,
+    const std::vector<float> *variance_diagonal = nullptr,
+    const std::vector<int16_t> *value_quantised = nullptr,
+    float value_scale = 0.0f,
+    const std::vector<int16_t> *variance_quantised = nullptr,
+    float variance_scale = 0.0f,
+    bool variance_is_diagonal = false,
+    bool variance_same_as_last = false,
+    uint32_t variance_reference = 0,
+    uint32_t sequence = 0) {
   auto value_vector__ = value_vector ? _fbb.CreateVector<float>(*value_vector) : 0;
   auto variance_matrix__ = variance_matrix ? _fbb.CreateVector<float>(*variance_matrix) : 0;
+  auto variance_diagonal__ = variance_diagonal ? _fbb.CreateVector<float>(*variance_diagonal) : 0;
+  auto value_quantised__ = value_quantised ? _fbb.CreateVector<int16_t>(*value_quantised) : 0;
+  auto variance_quantised__ = variance_quantised ? _fbb.CreateVector<int16_t>(*variance_quantised) : 0;
   return DataMsgContentNameSpace::CreateMsg(
       _fbb,
       value_vector__,
       variance_matrix__,
-      timestamp_in_us);
+      timestamp_in_us,
+      variance_diagonal__,
+      value_quantised__,
+      value_scale,
+      variance_quantised__,
+      variance_scale,
+      variance_is_diagonal,
+      variance_same_as_last,
+      variance_reference,
+      sequence);
 }
 
 inline const DataMsgContentNameSpace::Msg *GetMsg(const void *buf) {
@@ -99,11 +99,134 @@ DataMsgContentNameSpace.Msg.prototype.timestampInUs = function() {
   return offset ? this.bb.readInt64(this.bb_pos + offset) : this.bb.createLong(0, 0);
 };
 
+/**
+ * @param {number} index
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceDiagonal = function(index) {
+  var offset = this.bb.__offset(this.bb_pos, 10);
+  return offset ? this.bb.readFloat32(this.bb.__vector(this.bb_pos + offset) + index * 4) : 0;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceDiagonalLength = function() {
+  var offset = this.bb.__offset(this.bb_pos, 10);
+  return offset ? this.bb.__vector_len(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @returns {Float32Array}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceDiagonalArray = function() {
+  var offset = this.bb.__offset(this.bb_pos, 10);
+  return offset ? new Float32Array(this.bb.bytes().buffer, this.bb.bytes().byteOffset + this.bb.__vector(this.bb_pos + offset), this.bb.__vector_len(this.bb_pos + offset)) : null;
+};
+
+/**
+ * @param {number} index
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.valueQuantised = function(index) {
+  var offset = this.bb.__offset(this.bb_pos, 12);
+  return offset ? this.bb.readInt16(this.bb.__vector(this.bb_pos + offset) + index * 2) : 0;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.valueQuantisedLength = function() {
+  var offset = this.bb.__offset(this.bb_pos, 12);
+  return offset ? this.bb.__vector_len(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @returns {Int16Array}
+ */
+DataMsgContentNameSpace.Msg.prototype.valueQuantisedArray = function() {
+  var offset = this.bb.__offset(this.bb_pos, 12);
+  return offset ? new Int16Array(this.bb.bytes().buffer, this.bb.bytes().byteOffset + this.bb.__vector(this.bb_pos + offset), this.bb.__vector_len(this.bb_pos + offset)) : null;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.valueScale = function() {
+  var offset = this.bb.__offset(this.bb_pos, 14);
+  return offset ? this.bb.readFloat32(this.bb_pos + offset) : 0.0;
+};
+
+/**
+ * @param {number} index
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceQuantised = function(index) {
+  var offset = this.bb.__offset(this.bb_pos, 16);
+  return offset ? this.bb.readInt16(this.bb.__vector(this.bb_pos + offset) + index * 2) : 0;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceQuantisedLength = function() {
+  var offset = this.bb.__offset(this.bb_pos, 16);
+  return offset ? this.bb.__vector_len(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @returns {Int16Array}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceQuantisedArray = function() {
+  var offset = this.bb.__offset(this.bb_pos, 16);
+  return offset ? new Int16Array(this.bb.bytes().buffer, this.bb.bytes().byteOffset + this.bb.__vector(this.bb_pos + offset), this.bb.__vector_len(this.bb_pos + offset)) : null;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceScale = function() {
+  var offset = this.bb.__offset(this.bb_pos, 18);
+  return offset ? this.bb.readFloat32(this.bb_pos + offset) : 0.0;
+};
+
+/**
+ * @returns {boolean}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceIsDiagonal = function() {
+  var offset = this.bb.__offset(this.bb_pos, 20);
+  return offset ? !!this.bb.readInt8(this.bb_pos + offset) : false;
+};
+
+/**
+ * @returns {boolean}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceSameAsLast = function() {
+  var offset = this.bb.__offset(this.bb_pos, 22);
+  return offset ? !!this.bb.readInt8(this.bb_pos + offset) : false;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.varianceReference = function() {
+  var offset = this.bb.__offset(this.bb_pos, 24);
+  return offset ? this.bb.readUint32(this.bb_pos + offset) : 0;
+};
+
+/**
+ * @returns {number}
+ */
+DataMsgContentNameSpace.Msg.prototype.sequence = function() {
+  var offset = this.bb.__offset(this.bb_pos, 26);
+  return offset ? this.bb.readUint32(this.bb_pos + offset) : 0;
+};
+
 /**
  * @param {flatbuffers.Builder} builder
  */
 DataMsgContentNameSpace.Msg.startMsg = function(builder) {
-  builder.startObject(3);
+  builder.startObject(12);
 };
 
 /**
@@ -172,6 +295,141 @@ DataMsgContentNameSpace.Msg.addTimestampInUs = function(builder, timestampInUs)
   builder.addFieldInt64(2, timestampInUs, builder.createLong(0, 0));
 };
 
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} varianceDiagonalOffset
+ */
+DataMsgContentNameSpace.Msg.addVarianceDiagonal = function(builder, varianceDiagonalOffset) {
+  builder.addFieldOffset(3, varianceDiagonalOffset, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {Array.<number>} data
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Msg.createVarianceDiagonalVector = function(builder, data) {
+  builder.startVector(4, data.length, 4);
+  for (var i = data.length - 1; i >= 0; i--) {
+    builder.addFloat32(data[i]);
+  }
+  return builder.endVector();
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} numElems
+ */
+DataMsgContentNameSpace.Msg.startVarianceDiagonalVector = function(builder, numElems) {
+  builder.startVector(4, numElems, 4);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} valueQuantisedOffset
+ */
+DataMsgContentNameSpace.Msg.addValueQuantised = function(builder, valueQuantisedOffset) {
+  builder.addFieldOffset(4, valueQuantisedOffset, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {Array.<number>} data
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Msg.createValueQuantisedVector = function(builder, data) {
+  builder.startVector(2, data.length, 2);
+  for (var i = data.length - 1; i >= 0; i--) {
+    builder.addInt16(data[i]);
+  }
+  return builder.endVector();
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} numElems
+ */
+DataMsgContentNameSpace.Msg.startValueQuantisedVector = function(builder, numElems) {
+  builder.startVector(2, numElems, 2);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} valueScale
+ */
+DataMsgContentNameSpace.Msg.addValueScale = function(builder, valueScale) {
+  builder.addFieldFloat32(5, valueScale, 0.0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {flatbuffers.Offset} varianceQuantisedOffset
+ */
+DataMsgContentNameSpace.Msg.addVarianceQuantised = function(builder, varianceQuantisedOffset) {
+  builder.addFieldOffset(6, varianceQuantisedOffset, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {Array.<number>} data
+ * @returns {flatbuffers.Offset}
+ */
+DataMsgContentNameSpace.Msg.createVarianceQuantisedVector = function(builder, data) {
+  builder.startVector(2, data.length, 2);
+  for (var i = data.length - 1; i >= 0; i--) {
+    builder.addInt16(data[i]);
+  }
+  return builder.endVector();
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} numElems
+ */
+DataMsgContentNameSpace.Msg.startVarianceQuantisedVector = function(builder, numElems) {
+  builder.startVector(2, numElems, 2);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} varianceScale
+ */
+DataMsgContentNameSpace.Msg.addVarianceScale = function(builder, varianceScale) {
+  builder.addFieldFloat32(7, varianceScale, 0.0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {boolean} varianceIsDiagonal
+ */
+DataMsgContentNameSpace.Msg.addVarianceIsDiagonal = function(builder, varianceIsDiagonal) {
+  builder.addFieldInt8(8, +varianceIsDiagonal, +false);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {boolean} varianceSameAsLast
+ */
+DataMsgContentNameSpace.Msg.addVarianceSameAsLast = function(builder, varianceSameAsLast) {
+  builder.addFieldInt8(9, +varianceSameAsLast, +false);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} varianceReference
+ */
+DataMsgContentNameSpace.Msg.addVarianceReference = function(builder, varianceReference) {
+  builder.addFieldInt32(10, varianceReference, 0);
+};
+
+/**
+ * @param {flatbuffers.Builder} builder
+ * @param {number} sequence
+ */
+DataMsgContentNameSpace.Msg.addSequence = function(builder, sequence) {
+  builder.addFieldInt32(11, sequence, 0);
+};
+
 /**
  * @param {flatbuffers.Builder} builder
  * @returns {flatbuffers.Offset}
@@ -194,13 +452,31 @@ DataMsgContentNameSpace.Msg.finishMsgBuffer = function(builder, offset) {
  * @param {flatbuffers.Offset} valueVectorOffset
  * @param {flatbuffers.Offset} varianceMatrixOffset
  * @param {flatbuffers.Long} timestampInUs
+ * @param {flatbuffers.Offset} varianceDiagonalOffset
+ * @param {flatbuffers.Offset} valueQuantisedOffset
+ * @param {number} valueScale
+ * @param {flatbuffers.Offset} varianceQuantisedOffset
+ * @param {number} varianceScale
+ * @param {boolean} varianceIsDiagonal
+ * @param {boolean} varianceSameAsLast
+ * @param {number} varianceReference
+ * @param {number} sequence
  * @returns {flatbuffers.Offset}
  */
-DataMsgContentNameSpace.Msg.createMsg = function(builder, valueVectorOffset, varianceMatrixOffset, timestampInUs) {
+DataMsgContentNameSpace.Msg.createMsg = function(builder, valueVectorOffset, varianceMatrixOffset, timestampInUs, varianceDiagonalOffset, valueQuantisedOffset, valueScale, varianceQuantisedOffset, varianceScale, varianceIsDiagonal, varianceSameAsLast, varianceReference, sequence) {
   DataMsgContentNameSpace.Msg.startMsg(builder);
   DataMsgContentNameSpace.Msg.addValueVector(builder, valueVectorOffset);
   DataMsgContentNameSpace.Msg.addVarianceMatrix(builder, varianceMatrixOffset);
   DataMsgContentNameSpace.Msg.addTimestampInUs(builder, timestampInUs);
+  DataMsgContentNameSpace.Msg.addVarianceDiagonal(builder, varianceDiagonalOffset);
+  DataMsgContentNameSpace.Msg.addValueQuantised(builder, valueQuantisedOffset);
+  DataMsgContentNameSpace.Msg.addValueScale(builder, valueScale);
+  DataMsgContentNameSpace.Msg.addVarianceQuantised(builder, varianceQuantisedOffset);
+  DataMsgContentNameSpace.Msg.addVarianceScale(builder, varianceScale);
+  DataMsgContentNameSpace.Msg.addVarianceIsDiagonal(builder, varianceIsDiagonal);
+  DataMsgContentNameSpace.Msg.addVarianceSameAsLast(builder, varianceSameAsLast);
+  DataMsgContentNameSpace.Msg.addVarianceReference(builder, varianceReference);
+  DataMsgContentNameSpace.Msg.addSequence(builder, sequence);
   return DataMsgContentNameSpace.Msg.endMsg(builder);
 }
 
@@ -1 +1 @@
-./flatc --cpp --python -js msgcontent.fbs
\ No newline at end of file
+./flatc --cpp --python -js msgcontent.fbs msgbatch.fbs
\ No newline at end of file
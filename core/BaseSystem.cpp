@@ -33,20 +33,30 @@ Eigen::VectorXd BaseSystem::EvalOutputUpdateNonlinearPart(double Ts, const Eigen
 	return Eigen::VectorXd::Zero(getNumOfOutputs());
 }
 
-Eigen::VectorXd BaseSystem::EvalStateUpdate(double Ts, const Eigen::VectorXd& state, const Eigen::VectorXd& disturbance) const {
-	return getA(Ts)*state + getB(Ts)*disturbance + EvalStateUpdateNonlinearPart(Ts, state, disturbance);
+// Compatibility with the models overriding the functions with the vector arguments
+
+Eigen::VectorXd BaseSystem::EvalStateUpdateNonlinearPartView(double Ts, const VectorView & state, const VectorView & disturbance) const {
+	return EvalStateUpdateNonlinearPart(Ts, Eigen::VectorXd(state), Eigen::VectorXd(disturbance));
+}
+
+Eigen::VectorXd BaseSystem::EvalOutputUpdateNonlinearPartView(double Ts, const VectorView & state, const VectorView & noise) const {
+	return EvalOutputUpdateNonlinearPart(Ts, Eigen::VectorXd(state), Eigen::VectorXd(noise));
+}
+
+Eigen::VectorXd BaseSystem::EvalStateUpdate(double Ts, const VectorView& state, const VectorView& disturbance) const {
+	return getMatrix(MATRIX_A, Ts)*state + getMatrix(MATRIX_B, Ts)*disturbance + EvalStateUpdateNonlinearPartView(Ts, state, disturbance);
 }
 
-Eigen::VectorXd BaseSystem::EvalOutputUpdate(double Ts, const Eigen::VectorXd& state, const Eigen::VectorXd& noise) const {
-	return getC(Ts)*state + getD(Ts)*noise + EvalOutputUpdateNonlinearPart(Ts, state, noise);
+Eigen::VectorXd BaseSystem::EvalOutputUpdate(double Ts, const VectorView& state, const VectorView& noise) const {
+	return getMatrix(MATRIX_C, Ts)*state + getMatrix(MATRIX_D, Ts)*noise + EvalOutputUpdateNonlinearPartView(Ts, state, noise);
 }
 
-Eigen::VectorXd BaseSystem::EvalNonlinearPart(TimeUpdateType type, double Ts, const Eigen::VectorXd & state, const Eigen::VectorXd & in) const {
+Eigen::VectorXd BaseSystem::EvalNonlinearPart(TimeUpdateType type, double Ts, const VectorView & state, const VectorView & in) const {
 	switch (type) {
 	case STATE_UPDATE:
-		return EvalStateUpdateNonlinearPart(Ts, state, in);
+		return EvalStateUpdateNonlinearPartView(Ts, state, in);
 	case OUTPUT_UPDATE:
-		return EvalOutputUpdateNonlinearPart(Ts, state, in);
+		return EvalOutputUpdateNonlinearPartView(Ts, state, in);
 	}
 	throw std::runtime_error(std::string("BaseSystem::EvalNonlinearPart(): Unknown input!"));
 }
@@ -96,6 +106,10 @@ void BaseSystem::systemTest() const {
 		throw std::runtime_error(std::string("BaseSystem::systemTest()"));
 	if (!eq(getPInvD(0.01), pinv(getD(0.01))))
 		throw std::runtime_error(std::string("BaseSystem::systemTest()"));
+	// Check the declared structures
+	for (ModelMatrix matrix : { MATRIX_A, MATRIX_B, MATRIX_C, MATRIX_D })
+		if (!StructuredMatrix::HasStructure(getMatrix(matrix, 0.01), getMatrixStructure(matrix)))
+			throw std::runtime_error(std::string("BaseSystem::systemTest()"));
 	// Check dependency vectors
 	Eigen::VectorXi v;
 	v = getStateUpdateNonlinXDep();
@@ -114,11 +128,11 @@ void BaseSystem::systemTest() const {
 	Eigen::VectorXd m;
 	Eigen::VectorXd x = Eigen::VectorXd::Zero(nx);
 	Eigen::VectorXd i = Eigen::VectorXd::Zero(nw);
-	m = EvalStateUpdateNonlinearPart(1, x, i);
+	m = EvalNonlinearPart(STATE_UPDATE, 1, x, i);
 	if (m.size() != nx)
 		throw std::runtime_error(std::string("BaseSystem::systemTest()"));
 	i = Eigen::VectorXd::Zero(nv);
-	m = EvalOutputUpdateNonlinearPart(1, x, i);
+	m = EvalNonlinearPart(OUTPUT_UPDATE, 1, x, i);
 	if (m.size() != ny)
 		throw std::runtime_error(std::string("BaseSystem::systemTest()"));
 }
@@ -130,3 +144,22 @@ Eigen::MatrixXd BaseSystem::getPInvB(double Ts) const {
 Eigen::MatrixXd BaseSystem::getPInvD(double Ts) const {
 	return pinv(getD(Ts));
 }
+
+Eigen::MatrixXd BaseSystem::getMatrix(ModelMatrix matrix, double Ts) const {
+	switch (matrix) {
+	case MATRIX_A:
+		return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getA(Ts); });
+	case MATRIX_B:
+		return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getB(Ts); });
+	case MATRIX_C:
+		return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getC(Ts); });
+	case MATRIX_D:
+		return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getD(Ts); });
+	case MATRIX_PINV_B:
+		return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getPInvB(Ts); });
+	case MATRIX_PINV_D:
+		return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getPInvD(Ts); });
+	default:
+		throw std::runtime_error(std::string("BaseSystem::getMatrix(): Unknown input!"));
+	}
+}
@@ -61,16 +61,28 @@ namespace SF {
 			const Eigen::VectorXd& state, const Eigen::VectorXd& noise) const;
 		/*!< Returns the value of \f$g()\f$ function according to the inputs. By default it is zero, in other cases must be overridden. */
 
+		/*! \brief Copy-free variant of EvalStateUpdateNonlinearPart(): the arguments are views, e.g. segments of the stacked vectors
+		*
+		* By default it copies the arguments and calls EvalStateUpdateNonlinearPart(), so the existing models work unchanged.
+		* Override this one instead to avoid the copies in every evaluation (e.g. for every sigma point).
+		*/
+		virtual Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts,
+			const VectorView& state, const VectorView& disturbance) const;
+
+		/*! \brief Copy-free variant of EvalOutputUpdateNonlinearPart() (see EvalStateUpdateNonlinearPartView()) */
+		virtual Eigen::VectorXd EvalOutputUpdateNonlinearPartView(double Ts,
+			const VectorView& state, const VectorView& noise) const;
+
 
 		// The Eval functions execute the prediction/output computation with the given values and defined coefficients/functions
-		Eigen::VectorXd EvalStateUpdate(double Ts, const Eigen::VectorXd& state, const Eigen::VectorXd& BaseSystemDisturbance) const;
+		Eigen::VectorXd EvalStateUpdate(double Ts, const VectorView& state, const VectorView& BaseSystemDisturbance) const;
 		/*!< Returns the new state vector according to the arguments. */
 
-		Eigen::VectorXd EvalOutputUpdate(double Ts, const Eigen::VectorXd& state, const Eigen::VectorXd& BaseSystemNoise) const;
+		Eigen::VectorXd EvalOutputUpdate(double Ts, const VectorView& state, const VectorView& BaseSystemNoise) const;
 		/*!< Returns the output vector according to the arguments. */
 
 		Eigen::VectorXd EvalNonlinearPart(TimeUpdateType type, double Ts,
-			const Eigen::VectorXd& state, const Eigen::VectorXd& in) const;
+			const VectorView& state, const VectorView& in) const;
 		/*!< Returns the value of \f$f()\f$ or \f$g()\f$ function according to the inputs.*/
 
 		Eigen::VectorXi getNonlinDep(TimeUpdateType outType, VariableType inType); /*!< General interface to get the dependency vectors. */
@@ -82,6 +94,9 @@ namespace SF {
 		virtual Eigen::MatrixXd getPInvB(double Ts) const; /*!< Returns \f$pinv(\mathbf B) \f$. Can be overridden to decrease computational complexity.*/
 
 		virtual Eigen::MatrixXd getPInvD(double Ts) const; /*!< Returns \f$pinv(\mathbf D) \f$. Can be overridden to decrease computational complexity.*/
+
+		/*! \brief Returns \f$\mathbf A_{bs} \f$, \f$\mathbf B_{bs} \f$, \f$\mathbf C_{bs} \f$, \f$\mathbf D_{bs} \f$ or the pseudo-inverses (MATRIX_PINV_B/D) cached according to getCachingPolicy() */
+		Eigen::MatrixXd getMatrix(ModelMatrix matrix, double Ts) const;
 	};
 
 }
\ No newline at end of file
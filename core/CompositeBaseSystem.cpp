@@ -0,0 +1,335 @@
+#include "CompositeBaseSystem.h"
+#include <algorithm>
+
+using namespace SF;
+
+SF::CompositeBaseSystem::CompositeBaseSystem(unsigned int ID, const std::vector<BaseSystemPtr>& parts_) :
+	BaseSystem(ID), parts(parts_) {
+	if (parts.empty())
+		throw std::runtime_error(std::string("CompositeBaseSystem::CompositeBaseSystem(): There must be at least one part!"));
+	for (DataType type : { STATE, DISTURBANCE, OUTPUT, NOISE }) {
+		std::vector<unsigned int>& offset = offsets[type];
+		offset.push_back(0);
+		for (const BaseSystemPtr& part : parts)
+			offset.push_back(offset.back() + part->getNumOf(type));
+	}
+	stateIsRad = Eigen::VectorXi(getNumOfStates());
+	outputIsRad = Eigen::VectorXi(getNumOfOutputs());
+	for (size_t k = 0; k < parts.size(); k++) {
+		stateIsRad.segment(Offset(STATE, k), parts[k]->getNumOfStates()) = parts[k]->getIfStateIsRad();
+		outputIsRad.segment(Offset(OUTPUT, k), parts[k]->getNumOfOutputs()) = parts[k]->getIfOutputIsRad();
+	}
+}
+
+size_t SF::CompositeBaseSystem::getNumOfParts() const { return parts.size(); }
+
+BaseSystem::BaseSystemPtr SF::CompositeBaseSystem::getPart(size_t k) const { return parts.at(k); }
+
+unsigned int SF::CompositeBaseSystem::Offset(DataType type, size_t k) const { return offsets.at(type).at(k); }
+
+unsigned int SF::CompositeBaseSystem::getNumOfStates() const { return offsets.at(STATE).back(); }
+
+unsigned int SF::CompositeBaseSystem::getNumOfDisturbances() const { return offsets.at(DISTURBANCE).back(); }
+
+unsigned int SF::CompositeBaseSystem::getNumOfOutputs() const { return offsets.at(OUTPUT).back(); }
+
+unsigned int SF::CompositeBaseSystem::getNumOfNoises() const { return offsets.at(NOISE).back(); }
+
+std::vector<std::string> SF::CompositeBaseSystem::getStateNames() const { return _Names(STATE); }
+
+std::vector<std::string> SF::CompositeBaseSystem::getNoiseNames() const { return _Names(NOISE); }
+
+std::vector<std::string> SF::CompositeBaseSystem::getDisturbanceNames() const { return _Names(DISTURBANCE); }
+
+std::vector<std::string> SF::CompositeBaseSystem::getOutputNames() const { return _Names(OUTPUT); }
+
+std::string SF::CompositeBaseSystem::getName() const {
+	std::string name = "Composite(";
+	for (size_t k = 0; k < parts.size(); k++)
+		name += (k ? "," : "") + parts[k]->getName();
+	return name + ")";
+}
+
+const Eigen::VectorXi & SF::CompositeBaseSystem::getIfStateIsRad() const { return stateIsRad; }
+
+const Eigen::VectorXi & SF::CompositeBaseSystem::getIfOutputIsRad() const { return outputIsRad; }
+
+Eigen::MatrixXd SF::CompositeBaseSystem::getA(double Ts) const { return _BlockDiag(MATRIX_A, Ts); }
+
+Eigen::MatrixXd SF::CompositeBaseSystem::getB(double Ts) const { return _BlockDiag(MATRIX_B, Ts); }
+
+Eigen::MatrixXd SF::CompositeBaseSystem::getC(double Ts) const { return _BlockDiag(MATRIX_C, Ts); }
+
+Eigen::MatrixXd SF::CompositeBaseSystem::getD(double Ts) const { return _BlockDiag(MATRIX_D, Ts); }
+
+Eigen::MatrixXd SF::CompositeBaseSystem::getPInvB(double Ts) const { return _BlockDiag(MATRIX_PINV_B, Ts); }
+
+Eigen::MatrixXd SF::CompositeBaseSystem::getPInvD(double Ts) const { return _BlockDiag(MATRIX_PINV_D, Ts); }
+
+Eigen::VectorXi SF::CompositeBaseSystem::getStateUpdateNonlinXDep() const { return _Dep(STATE_UPDATE, VAR_STATE); }
+
+Eigen::VectorXi SF::CompositeBaseSystem::getStateUpdateNonlinWDep() const { return _Dep(STATE_UPDATE, VAR_EXTERNAL); }
+
+Eigen::VectorXi SF::CompositeBaseSystem::getOutputUpdateNonlinXDep() const { return _Dep(OUTPUT_UPDATE, VAR_STATE); }
+
+Eigen::VectorXi SF::CompositeBaseSystem::getOutputUpdateNonlinVDep() const { return _Dep(OUTPUT_UPDATE, VAR_EXTERNAL); }
+
+Eigen::VectorXd SF::CompositeBaseSystem::EvalStateUpdateNonlinearPartView(double Ts,
+	const VectorView & state, const VectorView & disturbance) const {
+	Eigen::VectorXd out(getNumOfStates());
+	for (size_t k = 0; k < parts.size(); k++)
+		out.segment(Offset(STATE, k), parts[k]->getNumOfStates()) = parts[k]->EvalStateUpdateNonlinearPartView(Ts,
+			state.segment(Offset(STATE, k), parts[k]->getNumOfStates()),
+			disturbance.segment(Offset(DISTURBANCE, k), parts[k]->getNumOfDisturbances()));
+	return out;
+}
+
+Eigen::VectorXd SF::CompositeBaseSystem::EvalOutputUpdateNonlinearPartView(double Ts,
+	const VectorView & state, const VectorView & noise) const {
+	Eigen::VectorXd out(getNumOfOutputs());
+	for (size_t k = 0; k < parts.size(); k++)
+		out.segment(Offset(OUTPUT, k), parts[k]->getNumOfOutputs()) = parts[k]->EvalOutputUpdateNonlinearPartView(Ts,
+			state.segment(Offset(STATE, k), parts[k]->getNumOfStates()),
+			noise.segment(Offset(NOISE, k), parts[k]->getNumOfNoises()));
+	return out;
+}
+
+MatrixStructure SF::CompositeBaseSystem::getMatrixStructure(ModelMatrix matrix) const {
+	DataType rowType = _RowType(matrix), colType = _ColType(matrix);
+	bool allZero = true, allIdentity = true, allDiagonal = true, allSelection = true;
+	for (size_t k = 0; k < parts.size(); k++) {
+		MatrixStructure structure = parts[k]->getMatrixStructure(matrix);
+		// the identity and diagonal blocks form an identity or diagonal matrix only if they are square
+		bool square = parts[k]->getNumOf(rowType) == parts[k]->getNumOf(colType);
+		allZero = allZero && structure == ZERO;
+		allIdentity = allIdentity && structure == IDENTITY && square;
+		allDiagonal = allDiagonal && (structure == ZERO || structure == IDENTITY || structure == DIAGONAL) && square;
+		allSelection = allSelection && (structure == ZERO || structure == IDENTITY || structure == SELECTION);
+	}
+	if (allZero)
+		return ZERO;
+	if (allIdentity)
+		return IDENTITY;
+	if (allDiagonal)
+		return DIAGONAL;
+	if (allSelection)
+		return SELECTION;
+	return DENSE;
+}
+
+void SF::CompositeBaseSystem::setStructuredBlock(StructuredMatrix & M, Eigen::Index row, Eigen::Index col,
+	Eigen::Index rows, Eigen::Index cols, ModelMatrix matrix, double Ts, bool structured) const {
+	if (rows == 0 || cols == 0)
+		return;
+	DataType rowType = _RowType(matrix), colType = _ColType(matrix);
+	if (rows != getNumOf(rowType) || cols != getNumOf(colType))
+		throw std::runtime_error(std::string("CompositeBaseSystem::setStructuredBlock(): Wrong block size!"));
+	for (size_t k = 0; k < parts.size(); k++)
+		parts[k]->setStructuredBlock(M, row + Offset(rowType, k), col + Offset(colType, k),
+			parts[k]->getNumOf(rowType), parts[k]->getNumOf(colType), matrix, Ts, structured);
+}
+
+DataType SF::CompositeBaseSystem::_RowType(ModelMatrix matrix) {
+	switch (matrix) {
+	case MATRIX_A:
+	case MATRIX_B:
+		return STATE;
+	case MATRIX_C:
+	case MATRIX_D:
+		return OUTPUT;
+	case MATRIX_PINV_B:
+		return DISTURBANCE;
+	case MATRIX_PINV_D:
+		return NOISE;
+	default:
+		throw std::runtime_error(std::string("CompositeBaseSystem::_RowType(): Not a basesystem matrix!"));
+	}
+}
+
+DataType SF::CompositeBaseSystem::_ColType(ModelMatrix matrix) {
+	switch (matrix) {
+	case MATRIX_A:
+	case MATRIX_C:
+	case MATRIX_PINV_B:
+		return STATE;
+	case MATRIX_B:
+		return DISTURBANCE;
+	case MATRIX_D:
+		return NOISE;
+	case MATRIX_PINV_D:
+		return OUTPUT;
+	default:
+		throw std::runtime_error(std::string("CompositeBaseSystem::_ColType(): Not a basesystem matrix!"));
+	}
+}
+
+Eigen::MatrixXd SF::CompositeBaseSystem::_BlockDiag(ModelMatrix matrix, double Ts) const {
+	DataType rowType = _RowType(matrix), colType = _ColType(matrix);
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(getNumOf(rowType), getNumOf(colType));
+	for (size_t k = 0; k < parts.size(); k++)
+		out.block(Offset(rowType, k), Offset(colType, k), parts[k]->getNumOf(rowType), parts[k]->getNumOf(colType)) =
+			parts[k]->getMatrix(matrix, Ts);
+	return out;
+}
+
+std::vector<std::string> SF::CompositeBaseSystem::_Names(DataType type) const {
+	std::vector<std::string> out;
+	for (const BaseSystemPtr& part : parts)
+		for (const std::string& name : part->getNames(type))
+			out.push_back(part->getName() + "_" + name);
+	return out;
+}
+
+Eigen::VectorXi SF::CompositeBaseSystem::_Dep(TimeUpdateType outType, VariableType inType) const {
+	DataType type = System::getInputValueType(outType, inType);
+	Eigen::VectorXi out(getNumOf(type));
+	for (size_t k = 0; k < parts.size(); k++)
+		out.segment(Offset(type, k), parts[k]->getNumOf(type)) = parts[k]->getNonlinDep(outType, inType);
+	return out;
+}
+
+SF::PartSensor::PartSensor(SensorPtr sensor_, CompositeBaseSystem::CompositeBaseSystemPtr composite, size_t part_) :
+	Sensor(composite, sensor_->getID()), sensor(sensor_), part(part_) {
+	if (part >= composite->getNumOfParts() || !sensor->isCompatible(composite->getPart(part)))
+		throw std::runtime_error(std::string("PartSensor::PartSensor(): The sensor is not compatible with the part!"));
+	for (DataType type : { STATE, DISTURBANCE, NOISE }) {
+		offsets[type] = composite->Offset(type, part);
+		lengths[type] = composite->getPart(part)->getNumOf(type);
+	}
+}
+
+Sensor::SensorPtr SF::PartSensor::getSensor() const { return sensor; }
+
+size_t SF::PartSensor::getPart() const { return part; }
+
+unsigned int SF::PartSensor::getNumOfStates() const { return sensor->getNumOfStates(); }
+
+unsigned int SF::PartSensor::getNumOfDisturbances() const { return sensor->getNumOfDisturbances(); }
+
+unsigned int SF::PartSensor::getNumOfOutputs() const { return sensor->getNumOfOutputs(); }
+
+unsigned int SF::PartSensor::getNumOfNoises() const { return sensor->getNumOfNoises(); }
+
+std::vector<std::string> SF::PartSensor::getStateNames() const { return sensor->getStateNames(); }
+
+std::vector<std::string> SF::PartSensor::getNoiseNames() const { return sensor->getNoiseNames(); }
+
+std::vector<std::string> SF::PartSensor::getDisturbanceNames() const { return sensor->getDisturbanceNames(); }
+
+std::vector<std::string> SF::PartSensor::getOutputNames() const { return sensor->getOutputNames(); }
+
+std::string SF::PartSensor::getName() const { return sensor->getName(); }
+
+const Eigen::VectorXi & SF::PartSensor::getIfStateIsRad() const { return sensor->getIfStateIsRad(); }
+
+const Eigen::VectorXi & SF::PartSensor::getIfOutputIsRad() const { return sensor->getIfOutputIsRad(); }
+
+CachingPolicy SF::PartSensor::getCachingPolicy() const { return NO_CACHING; }
+
+Eigen::MatrixXd SF::PartSensor::getAs_bs(double Ts) const { return _Embed(sensor->getMatrix(MATRIX_A_BS, Ts), STATE); }
+
+Eigen::MatrixXd SF::PartSensor::getAs(double Ts) const { return sensor->getMatrix(MATRIX_A, Ts); }
+
+Eigen::MatrixXd SF::PartSensor::getBs_bs(double Ts) const { return _Embed(sensor->getMatrix(MATRIX_B_BS, Ts), DISTURBANCE); }
+
+Eigen::MatrixXd SF::PartSensor::getBs(double Ts) const { return sensor->getMatrix(MATRIX_B, Ts); }
+
+Eigen::MatrixXd SF::PartSensor::getCs_bs(double Ts) const { return _Embed(sensor->getMatrix(MATRIX_C_BS, Ts), STATE); }
+
+Eigen::MatrixXd SF::PartSensor::getCs(double Ts) const { return sensor->getMatrix(MATRIX_C, Ts); }
+
+Eigen::MatrixXd SF::PartSensor::getDs_bs(double Ts) const { return _Embed(sensor->getMatrix(MATRIX_D_BS, Ts), NOISE); }
+
+Eigen::MatrixXd SF::PartSensor::getDs(double Ts) const { return sensor->getMatrix(MATRIX_D, Ts); }
+
+Eigen::MatrixXd SF::PartSensor::getPInvBs(double Ts) const { return sensor->getMatrix(MATRIX_PINV_B, Ts); }
+
+Eigen::MatrixXd SF::PartSensor::getPInvDs(double Ts) const { return sensor->getMatrix(MATRIX_PINV_D, Ts); }
+
+Eigen::VectorXi SF::PartSensor::getStateUpdateNonlinXbsDep() const { return _Embed(sensor->getStateUpdateNonlinXbsDep(), STATE); }
+
+Eigen::VectorXi SF::PartSensor::getStateUpdateNonlinXsDep() const { return sensor->getStateUpdateNonlinXsDep(); }
+
+Eigen::VectorXi SF::PartSensor::getStateUpdateNonlinWbsDep() const { return _Embed(sensor->getStateUpdateNonlinWbsDep(), DISTURBANCE); }
+
+Eigen::VectorXi SF::PartSensor::getStateUpdateNonlinWsDep() const { return sensor->getStateUpdateNonlinWsDep(); }
+
+Eigen::VectorXi SF::PartSensor::getOutputUpdateNonlinXbsDep() const { return _Embed(sensor->getOutputUpdateNonlinXbsDep(), STATE); }
+
+Eigen::VectorXi SF::PartSensor::getOutputUpdateNonlinXsDep() const { return sensor->getOutputUpdateNonlinXsDep(); }
+
+Eigen::VectorXi SF::PartSensor::getOutputUpdateNonlinVbsDep() const { return _Embed(sensor->getOutputUpdateNonlinVbsDep(), NOISE); }
+
+Eigen::VectorXi SF::PartSensor::getOutputUpdateNonlinVsDep() const { return sensor->getOutputUpdateNonlinVsDep(); }
+
+Eigen::VectorXd SF::PartSensor::EvalStateUpdateNonlinearPartView(double Ts, const VectorView & baseSystemState,
+	const VectorView & baseSystemDisturbance, const VectorView & sensorState, const VectorView & sensorDisturbance) const {
+	return sensor->EvalStateUpdateNonlinearPartView(Ts, baseSystemState.segment(offsets.at(STATE), lengths.at(STATE)),
+		baseSystemDisturbance.segment(offsets.at(DISTURBANCE), lengths.at(DISTURBANCE)), sensorState, sensorDisturbance);
+}
+
+Eigen::VectorXd SF::PartSensor::EvalOutputUpdateNonlinearPartView(double Ts, const VectorView & baseSystemState,
+	const VectorView & baseSystemNoise, const VectorView & sensorState, const VectorView & sensorNoise) const {
+	return sensor->EvalOutputUpdateNonlinearPartView(Ts, baseSystemState.segment(offsets.at(STATE), lengths.at(STATE)),
+		baseSystemNoise.segment(offsets.at(NOISE), lengths.at(NOISE)), sensorState, sensorNoise);
+}
+
+bool SF::PartSensor::isCompatible(BaseSystem::BaseSystemPtr ptr) const {
+	CompositeBaseSystem* composite = dynamic_cast<CompositeBaseSystem*>(ptr.get());
+	return composite && part < composite->getNumOfParts() && sensor->isCompatible(composite->getPart(part));
+}
+
+MatrixStructure SF::PartSensor::getMatrixStructure(ModelMatrix matrix) const {
+	MatrixStructure structure = sensor->getMatrixStructure(matrix);
+	switch (matrix) {
+	case MATRIX_A_BS:
+	case MATRIX_B_BS:
+	case MATRIX_C_BS:
+	case MATRIX_D_BS:
+		// the zero padding keeps only the zero and the selection matrices (an identity becomes a selection)
+		if (structure == ZERO || structure == SELECTION)
+			return structure;
+		if (structure == IDENTITY)
+			return SELECTION;
+		return DENSE;
+	default:
+		return structure;
+	}
+}
+
+void SF::PartSensor::setStructuredBlock(StructuredMatrix & M, Eigen::Index row, Eigen::Index col,
+	Eigen::Index rows, Eigen::Index cols, ModelMatrix matrix, double Ts, bool structured) const {
+	DataType colType;
+	switch (matrix) {
+	case MATRIX_A_BS:
+	case MATRIX_C_BS:
+		colType = STATE;
+		break;
+	case MATRIX_B_BS:
+		colType = DISTURBANCE;
+		break;
+	case MATRIX_D_BS:
+		colType = NOISE;
+		break;
+	default:
+		sensor->setStructuredBlock(M, row, col, rows, cols, matrix, Ts, structured);
+		return;
+	}
+	if (rows == 0 || cols == 0)
+		return;
+	sensor->setStructuredBlock(M, row, col + offsets.at(colType), rows, lengths.at(colType), matrix, Ts, structured);
+}
+
+Eigen::MatrixXd SF::PartSensor::_Embed(const Eigen::MatrixXd & M, DataType colType) const {
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(M.rows(), colType == STATE ? getNumOfBaseSystemStates() :
+		colType == DISTURBANCE ? getNumOfBaseSystemDisturbances() : getNumOfBaseSystemNoises());
+	out.middleCols(offsets.at(colType), lengths.at(colType)) = M;
+	return out;
+}
+
+Eigen::VectorXi SF::PartSensor::_Embed(const Eigen::VectorXi & dep, DataType type) const {
+	Eigen::VectorXi out = Eigen::VectorXi::Zero(type == STATE ? getNumOfBaseSystemStates() :
+		type == DISTURBANCE ? getNumOfBaseSystemDisturbances() : getNumOfBaseSystemNoises());
+	out.segment(offsets.at(type), lengths.at(type)) = dep;
+	return out;
+}
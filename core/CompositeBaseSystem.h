@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Sensor.h"
+#include <map>
+#include <vector>
+
+namespace SF {
+
+	/*! \brief BaseSystem consisting of several independent base systems (e.g. the robots of a cooperative localisation)
+	*
+	* The state, disturbance, output and noise vectors are the concatenated vectors of the parts, the model matrices are
+	* block diagonal and the nonlinear parts are evaluated part by part on the segments of the vectors. The model matrices
+	* are set as separate blocks into the structured matrices of SystemManager (see setStructuredBlock()), so the zero
+	* blocks between the parts are neither stored nor multiplied.
+	*
+	* The sensors can be coupled to the whole composite (e.g. relative measurements between the parts) or to one part:
+	* the sensors of a single base system can be attached to a part with PartSensor.
+	*/
+	class CompositeBaseSystem : public BaseSystem {
+	public:
+		typedef std::shared_ptr<CompositeBaseSystem> CompositeBaseSystemPtr; /*!< Shared pointer type for the CompositeBaseSystem class */
+
+		CompositeBaseSystem(unsigned int ID, const std::vector<BaseSystemPtr>& parts); /*!< Constructor, arguments: unique, user defined ID and the parts */
+
+		size_t getNumOfParts() const; /*!< Number of parts */
+
+		BaseSystemPtr getPart(size_t k) const; /*!< Get the k-th part */
+
+		unsigned int Offset(DataType type, size_t k) const; /*!< Index of the first STATE, DISTURBANCE, OUTPUT or NOISE variable of the k-th part */
+
+		unsigned int getNumOfStates() const override;
+		unsigned int getNumOfDisturbances() const override;
+		unsigned int getNumOfOutputs() const override;
+		unsigned int getNumOfNoises() const override;
+
+		std::vector<std::string> getStateNames() const override;
+		std::vector<std::string> getNoiseNames() const override;
+		std::vector<std::string> getDisturbanceNames() const override;
+		std::vector<std::string> getOutputNames() const override;
+		std::string getName() const override;
+
+		const Eigen::VectorXi& getIfStateIsRad() const override;
+		const Eigen::VectorXi& getIfOutputIsRad() const override;
+
+		Eigen::MatrixXd getA(double Ts) const override;
+		Eigen::MatrixXd getB(double Ts) const override;
+		Eigen::MatrixXd getC(double Ts) const override;
+		Eigen::MatrixXd getD(double Ts) const override;
+
+		Eigen::MatrixXd getPInvB(double Ts) const override;
+		Eigen::MatrixXd getPInvD(double Ts) const override;
+
+		Eigen::VectorXi getStateUpdateNonlinXDep() const override;
+		Eigen::VectorXi getStateUpdateNonlinWDep() const override;
+		Eigen::VectorXi getOutputUpdateNonlinXDep() const override;
+		Eigen::VectorXi getOutputUpdateNonlinVDep() const override;
+
+		Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts,
+			const VectorView& state, const VectorView& disturbance) const override;
+		Eigen::VectorXd EvalOutputUpdateNonlinearPartView(double Ts,
+			const VectorView& state, const VectorView& noise) const override;
+
+		MatrixStructure getMatrixStructure(ModelMatrix matrix) const override; /*!< The structure of the block diagonal matrix if it is known from the parts */
+
+		void setStructuredBlock(StructuredMatrix& M, Eigen::Index row, Eigen::Index col, Eigen::Index rows,
+			Eigen::Index cols, ModelMatrix matrix, double Ts, bool structured = true) const override; /*!< Every part sets its own block (see System::setStructuredBlock()) */
+
+	private:
+		std::vector<BaseSystemPtr> parts;
+		std::map<DataType, std::vector<unsigned int>> offsets; // the first index of the parts and the length at the end
+		Eigen::VectorXi stateIsRad, outputIsRad;
+
+		static DataType _RowType(ModelMatrix matrix); // type of the rows and columns of the model matrices
+		static DataType _ColType(ModelMatrix matrix);
+		Eigen::MatrixXd _BlockDiag(ModelMatrix matrix, double Ts) const; // model matrix of the parts as a block diagonal matrix
+		std::vector<std::string> _Names(DataType type) const;
+		Eigen::VectorXi _Dep(TimeUpdateType outType, VariableType inType) const;
+	};
+
+	/*! \brief Sensor of a single base system attached to a part of a CompositeBaseSystem
+	*
+	* The basesystem related matrices of the sensor are placed at the columns of the part, the nonlinear parts get
+	* the segments of the part. Everything else is the same as for the original sensor (that is not added to
+	* the SystemManager, only this one).
+	*/
+	class PartSensor : public Sensor {
+	public:
+		/*! \brief Constructor, arguments: the sensor, the composite and the index of the part the sensor is related to
+		*
+		* The ID is the ID of the sensor. Throws if the sensor is not compatible with the part.
+		*/
+		PartSensor(SensorPtr sensor, CompositeBaseSystem::CompositeBaseSystemPtr composite, size_t part);
+
+		SensorPtr getSensor() const; /*!< Get the original sensor */
+
+		size_t getPart() const; /*!< Get the index of the part */
+
+		unsigned int getNumOfStates() const override;
+		unsigned int getNumOfDisturbances() const override;
+		unsigned int getNumOfOutputs() const override;
+		unsigned int getNumOfNoises() const override;
+
+		std::vector<std::string> getStateNames() const override;
+		std::vector<std::string> getNoiseNames() const override;
+		std::vector<std::string> getDisturbanceNames() const override;
+		std::vector<std::string> getOutputNames() const override;
+		std::string getName() const override;
+
+		const Eigen::VectorXi& getIfStateIsRad() const override;
+		const Eigen::VectorXi& getIfOutputIsRad() const override;
+
+		CachingPolicy getCachingPolicy() const override; /*!< NO_CACHING: the original sensor caches its matrices, so its InvalidateCache() is enough */
+
+		Eigen::MatrixXd getAs_bs(double Ts) const override;
+		Eigen::MatrixXd getAs(double Ts) const override;
+		Eigen::MatrixXd getBs_bs(double Ts) const override;
+		Eigen::MatrixXd getBs(double Ts) const override;
+		Eigen::MatrixXd getCs_bs(double Ts) const override;
+		Eigen::MatrixXd getCs(double Ts) const override;
+		Eigen::MatrixXd getDs_bs(double Ts) const override;
+		Eigen::MatrixXd getDs(double Ts) const override;
+
+		Eigen::MatrixXd getPInvBs(double Ts) const override;
+		Eigen::MatrixXd getPInvDs(double Ts) const override;
+
+		Eigen::VectorXi getStateUpdateNonlinXbsDep() const override;
+		Eigen::VectorXi getStateUpdateNonlinXsDep() const override;
+		Eigen::VectorXi getStateUpdateNonlinWbsDep() const override;
+		Eigen::VectorXi getStateUpdateNonlinWsDep() const override;
+		Eigen::VectorXi getOutputUpdateNonlinXbsDep() const override;
+		Eigen::VectorXi getOutputUpdateNonlinXsDep() const override;
+		Eigen::VectorXi getOutputUpdateNonlinVbsDep() const override;
+		Eigen::VectorXi getOutputUpdateNonlinVsDep() const override;
+
+		Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemDisturbance, const VectorView& sensorState,
+			const VectorView& sensorDisturbance) const override;
+		Eigen::VectorXd EvalOutputUpdateNonlinearPartView(double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemNoise, const VectorView& sensorState,
+			const VectorView& sensorNoise) const override;
+
+		bool isCompatible(BaseSystem::BaseSystemPtr ptr) const override; /*!< Compatible with the composites having a compatible part with the same index */
+
+		MatrixStructure getMatrixStructure(ModelMatrix matrix) const override; /*!< The structure of the original sensor's matrix (the basesystem related ones are DENSE or ZERO) */
+
+		void setStructuredBlock(StructuredMatrix& M, Eigen::Index row, Eigen::Index col, Eigen::Index rows,
+			Eigen::Index cols, ModelMatrix matrix, double Ts, bool structured = true) const override; /*!< The basesystem related blocks are set only at the columns of the part */
+
+	private:
+		SensorPtr sensor;
+		size_t part;
+		std::map<DataType, unsigned int> offsets, lengths; // the segment of the part in the vectors of the composite
+
+		Eigen::MatrixXd _Embed(const Eigen::MatrixXd& M, DataType colType) const; // zero padding to the columns of the composite
+		Eigen::VectorXi _Embed(const Eigen::VectorXi& dep, DataType type) const;
+	};
+
+}
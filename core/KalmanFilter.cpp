@@ -1,4 +1,6 @@
 #include "KalmanFilter.h"
+#include <algorithm>
+#include <numeric>
 
 using namespace SF;
 
@@ -12,29 +14,43 @@ KalmanFilter::~KalmanFilter()
 
 using namespace SF;
 
-void KalmanFilter::Step(const DTime& dT) { // update, collect measurement, correction via Kalman-filtering
-	double dT_sec = duration_cast_to_sec(dT);
+static Eigen::VectorXi _Select(const Eigen::VectorXi& value, const Eigen::VectorXi& indices) {
+	Eigen::VectorXi out(indices.size());
+	for (Eigen::Index i = 0; i < indices.size(); i++)
+		out(i) = value(indices(i));
+	return out;
+}
+
+// The blocks of the systems in the result of getBlockValue()
+static std::vector<size_t> _Blocks(const SystemManager::IndexList& systems) {
+	std::vector<size_t> out(systems.size());
+	for (size_t i = 0; i < systems.size(); i++)
+		out[i] = (size_t)(systems[i] + 1);
+	return out;
+}
+
+void KalmanFilter::_PredictComponent(const IndexList& systems, double Ts, const std::vector<double>& sensorTs,
+	const StatisticValue& x, const StatisticValue& w, const Eigen::VectorXi& isXRad, StatisticValue& x_pred) const {
 	Eigen::MatrixXd sg1, sg2;
-	StatisticValue x_pred = Eval(STATE_UPDATE, dT_sec, (*this)(STATE), (*this)(DISTURBANCE), sg1, sg2);
+	x_pred = Eval(systems, STATE_UPDATE, Ts, x, w, sg1, sg2, false, sensorTs);
 	// Offset the rad state variables into the allowed +-pi interval
-	{
-		auto isStateRad_ = isStateRad();
-		Eigen::VectorXd& x_pred_v = x_pred.vector;
-		for (int i = 0; i < isStateRad_.size(); i++)
-			if (isStateRad_(i) == 1) {
-				x_pred_v(i) = fmod(x_pred_v(i), 2. * EIGEN_PI);
-				if (x_pred_v(i) < -EIGEN_PI)
-					x_pred_v(i) += EIGEN_PI * 2.;
-				if (x_pred_v(i) > EIGEN_PI)
-					x_pred_v(i) -= EIGEN_PI * 2.;
-			}
-	}
-	Eigen::MatrixXd Syxpred;
-	StatisticValue y_meas = (*this)(OUTPUT);
-	StatisticValue y_pred = Eval(OUTPUT_UPDATE, dT_sec, x_pred, (*this)(NOISE), Syxpred, sg2);
+	NormaliseRad(x_pred.vector, isXRad);
+}
 
-	PredictionDone(x_pred, y_pred);
-	StatisticValue newstate = x_pred;
+void KalmanFilter::_PredictComponent(const IndexList& systems, double Ts, const std::vector<double>& sensorTs,
+	const BlockStatisticValue& x, const StatisticValue& w, const Eigen::VectorXi& isXRad, StatisticValue& x_pred, size_t& nSkipped) const {
+	Eigen::MatrixXd sg1, sg2;
+	x_pred = Eval(systems, STATE_UPDATE, Ts, x, w, sg1, sg2, false, sensorTs, &nSkipped);
+	NormaliseRad(x_pred.vector, isXRad);
+}
+
+void KalmanFilter::_FilterComponent(const IndexList& systems, double Ts, const StatisticValue& x_pred,
+	const StatisticValue& v, const StatisticValue& y_meas, const Eigen::VectorXi& isYRad,
+	StatisticValue& y_pred, StatisticValue& x_filt) const {
+	Eigen::MatrixXd Syxpred, sg2;
+	y_pred = Eval(systems, OUTPUT_UPDATE, Ts, x_pred, v, Syxpred, sg2);
+
+	x_filt = x_pred;
 	if (y_pred.Length() > 0) {
 		Eigen::MatrixXd Syy = y_pred.variance + y_meas.variance;
 
@@ -42,22 +58,173 @@ void KalmanFilter::Step(const DTime& dT) { // update, collect measurement, corre
 		Eigen::MatrixXd Sxnew = (x_pred.variance - K * Syxpred);
 		Eigen::VectorXd ydiff = y_meas.vector - y_pred.vector;
 
-		auto isyrad = isOutputRad(false);
-		for (int i=0;i<isyrad.size();i++)
-			if (isyrad(i)==1) {
-				ydiff(i) = fmod(ydiff(i), 2. * EIGEN_PI);
-				if (ydiff(i) < -EIGEN_PI)
-					ydiff(i) += EIGEN_PI * 2.;
-				if (ydiff(i) > EIGEN_PI)
-					ydiff(i) -= EIGEN_PI * 2.;
-			}
-		newstate = StatisticValue(x_pred.vector + K * ydiff,
+		NormaliseRad(ydiff, isYRad);
+		x_filt = StatisticValue(x_pred.vector + K * ydiff,
 			(Sxnew + Sxnew.transpose()) / 2.);
 	}
+}
+
+std::vector<SystemManager::IndexList> KalmanFilter::_ComponentsToFilter() const {
+	if (decomposition)
+		return getComponents();
+	return std::vector<IndexList>(1, getAllSystems());
+}
+
+void KalmanFilter::_ForEachComponent(const std::vector<Eigen::VectorXi>& stateIndices, const std::function<void(size_t)>& task) {
+	if (stateIndices.size() < 2 || !pool) {
+		for (size_t c = 0; c < stateIndices.size(); c++)
+			task(c);
+		return;
+	}
+	// only the tasks of this step are waited for: the pool may be shared (e.g. by the filters of a FilterHost)
+	WorkStealingPool::TaskGroup group;
+	for (size_t c = 0; c < stateIndices.size(); c++)
+		if ((size_t)stateIndices[c].size() >= minParallelStates)
+			pool->Submit([&task, c]() { task(c); }, group);
+		else
+			task(c);
+	pool->Wait(group);
+}
+
+void KalmanFilter::Step(const DTime& dT) { // update, collect measurement, correction via Kalman-filtering
+	double dT_sec = duration_cast_to_sec(dT);
+	StatisticValue x = (*this)(STATE);
+	BlockStatisticValue w = getBlockValue(DISTURBANCE);
+	BlockStatisticValue v = getBlockValue(NOISE);
+	BlockStatisticValue y_blocks = getBlockValue(OUTPUT);
+	Eigen::VectorXi isXRad = isStateRad();
+	Eigen::VectorXi isYRad = isOutputRad(false);
+	std::vector<double> sensorTs = getSensorTs(dT_sec);
+	// The state update computed in advance can be used if the step is not earlier and not much later than expected:
+	// the remaining time is propagated from the speculated state
+	DTime remainingDT = dT - speculationDT;
+	bool useSpeculation = speculative && speculationValid && speculatedState.Length() == x.Length()
+		&& remainingDT >= DTime::zero() && remainingDT <= speculationTolerance;
+	double remainingDT_sec = duration_cast_to_sec(remainingDT);
+	// The sensors propagated in the speculation (with their held time) are propagated with the remaining time only
+	std::vector<double> remainingSensorTs(sensorTs.size());
+	for (size_t i = 0; i < sensorTs.size(); i++)
+		remainingSensorTs[i] = sensorTs[i] < 0 ? -1 : remainingDT_sec;
+	speculationValid = false;
+	// The state sparsified in the previous step is propagated block-wise
+	bool useSparse = sparsification && sparseStateValid && sparseState.Length() == x.Length();
+	sparseStateValid = false;
+	// Filter the components separately (the cross variances between them are zeros)
+	std::vector<IndexList> components = _ComponentsToFilter();
+	// The disturbances, noises and measurements of the components are taken block-wise
+	std::vector<Eigen::VectorXi> ix(components.size()), iy(components.size());
+	for (size_t c = 0; c < components.size(); c++) {
+		ix[c] = getIndices(components[c], STATE);
+		iy[c] = getIndices(components[c], OUTPUT);
+	}
+	std::vector<StatisticValue> x_preds(components.size()), y_preds(components.size()), x_filts(components.size());
+	std::vector<size_t> nSkipped(components.size(), 0);
+	_ForEachComponent(ix, [&](size_t c) {
+		std::vector<size_t> blocks = _Blocks(components[c]);
+		if (useSpeculation && remainingDT == DTime::zero())
+			x_preds[c] = speculatedState.GetPart(ix[c]);
+		else if (useSpeculation)
+			_PredictComponent(components[c], remainingDT_sec, remainingSensorTs, speculatedState.GetPart(ix[c]), w.GetBlocks(blocks),
+				_Select(isXRad, ix[c]), x_preds[c]);
+		else if (useSparse)
+			_PredictComponent(components[c], dT_sec, sensorTs, sparseState.GetSubValue(blocks), w.GetBlocks(blocks),
+				_Select(isXRad, ix[c]), x_preds[c], nSkipped[c]);
+		else
+			_PredictComponent(components[c], dT_sec, sensorTs, x.GetPart(ix[c]), w.GetBlocks(blocks), _Select(isXRad, ix[c]), x_preds[c]);
+		_FilterComponent(components[c], dT_sec, x_preds[c], v.GetBlocks(blocks), y_blocks.GetBlocks(blocks),
+			_Select(isYRad, iy[c]), y_preds[c], x_filts[c]);
+	});
+	StatisticValue x_pred, y_pred, newstate;
+	if (components.size() == 1) {
+		x_pred = x_preds[0];
+		y_pred = y_preds[0];
+		newstate = x_filts[0];
+	}
+	else {
+		x_pred = StatisticValue(x.Length());
+		y_pred = StatisticValue(y_blocks.Length());
+		newstate = StatisticValue(x.Length());
+		for (size_t c = 0; c < components.size(); c++) {
+			x_pred.SetPart(ix[c], x_preds[c]);
+			y_pred.SetPart(iy[c], y_preds[c]);
+			newstate.SetPart(ix[c], x_filts[c]);
+		}
+	}
+	if (sparsification) {
+		_Sparsify(newstate);
+		sparsificationStats.nSkippedBlockProducts = useSpeculation ? speculationSkipped : std::accumulate(nSkipped.begin(), nSkipped.end(), (size_t)0);
+	}
+	PredictionDone(x_pred, y_pred);
 	FilteringDone(newstate);
 
 	State() = newstate;
+	PropagationStepDone(dT_sec);
 	resetMeasurement();
+}
+
+void SF::KalmanFilter::PrepareStep(const Time & nextStepTime) {
+	if (!speculative || firstStep)
+		return;
+	speculationDT = duration_cast(nextStepTime - lastStepTime);
+	double dT_sec = duration_cast_to_sec(speculationDT);
+	StatisticValue x = (*this)(STATE);
+	BlockStatisticValue w = getBlockValue(DISTURBANCE);
+	Eigen::VectorXi isXRad = isStateRad();
+	std::vector<double> sensorTs = getSensorTs(dT_sec);
+	std::vector<IndexList> components = _ComponentsToFilter();
+	std::vector<Eigen::VectorXi> ix(components.size());
+	for (size_t c = 0; c < components.size(); c++)
+		ix[c] = getIndices(components[c], STATE);
+	bool useSparse = sparsification && sparseStateValid && sparseState.Length() == x.Length();
+	std::vector<StatisticValue> x_preds(components.size());
+	std::vector<size_t> nSkipped(components.size(), 0);
+	_ForEachComponent(ix, [&](size_t c) {
+		std::vector<size_t> blocks = _Blocks(components[c]);
+		if (useSparse)
+			_PredictComponent(components[c], dT_sec, sensorTs, sparseState.GetSubValue(blocks), w.GetBlocks(blocks),
+				_Select(isXRad, ix[c]), x_preds[c], nSkipped[c]);
+		else
+			_PredictComponent(components[c], dT_sec, sensorTs, x.GetPart(ix[c]), w.GetBlocks(blocks), _Select(isXRad, ix[c]), x_preds[c]);
+	});
+	speculationSkipped = std::accumulate(nSkipped.begin(), nSkipped.end(), (size_t)0);
+	speculatedState = StatisticValue(x.Length());
+	for (size_t c = 0; c < components.size(); c++)
+		speculatedState.SetPart(ix[c], x_preds[c]);
+	speculationValid = true;
+}
+
+bool SF::KalmanFilter::SaveDataMsg(const DataMsg & data, const Time & t) {
+	// The state update depends on the state and the disturbances only
+	if (data.GetDataType() == STATE || data.GetDataType() == DISTURBANCE)
+		speculationValid = false;
+	if (data.GetDataType() == STATE)
+		sparseStateValid = false;
+	return SystemManager::SaveDataMsg(data, t);
+}
+
+bool SF::KalmanFilter::SaveDataMsg(const DataMsgView & data, const Time & t) {
+	if (data.GetDataType() == STATE || data.GetDataType() == DISTURBANCE)
+		speculationValid = false;
+	if (data.GetDataType() == STATE)
+		sparseStateValid = false;
+	return SystemManager::SaveDataMsg(data, t);
+}
+
+void SF::KalmanFilter::AddSensor(const SensorData & sensorData, const StatisticValue & sensorState) {
+	speculationValid = false;
+	sparseStateValid = false;
+	SystemManager::AddSensor(sensorData, sensorState);
+}
+
+void SF::KalmanFilter::RemoveSensor(unsigned int ID) {
+	speculationValid = false;
+	sparseStateValid = false;
+	SystemManager::RemoveSensor(ID);
+}
+
+void SF::KalmanFilter::SetPropagationDecimation(unsigned int ID, unsigned int k) {
+	speculationValid = false;
+	SystemManager::SetPropagationDecimation(ID, k);
 }
 
 void SF::KalmanFilter::SamplingTimeOver(const Time & currentTime) {
@@ -77,3 +244,75 @@ void SF::KalmanFilter::MsgQueueEmpty(const Time & currentTime) {
 	Step(duration_cast(currentTime - lastStepTime));
 	lastStepTime = currentTime;
 }
+
+void SF::KalmanFilter::SetDecomposition(bool enable) {
+	decomposition = enable;
+}
+
+void SF::KalmanFilter::SetParallelComponents(WorkStealingPool::WorkStealingPoolPtr pool_, size_t minStates) {
+	pool = pool_;
+	minParallelStates = minStates;
+}
+
+void SF::KalmanFilter::SetCovarianceSparsification(bool enable, double threshold) {
+	if (threshold < 0 || threshold >= 1)
+		throw std::runtime_error(std::string("KalmanFilter::SetCovarianceSparsification(): The threshold must be in [0, 1)!"));
+	sparsification = enable;
+	sparsificationThreshold = threshold;
+	sparsificationStats = SparsificationStats();
+	sparseStateValid = false;
+}
+
+const KalmanFilter::SparsificationStats & SF::KalmanFilter::getSparsificationStats() const { return sparsificationStats; }
+
+void SF::KalmanFilter::_Sparsify(StatisticValue & state_) {
+	PartitionerPtr p = getPartitioner(true);
+	Eigen::Index nx = state_.Length();
+	// D^{-1/2} of the states
+	Eigen::VectorXd scale = state_.variance.diagonal().cwiseMax(1e-300).cwiseSqrt().cwiseInverse();
+	Eigen::VectorXd inflation = Eigen::VectorXd::Zero(nx);
+	SparsificationStats stats;
+	for (int i = 0; i < (int)nSensors(); i++) {
+		Eigen::Index oi = p->Offset(STATE, i), ni = p->n(STATE)[i + 1];
+		for (int j = i + 1; j < (int)nSensors() && ni > 0; j++) {
+			Eigen::Index oj = p->Offset(STATE, j), nj = p->n(STATE)[j + 1];
+			if (nj == 0)
+				continue;
+			auto cross = state_.variance.block(oi, oj, ni, nj);
+			if (!cross.isZero(0)) {
+				Eigen::MatrixXd normalised = scale.segment(oi, ni).asDiagonal() * cross * scale.segment(oj, nj).asDiagonal();
+				double c = Eigen::JacobiSVD<Eigen::MatrixXd>(normalised).singularValues()(0);
+				if (c >= sparsificationThreshold)
+					continue;
+				// 2 a^T S_ij b <= c (a^T D_i a + b^T D_j b)
+				inflation.segment(oi, ni) += c * state_.variance.diagonal().segment(oi, ni);
+				inflation.segment(oj, nj) += c * state_.variance.diagonal().segment(oj, nj);
+				cross.setZero();
+				state_.variance.block(oj, oi, nj, ni).setZero();
+				stats.nDroppedBlocks++;
+				stats.maxDroppedCorrelation = std::max(stats.maxDroppedCorrelation, c);
+			}
+		}
+	}
+	state_.variance.diagonal() += inflation;
+	// The state of the next prediction block-wise, without the zero cross variances
+	sparseState = BlockStatisticValue();
+	for (int i = -1; i < (int)nSensors(); i++)
+		sparseState.AddBlock(p->PartStatisticValue(STATE, state_, i));
+	for (int i = -1; i < (int)nSensors(); i++)
+		for (int j = i + 1; j < (int)nSensors(); j++) {
+			auto cross = state_.variance.block(p->Offset(STATE, i), p->Offset(STATE, j), p->n(STATE)[i + 1], p->n(STATE)[j + 1]);
+			if (cross.size() > 0 && !cross.isZero(0))
+				sparseState.SetCrossVariance(i + 1, j + 1, cross);
+		}
+	sparseStateValid = true;
+	stats.nStoredDense = (size_t)(nx * nx);
+	stats.nStoredSparse = (size_t)sparseState.nStoredVariances();
+	sparsificationStats = stats;
+}
+
+void SF::KalmanFilter::SetSpeculativePrediction(bool enable, DTime tolerance) {
+	speculative = enable;
+	speculationTolerance = tolerance;
+	speculationValid = false;
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "SystemManager.h"
+#include "WorkStealingPool.h"
+#include <functional>
 
 namespace SF {
 
@@ -37,12 +39,43 @@ namespace SF {
 	* \f$ \hat{\mathbf x}_k = \overline{\mathbf x}_k + \mathbf K (\mathbf y_{meas,k} - \overline{\mathbf y}_k) \f$ its covariance matrix as \f$ \hat{\Sigma}_k\f$
 	*
 	* where \f$ \mathbf K = \overline{\Sigma}_{xy,k}\left(\overline{\Sigma}_{yy,k} + \Sigma_{yy,meas,k} \right)^{-1} \f$
+	*
+	* The independent components of the model (see SystemManager::getComponents()) are filtered separately,
+	* and optionally in parallel on a WorkStealingPool (see SetParallelComponents()).
+	*
+	* With speculative prediction (see SetSpeculativePrediction()) the state update to the next sampling time is computed in
+	* PrepareStep(), while the reciever is idle, so only the output update and the measurement update remain for the step.
+	*
+	* With covariance sparsification (see SetCovarianceSparsification()) the weak sensor-sensor cross covariances are set to zero
+	* and the state is also kept block-wise without them, so the next state update skips them.
 	*/
 	class KalmanFilter : public SystemManager {
 		Time lastStepTime;
 		bool firstStep = true;
+		bool decomposition = true;
+		WorkStealingPool::WorkStealingPoolPtr pool;
+		size_t minParallelStates = 0;
+		bool speculative = false;
+		DTime speculationTolerance;
+		bool speculationValid = false;
+		DTime speculationDT; // dT of the speculative prediction
+		StatisticValue speculatedState; // state update computed in advance
+		bool sparsification = false;
+		double sparsificationThreshold = 0;
+		bool sparseStateValid = false;
+		BlockStatisticValue sparseState; // the sparsified state without the zero cross variances (a block for each system)
+		size_t speculationSkipped = 0; // the block products skipped in the speculative prediction
 
 	public:
+		/*! \brief Statistics of the covariance sparsification in the last step (see SetCovarianceSparsification()) */
+		struct SparsificationStats {
+			size_t nDroppedBlocks = 0; /*!< Number of the sensor-sensor cross covariance blocks set to zero in the step */
+			double maxDroppedCorrelation = 0; /*!< The largest normalised correlation of the dropped blocks */
+			size_t nStoredDense = 0; /*!< Number of the elements of the dense covariance matrix */
+			size_t nStoredSparse = 0; /*!< Number of the covariance elements stored block-wise, without the zero cross variances */
+			size_t nSkippedBlockProducts = 0; /*!< Number of the block products skipped in the state update of the step (zero cross variances of the previous step) */
+		};
+
 		KalmanFilter(BaseSystemData data, StatisticValue state_); /*!< Constructor. */
 
 		~KalmanFilter();
@@ -57,7 +90,79 @@ namespace SF {
 
 		void MsgQueueEmpty(const Time& currentTime) override; /*!< Is called if the DataMsgs in the queue were read */
 
+		void PrepareStep(const Time& nextStepTime) override; /*!< Computes the state update to the next sampling time if speculative prediction is enabled */
+
+		/*! \brief Saves the DataMsg, changed disturbances/states invalidate the speculative prediction */
+		bool SaveDataMsg(const DataMsg& data, const Time& t = Now()) override;
+
+		bool SaveDataMsg(const DataMsgView& data, const Time& t = Now()) override; /*!< The same for a recieved msg read in place */
+
+		void AddSensor(const SensorData& sensorData, const StatisticValue& sensorState) override; /*!< Add a sensor (invalidates the speculative prediction) */
+
+		void RemoveSensor(unsigned int ID) override; /*!< Remove the sensor (invalidates the speculative prediction) */
+
+		void SetPropagationDecimation(unsigned int ID, unsigned int k) override; /*!< Set the decimation of a sensor (invalidates the speculative prediction) */
+
+		/*! \brief Compute the state update in advance (in PrepareStep())
+		*
+		* The speculative state update is used in the step if the step is later than expected at most with tolerance: then the
+		* remaining time is propagated from the speculated state. This is exact only if the state update of the model is
+		* composable (two steps of dT1 and dT2 give the same as one of dT1 + dT2), so by default only exactly timed steps use it.
+		* Otherwise (earlier steps, later ones or if the state or disturbances changed meanwhile) the state update is recomputed.
+		*/
+		void SetSpeculativePrediction(bool enable, DTime tolerance = DTime(0));
+
+		void SetDecomposition(bool enable); /*!< To filter the independent components separately (default) or the whole model at once */
+
+		/*! \brief Filter the components with at least minStates states on the given pool (or sequentially if pool_ is NULL)
+		*
+		* The model functions (getA(), ... and the nonlinear parts) of the different components are called from different threads,
+		* so they must be thread-safe.
+		*/
+		void SetParallelComponents(WorkStealingPool::WorkStealingPoolPtr pool_, size_t minStates = 10);
+
+		/*! \brief Drop the weakly correlated sensor-sensor cross covariance blocks after each step (default: disabled)
+		*
+		* The correlation of the states of sensors i and j is the spectral norm of \f$ \mathbf D_i^{-1/2} \Sigma_{ij} \mathbf D_j^{-1/2} \f$
+		* (D: the diagonal of the variances, so it is at most 1). The blocks with correlation c < threshold are set to zero and
+		* \f$ c \mathbf D_i \f$, \f$ c \mathbf D_j \f$ are added to the variances of the sensors, so the new covariance matrix
+		* is not smaller than the original one (the estimation remains consistent).
+		*
+		* The state is also kept block-wise without the zero cross variances, so the linear state update of the next step skips
+		* their products (see getSparsificationStats()). The measurement update works on the predicted covariance matrix, where
+		* the state update refills the dropped blocks of the sensors coupled through the basesystem.
+		*/
+		void SetCovarianceSparsification(bool enable, double threshold = 0.01);
+
+		const SparsificationStats& getSparsificationStats() const; /*!< Statistics of the last step */
+
 		typedef std::shared_ptr<KalmanFilter> KalmanFilterPtr; /*!< Shared pointer type for the KalmanFilter class */
+
+	private:
+		/*! \brief State update of the given systems
+		*
+		* The inputs and outputs contain the values related to the listed systems (see SystemManager::Eval(const IndexList&, ...))
+		*/
+		void _PredictComponent(const IndexList& systems, double Ts, const std::vector<double>& sensorTs, const StatisticValue& x,
+			const StatisticValue& w, const Eigen::VectorXi& isXRad, StatisticValue& x_pred) const;
+
+		/*! \brief The same from the block-wise sparsified state, the skipped block products are added to nSkipped */
+		void _PredictComponent(const IndexList& systems, double Ts, const std::vector<double>& sensorTs, const BlockStatisticValue& x,
+			const StatisticValue& w, const Eigen::VectorXi& isXRad, StatisticValue& x_pred, size_t& nSkipped) const;
+
+		/*! \brief Output update and filtering of the given systems starting from the predicted state x_pred */
+		void _FilterComponent(const IndexList& systems, double Ts, const StatisticValue& x_pred,
+			const StatisticValue& v, const StatisticValue& y_meas, const Eigen::VectorXi& isYRad,
+			StatisticValue& y_pred, StatisticValue& x_filt) const;
+
+		std::vector<IndexList> _ComponentsToFilter() const; // the components to be filtered separately
+
+		/*! \brief Calls task(c) for each component (on the pool if it has enough states) and waits for them */
+		void _ForEachComponent(const std::vector<Eigen::VectorXi>& stateIndices, const std::function<void(size_t)>& task);
+
+		void _Sparsify(StatisticValue& state_); /*!< Drop the weak sensor-sensor cross covariances and store the state block-wise (see SetCovarianceSparsification()) */
+
+		SparsificationStats sparsificationStats; /*!< See getSparsificationStats() */
 	};
 
 }
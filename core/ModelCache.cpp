@@ -0,0 +1,58 @@
+#include "ModelCache.h"
+#include <cmath>
+
+using namespace SF;
+
+constexpr double SF::ModelCache::defaultResolution;
+
+SF::ModelCache::ModelCache(double resolution_, size_t maxEntries_) : resolution(resolution_), maxEntries(maxEntries_) {
+	if (resolution <= 0)
+		throw std::runtime_error(std::string("ModelCache::ModelCache(): The resolution must be positive!"));
+}
+
+SF::ModelCache::ModelCache(const ModelCache & other) : resolution(other.resolution), maxEntries(other.maxEntries) {}
+
+ModelCache & SF::ModelCache::operator=(const ModelCache & other) {
+	if (this != &other) {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		resolution = other.resolution;
+		maxEntries = other.maxEntries;
+	}
+	return *this;
+}
+
+Eigen::MatrixXd SF::ModelCache::Get(ModelMatrix matrix, double Ts, bool constant, const Evaluator & evaluate) {
+	std::pair<ModelMatrix, long long> key(matrix, 0);
+	double TsRounded = Ts;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!constant) {
+			key.second = std::llround(Ts / resolution);
+			TsRounded = key.second * resolution;
+		}
+		auto it = entries.find(key);
+		if (it != entries.end())
+			return it->second;
+	}
+	// Computed without locking: the models can be evaluated parallel
+	Eigen::MatrixXd value = evaluate(TsRounded);
+	std::lock_guard<std::mutex> lock(mutex);
+	if (entries.size() >= maxEntries)
+		entries.clear();
+	entries[key] = value;
+	return value;
+}
+
+void SF::ModelCache::Invalidate() {
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+}
+
+void SF::ModelCache::SetResolution(double resolution_) {
+	if (resolution_ <= 0)
+		throw std::runtime_error(std::string("ModelCache::SetResolution(): The resolution must be positive!"));
+	std::lock_guard<std::mutex> lock(mutex);
+	resolution = resolution_;
+	entries.clear();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <functional>
+#include "Eigen/Dense"
+
+namespace SF {
+
+	/*! \brief The model matrices that can be cached (the _BS ones are the sensor matrices related to the basesystem)
+	*/
+	enum ModelMatrix : unsigned char {
+		MATRIX_A = 1,
+		MATRIX_B,
+		MATRIX_C,
+		MATRIX_D,
+		MATRIX_A_BS,
+		MATRIX_B_BS,
+		MATRIX_C_BS,
+		MATRIX_D_BS,
+		MATRIX_PINV_B,
+		MATRIX_PINV_D };
+
+	/*! \brief How the model matrices of a system can be cached - declared by the system (see System::getCachingPolicy())
+	*
+	* - NO_CACHING: the matrices are always recomputed (e.g. they depend on time varying parameters)
+	* - CACHE_BY_TS: the matrices depend only on the sampling time
+	* - CACHE_CONSTANT: the matrices do not depend even on the sampling time
+	*
+	* If the cached parameters of a system change, System::InvalidateCache() must be called.
+	*/
+	enum CachingPolicy { NO_CACHING, CACHE_BY_TS, CACHE_CONSTANT };
+
+	/*! \brief Thread-safe cache of model matrices keyed by the matrix type and the quantised sampling time
+	*
+	* The sampling time is rounded to the resolution and the matrices are computed with the rounded value.
+	* The default resolution is the resolution of the measured dT of the steps (1 us), so the matrices are computed with
+	* the exact sampling time, and the nonlinear parts of the models (that get the exact one) are consistent with them.
+	*
+	* Coarse rounding is an explicit opt-in (SetResolution(), System::setCacheResolution()): with a resolution coarser than
+	* the jitter of the scheduling (typically below +-50 us) the jittered steps share the entry of the nominal sampling
+	* time. Then the cached matrices belong to a sampling time that differs from the exact one by up to resolution/2, e.g.
+	* the relative error of A = exp(Ac*Ts) is about ||Ac||*resolution/2, and they are inconsistent with the nonlinear parts
+	* by the same amount. If the number of entries reaches the limit, the cache is cleared.
+	*/
+	class ModelCache {
+	public:
+		typedef std::function<Eigen::MatrixXd(double Ts)> Evaluator; //!< Computes the matrix for the given sampling time
+
+		static constexpr double defaultResolution = 1e-6; //!< Default resolution of the sampling time [s] - the resolution of the measured dT
+
+		ModelCache(double resolution_ = defaultResolution, size_t maxEntries_ = 256); //!< Constructor - resolution in seconds
+
+		ModelCache(const ModelCache& other); //!< Copies the settings only, the new cache is empty
+
+		ModelCache& operator=(const ModelCache& other); //!< Copies the settings only and clears the cache
+
+		/*! \brief Get the cached matrix or compute and store it
+		*
+		* With constant = true the sampling time is not considered (the matrix is computed with the given one)
+		*/
+		Eigen::MatrixXd Get(ModelMatrix matrix, double Ts, bool constant, const Evaluator& evaluate);
+
+		void Invalidate(); //!< Clear the cache
+
+		void SetResolution(double resolution_); //!< Set the resolution of the sampling time (clears the cache)
+
+	private:
+		std::map<std::pair<ModelMatrix, long long>, Eigen::MatrixXd> entries;
+		double resolution;
+		size_t maxEntries;
+		std::mutex mutex;
+	};
+}
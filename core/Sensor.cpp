@@ -49,28 +49,43 @@ Eigen::VectorXi Sensor::getStateUpdateNonlinWbsDep() const {
 	 return Eigen::VectorXd::Zero(getNumOfOutputs());
  }
 
+ // Compatibility with the models overriding the functions with the vector arguments
+
+ Eigen::VectorXd Sensor::EvalStateUpdateNonlinearPartView(double Ts, const VectorView & baseSystemState,
+	 const VectorView & baseSystemDisturbance, const VectorView & sensorState, const VectorView & sensorDisturbance) const {
+	 return EvalStateUpdateNonlinearPart(Ts, Eigen::VectorXd(baseSystemState), Eigen::VectorXd(baseSystemDisturbance),
+		 Eigen::VectorXd(sensorState), Eigen::VectorXd(sensorDisturbance));
+ }
+
+ Eigen::VectorXd Sensor::EvalOutputUpdateNonlinearPartView(double Ts, const VectorView & baseSystemState,
+	 const VectorView & baseSystemNoise, const VectorView & sensorState, const VectorView & sensorNoise) const {
+	 return EvalOutputUpdateNonlinearPart(Ts, Eigen::VectorXd(baseSystemState), Eigen::VectorXd(baseSystemNoise),
+		 Eigen::VectorXd(sensorState), Eigen::VectorXd(sensorNoise));
+ }
+
  // The Eval functions execute the prediction/output computation with the given values and defined coefficients/functions
 
- Eigen::VectorXd Sensor::EvalStateUpdate(double Ts, Eigen::VectorXd baseSystemState, Eigen::VectorXd baseSystemDisturbance, Eigen::VectorXd sensorState, Eigen::VectorXd sensorDisturbance) const {
-	 return getAs_bs(Ts)*baseSystemState + getAs(Ts)*sensorState +
-		 getBs_bs(Ts)*baseSystemDisturbance + getBs(Ts)*sensorDisturbance +
-		 EvalStateUpdateNonlinearPart(Ts, baseSystemState, baseSystemDisturbance, sensorState, sensorDisturbance);
+ Eigen::VectorXd Sensor::EvalStateUpdate(double Ts, const VectorView& baseSystemState, const VectorView& baseSystemDisturbance,
+	 const VectorView& sensorState, const VectorView& sensorDisturbance) const {
+	 return getMatrix(MATRIX_A_BS, Ts)*baseSystemState + getMatrix(MATRIX_A, Ts)*sensorState +
+		 getMatrix(MATRIX_B_BS, Ts)*baseSystemDisturbance + getMatrix(MATRIX_B, Ts)*sensorDisturbance +
+		 EvalStateUpdateNonlinearPartView(Ts, baseSystemState, baseSystemDisturbance, sensorState, sensorDisturbance);
  }
 
- Eigen::VectorXd Sensor::EvalOutputUpdate(double Ts, Eigen::VectorXd baseSystemState, Eigen::VectorXd baseSystemNoise,
-	 Eigen::VectorXd sensorState, Eigen::VectorXd sensorNoise) const {
-	 return getCs_bs(Ts)*baseSystemState + getCs(Ts)*sensorState +
-		 getDs_bs(Ts)*baseSystemNoise + getDs(Ts)*sensorNoise +
-		 EvalOutputUpdateNonlinearPart(Ts, baseSystemState, baseSystemNoise, sensorState, sensorNoise);
+ Eigen::VectorXd Sensor::EvalOutputUpdate(double Ts, const VectorView& baseSystemState, const VectorView& baseSystemNoise,
+	 const VectorView& sensorState, const VectorView& sensorNoise) const {
+	 return getMatrix(MATRIX_C_BS, Ts)*baseSystemState + getMatrix(MATRIX_C, Ts)*sensorState +
+		 getMatrix(MATRIX_D_BS, Ts)*baseSystemNoise + getMatrix(MATRIX_D, Ts)*sensorNoise +
+		 EvalOutputUpdateNonlinearPartView(Ts, baseSystemState, baseSystemNoise, sensorState, sensorNoise);
  }
 
- Eigen::VectorXd Sensor::EvalNonlinearPart(TimeUpdateType type, double Ts, const Eigen::VectorXd & baseSystemState,
-	 const Eigen::VectorXd & baseSystemIn, const Eigen::VectorXd & sensorState, const Eigen::VectorXd & sensorIn) const {
+ Eigen::VectorXd Sensor::EvalNonlinearPart(TimeUpdateType type, double Ts, const VectorView & baseSystemState,
+	 const VectorView & baseSystemIn, const VectorView & sensorState, const VectorView & sensorIn) const {
 	 switch (type) {
 	 case STATE_UPDATE:
-		 return EvalStateUpdateNonlinearPart(Ts, baseSystemState, baseSystemIn, sensorState, sensorIn);
+		 return EvalStateUpdateNonlinearPartView(Ts, baseSystemState, baseSystemIn, sensorState, sensorIn);
 	 case OUTPUT_UPDATE:
-		 return EvalOutputUpdateNonlinearPart(Ts, baseSystemState, baseSystemIn, sensorState, sensorIn);
+		 return EvalOutputUpdateNonlinearPartView(Ts, baseSystemState, baseSystemIn, sensorState, sensorIn);
 	 }
 	 throw std::runtime_error(std::string("Sensor::EvalNonlinearPart(): Unknown input!"));
  }
@@ -156,6 +171,10 @@ Eigen::VectorXi Sensor::getStateUpdateNonlinWbsDep() const {
 		 throw std::runtime_error(std::string("Sensor::systemTest()"));
 	 if (!eq(getPInvDs(0.01),pinv(getDs(0.01))))
 		 throw std::runtime_error(std::string("Sensor::systemTest()"));
+	 // Check the declared structures
+	 for (ModelMatrix matrix : { MATRIX_A, MATRIX_B, MATRIX_C, MATRIX_D, MATRIX_A_BS, MATRIX_B_BS, MATRIX_C_BS, MATRIX_D_BS })
+		 if (!StructuredMatrix::HasStructure(getMatrix(matrix, 0.01), getMatrixStructure(matrix)))
+			 throw std::runtime_error(std::string("Sensor::systemTest()"));
 	 // Check dependency vectors
 	 Eigen::VectorXi v;
 	 v = getStateUpdateNonlinXbsDep();
@@ -189,12 +208,12 @@ Eigen::VectorXi Sensor::getStateUpdateNonlinWbsDep() const {
 	 Eigen::VectorXd x0 = Eigen::VectorXd::Zero(nx0);
 	 Eigen::VectorXd i = Eigen::VectorXd::Zero(nw);
 	 Eigen::VectorXd i0 = Eigen::VectorXd::Zero(nw0);
-	 m = EvalStateUpdateNonlinearPart(1, x0, i0, x, i);
+	 m = EvalNonlinearPart(STATE_UPDATE, 1, x0, i0, x, i);
 	 if (m.size() != nx)
 		 throw std::runtime_error(std::string("Sensor::systemTest()"));
 	 i0 = Eigen::VectorXd::Zero(nv0);
 	 i = Eigen::VectorXd::Zero(nv);
-	 m = EvalOutputUpdateNonlinearPart(1, x0, i0, x, i);
+	 m = EvalNonlinearPart(OUTPUT_UPDATE, 1, x0, i0, x, i);
 	 if (m.size() != ny)
 		 throw std::runtime_error(std::string("Sensor::systemTest()"));
  }
@@ -217,3 +236,30 @@ Eigen::VectorXi Sensor::getStateUpdateNonlinWbsDep() const {
  unsigned int Sensor::getNumOfBaseSystemDisturbances() const {
 	 return numOfBaseSystemDisturbances;
  }
+
+ Eigen::MatrixXd Sensor::getMatrix(ModelMatrix matrix, double Ts) const {
+	 switch (matrix) {
+	 case MATRIX_A:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getAs(Ts); });
+	 case MATRIX_B:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getBs(Ts); });
+	 case MATRIX_C:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getCs(Ts); });
+	 case MATRIX_D:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getDs(Ts); });
+	 case MATRIX_A_BS:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getAs_bs(Ts); });
+	 case MATRIX_B_BS:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getBs_bs(Ts); });
+	 case MATRIX_C_BS:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getCs_bs(Ts); });
+	 case MATRIX_D_BS:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getDs_bs(Ts); });
+	 case MATRIX_PINV_B:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getPInvBs(Ts); });
+	 case MATRIX_PINV_D:
+		 return _getCachedMatrix(matrix, Ts, [this](double Ts) { return getPInvDs(Ts); });
+	 default:
+		 throw std::runtime_error(std::string("Sensor::getMatrix(): Unknown input!"));
+	 }
+ }
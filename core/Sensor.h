@@ -87,20 +87,34 @@ namespace SF {
 			const Eigen::VectorXd& baseSystemNoise, const Eigen::VectorXd& sensorState,
 			const Eigen::VectorXd& sensorNoise) const; /*!< Returns the value of \f$g()\f$ function according to the inputs. By default it is zero, in other cases must be overridden. */
 
+		/*! \brief Copy-free variant of EvalStateUpdateNonlinearPart(): the arguments are views, e.g. segments of the stacked vectors
+		*
+		* By default it copies the arguments and calls EvalStateUpdateNonlinearPart(), so the existing models work unchanged.
+		* Override this one instead to avoid the copies in every evaluation (e.g. for every sigma point).
+		*/
+		virtual Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemDisturbance, const VectorView& sensorState,
+			const VectorView& sensorDisturbance) const;
+
+		/*! \brief Copy-free variant of EvalOutputUpdateNonlinearPart() (see EvalStateUpdateNonlinearPartView()) */
+		virtual Eigen::VectorXd EvalOutputUpdateNonlinearPartView(double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemNoise, const VectorView& sensorState,
+			const VectorView& sensorNoise) const;
+
 		// The Eval functions execute the prediction/output computation with the given values and defined coefficients/functions
-		Eigen::VectorXd EvalStateUpdate(double Ts, Eigen::VectorXd baseSystemState, Eigen::VectorXd baseSystemDisturbance,
-			Eigen::VectorXd sensorState, Eigen::VectorXd sensorDisturbance) const;
+		Eigen::VectorXd EvalStateUpdate(double Ts, const VectorView& baseSystemState, const VectorView& baseSystemDisturbance,
+			const VectorView& sensorState, const VectorView& sensorDisturbance) const;
 		/*!< Returns the new sensor state vector according to the arguments. */
 
-		Eigen::VectorXd EvalOutputUpdate(double Ts, Eigen::VectorXd baseSystemState, Eigen::VectorXd baseSystemNoise,
-			Eigen::VectorXd sensorState, Eigen::VectorXd sensorNoise) const;
+		Eigen::VectorXd EvalOutputUpdate(double Ts, const VectorView& baseSystemState, const VectorView& baseSystemNoise,
+			const VectorView& sensorState, const VectorView& sensorNoise) const;
 		/*!< Returns the sensor output vector according to the arguments. */
 
 		virtual bool isCompatible(BaseSystem::BaseSystemPtr ptr) const = 0; /*!< To check if the sensor is compatible with a BaseSystem.  (It must be implement using the _isCompatible<class> function.) */
 
-		Eigen::VectorXd EvalNonlinearPart(TimeUpdateType type, double Ts, const Eigen::VectorXd& baseSystemState,
-			const Eigen::VectorXd& baseSystemIn, const Eigen::VectorXd& sensorState,
-			const Eigen::VectorXd& sensorIn) const; /*!< Returns the value of \f$f()\f$ or \f$g()\f$ function according to the inputs. */
+		Eigen::VectorXd EvalNonlinearPart(TimeUpdateType type, double Ts, const VectorView& baseSystemState,
+			const VectorView& baseSystemIn, const VectorView& sensorState,
+			const VectorView& sensorIn) const; /*!< Returns the value of \f$f()\f$ or \f$g()\f$ function according to the inputs. */
 
 		Eigen::VectorXi getNonlinDepOnBaseSystemSignals(TimeUpdateType outType, VariableType inType) const;  /*!< General interface to get the dependency vectors. */
 
@@ -113,6 +127,9 @@ namespace SF {
 		virtual Eigen::MatrixXd getPInvBs(double Ts) const; /*!< Returns \f$pinv(\mathbf B_s) \f$. Can be overridden to decrease computational complexity.*/
 
 		virtual Eigen::MatrixXd getPInvDs(double Ts) const; /*!< Returns \f$pinv(\mathbf D_s) \f$. Can be overridden to decrease computational complexity.*/
+
+		/*! \brief Returns \f$\mathbf A_{s} \f$, ..., \f$\mathbf D_{s,bs} \f$ (MATRIX_A, ..., MATRIX_D_BS) or the pseudo-inverses (MATRIX_PINV_B/D) cached according to getCachingPolicy() */
+		Eigen::MatrixXd getMatrix(ModelMatrix matrix, double Ts) const;
 	};
 
 	template<class BaseSystemType>
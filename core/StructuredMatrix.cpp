@@ -0,0 +1,213 @@
+#include "StructuredMatrix.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using namespace SF;
+
+SF::StructuredMatrix::StructuredMatrix(Eigen::Index rows, Eigen::Index cols) : nRows(rows), nCols(cols) {}
+
+Eigen::Index SF::StructuredMatrix::rows() const { return nRows; }
+
+Eigen::Index SF::StructuredMatrix::cols() const { return nCols; }
+
+void SF::StructuredMatrix::SetBlock(Eigen::Index row, Eigen::Index col, MatrixStructure structure, const Eigen::MatrixXd & value) {
+	if (row + value.rows() > nRows || col + value.cols() > nCols)
+		throw std::runtime_error(std::string("StructuredMatrix::SetBlock(): The block is out of the matrix!"));
+	if (value.size() == 0 || structure == ZERO)
+		return;
+	Block block = { row, col, value.rows(), value.cols(), structure };
+	switch (structure) {
+	case IDENTITY:
+		break;
+	case DIAGONAL:
+		block.diagonal = value.diagonal();
+		break;
+	case SELECTION:
+		block.selection = Eigen::VectorXi::Constant(value.rows(), -1);
+		for (Eigen::Index i = 0; i < value.rows(); i++)
+			for (Eigen::Index j = 0; j < value.cols(); j++)
+				if (value(i, j) != 0) {
+					if (value(i, j) != 1 || block.selection[i] != -1)
+						throw std::runtime_error(std::string("StructuredMatrix::SetBlock(): The block is not a selection matrix!"));
+					block.selection[i] = (int)j;
+				}
+		break;
+	default:
+		block.structure = DENSE;
+		block.dense = value;
+	}
+	blocks.push_back(block);
+}
+
+void SF::StructuredMatrix::SetBlock(Eigen::Index row, Eigen::Index col, Eigen::Index rows, Eigen::Index cols, MatrixStructure structure) {
+	if (row + rows > nRows || col + cols > nCols)
+		throw std::runtime_error(std::string("StructuredMatrix::SetBlock(): The block is out of the matrix!"));
+	if (structure != ZERO && structure != IDENTITY)
+		throw std::runtime_error(std::string("StructuredMatrix::SetBlock(): The value of the block must be given!"));
+	if (rows == 0 || cols == 0 || structure == ZERO)
+		return;
+	Block block = { row, col, rows, cols, structure };
+	blocks.push_back(block);
+}
+
+Eigen::MatrixXd SF::StructuredMatrix::operator*(const Eigen::MatrixXd & X) const {
+	if (X.rows() != nCols)
+		throw std::runtime_error(std::string("StructuredMatrix::operator*(): Wrong argument size!"));
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(nRows, X.cols());
+	for (const Block& b : blocks) {
+		Eigen::Index k = std::min(b.rows, b.cols);
+		switch (b.structure) {
+		case IDENTITY:
+			out.middleRows(b.row, k) += X.middleRows(b.col, k);
+			break;
+		case DIAGONAL:
+			out.middleRows(b.row, k) += b.diagonal.asDiagonal() * X.middleRows(b.col, k);
+			break;
+		case SELECTION:
+			for (Eigen::Index i = 0; i < b.rows; i++)
+				if (b.selection[i] >= 0)
+					out.row(b.row + i) += X.row(b.col + b.selection[i]);
+			break;
+		default:
+			out.middleRows(b.row, b.rows).noalias() += b.dense * X.middleRows(b.col, b.cols);
+		}
+	}
+	return out;
+}
+
+Eigen::MatrixXd SF::StructuredMatrix::MultiplyTransposed(const Eigen::MatrixXd & X) const {
+	if (X.cols() != nCols)
+		throw std::runtime_error(std::string("StructuredMatrix::MultiplyTransposed(): Wrong argument size!"));
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(X.rows(), nRows);
+	for (const Block& b : blocks) {
+		Eigen::Index k = std::min(b.rows, b.cols);
+		switch (b.structure) {
+		case IDENTITY:
+			out.middleCols(b.row, k) += X.middleCols(b.col, k);
+			break;
+		case DIAGONAL:
+			out.middleCols(b.row, k) += X.middleCols(b.col, k) * b.diagonal.asDiagonal();
+			break;
+		case SELECTION:
+			for (Eigen::Index i = 0; i < b.rows; i++)
+				if (b.selection[i] >= 0)
+					out.col(b.row + i) += X.col(b.col + b.selection[i]);
+			break;
+		default:
+			out.middleCols(b.row, b.rows).noalias() += X.middleCols(b.col, b.cols) * b.dense.transpose();
+		}
+	}
+	return out;
+}
+
+void SF::StructuredMatrix::_AddProduct(const Block & b, const Eigen::Ref<const Eigen::MatrixXd>& X, Eigen::Ref<Eigen::MatrixXd> out) {
+	Eigen::Index k = std::min(b.rows, b.cols);
+	switch (b.structure) {
+	case IDENTITY:
+		out.topRows(k) += X.topRows(k);
+		break;
+	case DIAGONAL:
+		out.topRows(k) += b.diagonal.asDiagonal() * X.topRows(k);
+		break;
+	case SELECTION:
+		for (Eigen::Index i = 0; i < b.rows; i++)
+			if (b.selection[i] >= 0)
+				out.row(i) += X.row(b.selection[i]);
+		break;
+	default:
+		out.noalias() += b.dense * X;
+	}
+}
+
+Eigen::MatrixXd SF::StructuredMatrix::MultiplyVariance(const BlockStatisticValue & S, size_t* nSkipped) const {
+	if (S.Length() != nCols)
+		throw std::runtime_error(std::string("StructuredMatrix::MultiplyVariance(): Wrong argument size!"));
+	// The block of S in the columns of each block
+	std::vector<size_t> inBlock(blocks.size());
+	for (size_t i = 0; i < blocks.size(); i++) {
+		size_t k = 0;
+		while (S.BlockStart(k) + S.BlockLength(k) <= blocks[i].col)
+			k++;
+		if (blocks[i].col + blocks[i].cols > S.BlockStart(k) + S.BlockLength(k))
+			return (*this) * S.ToStatisticValue().variance;
+		inBlock[i] = k;
+	}
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(nRows, nCols);
+	for (size_t i = 0; i < blocks.size(); i++) {
+		const Block& b = blocks[i];
+		size_t k = inBlock[i];
+		Eigen::Index first = b.col - S.BlockStart(k);
+		for (size_t j = 0; j < S.nBlocks(); j++) {
+			auto outBlock = out.block(b.row, S.BlockStart(j), b.rows, S.BlockLength(j));
+			if (j == k) {
+				_AddProduct(b, S.GetBlock(k).variance.View().middleRows(first, b.cols), outBlock);
+				continue;
+			}
+			const Eigen::MatrixXd* cross = S.FindCrossVariance(std::min(k, j), std::max(k, j));
+			if (!cross) {
+				if (nSkipped)
+					(*nSkipped)++;
+			}
+			else if (k < j)
+				_AddProduct(b, cross->middleRows(first, b.cols), outBlock);
+			else
+				_AddProduct(b, cross->middleCols(first, b.cols).transpose(), outBlock);
+		}
+	}
+	return out;
+}
+
+Eigen::MatrixXd SF::StructuredMatrix::ToDense() const {
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(nRows, nCols);
+	for (const Block& b : blocks) {
+		auto block = out.block(b.row, b.col, b.rows, b.cols);
+		switch (b.structure) {
+		case IDENTITY:
+			block = Eigen::MatrixXd::Identity(b.rows, b.cols);
+			break;
+		case DIAGONAL:
+			block.diagonal() = b.diagonal;
+			break;
+		case SELECTION:
+			for (Eigen::Index i = 0; i < b.rows; i++)
+				if (b.selection[i] >= 0)
+					block(i, b.selection[i]) = 1;
+			break;
+		default:
+			block = b.dense;
+		}
+	}
+	return out;
+}
+
+bool SF::StructuredMatrix::HasStructure(const Eigen::MatrixXd & M, MatrixStructure structure, double tolerance) {
+	for (Eigen::Index i = 0; i < M.rows(); i++) {
+		int nNonzeros = 0;
+		for (Eigen::Index j = 0; j < M.cols(); j++) {
+			bool isZero = std::abs(M(i, j)) <= tolerance;
+			switch (structure) {
+			case ZERO:
+				if (!isZero)
+					return false;
+				break;
+			case IDENTITY:
+				if (std::abs(M(i, j) - (i == j ? 1. : 0.)) > tolerance)
+					return false;
+				break;
+			case DIAGONAL:
+				if (i != j && !isZero)
+					return false;
+				break;
+			case SELECTION:
+				if (M(i, j) != 0 && (M(i, j) != 1 || ++nNonzeros > 1))
+					return false;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	return true;
+}
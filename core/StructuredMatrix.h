@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include "Eigen/Dense"
+#include "BlockStatisticValue.h"
+
+namespace SF {
+
+	/*! \brief The structure of a model matrix - declared by the system (see System::getMatrixStructure())
+	*
+	* - DENSE: no known structure
+	* - ZERO: every element is zero
+	* - IDENTITY: ones in the main diagonal and zeros elsewhere (as Eigen::MatrixXd::Identity(rows, cols))
+	* - DIAGONAL: nonzero elements only in the main diagonal
+	* - SELECTION: every row contains at most one nonzero element and it is 1 (it selects elements of the input)
+	*/
+	enum MatrixStructure { DENSE, ZERO, IDENTITY, DIAGONAL, SELECTION };
+
+	/*! \brief Block matrix with structured blocks
+	*
+	* The blocks not set are zero. The products skip the zero blocks, copy the rows/columns for the identity and selection
+	* blocks and scale them for the diagonal blocks. Only the dense blocks are multiplied as matrices.
+	*/
+	class StructuredMatrix {
+	public:
+		StructuredMatrix(Eigen::Index rows = 0, Eigen::Index cols = 0); //!< Constructor - zero matrix
+
+		Eigen::Index rows() const; //!< Number of rows
+
+		Eigen::Index cols() const; //!< Number of columns
+
+		/*! \brief Set the block with the given top left corner
+		*
+		* The value is not needed for ZERO and IDENTITY blocks (see the other overload). The blocks must not overlap.
+		*/
+		void SetBlock(Eigen::Index row, Eigen::Index col, MatrixStructure structure, const Eigen::MatrixXd& value);
+
+		void SetBlock(Eigen::Index row, Eigen::Index col, Eigen::Index rows, Eigen::Index cols, MatrixStructure structure); //!< Set a ZERO or IDENTITY block
+
+		Eigen::MatrixXd operator*(const Eigen::MatrixXd& X) const; //!< Returns M * X
+
+		Eigen::MatrixXd MultiplyTransposed(const Eigen::MatrixXd& X) const; //!< Returns X * M^T
+
+		/*! \brief Returns M * S (S: the covariance matrix of the block statistic value)
+		*
+		* The products with the cross variance blocks not stored in S (the zero ones) are skipped, their number is added to
+		* nSkipped (if not NULL). The columns of the blocks of M must not span more blocks of S, otherwise the dense covariance
+		* matrix is used.
+		*/
+		Eigen::MatrixXd MultiplyVariance(const BlockStatisticValue& S, size_t* nSkipped = NULL) const;
+
+		Eigen::MatrixXd ToDense() const; //!< The dense matrix
+
+		/*! \brief Check if the matrix has the given structure (with the given tolerance for the zero elements) */
+		static bool HasStructure(const Eigen::MatrixXd& M, MatrixStructure structure, double tolerance = 1e-12);
+
+	private:
+		struct Block {
+			Eigen::Index row, col, rows, cols;
+			MatrixStructure structure;
+			Eigen::MatrixXd dense; // DENSE
+			Eigen::VectorXd diagonal; // DIAGONAL
+			Eigen::VectorXi selection; // SELECTION: the selected column of every row or -1
+		};
+
+		static void _AddProduct(const Block& b, const Eigen::Ref<const Eigen::MatrixXd>& X, Eigen::Ref<Eigen::MatrixXd> out); // out += block * X
+
+		Eigen::Index nRows, nCols;
+		std::vector<Block> blocks;
+	};
+}
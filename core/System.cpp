@@ -1,5 +1,7 @@
 #include "System.h"
 #include <iostream>
+#include <map>
+#include <mutex>
 
 using namespace SF;
 
@@ -66,13 +68,21 @@ std::vector<std::string> System::getNames(DataType type) const {
 std::string System::getName() const {
 	return "System";
 }
+// Zero vectors shared by the default implementations (the systems may have different sizes)
+static const Eigen::VectorXi& _getZeros(unsigned int n) {
+	static std::mutex zerosMutex;
+	static std::map<unsigned int, Eigen::VectorXi> zeros;
+	std::lock_guard<std::mutex> lock(zerosMutex);
+	auto it = zeros.find(n);
+	if (it == zeros.end())
+		it = zeros.insert(std::make_pair(n, Eigen::VectorXi::Zero(n))).first;
+	return it->second;
+}
 const Eigen::VectorXi & SF::System::getIfStateIsRad() const {
-	static Eigen::VectorXi out = Eigen::VectorXi::Zero(getNumOfStates());
-	return out;
+	return _getZeros(getNumOfStates());
 }
 const Eigen::VectorXi & SF::System::getIfOutputIsRad() const {
-	static Eigen::VectorXi out = Eigen::VectorXi::Zero(getNumOfOutputs());
-	return out;
+	return _getZeros(getNumOfOutputs());
 }
 DataType System::getInputValueType(TimeUpdateType outType, VariableType inType) {
 	if (inType == VAR_STATE)
@@ -104,3 +114,41 @@ void System::_systemTest() const {
 	if (getNames(DataType::NOISE).size() != getNumOf(DataType::NOISE))
 		throw std::runtime_error(std::string("System::_systemTest()"));
 }
+
+CachingPolicy System::getCachingPolicy() const {
+	return NO_CACHING;
+}
+
+void System::InvalidateCache() const {
+	modelCache.Invalidate();
+}
+
+void System::setCacheResolution(double resolution) {
+	modelCache.SetResolution(resolution);
+}
+
+Eigen::MatrixXd System::_getCachedMatrix(ModelMatrix matrix, double Ts, const ModelCache::Evaluator & evaluate) const {
+	switch (getCachingPolicy()) {
+	case CACHE_BY_TS:
+		return modelCache.Get(matrix, Ts, false, evaluate);
+	case CACHE_CONSTANT:
+		return modelCache.Get(matrix, Ts, true, evaluate);
+	default:
+		return evaluate(Ts);
+	}
+}
+
+MatrixStructure System::getMatrixStructure(ModelMatrix matrix) const {
+	return DENSE;
+}
+
+void System::setStructuredBlock(StructuredMatrix & M, Eigen::Index row, Eigen::Index col, Eigen::Index rows,
+	Eigen::Index cols, ModelMatrix matrix, double Ts, bool structured) const {
+	if (rows == 0 || cols == 0)
+		return;
+	MatrixStructure structure = structured ? getMatrixStructure(matrix) : DENSE;
+	if (structure == ZERO || structure == IDENTITY)
+		M.SetBlock(row, col, rows, cols, structure);
+	else
+		M.SetBlock(row, col, structure, getMatrix(matrix, Ts));
+}
@@ -5,6 +5,8 @@
 #include <vector>
 #include "defs.h"
 #include "StatisticValue.h"
+#include "ModelCache.h"
+#include "StructuredMatrix.h"
 #include <string>
 
 namespace SF {
@@ -15,12 +17,15 @@ namespace SF {
 	*/
 	enum VariableType { VAR_STATE, VAR_EXTERNAL };
 
+	typedef Eigen::Ref<const Eigen::VectorXd> VectorView; /*!< Non-owning view of a vector or a contiguous part of it (e.g. a segment of a stacked vector) */
+
 	/*! \brief Abstract superclass for BaseSystem and Sensor classes providing general interface for their common properties
 	*
 	*
 	*/
 	class System {
 		unsigned int ID; /*!< User defined ID */
+		mutable ModelCache modelCache; /*!< Cache of the model matrices (see getCachingPolicy()) */
 	public:
 		unsigned int getID() const { return ID; } /*!< Get user defined ID */
 
@@ -46,6 +51,36 @@ namespace SF {
 
 		virtual const Eigen::VectorXi& getIfOutputIsRad() const; /*!< Get if the output variables are periodic radians */
 
+		/*! \brief Get how the model matrices (and their pseudo-inverses) can be cached
+		*
+		* By default they are not cached. Override it to declare that they depend only on the sampling time (CACHE_BY_TS)
+		* or they are constant (CACHE_CONSTANT). Then InvalidateCache() must be called if the matrices change.
+		*/
+		virtual CachingPolicy getCachingPolicy() const;
+
+		void InvalidateCache() const; /*!< Clear the cached model matrices */
+
+		void setCacheResolution(double resolution); /*!< Set the resolution of the sampling time in the cache [s] (default: ModelCache::defaultResolution, see ModelCache for the error of coarser ones) */
+
+		/*! \brief Get the structure of a model matrix (MATRIX_A, ..., MATRIX_D_BS)
+		*
+		* By default every matrix is DENSE. Override it to declare the ZERO, IDENTITY, DIAGONAL or SELECTION matrices
+		* (for every sampling time): SystemManager does not compute the ZERO and IDENTITY ones and exploits the structure
+		* in the products. The declarations are checked by systemTest().
+		*/
+		virtual MatrixStructure getMatrixStructure(ModelMatrix matrix) const;
+
+		virtual Eigen::MatrixXd getMatrix(ModelMatrix matrix, double Ts) const = 0; /*!< Get a model matrix (see BaseSystem::getMatrix() and Sensor::getMatrix()) */
+
+		/*! \brief Set a model matrix as the block of M with the given top left corner and size
+		*
+		* By default it is one block with the declared structure (DENSE if structured is false) and the ZERO and IDENTITY
+		* matrices are not evaluated. Override it if the matrix consists of independent blocks (see CompositeBaseSystem):
+		* then the zeros between them are neither stored nor multiplied.
+		*/
+		virtual void setStructuredBlock(StructuredMatrix& M, Eigen::Index row, Eigen::Index col, Eigen::Index rows,
+			Eigen::Index cols, ModelMatrix matrix, double Ts, bool structured = true) const;
+
 	protected:
 		System(unsigned int ID); /*!< Constructor */
 
@@ -64,6 +99,9 @@ namespace SF {
 
 	protected:
 		void _systemTest() const; /*!< To check the consistency of the defined functions */
+
+		/*! \brief Get the matrix from the cache or compute it with the evaluator according to getCachingPolicy() */
+		Eigen::MatrixXd _getCachedMatrix(ModelMatrix matrix, double Ts, const ModelCache::Evaluator& evaluate) const;
 	};
 
 }
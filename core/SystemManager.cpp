@@ -1,5 +1,6 @@
 #include "SystemManager.h"
 #include "RelaxedUTN.h"
+#include <algorithm>
 
 using namespace SF;
 using namespace RelaxedUnscentedTransformation;
@@ -73,6 +74,34 @@ void SystemManager::SystemData::setVariance(const Eigen::MatrixXd & value, DataT
 	}
 }
 
+void SystemManager::SystemData::setData(const DataMsgView & data) {
+	size_t n = num(data.GetDataType(), true);
+	if ((data.HasValue() && static_cast<size_t>(data.Value().size()) != n) ||
+		(data.HasVariance() && static_cast<size_t>(data.VarianceSize()) != n))
+		throw std::runtime_error(std::string("SystemData::setData(): Wrong argument size\n"));
+	StatisticValue* value;
+	switch (data.GetDataType()) {
+	case DataType::NOISE:
+		value = &noise;
+		break;
+	case DataType::DISTURBANCE:
+		value = &disturbance;
+		break;
+	case DataType::OUTPUT:
+		value = &measurement;
+		break;
+	default:
+		throw std::runtime_error(std::string("SystemData::setData(): Wrong argument\n"));
+	}
+	if (data.HasValue()) {
+		data.CopyValue(value->vector);
+		if (data.GetDataType() == DataType::OUTPUT && measStatus == OBSOLETHE)
+			measStatus = UPTODATE;
+	}
+	if (data.HasVariance())
+		data.CopyVariance(value->variance);
+}
+
 // set the given value
 
 Eigen::VectorXd SystemManager::SystemData::getValue(DataType type) const {
@@ -110,21 +139,50 @@ bool SystemManager::SystemData::available() const { return measStatus != OBSOLET
 
 // returns if is measurement available
 
-SystemManager::Partitioner SystemManager::getPartitioner(bool forcedOutput) const {
-	Partitioner p(nSensors() + 1);
-	p.nx[0] = BaseSystem().num(DataType::STATE, forcedOutput);
-	p.ny[0] = BaseSystem().num(DataType::OUTPUT, forcedOutput);
-	p.nw[0] = BaseSystem().num(DataType::DISTURBANCE, forcedOutput);
-	p.nv[0] = BaseSystem().num(DataType::NOISE, forcedOutput);
-	for (size_t n = 0; n < nSensors(); n++) {
-		p.nx[n + 1] = Sensor(n).num(DataType::STATE, forcedOutput);
-		p.ny[n + 1] = Sensor(n).num(DataType::OUTPUT, forcedOutput);
-		p.nw[n + 1] = Sensor(n).num(DataType::DISTURBANCE, forcedOutput);
-		p.nv[n + 1] = Sensor(n).num(DataType::NOISE, forcedOutput);
+SystemManager::PartitionerPtr SystemManager::getPartitioner(bool forcedOutput) const {
+	return getPartitioner(allSystems, forcedOutput);
+}
+
+SystemManager::PartitionerPtr SystemManager::getPartitioner(const IndexList& systems, bool forcedOutput) const {
+	// Key: the listed systems and their availability (the numbers depend only on them)
+	static thread_local std::vector<int> key;
+	key.clear();
+	for (int index : systems)
+		key.push_back(2 * (index + 1) + ((forcedOutput || SystemByIndex(index).available()) ? 1 : 0));
+	std::lock_guard<std::mutex> lock(partitionerMutex);
+	auto it = partitionerCache.find(key);
+	if (it != partitionerCache.end())
+		return it->second;
+	auto p = std::make_shared<Partitioner>(systems.size());
+	for (size_t n = 0; n < systems.size(); n++) {
+		const SystemData& sys = SystemByIndex(systems[n]);
+		p->nx[n] = sys.num(DataType::STATE, forcedOutput);
+		p->ny[n] = sys.num(DataType::OUTPUT, forcedOutput);
+		p->nw[n] = sys.num(DataType::DISTURBANCE, forcedOutput);
+		p->nv[n] = sys.num(DataType::NOISE, forcedOutput);
 	}
+	p->UpdateOffsets();
+	if (partitionerCache.size() >= MAX_CACHED_PARTITIONERS)
+		partitionerCache.clear();
+	partitionerCache[key] = p;
 	return p;
 }
 
+Eigen::VectorXi SystemManager::getIndices(const IndexList& systems, DataType type, bool forcedOutput) const {
+	PartitionerPtr p = getPartitioner(forcedOutput);
+	const std::vector<size_t>& n_ = p->n(type);
+	const std::vector<size_t>& offsets = p->offsets(type);
+	size_t n = 0;
+	for (int index : systems)
+		n += n_[index + 1];
+	Eigen::VectorXi out(n);
+	Eigen::Index k = 0;
+	for (int index : systems)
+		for (size_t i = offsets[index + 1]; i < offsets[index + 2]; i++)
+			out[k++] = (int)i;
+	return out;
+}
+
 bool SystemManager::isAvailable(int index) const {
 	if (index == -1)
 		return BaseSystem().available();
@@ -158,13 +216,39 @@ bool SystemManager::SaveDataMsg(const DataMsg & data, const Time& t) {
 	return true;
 }
 
+bool SystemManager::SaveDataMsg(const DataMsgView & data, const Time& t) {
+	try {
+		this->SystemByID(data.GetSourceID())->setData(data);
+	}
+	catch (const SystemIDNotFoundWarning&) {
+		printf("Warning: unknown sensor ID (%d).\n", data.GetSourceID());
+		return false;
+	}
+	return true;
+}
+
+const SystemManager::SystemData & SystemManager::SystemByIndex(int index) const {
+	if (index == -1)
+		return baseSystem;
+	return sensorList[index];
+}
+
 int SystemManager::_GetIndex(unsigned int ID) const {
+	int index = _FindIndex(ID);
+	if (index == INDEX_UNKNOWN)
+		throw SystemIDNotFoundWarning(ID);
+	return index;
+}
+
+int SystemManager::_FindIndex(unsigned int ID) const {
+	if (ID < indexByID.size())
+		return indexByID[ID];
 	if (ID == baseSystem.getPtr()->getID())
 		return -1;
 	for (unsigned int i = 0; i < nSensors(); i++)
 		if (sensorList[i].getPtr()->getID() == ID)
 			return i;
-	throw SystemIDNotFoundWarning(ID);
+	return INDEX_UNKNOWN;
 }
 
 // returns -1 for the basesystem!
@@ -181,12 +265,81 @@ void SystemManager::AddSensor(const SensorData & sensorData, const StatisticValu
 		sensorList.push_back(sensorData);
 		// Add the initial state values and variances to the state/variance matrix
 		state.Add(sensorState);
+		// Keep the results consistent with the new partitioning
+		if (state_predicted.Length() > 0)
+			state_predicted.Add(sensorState);
+		if (state_filtered.Length() > 0)
+			state_filtered.Add(sensorState);
+		output_predicted = StatisticValue();
+		_UpdateComponents();
+		if (state_predicted.Length() > 0)
+			_Publish(FILTER_TIME_UPDATE);
+		_Publish(FILTER_MEAS_UPDATE);
 	}
 	else throw std::runtime_error(std::string("SystemManager::AddSensor(): Not compatible sensor tried to be added!\n"));
 }
 
+void SystemManager::RemoveSensor(unsigned int ID) {
+	int index;
+	try {
+		index = _GetIndex(ID);
+	}
+	catch (const SystemIDNotFoundWarning&) {
+		throw std::runtime_error(std::string("SystemManager::RemoveSensor(): Unknown sensor ID!"));
+	}
+	if (index == -1)
+		throw std::runtime_error(std::string("SystemManager::RemoveSensor(): The basesystem cannot be removed!"));
+	Eigen::Index start = baseSystem.num(STATE);
+	for (int i = 0; i < index; i++)
+		start += sensorList[i].num(STATE);
+	Eigen::Index n = sensorList[index].num(STATE);
+	state.Remove(start, n);
+	if (state_predicted.Length() > 0)
+		state_predicted.Remove(start, n);
+	if (state_filtered.Length() > 0)
+		state_filtered.Remove(start, n);
+	output_predicted = StatisticValue();
+	sensorList.erase(sensorList.begin() + index);
+	_UpdateComponents();
+	if (state_predicted.Length() > 0)
+		_Publish(FILTER_TIME_UPDATE);
+	_Publish(FILTER_MEAS_UPDATE);
+}
+
 size_t SystemManager::nSensors() const { return sensorList.size(); }
 
+const std::vector<SystemManager::IndexList>& SystemManager::getComponents() const { return components; }
+
+const SystemManager::IndexList & SystemManager::getAllSystems() const { return allSystems; }
+
+void SystemManager::_UpdateComponents() {
+	allSystems = IndexList(1, -1);
+	components = std::vector<IndexList>(1, IndexList(1, -1));
+	for (int i = 0; i < (int)nSensors(); i++) {
+		allSystems.push_back(i);
+		if (sensorList[i].isCoupledToBaseSystem())
+			components[0].push_back(i);
+		else
+			components.push_back(IndexList(1, i));
+	}
+	// The first system with the ID is found (as by a linear search)
+	indexByID.fill(INDEX_UNKNOWN);
+	for (int i = (int)nSensors() - 1; i >= -1; i--) {
+		unsigned int ID = SystemByIndex(i).getPtr()->getID();
+		if (ID < indexByID.size())
+			indexByID[ID] = i;
+	}
+	std::lock_guard<std::mutex> lock(partitionerMutex);
+	partitionerCache.clear();
+}
+
+size_t SystemManager::num(const IndexList& systems, DataType type, bool forcedOutput) const {
+	size_t out = 0;
+	for (int index : systems)
+		out += SystemByIndex(index).num(type, forcedOutput);
+	return out;
+}
+
 size_t SystemManager::num(DataType type, bool forcedOutput) const {
 	if (type == STATE) return state.Length();
 	size_t out = baseSystem.num(type, forcedOutput);
@@ -196,25 +349,36 @@ size_t SystemManager::num(DataType type, bool forcedOutput) const {
 }
 
 Eigen::VectorXi SystemManager::dep(TimeUpdateType outType, VariableType inType, bool forcedOutput) const {
+	return dep(allSystems, outType, inType, forcedOutput);
+}
+
+Eigen::VectorXi SystemManager::dep(const IndexList& systems, TimeUpdateType outType, VariableType inType, bool forcedOutput) const {
 	DataType type = System::getInputValueType(outType, inType);
-	Eigen::Index n = num(type, forcedOutput);
+	Eigen::Index n = num(systems, type, forcedOutput);
 	// Get nonlinear dependencies
 	Eigen::VectorXi dep_ = Eigen::VectorXi(n);
-	// Sum dependencies from basesystem properties
-	Eigen::VectorXi baseSystemDep = baseSystem.dep(outType, inType, forcedOutput);
-	for (size_t i = 0; i < nSensors(); i++) {
-		Eigen::VectorXi temp = sensorList[i].depBaseSystem(outType, inType, forcedOutput);
-		for (Eigen::Index j = 0; j < temp.size(); j++)
-			if (temp[j] == 1) baseSystemDep[j] = 1;
-	}
 	// Concatenate dep vectors
-	Eigen::Index j = baseSystemDep.size();
-	dep_.segment(0, j) = baseSystemDep;
-	for (size_t i = 0; i < nSensors(); i++) {
-		Eigen::VectorXi temp = sensorList[i].depSensor(outType, inType, forcedOutput);
-		Eigen::Index d = temp.size();
-		dep_.segment(j, d) = temp;
-		j += d;
+	Eigen::Index j = 0;
+	for (int index : systems) {
+		if (index == -1) {
+			// Sum dependencies from basesystem properties
+			Eigen::VectorXi baseSystemDep = baseSystem.dep(outType, inType, forcedOutput);
+			for (int i : systems)
+				if (i != -1) {
+					Eigen::VectorXi temp = sensorList[i].depBaseSystem(outType, inType, forcedOutput);
+					for (Eigen::Index k = 0; k < temp.size(); k++)
+						if (temp[k] == 1) baseSystemDep[k] = 1;
+				}
+			Eigen::Index d = baseSystemDep.size();
+			dep_.segment(j, d) = baseSystemDep;
+			j += d;
+		}
+		else {
+			Eigen::VectorXi temp = sensorList[index].depSensor(outType, inType, forcedOutput);
+			Eigen::Index d = temp.size();
+			dep_.segment(j, d) = temp;
+			j += d;
+		}
 	}
 	return dep_;
 }
@@ -283,111 +447,213 @@ SystemManager::SystemData * SystemManager::SystemByID(unsigned int ID) {
 StatisticValue SystemManager::operator()(DataType type, bool forcedOutput) const {
 	if (type == STATE)
 		return state;
-	size_t k = baseSystem.num(type, forcedOutput);
-	for (unsigned int i = 0; i < nSensors(); i++)
-		k += sensorList[i].num(type, forcedOutput);
-	StatisticValue out(k);
-	out.Insert(0, baseSystem(type));
-	k = baseSystem.num(type, forcedOutput);
-	for (unsigned int i = 0; i < nSensors(); i++) {
-		size_t dk = sensorList[i].num(type, forcedOutput);
-		if (dk>0)
-			out.Insert(k, sensorList[i](type, forcedOutput));
-		k += dk;
-	}
+	return getBlockValue(type, forcedOutput).ToStatisticValue();
+}
+
+BlockStatisticValue SystemManager::getBlockValue(DataType type, bool forcedOutput) const {
+	if (type == STATE)
+		throw std::runtime_error(std::string("SystemManager::getBlockValue(): The state is not block diagonal!"));
+	// The noise of the basesystem is counted (as zeros) even without measurement
+	auto getBlock = [type, forcedOutput](const SystemData& sys) {
+		StatisticValue value = sys(type, forcedOutput);
+		size_t n = sys.num(type, forcedOutput);
+		return value.Length() == (Eigen::Index)n ? value : StatisticValue(n);
+	};
+	BlockStatisticValue out;
+	out.AddBlock(getBlock(baseSystem));
+	for (size_t i = 0; i < nSensors(); i++)
+		out.AddBlock(getBlock(sensorList[i]));
 	return out;
 }
 
+// The model matrix of STATE_UPDATE/OUTPUT_UPDATE related to the STATE or the DISTURBANCE/NOISE (basesystem block of the sensors: _BS)
+static ModelMatrix _GetModelMatrix(TimeUpdateType type, VariableType inType, bool baseSystemBlock) {
+	static const ModelMatrix matrices[2][2][2] = {
+		{ { MATRIX_A, MATRIX_B }, { MATRIX_C, MATRIX_D } },
+		{ { MATRIX_A_BS, MATRIX_B_BS }, { MATRIX_C_BS, MATRIX_D_BS } } };
+	return matrices[baseSystemBlock ? 1 : 0][type == STATE_UPDATE ? 0 : 1][inType == VAR_STATE ? 0 : 1];
+}
+
 /* Get A,B, C,D matrices according to the available sensors*/
 void SystemManager::getMatrices(TimeUpdateType out_, double Ts, Eigen::MatrixXd & A,
 	Eigen::MatrixXd & B, bool forcedOutput) const {
+	getMatrices(allSystems, out_, Ts, A, B, forcedOutput);
+}
+
+void SystemManager::getMatrices(const IndexList& systems, TimeUpdateType out_, double Ts, Eigen::MatrixXd & A,
+	Eigen::MatrixXd & B, bool forcedOutput, const std::vector<double>& sensorTs) const {
+	StructuredMatrix sA, sB;
+	getStructuredMatrices(systems, out_, Ts, sA, sB, forcedOutput, sensorTs);
+	A = sA.ToDense();
+	B = sB.ToDense();
+}
+
+void SystemManager::getStructuredMatrices(TimeUpdateType out_, double Ts, StructuredMatrix & A,
+	StructuredMatrix & B, bool forcedOutput) const {
+	getStructuredMatrices(allSystems, out_, Ts, A, B, forcedOutput);
+}
+
+void SystemManager::getStructuredMatrices(const IndexList& systems, TimeUpdateType out_, double Ts, StructuredMatrix & A,
+	StructuredMatrix & B, bool forcedOutput, const std::vector<double>& sensorTs) const {
 	DataType outValueType = System::getOutputValueType(out_);
 	DataType inValueType = System::getInputValueType(out_, VAR_EXTERNAL);
-	Eigen::Index nx = state.Length();
-	size_t n_in = baseSystem.num(inValueType, forcedOutput);
-	size_t n_out = baseSystem.num(outValueType, forcedOutput);
-	for (size_t i = 0; i < nSensors(); i++) {
-		n_in += sensorList[i].num(inValueType, forcedOutput);
-		n_out += sensorList[i].num(outValueType, forcedOutput);
-	}
+	size_t nx = num(systems, STATE, forcedOutput);
+	size_t n_in = num(systems, inValueType, forcedOutput);
+	size_t n_out = num(systems, outValueType, forcedOutput);
 	// init matrices az zero
-	A = Eigen::MatrixXd::Zero(n_out, nx);
-	B = Eigen::MatrixXd::Zero(n_out, n_in);
+	A = StructuredMatrix(n_out, nx);
+	B = StructuredMatrix(n_out, n_in);
+	// the systems place their blocks (the ZERO and IDENTITY ones are not evaluated, see System::setStructuredBlock())
+	auto setBlock = [this, out_](StructuredMatrix& M, size_t row, size_t col, size_t rows, size_t cols,
+		const System& system, VariableType inType, bool baseSystemBlock, double Ts) {
+		system.setStructuredBlock(M, row, col, rows, cols, _GetModelMatrix(out_, inType, baseSystemBlock), Ts, structuredEvaluation);
+	};
 	// fill them
-	// basesystem:
-	size_t nx0 = baseSystem.num(STATE, forcedOutput);
-	size_t nin0 = baseSystem.num(inValueType, forcedOutput);
-	size_t nout0 = baseSystem.num(outValueType, forcedOutput);
-	A.block(0, 0, nout0, nx0) = baseSystem.getMatrix(Ts, out_, VAR_STATE, forcedOutput);
-	B.block(0, 0, nout0, nin0) = baseSystem.getMatrix(Ts, out_, VAR_EXTERNAL, forcedOutput);
+	// basesystem (if listed, it is the first):
+	bool hasBaseSystem = !systems.empty() && systems[0] == -1;
+	size_t nx0 = 0, nin0 = 0, nout0 = 0;
+	if (hasBaseSystem) {
+		nx0 = baseSystem.num(STATE, forcedOutput);
+		nin0 = baseSystem.num(inValueType, forcedOutput);
+		nout0 = baseSystem.num(outValueType, forcedOutput);
+		setBlock(A, 0, 0, nout0, nx0, *baseSystem.getBaseSystemPtr(), VAR_STATE, false, Ts);
+		setBlock(B, 0, 0, nout0, nin0, *baseSystem.getBaseSystemPtr(), VAR_EXTERNAL, false, Ts);
+	}
 	// sensors:
 	size_t iin = nin0, iout = nout0, ix = nx0;
-	for (size_t i = 0; i < nSensors(); i++) {
-		size_t dx = sensorList[i].num(STATE, forcedOutput);
-		size_t din = sensorList[i].num(inValueType, forcedOutput);
-		size_t dout = sensorList[i].num(outValueType, forcedOutput);
-		A.block(iout, 0, dout, nx0) = sensorList[i].getMatrixBaseSystem(Ts, out_, VAR_STATE, forcedOutput);
-		B.block(iout, 0, dout, nin0) = sensorList[i].getMatrixBaseSystem(Ts, out_, VAR_EXTERNAL, forcedOutput);
-		A.block(iout, ix, dout, dx) = sensorList[i].getMatrixSensor(Ts, out_, VAR_STATE, forcedOutput);
-		B.block(iout, iin, dout, din) = sensorList[i].getMatrixSensor(Ts, out_, VAR_EXTERNAL, forcedOutput);
+	for (int i : systems) {
+		if (i == -1)
+			continue;
+		const SensorData& sensor = sensorList[i];
+		size_t dx = sensor.num(STATE, forcedOutput);
+		size_t din = sensor.num(inValueType, forcedOutput);
+		size_t dout = sensor.num(outValueType, forcedOutput);
+		double Tsi = (out_ == STATE_UPDATE && !sensorTs.empty()) ? sensorTs[i] : Ts;
+		if (Tsi < 0) {
+			// held state: x_i = x_i
+			if (dx > 0)
+				A.SetBlock(iout, ix, dout, dx, IDENTITY);
+		}
+		else {
+			if (hasBaseSystem) {
+				setBlock(A, iout, 0, dout, nx0, *sensor.getSensorPtr(), VAR_STATE, true, Tsi);
+				setBlock(B, iout, 0, dout, nin0, *sensor.getSensorPtr(), VAR_EXTERNAL, true, Tsi);
+			}
+			setBlock(A, iout, ix, dout, dx, *sensor.getSensorPtr(), VAR_STATE, false, Tsi);
+			setBlock(B, iout, iin, dout, din, *sensor.getSensorPtr(), VAR_EXTERNAL, false, Tsi);
+		}
 		iout += dout;
 		iin += din;
 		ix += dx;
 	}
 }
 
+void SystemManager::SetStructuredEvaluation(bool enabled) {
+	structuredEvaluation = enabled;
+}
+
+void SystemManager::SetPropagationDecimation(unsigned int ID, unsigned int k) {
+	int index = _FindIndex(ID);
+	if (index == INDEX_UNKNOWN)
+		throw std::runtime_error(std::string("SystemManager::SetPropagationDecimation(): Unknown sensor ID!"));
+	if (index == -1)
+		throw std::runtime_error(std::string("SystemManager::SetPropagationDecimation(): The basesystem is propagated in every step!"));
+	sensorList[index].setDecimation(k);
+}
+
+std::vector<double> SystemManager::getSensorTs(double Ts) const {
+	bool decimated = false;
+	for (const SensorData& sensor : sensorList)
+		decimated = decimated || sensor.getDecimation() > 1;
+	if (!decimated)
+		return std::vector<double>();
+	std::vector<double> out(nSensors());
+	for (size_t i = 0; i < nSensors(); i++)
+		out[i] = sensorList[i].propagationTs(Ts);
+	return out;
+}
+
+void SystemManager::PropagationStepDone(double Ts) {
+	for (SensorData& sensor : sensorList)
+		sensor.propagationStepDone(Ts);
+}
+
 // could be faster....
 
 Eigen::VectorXd SystemManager::EvalNonLinPart(double Ts,
  TimeUpdateType outType, const Eigen::VectorXd& state, const Eigen::VectorXd& in, bool forcedOutput) const {
+	return EvalNonLinPart(allSystems, Ts, outType, state, in, forcedOutput);
+}
+
+Eigen::VectorXd SystemManager::EvalNonLinPart(const IndexList& systems, double Ts,
+	TimeUpdateType outType, const Eigen::VectorXd& state, const Eigen::VectorXd& in, bool forcedOutput,
+	const std::vector<double>& sensorTs) const {
 	DataType intype = System::getInputValueType(outType, VAR_EXTERNAL);
 	DataType outtype = System::getOutputValueType(outType);
-	size_t n_out = num(outtype, forcedOutput);
+	size_t n_out = num(systems, outtype, forcedOutput);
 	// Partitionate vectors
-	auto partitioner = getPartitioner(forcedOutput);
+	auto partitioner = getPartitioner(systems, forcedOutput);
 	// Return value
 	Eigen::VectorXd out = Eigen::VectorXd(n_out);
 	// Call the functions
-	size_t n;
-	auto xbase = partitioner.PartValue(STATE, state, -1);
-	auto inbase = partitioner.PartValue(intype, in, -1);
-	if (outType == STATE_UPDATE || baseSystem.available() || forcedOutput) {
+	size_t n = 0;
+	bool hasBaseSystem = !systems.empty() && systems[0] == -1;
+	// The parts of the vectors are passed as views (without copies)
+	// If the basesystem is not listed, the sensors do not depend on it: the current values are given to have the proper sizes
+	Eigen::VectorXd inbaseCurrent = hasBaseSystem ? Eigen::VectorXd() : baseSystem.getValue(intype);
+	VectorView xbase = hasBaseSystem ? VectorView(partitioner->PartValue(STATE, state, -1)) :
+		VectorView(this->state.vector.head(baseSystem.num(STATE)));
+	VectorView inbase = hasBaseSystem ? VectorView(partitioner->PartValue(intype, in, -1)) : VectorView(inbaseCurrent);
+	if (hasBaseSystem && (outType == STATE_UPDATE || baseSystem.available() || forcedOutput)) {
 		n = baseSystem.num(outtype, forcedOutput);
 		out.segment(0, n) = baseSystem.getBaseSystemPtr()->EvalNonlinearPart(outType, Ts, xbase, inbase);
 	}
-	else n = 0;
-	for (size_t i = 0; i < nSensors(); i++)
+	for (size_t k = hasBaseSystem ? 1 : 0; k < systems.size(); k++) {
+		int i = systems[k];
 		if (outType == STATE_UPDATE || sensorList[i].available() || forcedOutput) {
 			size_t d = sensorList[i].num(outtype, forcedOutput);
-			auto xi = partitioner.PartValue(STATE, state, (int)i);
-			auto ini = partitioner.PartValue(intype, in, (int)i);
-			out.segment(n, d) = sensorList[i].getSensorPtr()->EvalNonlinearPart(outType, Ts, xbase, inbase, xi, ini);
+			double Tsi = (outType == STATE_UPDATE && !sensorTs.empty()) ? sensorTs[i] : Ts;
+			if (Tsi < 0) // held state
+				out.segment(n, d).setZero();
+			else
+				out.segment(n, d) = sensorList[i].getSensorPtr()->EvalNonlinearPart(outType, Tsi, xbase, inbase,
+					partitioner->PartValue(STATE, state, (int)k - 1), partitioner->PartValue(intype, in, (int)k - 1));
 			n += d;
 		}
+	}
 	return out;
 }
 
 StatisticValue SystemManager::Eval(TimeUpdateType outType, double Ts, const StatisticValue& state_,
 	const StatisticValue& in, Eigen::MatrixXd & S_out_x, Eigen::MatrixXd& S_out_in, bool forcedOutput) const {
+	return Eval(allSystems, outType, Ts, state_, in, S_out_x, S_out_in, forcedOutput);
+}
+
+StatisticValue SystemManager::Eval(const IndexList& systems, TimeUpdateType outType, double Ts, const StatisticValue& state_,
+	const StatisticValue& in, Eigen::MatrixXd & S_out_x, Eigen::MatrixXd& S_out_in, bool forcedOutput,
+	const std::vector<double>& sensorTs) const {
 	DataType inType = System::getInputValueType(outType, VAR_EXTERNAL);
-	Eigen::Index nX = num(STATE, forcedOutput);
-	Eigen::Index nIn = num(inType, forcedOutput);
+	Eigen::Index nX = num(systems, STATE, forcedOutput);
+	Eigen::Index nIn = num(systems, inType, forcedOutput);
 	// Get nonlinear dependencies
-	Eigen::VectorXi stateDep = dep(outType, VAR_STATE, forcedOutput);
-	Eigen::VectorXi inDep = dep(outType, VAR_EXTERNAL, forcedOutput);
-	size_t nOut = num(System::getOutputValueType(outType), forcedOutput);
-	// Get coefficient matrices
-	Eigen::MatrixXd A, B;
-	getMatrices(outType, Ts, A, B, forcedOutput);
+	Eigen::VectorXi stateDep = dep(systems, outType, VAR_STATE, forcedOutput);
+	Eigen::VectorXi inDep = dep(systems, outType, VAR_EXTERNAL, forcedOutput);
+	size_t nOut = num(systems, System::getOutputValueType(outType), forcedOutput);
 	// CASE 1: No nonlinearity (simple linear mapping...)
 	if (stateDep.sum() + inDep.sum() == 0) {
+		// The structured products skip the zero blocks and copy/scale for the identity, selection and diagonal ones
+		StructuredMatrix A, B;
+		getStructuredMatrices(systems, outType, Ts, A, B, forcedOutput, sensorTs);
 		Eigen::VectorXd y = A * state_.vector + B * in.vector;
 		S_out_x = A * state_.variance;
 		S_out_in = B * in.variance;
-		Eigen::MatrixXd Sy = S_out_x * A.transpose() + S_out_in * B.transpose();
+		Eigen::MatrixXd Sy = A.MultiplyTransposed(S_out_x) + B.MultiplyTransposed(S_out_in);
 		return { y,Sy };
 	}
 	else { // CASE 2: Totally nonlinear
+		// Get coefficient matrices - dense, as RelaxedUTN takes dense ones (see the limitation at getStructuredMatrices())
+		Eigen::MatrixXd A, B;
+		getMatrices(systems, outType, Ts, A, B, forcedOutput, sensorTs);
 		Eigen::VectorXd y;
 		Eigen::MatrixXd Sy;
 		std::vector<Eigen::MatrixXd> Sxny;
@@ -399,8 +665,8 @@ StatisticValue SystemManager::Eval(TimeUpdateType outType, double Ts, const Stat
 		for (int n = 0; n < nIn; n++)
 			ilIn[n] = n;
 
-		auto fin = [this,Ts,outType,forcedOutput](const std::vector<Eigen::VectorXd>& values)->Eigen::VectorXd {
-			return EvalNonLinPart(Ts, outType, values[0], values[1], forcedOutput);
+		auto fin = [this,&systems,Ts,outType,forcedOutput,&sensorTs](const std::vector<Eigen::VectorXd>& values)->Eigen::VectorXd {
+			return EvalNonLinPart(systems, Ts, outType, values[0], values[1], forcedOutput, sensorTs);
 		};
 
 		int K = 0;
@@ -428,6 +694,20 @@ StatisticValue SystemManager::Eval(TimeUpdateType outType, double Ts, const Stat
 	}
 }
 
+StatisticValue SystemManager::Eval(const IndexList& systems, TimeUpdateType outType, double Ts, const BlockStatisticValue& state_,
+	const StatisticValue& in, Eigen::MatrixXd & S_out_x, Eigen::MatrixXd& S_out_in, bool forcedOutput,
+	const std::vector<double>& sensorTs, size_t* nSkipped) const {
+	if (dep(systems, outType, VAR_STATE, forcedOutput).sum() + dep(systems, outType, VAR_EXTERNAL, forcedOutput).sum() != 0)
+		return Eval(systems, outType, Ts, state_.ToStatisticValue(), in, S_out_x, S_out_in, forcedOutput, sensorTs);
+	StructuredMatrix A, B;
+	getStructuredMatrices(systems, outType, Ts, A, B, forcedOutput, sensorTs);
+	Eigen::VectorXd y = A * state_.Vector() + B * in.vector;
+	S_out_x = A.MultiplyVariance(state_, nSkipped);
+	S_out_in = B * in.variance;
+	Eigen::MatrixXd Sy = A.MultiplyTransposed(S_out_x) + B.MultiplyTransposed(S_out_in);
+	return { y,Sy };
+}
+
 DataMsg SF::SystemManager::GetDataByID(int systemID, DataType dataType, OperationType opType, Time currentTime) {
 	if (((dataType == NOISE || dataType == DISTURBANCE) && opType == FILTER_TIME_UPDATE)
 		|| (dataType == OUTPUT && opType == SENSOR)) {
@@ -438,61 +718,35 @@ DataMsg SF::SystemManager::GetDataByID(int systemID, DataType dataType, Operatio
 			StatisticValue(systemDataPtr->getValue(dataType), systemDataPtr->getVariance(dataType)), currentTime);
 	}
 
-	if (opType == FILTER_TIME_UPDATE) {
-		if (dataType == STATE)
-			return DataMsg(systemID, dataType, opType,
-				getPartitioner().PartStatisticValue(dataType, state_predicted, _GetIndex(systemID)), currentTime);
-		if (dataType == OUTPUT) {
-			int index = _GetIndex(systemID);
-			if (!isAvailable(index))
-				throw std::runtime_error(std::string("SystemManager::GetDataByID OUTPUT not available."));
-			return DataMsg(systemID, dataType, opType,
-				getPartitioner().PartStatisticValue(dataType, output_predicted, index), currentTime);
-		}
-	}
-
-	if (opType == FILTER_MEAS_UPDATE) {
-		if (dataType == STATE)
-			return DataMsg(systemID, dataType, opType,
-				getPartitioner().PartStatisticValue(dataType, state_filtered, _GetIndex(systemID)), currentTime);
-		//if (dataType == OUTPUT)
-		//	return getPartitioner().PartStatisticValue(dataType, output_filtered, _GetIndex(systemID));
+	if (opType == FILTER_TIME_UPDATE || opType == FILTER_MEAS_UPDATE) {
+		ResultSnapshotPtr results = std::atomic_load(opType == FILTER_TIME_UPDATE ? &predicted : &filtered);
+		if (!results)
+			throw std::runtime_error(std::string("SystemManager::GetDataByID No results yet."));
+		auto it = std::find(results->IDs.begin(), results->IDs.end(), (unsigned int)systemID);
+		if (it == results->IDs.end())
+			throw std::runtime_error(std::string("SystemManager::GetDataByID Unknown system ID."));
+		return _GetResult(*results, (int)(it - results->IDs.begin()) - 1, dataType, opType, currentTime);
 	}
 
 	throw std::runtime_error(std::string("SystemManager::GetDataByID Not implemented case."));
 }
 
 DataMsg SF::SystemManager::GetDataByIndex(int systemIndex, DataType dataType, OperationType opType, Time currentTime) {
-	SystemData * systemDataPtr;
-	if (systemIndex == -1)
-		systemDataPtr = &baseSystem;
-	else
-		systemDataPtr = &sensorList[systemIndex];
 	if (((dataType == NOISE || dataType == DISTURBANCE) && opType == FILTER_TIME_UPDATE)
 		|| (dataType == OUTPUT && opType == SENSOR)) {
+		const SystemData& systemData = SystemByIndex(systemIndex);
 		if (dataType == OUTPUT && !isAvailable(systemIndex))
 			throw std::runtime_error(std::string("SystemManager::GetDataByID OUTPUT not available."));
-		return DataMsg(systemDataPtr->getPtr()->getID(), dataType, opType,
-			StatisticValue(systemDataPtr->getValue(dataType), systemDataPtr->getVariance(dataType)), currentTime);
+		return DataMsg(systemData.getPtr()->getID(), dataType, opType,
+			StatisticValue(systemData.getValue(dataType), systemData.getVariance(dataType)), currentTime);
 	}
-	if (opType == FILTER_TIME_UPDATE) {
-		if (dataType == STATE)
-			return DataMsg(systemDataPtr->getPtr()->getID(), dataType, opType,
-				getPartitioner().PartStatisticValue(dataType, state_predicted, systemIndex), currentTime);
-		if (dataType == OUTPUT) {
-			if (!isAvailable(systemIndex))
-				throw std::runtime_error(std::string("SystemManager::GetDataByID OUTPUT not available."));
-			return DataMsg(systemDataPtr->getPtr()->getID(), dataType, opType,
-				getPartitioner().PartStatisticValue(dataType, output_predicted, systemIndex), currentTime);
-		}
-	}
-
-	if (opType == FILTER_MEAS_UPDATE) {
-		if (dataType == STATE)
-			return DataMsg(systemDataPtr->getPtr()->getID(), dataType, opType,
-				getPartitioner().PartStatisticValue(dataType, state_filtered, systemIndex), currentTime);
-		//if (dataType == OUTPUT)
-		//	return getPartitioner().PartStatisticValue(dataType, output_filtered, _GetIndex(systemID));
+	if (opType == FILTER_TIME_UPDATE || opType == FILTER_MEAS_UPDATE) {
+		ResultSnapshotPtr results = std::atomic_load(opType == FILTER_TIME_UPDATE ? &predicted : &filtered);
+		if (!results)
+			throw std::runtime_error(std::string("SystemManager::GetDataByIndex No results yet."));
+		if (systemIndex < -1 || systemIndex + 1 >= (int)results->IDs.size())
+			throw std::runtime_error(std::string("SystemManager::GetDataByIndex Wrong system index."));
+		return _GetResult(*results, systemIndex, dataType, opType, currentTime);
 	}
 
 	throw std::runtime_error(std::string("SystemManager::GetDataByIndex Not implemented case."));
@@ -502,6 +756,9 @@ SystemManager::SystemManager(const BaseSystemData& data, const StatisticValue& s
 	sensorList(std::vector<SensorData>()), state(state_), baseSystem(data) {
 	if (data.num(STATE) != state_.Length())
 		throw std::runtime_error("Wrong state size!");
+	state_filtered = state;
+	_UpdateComponents();
+	_Publish(FILTER_MEAS_UPDATE);
 }
 
 SystemManager::~SystemManager() {
@@ -541,12 +798,12 @@ std::ostream & SystemManager::print(std::ostream & stream) const {
 	};
 
 	stream << "Basesystem: ";
-	printSystem(stream, &baseSystem, partitioner.PartValue(STATE, state.vector,-1),
-		partitioner.PartValue(OUTPUT, output.vector, -1));
+	printSystem(stream, &baseSystem, partitioner->PartValue(STATE, state.vector,-1),
+		partitioner->PartValue(OUTPUT, output.vector, -1));
 	for (unsigned int sensor_i = 0; sensor_i < nSensors(); sensor_i++) {
 		stream << "Sensor " << sensor_i << ": ";
-		printSystem(stream, &sensorList[sensor_i], partitioner.PartValue(STATE, state.vector, sensor_i),
-			partitioner.PartValue(OUTPUT, output.vector, sensor_i));
+		printSystem(stream, &sensorList[sensor_i], partitioner->PartValue(STATE, state.vector, sensor_i),
+			partitioner->PartValue(OUTPUT, output.vector, sensor_i));
 	}
 	// STATE variances
 	stream << "Variance matrix of the state:\n";
@@ -586,10 +843,117 @@ void SystemManager::resetMeasurement() {
 void SystemManager::PredictionDone(const StatisticValue& state, const StatisticValue& output) {
 	state_predicted = state;
 	output_predicted = output;
+	_Notify(*_Publish(FILTER_TIME_UPDATE), FILTER_TIME_UPDATE);
 }
 
 void SystemManager::FilteringDone(const StatisticValue& state) {
 	state_filtered = state;
+	_Notify(*_Publish(FILTER_MEAS_UPDATE), FILTER_MEAS_UPDATE);
+}
+
+SystemManager::ResultSnapshotPtr SystemManager::_Publish(OperationType opType) {
+	// The snapshot is built without locking, only the pointer is swapped
+	std::shared_ptr<ResultSnapshot> results = std::make_shared<ResultSnapshot>();
+	results->partitioner = getPartitioner();
+	results->IDs.reserve(nSensors() + 1);
+	results->available.reserve(nSensors() + 1);
+	for (int index = -1; index < (int)nSensors(); index++) {
+		results->IDs.push_back(SystemByIndex(index).getPtr()->getID());
+		results->available.push_back(opType == FILTER_TIME_UPDATE && output_predicted.Length() > 0 && isAvailable(index));
+	}
+	if (opType == FILTER_TIME_UPDATE) {
+		results->state = state_predicted;
+		results->output = output_predicted;
+		std::atomic_store(&predicted, ResultSnapshotPtr(results));
+	}
+	else {
+		results->state = state_filtered;
+		results->disturbance = (*this)(DISTURBANCE);
+		results->isStateRad = isStateRad();
+		std::atomic_store(&filtered, ResultSnapshotPtr(results));
+	}
+	return results;
+}
+
+void SystemManager::_Notify(const ResultSnapshot & results, OperationType opType) const {
+	// Nothing is computed without callbacks
+	std::shared_ptr<const CallbackList> list = std::atomic_load(&callbacks);
+	if (!list)
+		return;
+	Time currentTime = Now();
+	for (size_t k = 0; k < results.IDs.size(); k++)
+		for (DataType type : { STATE, OUTPUT }) {
+			if (type == OUTPUT && !results.available[k])
+				continue;
+			DataMsg data = _GetResult(results, (int)k - 1, type, opType, currentTime);
+			for (const auto& callback : *list)
+				callback.second(data);
+		}
+}
+
+DataMsg SystemManager::_GetResult(const ResultSnapshot & results, int index, DataType dataType,
+	OperationType opType, const Time & currentTime) {
+	unsigned int ID = results.IDs[index + 1];
+	if (dataType == STATE)
+		return DataMsg(ID, dataType, opType, results.partitioner->PartStatisticValue(dataType, results.state, index), currentTime);
+	if (dataType == OUTPUT && opType == FILTER_TIME_UPDATE) {
+		if (!results.available[index + 1])
+			throw std::runtime_error(std::string("SystemManager::GetDataByID OUTPUT not available."));
+		return DataMsg(ID, dataType, opType, results.partitioner->PartStatisticValue(dataType, results.output, index), currentTime);
+	}
+	throw std::runtime_error(std::string("SystemManager::GetDataByID Not implemented case."));
+}
+
+size_t SystemManager::AddCallback(const Callback & callback) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
+	std::shared_ptr<const CallbackList> list = std::atomic_load(&callbacks);
+	std::shared_ptr<CallbackList> newList = list ? std::make_shared<CallbackList>(*list) : std::make_shared<CallbackList>();
+	newList->push_back(std::make_pair(nextCallbackHandle, callback));
+	std::atomic_store(&callbacks, std::shared_ptr<const CallbackList>(newList));
+	return nextCallbackHandle++;
+}
+
+void SystemManager::RemoveCallback(size_t handle) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
+	std::shared_ptr<const CallbackList> list = std::atomic_load(&callbacks);
+	if (!list)
+		return;
+	std::shared_ptr<CallbackList> newList = std::make_shared<CallbackList>(*list);
+	newList->erase(std::remove_if(newList->begin(), newList->end(),
+		[handle](const std::pair<size_t, Callback>& callback) { return callback.first == handle; }), newList->end());
+	std::atomic_store(&callbacks, newList->empty() ? std::shared_ptr<const CallbackList>() : std::shared_ptr<const CallbackList>(newList));
+}
+
+std::vector<StatisticValue> SystemManager::PredictHorizon(const std::vector<DTime>& horizons) const {
+	ResultSnapshotPtr s = std::atomic_load(&filtered);
+	std::vector<StatisticValue> out;
+	out.reserve(horizons.size());
+	StatisticValue x = s->state;
+	DTime tLast(0);
+	for (const DTime& t : horizons) {
+		if (t < tLast)
+			throw std::runtime_error(std::string("SystemManager::PredictHorizon(): The horizons must be ascending!"));
+		// Continue from the previous horizon
+		if (t > tLast) {
+			Eigen::MatrixXd sg1, sg2;
+			x = Eval(STATE_UPDATE, duration_cast_to_sec(t - tLast), x, s->disturbance, sg1, sg2, true);
+			NormaliseRad(x.vector, s->isStateRad);
+		}
+		out.push_back(x);
+		tLast = t;
+	}
+	return out;
+}
+
+void SystemManager::NormaliseRad(Eigen::VectorXd & value, const Eigen::VectorXi & isRad) {
+	for (Eigen::Index i = 0; i < isRad.size(); i++)
+		if (isRad(i) == 1) {
+			value(i) = fmod(value(i), 2. * EIGEN_PI);
+			if (value(i) < -EIGEN_PI)
+				value(i) += EIGEN_PI * 2.;
+			if (value(i) > EIGEN_PI)
+				value(i) -= EIGEN_PI * 2.;
+		}
 }
 
 SystemManager::BaseSystemData::BaseSystemData(BaseSystem::BaseSystemPtr ptr_,
@@ -629,21 +993,25 @@ Eigen::MatrixXd SystemManager::BaseSystemData::getMatrix(double Ts, TimeUpdateTy
 	case STATE_UPDATE:
 		switch (inType) {
 		case VAR_STATE:
-			return ptr->getA(Ts);
+			return ptr->getMatrix(MATRIX_A, Ts);
 		case VAR_EXTERNAL:
-			return ptr->getB(Ts);
+			return ptr->getMatrix(MATRIX_B, Ts);
 		}
 	case OUTPUT_UPDATE:
 		switch (inType) {
 		case VAR_STATE:
-			return ptr->getC(Ts);
+			return ptr->getMatrix(MATRIX_C, Ts);
 		case VAR_EXTERNAL:
-			return ptr->getD(Ts);
+			return ptr->getMatrix(MATRIX_D, Ts);
 		}
 	}
 	throw std::runtime_error(std::string("SystemManager::BaseSystemData::getMatrix(): unknown parameters"));
 }
 
+MatrixStructure SystemManager::BaseSystemData::getMatrixStructure(TimeUpdateType type, VariableType inType) const {
+	return ptr->getMatrixStructure(_GetModelMatrix(type, inType, false));
+}
+
 BaseSystem::BaseSystemPtr SystemManager::BaseSystemData::getBaseSystemPtr() const { return ptr; }
 
 System::SystemPtr SystemManager::BaseSystemData::getPtr() const { return ptr; }
@@ -696,16 +1064,16 @@ Eigen::MatrixXd SystemManager::SensorData::getMatrixBaseSystem(double Ts, TimeUp
 	case STATE_UPDATE:
 		switch (inType) {
 		case VAR_STATE:
-			return ptr->getAs_bs(Ts);
+			return ptr->getMatrix(MATRIX_A_BS, Ts);
 		case VAR_EXTERNAL:
-			return ptr->getBs_bs(Ts);
+			return ptr->getMatrix(MATRIX_B_BS, Ts);
 		}
 	case OUTPUT_UPDATE:
 		switch (inType) {
 		case VAR_STATE:
-			return ptr->getCs_bs(Ts);
+			return ptr->getMatrix(MATRIX_C_BS, Ts);
 		case VAR_EXTERNAL:
-			return ptr->getDs_bs(Ts);
+			return ptr->getMatrix(MATRIX_D_BS, Ts);
 		}
 	}
 	throw std::runtime_error(std::string("SystemManager::SensorData::getMatrixBaseSystem(): unknown parameters"));
@@ -719,30 +1087,93 @@ Eigen::MatrixXd SystemManager::SensorData::getMatrixSensor(double Ts,
 	case STATE_UPDATE:
 		switch (inType) {
 		case VAR_STATE:
-			return ptr->getAs(Ts);
+			return ptr->getMatrix(MATRIX_A, Ts);
 		case VAR_EXTERNAL:
-			return ptr->getBs(Ts);
+			return ptr->getMatrix(MATRIX_B, Ts);
 		}
 	case OUTPUT_UPDATE:
 		switch (inType) {
 		case VAR_STATE:
-			return ptr->getCs(Ts);
+			return ptr->getMatrix(MATRIX_C, Ts);
 		case VAR_EXTERNAL:
-			return ptr->getDs(Ts);
+			return ptr->getMatrix(MATRIX_D, Ts);
 		}
 	}
 	throw std::runtime_error(std::string("SystemManager::SensorData::getMatrixSensor(): unknown parameters"));
 }
 
+MatrixStructure SystemManager::SensorData::getMatrixStructureBaseSystem(TimeUpdateType type, VariableType inType) const {
+	return ptr->getMatrixStructure(_GetModelMatrix(type, inType, true));
+}
+
+MatrixStructure SystemManager::SensorData::getMatrixStructureSensor(TimeUpdateType type, VariableType inType) const {
+	return ptr->getMatrixStructure(_GetModelMatrix(type, inType, false));
+}
+
 Sensor::SensorPtr SystemManager::SensorData::getSensorPtr() const { return ptr; }
 
+bool SystemManager::SensorData::isCoupledToBaseSystem() const {
+	// Nonlinear dependencies
+	for (TimeUpdateType outType : { STATE_UPDATE, OUTPUT_UPDATE })
+		for (VariableType inType : { VAR_STATE, VAR_EXTERNAL })
+			if (ptr->getNonlinDepOnBaseSystemSignals(outType, inType).any())
+				return true;
+	// Linear coupling: the matrices may depend on Ts, so they are checked with several sampling times
+	for (double Ts : { 0.001, 0.01, 0.1, 1. })
+		if (!ptr->getAs_bs(Ts).isZero(0) || !ptr->getBs_bs(Ts).isZero(0) ||
+			!ptr->getCs_bs(Ts).isZero(0) || !ptr->getDs_bs(Ts).isZero(0))
+			return true;
+	return false;
+}
+
 System::SystemPtr SystemManager::SensorData::getPtr() const { return ptr; }
 
 bool SystemManager::SensorData::isBaseSystem() const { return false; }
 
+void SystemManager::SensorData::setDecimation(unsigned int decimation_) {
+	if (decimation_ == 0)
+		throw std::runtime_error(std::string("SystemManager::SensorData::setDecimation(): The decimation must be positive!"));
+	decimation = decimation_;
+	nHeldSteps = 0;
+	heldTs = 0;
+}
+
+unsigned int SystemManager::SensorData::getDecimation() const { return decimation; }
+
+double SystemManager::SensorData::propagationTs(double Ts) const {
+	if (nHeldSteps + 1 < decimation)
+		return -1;
+	return heldTs + Ts;
+}
+
+void SystemManager::SensorData::propagationStepDone(double Ts) {
+	if (nHeldSteps + 1 < decimation) {
+		nHeldSteps++;
+		heldTs += Ts;
+	}
+	else {
+		nHeldSteps = 0;
+		heldTs = 0;
+	}
+}
+
 SystemManager::Partitioner::Partitioner(size_t N) : nx(std::vector<size_t>(N)),
 nw(std::vector<size_t>(N)), ny(std::vector<size_t>(N)),
-nv(std::vector<size_t>(N)) {}
+nv(std::vector<size_t>(N)) {
+	UpdateOffsets();
+}
+
+void SystemManager::Partitioner::UpdateOffsets() {
+	auto prefixSum = [](const std::vector<size_t>& n_, std::vector<size_t>& o_) {
+		o_.assign(n_.size() + 1, 0);
+		for (size_t i = 0; i < n_.size(); i++)
+			o_[i + 1] = o_[i] + n_[i];
+	};
+	prefixSum(nx, ox);
+	prefixSum(nw, ow);
+	prefixSum(ny, oy);
+	prefixSum(nv, ov);
+}
 
 const std::vector<size_t>& SystemManager::Partitioner::n(DataType type) const {
 	switch (type) {
@@ -759,54 +1190,49 @@ const std::vector<size_t>& SystemManager::Partitioner::n(DataType type) const {
 	}
 }
 
-Eigen::VectorXd SystemManager::Partitioner::PartValue(DataType type, const Eigen::VectorXd & value, int index) const {
-	return Eigen::VectorXd(PartValue(type, const_cast<Eigen::VectorXd&>(value), index));
-	/*
-	auto n_ = n(type);
-	//if (index == -1) return value.segment(0, n_[0]);
-	size_t n0 = 0;
-	for (int i = 0; i < index + 1; i++)
-	n0 += n_[i];
-	return value.segment(n0, n_[index + 1]);*/
+const std::vector<size_t>& SystemManager::Partitioner::offsets(DataType type) const {
+	switch (type) {
+	case DataType::NOISE:
+		return ov;
+	case DataType::DISTURBANCE:
+		return ow;
+	case DataType::STATE:
+		return ox;
+	case DataType::OUTPUT:
+		return oy;
+	default:
+		throw std::runtime_error(std::string("Partitioner::offsets(): Unknown argument!"));
+	}
+}
+
+size_t SystemManager::Partitioner::Offset(DataType type, int index) const { //index=-1: basesystem, index=0 sensor0....
+	return offsets(type)[index + 1];
+}
+
+Eigen::VectorBlock<const Eigen::VectorXd> SystemManager::Partitioner::PartValue(DataType type, const Eigen::VectorXd & value, int index) const {
+	return value.segment(Offset(type, index), n(type)[index + 1]);
 }
 
-Eigen::VectorBlock<Eigen::VectorXd> SystemManager::Partitioner::PartValue(DataType type, Eigen::VectorXd & value, int index) const { //index=-1: basesystem, index=0 sensor0....
-	auto n_ = n(type);
-	//if (index == -1) return value.segment(0, n_[0]);
-	size_t n0 = 0;
-	for (int i = 0; i < index + 1; i++)
-		n0 += n_[i];
-	return value.segment(n0, n_[index + 1]);
+Eigen::VectorBlock<Eigen::VectorXd> SystemManager::Partitioner::PartValue(DataType type, Eigen::VectorXd & value, int index) const {
+	return value.segment(Offset(type, index), n(type)[index + 1]);
 }
 
 Eigen::Block<Eigen::MatrixXd> SystemManager::Partitioner::PartVariance(DataType type, Eigen::MatrixXd & value, int index1, int index2) const {
-	auto n_ = n(type);
-	//if (index == -1) return value.segment(0, n_[0]);
-	size_t n01 = 0, n02 = 0;
-	for (int i = 0; i < index1 + 1; i++)
-		n01 += n_[i];
-	for (int i = 0; i < index2 + 1; i++)
-		n02 += n_[i];
-	return value.block(n01, n02, n_[index1 + 1], n_[index2 + 1]);
+	const std::vector<size_t>& n_ = n(type);
+	return value.block(Offset(type, index1), Offset(type, index2), n_[index1 + 1], n_[index2 + 1]);
 }
 
-Eigen::MatrixXd SystemManager::Partitioner::PartVariance(DataType type, const Eigen::MatrixXd & value, int index1, int index2) const {
-	return Eigen::MatrixXd(PartVariance(type, const_cast<Eigen::MatrixXd&>(value), index1, index2));
+Eigen::Block<const Eigen::MatrixXd> SystemManager::Partitioner::PartVariance(DataType type, const Eigen::MatrixXd & value, int index1, int index2) const {
+	const std::vector<size_t>& n_ = n(type);
+	return value.block(Offset(type, index1), Offset(type, index2), n_[index1 + 1], n_[index2 + 1]);
 }
 
 Eigen::Block<Eigen::MatrixXd> SystemManager::Partitioner::PartVariance(DataType type1, DataType type2, Eigen::MatrixXd & value, int index1, int index2) const {
-	const std::vector<size_t>& n1_ = n(type1);
-	const std::vector<size_t>& n2_ = n(type2);
-	//if (index == -1) return value.segment(0, n_[0]);
-	size_t n01 = 0, n02 = 0;
-	for (int i = 0; i < index1 + 1; i++)
-		n01 += n1_[i];
-	for (int i = 0; i < index2 + 1; i++)
-		n02 += n2_[i];
-	return value.block(n01, n02, n1_[index1 + 1], n2_[index2 + 1]);
+	return value.block(Offset(type1, index1), Offset(type2, index2), n(type1)[index1 + 1], n(type2)[index2 + 1]);
 }
 
 StatisticValue SystemManager::Partitioner::PartStatisticValue(DataType type, const StatisticValue & value, int index) const {
+	// The block of the stored covariance (not of a converted copy)
 	return StatisticValue(PartValue(type, value.vector, index),
-		PartVariance(type, value.variance, index, index));
+		value.variance.block(Offset(type, index), Offset(type, index), n(type)[index + 1], n(type)[index + 1]));
 }
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Sensor.h"
+#include "BlockStatisticValue.h"
 #include "DataMsg.h"
 #include "FilterCore.h"
+#include <array>
+#include <map>
+#include <mutex>
 
 namespace SF {
 
@@ -88,7 +92,7 @@ namespace SF {
 	* -- CallbackGotDataMsg() with data incoming from sensors
 	*
 	* -- Step(Ts) for filtering
-	* - Get the results or register a Callback via SetCallback()
+	* - Get the results (from any thread) or register a Callback via AddCallback()
 	 */
 	class SystemManager : public FilterCore {
 	public:
@@ -120,6 +124,8 @@ namespace SF {
 			/*!< Set the state/output/disturbance/noise vector. */
 			void setVariance(const Eigen::MatrixXd& value, DataType type);
 			/*!< Set the state/output/disturbance/noise covariance matrix. */
+			void setData(const DataMsgView& data);
+			/*!< Set the vector and/or the covariance matrix converted directly from the recieved floats. */
 			Eigen::VectorXd getValue(DataType type) const;  /*!< Returns the state/output/disturbance/noise vector. */
 			Eigen::MatrixXd getVariance(DataType type) const;  /*!< Returns the state/output/disturbance/noise covariance matrix. */
 			void resetMeasurement(); /*!< Set the measurement status OBSOLETHE from UPTODATE. */
@@ -142,6 +148,7 @@ namespace SF {
 				bool forcedOutput = false) const; /*!< Returns if the nonlinear part of STATE_UPDATE/OUTPUT_UPDATE depends on the elements of STATE or DISTURBANCE/NOISE values */
 			Eigen::MatrixXd getMatrix(double Ts, TimeUpdateType type,
 				VariableType inType, bool forcedOutput = false) const; /*!< Returns \f$\mathbf A_{bs} \f$, \f$\mathbf B_{bs} \f$, \f$\mathbf C_{bs} \f$, \f$\mathbf D_{bs} \f$ matrices  according to the measurement status and the forcedoutput flag */
+			MatrixStructure getMatrixStructure(TimeUpdateType type, VariableType inType) const; /*!< Returns the declared structure of the matrix returned by getMatrix() */
 			BaseSystem::BaseSystemPtr getBaseSystemPtr() const; /*!< BaseSystemPtr getter. */
 			System::SystemPtr getPtr() const override;  /*!< SystemPtr getter. */
 			bool isBaseSystem() const override; /*!< To check if it is for a basesystem or a sensor. */
@@ -152,6 +159,9 @@ namespace SF {
 		*/
 		class SensorData : public SystemData {
 			Sensor::SensorPtr ptr; /*!< Stores the shared pointer to the Sensor instance*/
+			unsigned int decimation = 1; /*!< The state is propagated in every decimation-th step (see SystemManager::SetPropagationDecimation()) */
+			unsigned int nHeldSteps = 0; /*!< Number of steps since the last propagation */
+			double heldTs = 0; /*!< Time elapsed since the last propagation */
 		public:
 			SensorData(Sensor::SensorPtr ptr_, const StatisticValue& noise_,
 				const StatisticValue& disturbance_); /*!< Constructor without providing measurement result */
@@ -166,7 +176,14 @@ namespace SF {
 				VariableType inType, bool forcedOutput = false) const; /*!< Returns \f$\mathbf A'_{si} \f$, \f$\mathbf B'_{si} \f$, \f$\mathbf C'_{si} \f$, \f$\mathbf D'_{si} \f$ matrices  according to the measurement status and the forcedoutput flag */
 			Eigen::MatrixXd getMatrixSensor(double Ts, TimeUpdateType type, VariableType inType,
 				bool forcedOutput = false) const;  /*!< Returns \f$\mathbf A_{si} \f$, \f$\mathbf B_{si} \f$, \f$\mathbf C_{si} \f$, \f$\mathbf D_{si} \f$ matrices  according to the measurement status and the forcedoutput flag */
+			MatrixStructure getMatrixStructureBaseSystem(TimeUpdateType type, VariableType inType) const; /*!< Returns the declared structure of the matrix returned by getMatrixBaseSystem() */
+			MatrixStructure getMatrixStructureSensor(TimeUpdateType type, VariableType inType) const; /*!< Returns the declared structure of the matrix returned by getMatrixSensor() */
 			Sensor::SensorPtr getSensorPtr() const; /*!< SensorPtr getter. */
+			void setDecimation(unsigned int decimation_); /*!< See SystemManager::SetPropagationDecimation() */
+			unsigned int getDecimation() const; /*!< See SystemManager::SetPropagationDecimation() */
+			double propagationTs(double Ts) const; /*!< Ts of the propagation in the next step with the given Ts: the accumulated time or negative if the state is held */
+			void propagationStepDone(double Ts); /*!< Register a step with the given Ts (see propagationTs()) */
+			bool isCoupledToBaseSystem() const; /*!< Returns false if the sensor states, outputs never depend on the basesystem signals (all \f$\mathbf A'_{si} \f$, \f$\mathbf B'_{si} \f$, \f$\mathbf C'_{si} \f$, \f$\mathbf D'_{si} \f$ and the related nonlinear dependencies are zero) */
 			System::SystemPtr getPtr() const override; /*!< SystemPtr getter. */
 			bool isBaseSystem() const override; /*!< To check if it is for a basesystem or a sensor. */
 		};
@@ -184,21 +201,63 @@ namespace SF {
 
 		typedef std::shared_ptr<SystemManager> SystemManagerPtr; /*!< Shared pointer type for SystemManager class */
 
+		typedef std::vector<int> IndexList; /*!< List of system indices (-1: basesystem, 0: first sensor...) */
+
 		/*! \brief Add a sensor: a SensorData class and its initial state, covariance matrix  must be given as inputs
 		*
 		* The function performs System::Selftest on the sensor, and check its compatibility to the basesystem
+		*
+		* The state of the other systems is kept, so sensors can be added while filtering (see RemoveSensor()).
+		*/
+		virtual void AddSensor(const SensorData& sensorData, const StatisticValue& sensorState);
+
+		/*! \brief Remove the sensor with the given ID keeping the state of the other systems
+		*
+		* Sensors can be added/removed while filtering, but not concurrently with the filter thread: call them from the
+		* thread of the filter (e.g. from SaveDataMsg()) or while the reciever is paused.
 		*/
-		void AddSensor(const SensorData& sensorData, const StatisticValue& sensorState);
+		virtual void RemoveSensor(unsigned int ID);
 
 		/*! \brief The function to inject data (meas. results, noise, disturbance value and/or variances)
 		*
 		*/
 		virtual bool SaveDataMsg(const DataMsg& data, const Time& t = Now()) override;
 
+		/*! \brief The same for a recieved msg read in place: the values are converted directly into the stored ones
+		*
+		*/
+		virtual bool SaveDataMsg(const DataMsgView& data, const Time& t = Now()) override;
+
 		typedef std::function<void(const DataMsg& data)> Callback; /*!< Callback that can be set to handle results of time update & filtering update */
 
+		/*! \brief Register a callback for the results of the time updates and the filtering updates
+		*
+		* After every time update it is called with the STATE and the available OUTPUTs of the systems (FILTER_TIME_UPDATE),
+		* after every filtering with the STATEs (FILTER_MEAS_UPDATE). It is called from the thread of the filter after the
+		* results are published, so it must return quickly. Without callbacks no messages are created.
+		*
+		* Returns a handle for RemoveCallback(). Callbacks can be added/removed from any thread.
+		*/
+		size_t AddCallback(const Callback& callback);
+
+		void RemoveCallback(size_t handle); /*!< Remove a callback registered by AddCallback() */
+
 		size_t nSensors() const override; /*!< Get number of sensor installed */
 
+		/*! \brief Get the independent components of the model
+		*
+		* The first component contains the basesystem and the sensors coupled to it (see SensorData::isCoupledToBaseSystem()),
+		* the other components are the decoupled sensors one by one. The states of the different components are never correlated,
+		* so they can be filtered separately. The components are updated in AddSensor().
+		*/
+		const std::vector<IndexList>& getComponents() const;
+
+		/*! \brief Get the indices of the elements of the STATE/OUTPUT/DISTURBANCE/NOISE vector related to the given systems
+		*
+		* By using forcedOutput=true input, it assumes UPTODATE measurements
+		*/
+		Eigen::VectorXi getIndices(const IndexList& systems, DataType type, bool forcedOutput = false) const;
+
 		const SystemData* SystemByID(unsigned int ID) const;  /*!< Get const pointer for a SystemData by ID */
 
 		/*! \brief Get the current number of states, outputs, noises or disturbances of the system
@@ -232,12 +291,47 @@ namespace SF {
 		void getMatrices(TimeUpdateType out_, double Ts, Eigen::MatrixXd& A,
 			Eigen::MatrixXd& B, bool forcedOutput = false) const;
 
+		/*! \brief Get the A,B, C,D matrices as block matrices with the structures declared by the systems (see System::getMatrixStructure())
+		*
+		* The ZERO and IDENTITY blocks are not computed. getMatrices() returns their dense form.
+		*
+		* Limitation: Eval() exploits the structures only if the update is linear. With nonlinear parts the relaxed
+		* unscented transformation (RelaxedUT submodule) is used, which takes dense matrices, so there the dense products
+		* are computed (the ZERO and IDENTITY blocks are still not evaluated by the systems).
+		*/
+		void getStructuredMatrices(TimeUpdateType out_, double Ts, StructuredMatrix& A,
+			StructuredMatrix& B, bool forcedOutput = false) const;
+
+		/*! \brief Exploit the declared structures of the model matrices in Eval() (default: true)
+		*
+		* With false every block is computed and multiplied as a dense matrix.
+		*/
+		void SetStructuredEvaluation(bool enabled);
+
+		/*! \brief Propagate the state of the sensor only in every k-th step of the filter (multi-rate filtering)
+		*
+		* For slowly varying sensor states (e.g. calibration, drift). In the steps between the state of the sensor is held
+		* (identity state update without disturbance and nonlinear part), so its cross covariances with the other states
+		* are propagated by the models of the other states only. In the k-th step the state update of the sensor is computed
+		* with the time accumulated since its last propagation. k = 1 (default) propagates it in every step.
+		*
+		* It is applied by KalmanFilter::Step() (and PrepareStep()); Eval() and PredictHorizon() propagate every state.
+		*/
+		virtual void SetPropagationDecimation(unsigned int ID, unsigned int k);
+
 		/*! \brief Get STATE, DISTURBANCE, measured OUTPUT, NOISE vectors of the system according to the measurement statuses of the systems
 		*
 		* By using forcedOutput=true input, it assumes UPTODATE measurements
 		*/
 		StatisticValue operator()(DataType type, bool forcedOutput = false) const;
 
+		/*! \brief Get DISTURBANCE, measured OUTPUT, NOISE values of the systems as blocks without the zero cross variances
+		*
+		* Block 0 belongs to the basesystem, block i+1 to the i-th sensor (see getAllSystems()). The blocks of the
+		* not available outputs are empty. By using forcedOutput=true input, it assumes UPTODATE measurements
+		*/
+		BlockStatisticValue getBlockValue(DataType type, bool forcedOutput = false) const;
+
 		std::ostream & print(std::ostream & stream) const;  /*!<  Print the current status of the system. */
 
 		/*! \brief Evaluate the nonlinear part of the STATE_UPDATE/OUTPUT_UPDATE with given Ts, state vector and disturbance/noise values according to the measurement statuses of the systems
@@ -252,16 +346,37 @@ namespace SF {
 		* Returns the computed vector&variance, and it cross-variance matrices with the state (S_out_x) and the disturbance/noise (S_out_in)
 		*
 		* By using forcedOutput=true input, it assumes UPTODATE measurements
+		*
+		* The structured products (see getStructuredMatrices()) are used only if the update is linear.
 		*/
 		StatisticValue Eval(TimeUpdateType outType, double Ts, const StatisticValue& state_, const StatisticValue& in,
 			Eigen::MatrixXd& S_out_x, Eigen::MatrixXd& S_out_in, bool forcedOutput = false) const;
 
+		/*! \brief Get the input values (NOISE, DISTURBANCE, SENSOR OUTPUT) or the results of the last step
+		*
+		* The results (FILTER_TIME_UPDATE and FILTER_MEAS_UPDATE) are read from immutable snapshots published after each
+		* time update and filtering: they can be read from any thread without blocking the filter.
+		*/
 		DataMsg GetDataByID(int systemID, DataType dataType, OperationType opType, Time currentTime) override;
 
-		DataMsg GetDataByIndex(int systemIndex, DataType dataType, OperationType opType, Time currentTime = Now()) override;
+		DataMsg GetDataByIndex(int systemIndex, DataType dataType, OperationType opType, Time currentTime = Now()) override; /*!< See GetDataByID(), the index refers to the systems at the last step */
+
+		/*! \brief Predict the state and its covariance matrix to the given horizons (the times elapsed since the last filtering)
+		*
+		* The horizons must be ascending, each prediction is computed from the previous one by applying the STATE_UPDATE model.
+		*
+		* It works on the snapshot of the last filtered state and the disturbances published by FilteringDone(), so it can be
+		* called from any thread without blocking the filter. (Adding/removing sensors must not be done concurrently.)
+		*/
+		std::vector<StatisticValue> PredictHorizon(const std::vector<DTime>& horizons) const;
 
 	private:
-		StatisticValue state_predicted, output_predicted, state_filtered;// , output_filtered;
+		StatisticValue state_predicted, output_predicted, state_filtered;// , output_filtered; (only for the filter thread, see _Publish())
+
+		typedef std::vector<std::pair<size_t, Callback>> CallbackList; /*!< The callbacks with their handles */
+		std::shared_ptr<const CallbackList> callbacks; /*!< Copied on write, accessed atomically (nullptr if empty) */
+		std::mutex callbackMutex; /*!< Serialises AddCallback() and RemoveCallback() */
+		size_t nextCallbackHandle = 0; /*!< See AddCallback() */
 
 	protected:
 		/*! \brief Simple class to fasten up the partitioning of state/output/disturbance/noise vectors and covariance matrixes for systems, sensors according to the measurement statuses of the systems
@@ -273,39 +388,111 @@ namespace SF {
 			std::vector<size_t> nw;  /*!< Number of disturbances of the systems */
 			std::vector<size_t> ny;  /*!< Number of outputs of the systems */
 			std::vector<size_t> nv;  /*!< Number of noises of the systems */
+			std::vector<size_t> ox;  /*!< Offsets of the states of the systems (and their total number at the end) */
+			std::vector<size_t> ow;  /*!< Offsets of the disturbances of the systems (and their total number at the end) */
+			std::vector<size_t> oy;  /*!< Offsets of the outputs of the systems (and their total number at the end) */
+			std::vector<size_t> ov;  /*!< Offsets of the noises of the systems (and their total number at the end) */
 			Partitioner(size_t N); /*!< Constructor. N is the number of systems */
+			void UpdateOffsets(); /*!< Compute the offsets from the numbers (call it after setting them) */
 			const std::vector<size_t>& n(DataType type) const; /*!< Get number of states/outputs/dist.-es/noises */
+			const std::vector<size_t>& offsets(DataType type) const; /*!< Get the offsets of the states/outputs/dist.-es/noises */
 			Eigen::VectorBlock<Eigen::VectorXd> PartValue(DataType type,
 				Eigen::VectorXd& value, int index) const;  /*!< Partitionate a vector */
-			Eigen::VectorXd PartValue(DataType type,
-				const Eigen::VectorXd& value, int index) const;  /*!< Partitionate a const vector */
+			Eigen::VectorBlock<const Eigen::VectorXd> PartValue(DataType type,
+				const Eigen::VectorXd& value, int index) const;  /*!< Partitionate a const vector (the result is a view, not a copy) */
 			Eigen::Block<Eigen::MatrixXd> PartVariance(DataType type,
 				Eigen::MatrixXd& value, int index1, int index2) const;   /*!< Partitionate a variance matrix */
-			Eigen::MatrixXd PartVariance(DataType type,
-				const Eigen::MatrixXd& value, int index1, int index2) const; /*!< Partitionate a const variance matrix */
+			Eigen::Block<const Eigen::MatrixXd> PartVariance(DataType type,
+				const Eigen::MatrixXd& value, int index1, int index2) const; /*!< Partitionate a const variance matrix (the result is a view, not a copy) */
 			Eigen::Block<Eigen::MatrixXd> PartVariance(DataType type1, DataType type2,
 				Eigen::MatrixXd& value, int index1, int index2) const; /*!< Partitionate a cross-variance matrix */
 			StatisticValue PartStatisticValue(DataType type, const StatisticValue& value, int index) const; /*!< Constructor */
+			size_t Offset(DataType type, int index) const; /*!< Index of the first element of the system in the stacked vector */
 		};
 
+		typedef std::shared_ptr<const Partitioner> PartitionerPtr; /*!< Shared pointer type for the cached Partitioners */
+
 		/*! \brief Get Partitioner struct according to the current measurement statuses of the systems
 		*
 		* By using forcedOutput=true input, it assumes UPTODATE measurements
+		*
+		* The partitioners are cached by the listed systems and their availability, so they are computed only once
+		* for every measurement status pattern (the cache is cleared when a sensor is added or removed).
 		*/
-		Partitioner getPartitioner(bool forcedOutput = false) const;
+		PartitionerPtr getPartitioner(bool forcedOutput = false) const;
 
-		/*! \brief Get index for a (user defined) systemID. It returns -1 for the basesystem!
+		/*! \brief The functions below work on the signals of the listed systems only (e.g. a component, see getComponents())
+		*
+		* The vectors contain the values related to the listed systems in the order of the list.
+		* The listed sensors must not depend on the basesystem if it is not listed.
+		*/
+		PartitionerPtr getPartitioner(const IndexList& systems, bool forcedOutput = false) const;
+
+		size_t num(const IndexList& systems, DataType type, bool forcedOutput = false) const; /*!< See num() and getPartitioner(const IndexList&, bool) */
+
+		Eigen::VectorXi dep(const IndexList& systems, TimeUpdateType outType, VariableType inType,
+			bool forcedOutput = false) const; /*!< See dep() and getPartitioner(const IndexList&, bool) */
+
+		/*! \brief Ts of the STATE_UPDATE of the sensors in the next step of the filter (see SetPropagationDecimation())
 		*
+		* Negative for the held sensor states. Empty if no sensor is decimated. It can be given to the functions below.
+		*/
+		std::vector<double> getSensorTs(double Ts) const;
+
+		void PropagationStepDone(double Ts); /*!< Register a step of the filter for the decimated sensors (see getSensorTs()) */
+
+		// sensorTs: Ts of the STATE_UPDATE of the sensors if it is not empty (see getSensorTs())
+
+		void getMatrices(const IndexList& systems, TimeUpdateType out_, double Ts, Eigen::MatrixXd& A,
+			Eigen::MatrixXd& B, bool forcedOutput = false,
+			const std::vector<double>& sensorTs = std::vector<double>()) const; /*!< See getMatrices() and getPartitioner(const IndexList&, bool) */
+
+		void getStructuredMatrices(const IndexList& systems, TimeUpdateType out_, double Ts, StructuredMatrix& A,
+			StructuredMatrix& B, bool forcedOutput = false,
+			const std::vector<double>& sensorTs = std::vector<double>()) const; /*!< See getStructuredMatrices() and getPartitioner(const IndexList&, bool) */
+
+		Eigen::VectorXd EvalNonLinPart(const IndexList& systems, double Ts, TimeUpdateType outType,
+			const Eigen::VectorXd& state, const Eigen::VectorXd& in, bool forcedOutput = false,
+			const std::vector<double>& sensorTs = std::vector<double>()) const; /*!< See EvalNonLinPart() and getPartitioner(const IndexList&, bool) */
+
+		StatisticValue Eval(const IndexList& systems, TimeUpdateType outType, double Ts, const StatisticValue& state_,
+			const StatisticValue& in, Eigen::MatrixXd& S_out_x, Eigen::MatrixXd& S_out_in,
+			bool forcedOutput = false, const std::vector<double>& sensorTs = std::vector<double>()) const; /*!< See Eval() and getPartitioner(const IndexList&, bool) */
+
+		/*! \brief The same with block-wise state (a block for each listed system)
 		*
+		* In the linear case the products with the zero cross variances of the state are skipped (counted in nSkipped if
+		* not NULL, see StructuredMatrix::MultiplyVariance()), otherwise the dense state is used.
+		*/
+		StatisticValue Eval(const IndexList& systems, TimeUpdateType outType, double Ts, const BlockStatisticValue& state_,
+			const StatisticValue& in, Eigen::MatrixXd& S_out_x, Eigen::MatrixXd& S_out_in, bool forcedOutput = false,
+			const std::vector<double>& sensorTs = std::vector<double>(), size_t* nSkipped = NULL) const;
+
+		const IndexList& getAllSystems() const; /*!< List of all the systems: {-1, 0, 1, ..., nSensors()-1} */
+
+		/*! \brief Offset the rad elements of the vector into the allowed +-pi interval
+		*
+		*/
+		static void NormaliseRad(Eigen::VectorXd& value, const Eigen::VectorXi& isRad);
+
+		/*! \brief Get index for a (user defined) systemID. It returns -1 for the basesystem!
+		*
+		* The IDs sent in the messages (0...255) are looked up in a table.
 		*/
 		int _GetIndex(unsigned int ID) const;
 
+		static const int INDEX_UNKNOWN = -2; /*!< Returned by _FindIndex() for unknown IDs */
+
+		int _FindIndex(unsigned int ID) const; /*!< Same as _GetIndex(), but returns INDEX_UNKNOWN instead of throwing for unknown IDs */
+
 		BaseSystemData & BaseSystem();   /*!< Returns a BaseSystemData ref for an index */
 
 		const BaseSystemData & BaseSystem() const;   /*!< Returns a const BaseSystemData ref for an index */
 
 		SensorData & Sensor(size_t index);   /*!< Returns a SensorData ref for an index */
 
+		const SystemData& SystemByIndex(int index) const;   /*!< Returns a const SystemData ref for an index (-1: basesystem) */
+
 		StatisticValue& State();   /*!< Returns ref of the state value  */
 
 		SystemData* SystemByID(unsigned int ID);   /*!< Returns a SystemData* for an ID */
@@ -324,6 +511,41 @@ namespace SF {
 		BaseSystemData baseSystem; /*!< Stores the data related to the basesystem */
 		std::vector<SensorData> sensorList;  /*!< Stores the data related to the sensors */
 		StatisticValue state;  /*!< Stores the state of the system */
+		std::vector<IndexList> components; /*!< Independent components of the model */
+		IndexList allSystems; /*!< List of all the systems */
+		bool structuredEvaluation = true; /*!< See SetStructuredEvaluation() */
+		std::array<int, 256> indexByID; /*!< Index of the systems by ID (see _GetIndex()), INDEX_UNKNOWN for the unused IDs */
+		mutable std::map<std::vector<int>, PartitionerPtr> partitionerCache; /*!< See getPartitioner() */
+		mutable std::mutex partitionerMutex; /*!< Protects the partitioner cache */
+		static const size_t MAX_CACHED_PARTITIONERS = 256; /*!< The cache is cleared if it grows bigger */
+
+		void _UpdateComponents(); /*!< Recompute the components, the list of the systems and the lookup tables */
+
+		/*! \brief Immutable results of a time update or filtering
+		*
+		* The filter builds a new one after each step and swaps the pointer atomically (see _Publish()), the readers keep
+		* the one they loaded as long as they need it.
+		*/
+		struct ResultSnapshot {
+			StatisticValue state; /*!< Predicted or filtered state */
+			StatisticValue output; /*!< Predicted output (empty for the filtering) */
+			StatisticValue disturbance; /*!< Disturbances at the filtering (for PredictHorizon()) */
+			Eigen::VectorXi isStateRad; /*!< See isStateRad() */
+			PartitionerPtr partitioner; /*!< Partitioner of the vectors (measurement statuses at the time of the step) */
+			std::vector<unsigned int> IDs; /*!< IDs of the systems (index + 1) */
+			std::vector<bool> available; /*!< If the output of the system is in the results (index + 1) */
+		};
+		typedef std::shared_ptr<const ResultSnapshot> ResultSnapshotPtr; /*!< Shared pointer type for the snapshots */
+
+		ResultSnapshotPtr predicted, filtered; /*!< The last published snapshots, accessed atomically */
+
+		/*! \brief Publish the results of the FILTER_TIME_UPDATE or FILTER_MEAS_UPDATE and return the new snapshot */
+		ResultSnapshotPtr _Publish(OperationType opType);
+
+		void _Notify(const ResultSnapshot& results, OperationType opType) const; /*!< Forward the results to the callbacks (see AddCallback()) */
+
+		static DataMsg _GetResult(const ResultSnapshot& results, int index, DataType dataType,
+			OperationType opType, const Time& currentTime); /*!< Result of a system from a snapshot */
 	};
 
 }
@@ -4,7 +4,7 @@
 using namespace SF;
 using namespace RelaxedUnscentedTransformation;
 
-const WAUKF::mapOfVectorWindows & WAUKF::_getValueWindows(DataType signal) const {
+const WAUKF::vectorOfVectorWindows & WAUKF::_getValueWindows(DataType signal) const {
 	switch (signal) {
 	case DISTURBANCE:
 		return disturbanceValueWindows;
@@ -15,7 +15,7 @@ const WAUKF::mapOfVectorWindows & WAUKF::_getValueWindows(DataType signal) const
 	}
 }
 
-const WAUKF::mapOfMatrixWindows & WAUKF::_getVarianceWindows(DataType signal) const {
+const WAUKF::vectorOfMatrixWindows & WAUKF::_getVarianceWindows(DataType signal) const {
 	switch (signal) {
 	case DISTURBANCE:
 		return disturbanceVarianceWindows;
@@ -29,50 +29,75 @@ const WAUKF::mapOfMatrixWindows & WAUKF::_getVarianceWindows(DataType signal) co
 bool WAUKF::_isEstimated(unsigned int systemID, DataType type, ValueType valueorvariance) const {
 	if (type == STATE || type == OUTPUT)
 		return false;
+	size_t i = (size_t)(_FindIndex(systemID) + 1); // INDEX_UNKNOWN: out of range
 	switch (valueorvariance) {
 	case VALUE: {
-		const mapOfVectorWindows& temp = _getValueWindows(type);
-		return temp.find(systemID) != temp.end();
+		const vectorOfVectorWindows& temp = _getValueWindows(type);
+		return i < temp.size() && temp[i] != nullptr;
 	}
 	case VARIANCE: {
-		const mapOfMatrixWindows& temp = _getVarianceWindows(type);
-		return temp.find(systemID) != temp.end();
+		const vectorOfMatrixWindows& temp = _getVarianceWindows(type);
+		return i < temp.size() && temp[i] != nullptr;
 	}
 	default:
 		throw std::runtime_error(std::string("WAUKF::_isEstimated Unknown option!"));
 	}
 }
 
+template<class Type>
+std::shared_ptr<Estimator<Type>>& WAUKF::_Window(std::vector<std::shared_ptr<Estimator<Type>>>& windows, unsigned int ID) {
+	size_t i = (size_t)(_GetIndex(ID) + 1);
+	if (windows.size() <= i)
+		windows.resize(i + 1);
+	return windows[i];
+}
+
 void WAUKF::SetDisturbanceValueWindowing(System::SystemPtr ptr, unsigned int windowSize) {
-	disturbanceValueWindows.insert(std::pair<unsigned int,
-		MAWindow<Eigen::VectorXd>>(ptr->getID(), MAWindow<Eigen::VectorXd>(windowSize,
-			SystemByID(ptr->getID())->getValue(DISTURBANCE))));
+	_Window(disturbanceValueWindows, ptr->getID()) = std::make_shared<MAWindow<Eigen::VectorXd>>(windowSize,
+		SystemByID(ptr->getID())->getValue(DISTURBANCE));
+}
+
+void WAUKF::SetDisturbanceValueForgetting(System::SystemPtr ptr, double lambda) {
+	_Window(disturbanceValueWindows, ptr->getID()) = std::make_shared<ExpForgetting<Eigen::VectorXd>>(lambda,
+		SystemByID(ptr->getID())->getValue(DISTURBANCE));
 }
 
 void WAUKF::SetNoiseValueWindowing(System::SystemPtr ptr, unsigned int windowSize) {
-	noiseValueWindows.insert(std::pair<unsigned int,
-		MAWindow<Eigen::VectorXd>>(ptr->getID(), MAWindow<Eigen::VectorXd>(windowSize,
-			SystemByID(ptr->getID())->getValue(NOISE))));
+	_Window(noiseValueWindows, ptr->getID()) = std::make_shared<MAWindow<Eigen::VectorXd>>(windowSize,
+		SystemByID(ptr->getID())->getValue(NOISE));
+}
+
+void WAUKF::SetNoiseValueForgetting(System::SystemPtr ptr, double lambda) {
+	_Window(noiseValueWindows, ptr->getID()) = std::make_shared<ExpForgetting<Eigen::VectorXd>>(lambda,
+		SystemByID(ptr->getID())->getValue(NOISE));
 }
 
 void WAUKF::SetDisturbanceVarianceWindowing(System::SystemPtr ptr, unsigned int windowSize) {
-	disturbanceVarianceWindows.insert(std::pair<unsigned int,
-		MAWindow<Eigen::MatrixXd>>(ptr->getID(), MAWindow<Eigen::MatrixXd>(windowSize,
-			SystemByID(ptr->getID())->getVariance(DISTURBANCE))));
+	_Window(disturbanceVarianceWindows, ptr->getID()) = std::make_shared<MAWindow<Eigen::MatrixXd>>(windowSize,
+		SystemByID(ptr->getID())->getVariance(DISTURBANCE));
+}
+
+void WAUKF::SetDisturbanceVarianceForgetting(System::SystemPtr ptr, double lambda) {
+	_Window(disturbanceVarianceWindows, ptr->getID()) = std::make_shared<ExpForgetting<Eigen::MatrixXd>>(lambda,
+		SystemByID(ptr->getID())->getVariance(DISTURBANCE));
 }
 
 void WAUKF::SetNoiseVarianceWindowing(System::SystemPtr ptr, unsigned int windowSize) {
-	noiseVarianceWindows.insert(std::pair<unsigned int,
-		MAWindow<Eigen::MatrixXd>>(ptr->getID(), MAWindow<Eigen::MatrixXd>(windowSize,
-			SystemByID(ptr->getID())->getVariance(NOISE))));
+	_Window(noiseVarianceWindows, ptr->getID()) = std::make_shared<MAWindow<Eigen::MatrixXd>>(windowSize,
+		SystemByID(ptr->getID())->getVariance(NOISE));
+}
+
+void WAUKF::SetNoiseVarianceForgetting(System::SystemPtr ptr, double lambda) {
+	_Window(noiseVarianceWindows, ptr->getID()) = std::make_shared<ExpForgetting<Eigen::MatrixXd>>(lambda,
+		SystemByID(ptr->getID())->getVariance(NOISE));
 }
 
 WAUKF::WAUKF(const BaseSystemData & data, const StatisticValue & state_) : SystemManager(data, state_),
-	noiseValueWindows(mapOfVectorWindows()), disturbanceValueWindows(mapOfVectorWindows()),
-	noiseVarianceWindows(mapOfMatrixWindows()), disturbanceVarianceWindows(mapOfMatrixWindows()) {}
+	noiseValueWindows(vectorOfVectorWindows()), disturbanceValueWindows(vectorOfVectorWindows()),
+	noiseVarianceWindows(vectorOfMatrixWindows()), disturbanceVarianceWindows(vectorOfMatrixWindows()) {}
 
 StatisticValue WAUKF::_evalWithV0(TimeUpdateType outType, double Ts,
-	const StatisticValue & state_, const StatisticValue & in, Eigen::MatrixXd & S_out_x,
+	const StatisticValue & state_, const BlockStatisticValue & inBlocks, Eigen::MatrixXd & S_out_x,
 	Eigen::MatrixXd & S_out_in, bool forcedOutput, StatisticValue & v0) const {
 	DataType inType = System::getInputValueType(outType, VAR_EXTERNAL);
 	Eigen::Index nX = num(STATE, forcedOutput);
@@ -86,6 +111,7 @@ StatisticValue WAUKF::_evalWithV0(TimeUpdateType outType, double Ts,
 	Eigen::MatrixXd Sz;
 	Eigen::MatrixXd Szx;
 	Eigen::MatrixXd Szw;
+	Eigen::VectorXd inVector = inBlocks.Vector();
 	if (stateDep.sum() + inDep.sum() == 0) {
 		z = Eigen::VectorXd::Zero(nOut);
 		Sz = Eigen::MatrixXd::Zero(nOut, nOut);
@@ -93,6 +119,8 @@ StatisticValue WAUKF::_evalWithV0(TimeUpdateType outType, double Ts,
 		Szw = Eigen::MatrixXd::Zero(nOut, nIn);
 	}
 	else {
+		// The sigma points need the dense covariance matrix
+		StatisticValue in = inBlocks.ToStatisticValue();
 		// Sigma values by applying partial chol
 		Eigen::MatrixXd dX = PartialChol(state_.variance, stateDep);
 		Eigen::MatrixXd dIn;
@@ -164,13 +192,14 @@ StatisticValue WAUKF::_evalWithV0(TimeUpdateType outType, double Ts,
 	Eigen::VectorXd y = A * state_.vector + z;
 
 	S_out_x = A * state_.variance + Szx;
-	S_out_in = B * in.variance + Szw;
+	// The disturbances/noises of the systems are independent: block-wise products
+	S_out_in = inBlocks.MultiplyVariance(B) + Szw;
 	Eigen::MatrixXd Sy = S_out_x * A.transpose() + Szw * B.transpose() +
 		Sz + A * Szx.transpose() + B * Szw.transpose();
 
 	v0 = StatisticValue(y, Sy);
-	Sy += B * in.variance * B.transpose();
-	y += B * in.vector;
+	Sy += inBlocks.TransformVariance(B);
+	y += B * inVector;
 	return StatisticValue(y, Sy);
 }
 
@@ -195,11 +224,11 @@ void WAUKF::Step(const DTime& dT) { // update, collect measurement, correction v
 	Eigen::MatrixXd sg1, sg2;
 	StatisticValue x_pred0, y_pred0;
 	StatisticValue x_pred = _evalWithV0(STATE_UPDATE, dT_sec, (*this)(STATE),
-		(*this)(DataType::DISTURBANCE), sg1, sg2, false, x_pred0);
+		getBlockValue(DataType::DISTURBANCE), sg1, sg2, false, x_pred0);
 	Eigen::MatrixXd Syxpred;
 	StatisticValue y_meas = (*this)(OUTPUT);
 	StatisticValue y_pred = _evalWithV0(OUTPUT_UPDATE, dT_sec, x_pred,
-		(*this)(DataType::NOISE), Syxpred, sg2, false, y_pred0);
+		getBlockValue(DataType::NOISE), Syxpred, sg2, false, y_pred0);
 
 	PredictionDone(x_pred, y_pred);
 	// Kalman-filtering
@@ -213,45 +242,49 @@ void WAUKF::Step(const DTime& dT) { // update, collect measurement, correction v
 	State() = newstate;
 
 	// Statistics estimation
-	Partitioner p = getPartitioner();
+	PartitionerPtr p = getPartitioner();
 	Eigen::VectorXd epsilon = y_meas.vector - y_pred.vector;
 	// DISTURBANCE
 	{
-		Eigen::MatrixXd pinvBbs = BaseSystem().getBaseSystemPtr()->getPInvB(dT_sec);
+		Eigen::MatrixXd pinvBbs = BaseSystem().getBaseSystemPtr()->getMatrix(MATRIX_PINV_B, dT_sec);
 		{ //Disturbance value estimation
 			Eigen::VectorXd value = newstate.vector - x_pred0.vector;
-			for (auto it = disturbanceValueWindows.begin(); it != disturbanceValueWindows.end(); it++) {
-				int index = _GetIndex(it->first);
-				Eigen::VectorXd v = pinvBbs * p.PartValue(DataType::STATE, value, -1);// partx_[0];
+			for (int index = -1; index + 1 < (int)disturbanceValueWindows.size(); index++) {
+				const auto& window = disturbanceValueWindows[index + 1];
+				if (!window)
+					continue;
+				Eigen::VectorXd v = pinvBbs * p->PartValue(DataType::STATE, value, -1);// partx_[0];
 				if (index != -1) { //basesystem
 					auto sys = Sensor(index);
 					Eigen::MatrixXd Bi0 = sys.getMatrixBaseSystem(dT_sec, STATE_UPDATE, VAR_EXTERNAL, true);
-					Eigen::MatrixXd pinvBi1 = sys.getSensorPtr()->getPInvBs(dT_sec);
-					v = pinvBi1 * (p.PartValue(DataType::STATE, value, index) - Bi0 * v);
+					Eigen::MatrixXd pinvBi1 = sys.getSensorPtr()->getMatrix(MATRIX_PINV_B, dT_sec);
+					v = pinvBi1 * (p->PartValue(DataType::STATE, value, index) - Bi0 * v);
 				}
-				it->second.AddValue(v);
+				window->AddValue(v);
 				if (index != -1)
-					Sensor(index).setValue(it->second.Value(), DISTURBANCE);
+					Sensor(index).setValue(window->Value(), DISTURBANCE);
 				else
-					BaseSystem().setValue(it->second.Value(), DISTURBANCE);
+					BaseSystem().setValue(window->Value(), DISTURBANCE);
 			}
 		}
 		{ // Disturbance variance
 			Eigen::MatrixXd value = K * epsilon;
 			value = newstate.variance + value * value.transpose() - x_pred0.variance;
-			for (auto it = disturbanceVarianceWindows.begin(); it != disturbanceVarianceWindows.end(); it++) {
-				int index = _GetIndex(it->first);
-				Eigen::MatrixXd v = pinvBbs * p.PartVariance(DataType::STATE, value, -1, -1) * pinvBbs.transpose();
+			for (int index = -1; index + 1 < (int)disturbanceVarianceWindows.size(); index++) {
+				const auto& window = disturbanceVarianceWindows[index + 1];
+				if (!window)
+					continue;
+				Eigen::MatrixXd v = pinvBbs * p->PartVariance(DataType::STATE, value, -1, -1) * pinvBbs.transpose();
 				if (index != -1) {
 					auto sys = Sensor(index);
 					Eigen::MatrixXd Bi0 = sys.getMatrixBaseSystem(dT_sec, STATE_UPDATE, VAR_EXTERNAL, true);
-					Eigen::MatrixXd v2 = Bi0 * pinvBbs * p.PartVariance(DataType::STATE, value, -1, index);
-					Eigen::MatrixXd pinvBi1 = sys.getSensorPtr()->getPInvBs(dT_sec);
+					Eigen::MatrixXd v2 = Bi0 * pinvBbs * p->PartVariance(DataType::STATE, value, -1, index);
+					Eigen::MatrixXd pinvBi1 = sys.getSensorPtr()->getMatrix(MATRIX_PINV_B, dT_sec);
 					v = pinvBi1 * (Bi0*v*Bi0.transpose() - v2 - v2.transpose() +
-						p.PartVariance(DataType::STATE, value, index, index))*pinvBi1.transpose();
+						p->PartVariance(DataType::STATE, value, index, index))*pinvBi1.transpose();
 				}
-				it->second.AddValue(DiagAndLimit(v, 0.00001));
-				Eigen::MatrixXd out = it->second.Value();
+				window->AddValue(DiagAndLimit(v, 0.00001));
+				Eigen::MatrixXd out = window->Value();
 				if (index != -1)
 					Sensor(index).setVariance(out, DISTURBANCE);
 				else
@@ -261,43 +294,47 @@ void WAUKF::Step(const DTime& dT) { // update, collect measurement, correction v
 	}
 	// NOISE
 	{
-		Eigen::MatrixXd pinvDbs = BaseSystem().getBaseSystemPtr()->getPInvD(dT_sec);
+		Eigen::MatrixXd pinvDbs = BaseSystem().getBaseSystemPtr()->getMatrix(MATRIX_PINV_D, dT_sec);
 		{ //Noise value estimation
 			Eigen::VectorXd value = y_meas.vector - y_pred0.vector;
-			for (auto it = noiseValueWindows.begin(); it != noiseValueWindows.end(); it++) {
-				int index = _GetIndex(it->first);
+			for (int index = -1; index + 1 < (int)noiseValueWindows.size(); index++) {
+				const auto& window = noiseValueWindows[index + 1];
+				if (!window)
+					continue;
 				if (isAvailable(index)) {
-					Eigen::VectorXd v = pinvDbs * p.PartValue(DataType::OUTPUT, value, -1);// partx_[0];
+					Eigen::VectorXd v = pinvDbs * p->PartValue(DataType::OUTPUT, value, -1);// partx_[0];
 					if (index != -1) { //basesystem
 						auto sys = Sensor(index);
 						Eigen::MatrixXd Di0 = sys.getMatrixBaseSystem(dT_sec, OUTPUT_UPDATE, VAR_EXTERNAL, true);
-						Eigen::MatrixXd pinvDi1 = sys.getSensorPtr()->getPInvDs(dT_sec);
-						v = pinvDi1 * (p.PartValue(DataType::OUTPUT, value, index) - Di0 * v);
+						Eigen::MatrixXd pinvDi1 = sys.getSensorPtr()->getMatrix(MATRIX_PINV_D, dT_sec);
+						v = pinvDi1 * (p->PartValue(DataType::OUTPUT, value, index) - Di0 * v);
 					}
-					it->second.AddValue(v);
+					window->AddValue(v);
 					if (index != -1)
-						Sensor(index).setValue(it->second.Value(), NOISE);
+						Sensor(index).setValue(window->Value(), NOISE);
 					else
-						BaseSystem().setValue(it->second.Value(), NOISE);
+						BaseSystem().setValue(window->Value(), NOISE);
 				}
 			}
 		}
 		{ // Noise variance
 			Eigen::MatrixXd value = epsilon * epsilon.transpose() - y_pred0.variance;
-			for (auto it = noiseVarianceWindows.begin(); it != noiseVarianceWindows.end(); it++) {
-				int index = _GetIndex(it->first);
+			for (int index = -1; index + 1 < (int)noiseVarianceWindows.size(); index++) {
+				const auto& window = noiseVarianceWindows[index + 1];
+				if (!window)
+					continue;
 				if (isAvailable(index)) {
-					Eigen::MatrixXd v = pinvDbs * p.PartVariance(OUTPUT, value, -1, -1) * pinvDbs.transpose();
+					Eigen::MatrixXd v = pinvDbs * p->PartVariance(OUTPUT, value, -1, -1) * pinvDbs.transpose();
 					if (index != -1) { //basesystem
 						auto sys = Sensor(index);
 						Eigen::MatrixXd Di0 = sys.getMatrixBaseSystem(dT_sec, OUTPUT_UPDATE, VAR_EXTERNAL, true);
-						Eigen::MatrixXd v2 = Di0 * pinvDbs * p.PartVariance(OUTPUT, value, -1, index); // index sorrend?
-						Eigen::MatrixXd pinvDi1 = sys.getSensorPtr()->getPInvDs(dT_sec);
+						Eigen::MatrixXd v2 = Di0 * pinvDbs * p->PartVariance(OUTPUT, value, -1, index); // index sorrend?
+						Eigen::MatrixXd pinvDi1 = sys.getSensorPtr()->getMatrix(MATRIX_PINV_D, dT_sec);
 						v = pinvDi1 * (Di0*v*Di0.transpose() - v2 - v2.transpose() +
-							p.PartVariance(OUTPUT, value, index, index))*pinvDi1.transpose();
+							p->PartVariance(OUTPUT, value, index, index))*pinvDi1.transpose();
 					}
-					it->second.AddValue(v);
-					Eigen::MatrixXd res = DiagAndLimit(it->second.Value(), 0.00001);
+					window->AddValue(v);
+					Eigen::MatrixXd res = DiagAndLimit(window->Value(), 0.00001);
 					//std::cout << "S_vv_0: \n" << res << std::endl;
 					if (index != -1)
 						Sensor(index).setVariance(res, NOISE);
@@ -311,6 +348,20 @@ void WAUKF::Step(const DTime& dT) { // update, collect measurement, correction v
 	resetMeasurement();
 }
 
+void WAUKF::RemoveSensor(unsigned int ID) {
+	int index = _FindIndex(ID);
+	SystemManager::RemoveSensor(ID);
+	// The indices of the next sensors are decreased
+	auto erase = [index](auto& windows) {
+		if ((int)windows.size() > index + 1)
+			windows.erase(windows.begin() + index + 1);
+	};
+	erase(noiseValueWindows);
+	erase(disturbanceValueWindows);
+	erase(noiseVarianceWindows);
+	erase(disturbanceVarianceWindows);
+}
+
 bool WAUKF::SaveDataMsg(const DataMsg& data, const Time& t) {
 	auto data_ = data;
 	if (_isEstimated(data.GetSourceID(), data.GetDataType(), VALUE))
@@ -320,6 +371,15 @@ bool WAUKF::SaveDataMsg(const DataMsg& data, const Time& t) {
 	return SystemManager::SaveDataMsg(data_, t);
 }
 
+bool WAUKF::SaveDataMsg(const DataMsgView& data, const Time& t) {
+	auto data_ = data;
+	if (_isEstimated(data.GetSourceID(), data.GetDataType(), VALUE))
+		data_.ClearValue();
+	if (_isEstimated(data.GetSourceID(), data.GetDataType(), VARIANCE))
+		data_.ClearVariance();
+	return SystemManager::SaveDataMsg(data_, t);
+}
+
 void SF::WAUKF::SamplingTimeOver(const Time & currentTime) {
 	if (firstStep) {
 		firstStep = false;
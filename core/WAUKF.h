@@ -1,6 +1,7 @@
-﻿#include "SystemManager.h"
+﻿#pragma once
+#include "SystemManager.h"
 #include "Eigen/Dense"
-#include <map>
+#include <vector>
 
 namespace SF {
 
@@ -8,23 +9,58 @@ namespace SF {
 
 	enum ValueType { VALUE, VARIANCE };
 
-	/*! \brief Moving average window implementation
+	/*! \brief Interface of the recursive estimators of the disturbance/noise values and variances
 	*
 	*  Type can be Eigen::VectorXd or Eigen::MatrixXd
 	*/
 	template<class Type>
-	class MAWindow {
-		Type data[MAX_WINDOW_SIZE]; /*!< Buffer*/
+	class Estimator {
+	public:
+		virtual ~Estimator() {}
+		virtual const Type& Value() = 0;  /*!< Get the actual result */
+		virtual void AddValue(const Type& value) = 0;  /*!< Add a new value */
+	};
+
+	/*! \brief Moving average window implementation
+	*
+	*  Type can be Eigen::VectorXd or Eigen::MatrixXd (symmetric matrices are assumed, only the upper triangle is stored).
+	*  The sum of the window is updated with the new and the dropped element, so the cost of AddValue() does not depend on the window size.
+	*/
+	template<class Type>
+	class MAWindow : public Estimator<Type> {
+		std::vector<Eigen::VectorXd> data; /*!< Buffer of the packed values */
+		Eigen::VectorXd sum; /*!< Sum of the packed values in the buffer */
 		Type out; /*!< Last result*/
 		bool upToDate; /*!< Last result is uptodate*/
 		bool initialized; /*!< If it is initialized*/
 		unsigned int lastWritten; /*!< Index of the latest element */
 		unsigned int windowSize; /*!< Used windowsize */
+		unsigned int nSinceResum; /*!< Number of updates since the sum was recomputed (to avoid the accumulation of rounding errors) */
+		Eigen::Index rows; /*!< Size of the values */
+
+		void _Init(const Type& value); /*!< Fill the buffer with the value */
 	public:
 		MAWindow(unsigned int windowSize_, const Type& initValue); /*!< Constructor with initialization */
 		MAWindow(unsigned int windowSize_ = 100);  /*!< Constructor without initialization */
-		const Type& Value();  /*!< Get the actual result */
-		void AddValue(const Type& value);  /*!< Add a new value */
+		const Type& Value() override;  /*!< Get the actual result */
+		void AddValue(const Type& value) override;  /*!< Add a new value */
+	};
+
+	/*! \brief Recursive estimator with exponential forgetting
+	*
+	*  Value = lambda * Value + (1 - lambda) * value for each new value, so only the last result is stored.
+	*  Type can be Eigen::VectorXd or Eigen::MatrixXd
+	*/
+	template<class Type>
+	class ExpForgetting : public Estimator<Type> {
+		Type out; /*!< Last result*/
+		double lambda; /*!< Forgetting factor */
+		bool initialized; /*!< If it is initialized*/
+	public:
+		ExpForgetting(double lambda_, const Type& initValue); /*!< Constructor with initialization */
+		ExpForgetting(double lambda_);  /*!< Constructor without initialization: the first value is taken as it is */
+		const Type& Value() override;  /*!< Get the actual result */
+		void AddValue(const Type& value) override;  /*!< Add a new value */
 	};
 
 	/*! \brief Class to perform Kalman-filtering with windowing based parameter estimation on complex asynchronous multisensor systems
@@ -89,6 +125,18 @@ namespace SF {
 		void SetNoiseVarianceWindowing(System::SystemPtr ptr, unsigned int windowSize);
 		/*!< Add a window to estimate \f$ \Sigma_{vv}\f$ noise variance for a given System (= BaseSystem or Sensor) with given window size.*/
 
+		void SetDisturbanceValueForgetting(System::SystemPtr ptr, double lambda);
+		/*!< Estimate \f$ \mathbf w_i\f$ disturbance value for a given System with exponential forgetting (instead of a window).*/
+
+		void SetNoiseValueForgetting(System::SystemPtr ptr, double lambda);
+		/*!< Estimate \f$ \mathbf v_i\f$ noise value for a given System with exponential forgetting (instead of a window).*/
+
+		void SetDisturbanceVarianceForgetting(System::SystemPtr ptr, double lambda);
+		/*!< Estimate \f$ \Sigma_{ww}\f$ disturbance variance for a given System with exponential forgetting (instead of a window).*/
+
+		void SetNoiseVarianceForgetting(System::SystemPtr ptr, double lambda);
+		/*!< Estimate \f$ \Sigma_{vv}\f$ noise variance for a given System with exponential forgetting (instead of a window).*/
+
 		typedef std::shared_ptr<WAUKF> WAUKFPtr; /*!< Shared pointer type for the WAUKF class */
 
 		/*! \brief Time update with the given dT and Kalman-filter based on the available sensors
@@ -109,53 +157,92 @@ namespace SF {
 		*/
 		bool SaveDataMsg(const DataMsg& data, const Time&) override;
 
+		bool SaveDataMsg(const DataMsgView& data, const Time&) override; /*!< The same for a recieved msg read in place */
+
+		void RemoveSensor(unsigned int ID) override; /*!< Remove the sensor and its windows */
+
 	private:
-		typedef std::map<unsigned int, MAWindow<Eigen::VectorXd>> mapOfVectorWindows;
-		typedef std::map<unsigned int, MAWindow<Eigen::MatrixXd>> mapOfMatrixWindows;
+		// The estimators of the systems by index + 1 (the basesystem is the first), nullptr if not estimated
+		typedef std::vector<std::shared_ptr<Estimator<Eigen::VectorXd>>> vectorOfVectorWindows;
+		typedef std::vector<std::shared_ptr<Estimator<Eigen::MatrixXd>>> vectorOfMatrixWindows;
 
-		mapOfVectorWindows noiseValueWindows;
-		mapOfVectorWindows disturbanceValueWindows;
-		mapOfMatrixWindows noiseVarianceWindows;
-		mapOfMatrixWindows disturbanceVarianceWindows;
+		vectorOfVectorWindows noiseValueWindows;
+		vectorOfVectorWindows disturbanceValueWindows;
+		vectorOfMatrixWindows noiseVarianceWindows;
+		vectorOfMatrixWindows disturbanceVarianceWindows;
 
-		const mapOfVectorWindows& _getValueWindows(DataType signal) const;
-		const mapOfMatrixWindows& _getVarianceWindows(DataType signal) const;
+		const vectorOfVectorWindows& _getValueWindows(DataType signal) const;
+		const vectorOfMatrixWindows& _getVarianceWindows(DataType signal) const;
 		bool _isEstimated(unsigned int systemID, DataType signal, ValueType type) const;
 
+		template<class Type>
+		std::shared_ptr<Estimator<Type>>& _Window(std::vector<std::shared_ptr<Estimator<Type>>>& windows, unsigned int ID); /*!< The estimator of the system (for setting it) */
+
 		StatisticValue _evalWithV0(TimeUpdateType outType, double Ts, const StatisticValue& state_,
-			const StatisticValue& in, Eigen::MatrixXd & S_out_x, Eigen::MatrixXd& S_out_in,
+			const BlockStatisticValue& inBlocks, Eigen::MatrixXd & S_out_x, Eigen::MatrixXd& S_out_in,
 			bool forcedOutput, StatisticValue& v0) const;
 	};
 
+	namespace detail {
+		// Packing of the stored values: vectors as they are, matrices by their upper triangle
+		inline Eigen::VectorXd _Pack(const Eigen::VectorXd& value) { return value; }
+
+		inline Eigen::VectorXd _Pack(const Eigen::MatrixXd& value) {
+			Eigen::VectorXd out(value.rows() * (value.rows() + 1) / 2);
+			Eigen::Index k = 0;
+			for (Eigen::Index j = 0; j < value.cols(); j++) {
+				out.segment(k, j + 1) = value.col(j).head(j + 1);
+				k += j + 1;
+			}
+			return out;
+		}
+
+		inline void _Unpack(const Eigen::VectorXd& packed, Eigen::Index rows, Eigen::VectorXd& out) { out = packed; }
+
+		inline void _Unpack(const Eigen::VectorXd& packed, Eigen::Index rows, Eigen::MatrixXd& out) {
+			out.resize(rows, rows);
+			Eigen::Index k = 0;
+			for (Eigen::Index j = 0; j < rows; j++) {
+				out.col(j).head(j + 1) = packed.segment(k, j + 1);
+				out.row(j).head(j) = packed.segment(k, j).transpose();
+				k += j + 1;
+			}
+		}
+	}
+
 	template<class Type>
 	inline MAWindow<Type>::MAWindow(unsigned int windowSize_, const Type & initValue) :
-		windowSize(windowSize_), initialized(true), lastWritten(0) {
+		windowSize(windowSize_), initialized(true), lastWritten(0), nSinceResum(0) {
 		if (windowSize > MAX_WINDOW_SIZE)
 			throw std::runtime_error(std::string("MAWindow::MAWindow Wrong window size to be applied!"));
-		out = initValue;
-		upToDate = true;
-		initialized = true;
-		for (unsigned int n = 0; n < MAX_WINDOW_SIZE; n++)
-			data[n] = initValue;
+		_Init(initValue);
 	}
 
 	template<class Type>
 	inline MAWindow<Type>::MAWindow(unsigned int windowSize_) :
-		windowSize(windowSize_), initialized(false), lastWritten(0), upToDate(false) {}
+		windowSize(windowSize_), initialized(false), lastWritten(0), upToDate(false), nSinceResum(0) {
+		if (windowSize > MAX_WINDOW_SIZE)
+			throw std::runtime_error(std::string("MAWindow::MAWindow Wrong window size to be applied!"));
+	}
+
+	template<class Type>
+	inline void MAWindow<Type>::_Init(const Type & value) {
+		out = value;
+		upToDate = true;
+		initialized = true;
+		rows = value.rows();
+		Eigen::VectorXd packed = detail::_Pack(value);
+		data.assign(windowSize, packed);
+		sum = packed * windowSize;
+		nSinceResum = 0;
+	}
 
 	template<class Type>
 	inline const Type & MAWindow<Type>::Value() {
 		if (!initialized)
 			throw std::runtime_error(std::string("MAWindow::Value Getter cannot be applied before initialization!"));
 		if (!upToDate) {
-			out = out * 0;
-			int starter = lastWritten;
-			for (int n = 0; n < (int)windowSize; n++) {
-				if (starter - n < 0)
-					starter += MAX_WINDOW_SIZE;
-				out += data[starter - n];
-			}
-			out /= windowSize;
+			detail::_Unpack(sum / windowSize, rows, out);
 			upToDate = true;
 		}
 		return out;
@@ -166,9 +253,18 @@ namespace SF {
 		if (initialized) {
 			if (windowSize > 0) {
 				lastWritten++;
-				if (lastWritten >= MAX_WINDOW_SIZE)
+				if (lastWritten >= windowSize)
 					lastWritten = 0;
-				data[lastWritten] = value;
+				Eigen::VectorXd packed = detail::_Pack(value);
+				// Replace the oldest element in the sum
+				sum += packed - data[lastWritten];
+				data[lastWritten] = packed;
+				if (++nSinceResum >= windowSize) {
+					sum.setZero();
+					for (const Eigen::VectorXd& d : data)
+						sum += d;
+					nSinceResum = 0;
+				}
 				upToDate = false;
 			}
 			else {
@@ -176,12 +272,38 @@ namespace SF {
 				upToDate = true;
 			}
 		}
+		else
+			_Init(value);
+	}
+
+	template<class Type>
+	inline ExpForgetting<Type>::ExpForgetting(double lambda_, const Type & initValue) :
+		out(initValue), lambda(lambda_), initialized(true) {
+		if (lambda <= 0 || lambda > 1)
+			throw std::runtime_error(std::string("ExpForgetting::ExpForgetting Wrong forgetting factor to be applied!"));
+	}
+
+	template<class Type>
+	inline ExpForgetting<Type>::ExpForgetting(double lambda_) :
+		lambda(lambda_), initialized(false) {
+		if (lambda <= 0 || lambda > 1)
+			throw std::runtime_error(std::string("ExpForgetting::ExpForgetting Wrong forgetting factor to be applied!"));
+	}
+
+	template<class Type>
+	inline const Type & ExpForgetting<Type>::Value() {
+		if (!initialized)
+			throw std::runtime_error(std::string("ExpForgetting::Value Getter cannot be applied before initialization!"));
+		return out;
+	}
+
+	template<class Type>
+	inline void ExpForgetting<Type>::AddValue(const Type & value) {
+		if (initialized)
+			out = lambda * out + (1. - lambda) * value;
 		else {
 			out = value;
-			upToDate = true;
 			initialized = true;
-			for (unsigned int n = 0; n < MAX_WINDOW_SIZE; n++)
-				data[n] = value;
 		}
 	}
 
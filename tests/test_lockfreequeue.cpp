@@ -0,0 +1,94 @@
+#include "common/unity.h"
+void setUp() {}
+void tearDown() {}
+
+#include <thread>
+#include <vector>
+#include"LockFreeQueue.h"
+#include"DataMsg.h"
+
+using namespace SF;
+
+void spscOrderTest() {
+	SPSCQueue<int> queue(5);
+	TEST_ASSERT_EQUAL_INT(8, queue.Capacity());
+	const int N = 100000;
+	std::thread producer([&queue]() {
+		for (int i = 0; i < N; i++)
+			while (!queue.TryPush(i))
+				std::this_thread::yield();
+	});
+	for (int i = 0; i < N; i++) {
+		int* x;
+		while ((x = queue.Front()) == nullptr)
+			std::this_thread::yield();
+		TEST_ASSERT_EQUAL_INT(i, *x);
+		queue.Pop();
+	}
+	producer.join();
+	TEST_ASSERT(queue.Front() == nullptr);
+}
+
+void fullTest() {
+	MPSCQueue<int> queue(4);
+	for (int i = 0; i < 4; i++)
+		TEST_ASSERT(queue.TryPush(i));
+	TEST_ASSERT(!queue.TryPush(4));
+	TEST_ASSERT_EQUAL_INT(4, queue.Size());
+	queue.Pop();
+	TEST_ASSERT(queue.TryPush(4));
+	TEST_ASSERT_EQUAL_INT(1, *queue.Front());
+}
+
+void mpscTest() {
+	MPSCQueue<int> queue(64);
+	const int nProducers = 4, N = 20000;
+	std::vector<std::thread> producers;
+	for (int p = 0; p < nProducers; p++)
+		producers.push_back(std::thread([&queue, p]() {
+			for (int i = 0; i < N; i++)
+				while (!queue.TryPush(p * N + i))
+					std::this_thread::yield();
+		}));
+	// every element arrives once, in order per producer
+	std::vector<int> last(nProducers, -1);
+	for (int k = 0; k < nProducers * N; k++) {
+		int* x;
+		while ((x = queue.Front()) == nullptr)
+			std::this_thread::yield();
+		int p = *x / N;
+		TEST_ASSERT(*x % N > last[p]);
+		last[p] = *x % N;
+		queue.Pop();
+	}
+	for (auto& t : producers)
+		t.join();
+	for (int p = 0; p < nProducers; p++)
+		TEST_ASSERT_EQUAL_INT(N - 1, last[p]);
+}
+
+void slotReuseTest() {
+	// The storage of the DataMsg in the slot is reused if the size is the same
+	SPSCQueue<DataMsg> queue(1);
+	DataMsg d(1, OUTPUT, SENSOR);
+	d.SetValueVector(Eigen::VectorXd::Ones(6));
+	const double* storage = nullptr;
+	for (int i = 0; i < 3 * static_cast<int>(queue.Capacity()); i++) {
+		TEST_ASSERT(queue.TryPush(d));
+		if (i == static_cast<int>(queue.Capacity()))
+			storage = queue.Front()->GetValue().data();
+		if (i > static_cast<int>(queue.Capacity()) && i % queue.Capacity() == 0)
+			TEST_ASSERT(storage == queue.Front()->GetValue().data());
+		TEST_ASSERT(*queue.Front() == d);
+		queue.Pop();
+	}
+}
+
+int main (void) {
+	UNITY_BEGIN();
+	RUN_TEST([]() { spscOrderTest(); });
+	RUN_TEST([]() { fullTest(); });
+	RUN_TEST([]() { mpscTest(); });
+	RUN_TEST([]() { slotReuseTest(); });
+	return UNITY_END();
+}
@@ -3,8 +3,13 @@ void setUp() {}
 void tearDown() {}
 
 #include <thread>
+#include <atomic>
 #include <iostream>
+#include <random>
 #include"SystemManager.h"
+#include"KalmanFilter.h"
+#include"WAUKF.h"
+#include"CompositeBaseSystem.h"
 
 using namespace SF;
 
@@ -13,6 +18,12 @@ class SystemManagerTester : public SystemManager {
 public:
 	SystemManagerTester(const BaseSystemData& data, const StatisticValue& state_) : SystemManager(data,state_) {}
 
+	using SystemManager::Eval;
+	using SystemManager::EvalNonLinPart;
+	using SystemManager::getPartitioner;
+	using SystemManager::SystemByID;
+	using SystemManager::Sensor;
+
 	void SamplingTimeOver(const Time& currentTime) override {}; /*!< Is called in each sampling time - input: time */
 
 	void MsgQueueEmpty(const Time& currentTime) override {}; /*!< Is called if the DataMsgs in the queue were read */
@@ -121,8 +132,974 @@ void linearTest() {
 		TEST_ASSERT(0);
 }
 
+class TestSensor : public Sensor {
+	bool coupled;
+public:
+	TestSensor(BaseSystem::BaseSystemPtr ptr, unsigned int ID, bool coupled_) : Sensor(ptr, ID), coupled(coupled_) {}
+
+	Eigen::MatrixXd getAs_bs(double Ts) const {
+		Eigen::MatrixXd out = Eigen::MatrixXd::Zero(2, 6);
+		if (coupled)
+			out(0, 0) = Ts;
+		return out;
+	}
+
+	Eigen::MatrixXd getAs(double Ts) const {
+		Eigen::MatrixXd out(2, 2);
+		out << 1, Ts, 0, 1;
+		return out;
+	}
+
+	Eigen::MatrixXd getBs_bs(double Ts) const { return Eigen::MatrixXd::Zero(2, 3); }
+
+	Eigen::MatrixXd getBs(double Ts) const { return Eigen::MatrixXd::Identity(2, 2); }
+
+	Eigen::MatrixXd getCs_bs(double Ts) const { return Eigen::MatrixXd::Zero(1, 6); }
+
+	Eigen::MatrixXd getCs(double Ts) const { return Eigen::MatrixXd::Identity(1, 2); }
+
+	Eigen::MatrixXd getDs_bs(double Ts) const { return Eigen::MatrixXd::Zero(1, 0); }
+
+	Eigen::MatrixXd getDs(double Ts) const { return Eigen::MatrixXd::Identity(1, 1); }
+
+	bool isCompatible(BaseSystem::BaseSystemPtr ptr) const { return true; }
+
+	unsigned int getNumOfStates() const { return 2; }
+
+	unsigned int getNumOfDisturbances() const { return 2; }
+
+	unsigned int getNumOfOutputs() const { return 1; }
+
+	unsigned int getNumOfNoises() const { return 1; }
+};
+
+KalmanFilter::KalmanFilterPtr createKalmanFilter(BaseSystem::BaseSystemPtr baseSystem = std::make_shared<TestBaseSystem>()) {
+	Eigen::MatrixXd Sw = Eigen::MatrixXd::Identity(3, 3);
+	StatisticValue in(Eigen::VectorXd::Zero(3), Sw);
+	SystemManager::BaseSystemData bsData(baseSystem, StatisticValue(0), in);
+	StatisticValue state(Eigen::VectorXd::Zero(6), Eigen::MatrixXd::Identity(6, 6));
+	auto filter = std::make_shared<KalmanFilter>(bsData, state);
+	for (unsigned int i = 0; i < 4; i++) {
+		SystemManager::SensorData sData(std::make_shared<TestSensor>(baseSystem, i + 1, i % 2 == 0),
+			StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+			StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2) * 0.01));
+		filter->AddSensor(sData, StatisticValue(Eigen::VectorXd::Ones(2), Eigen::MatrixXd::Identity(2, 2)));
+	}
+	return filter;
+}
+
+void decompositionTest() {
+	auto decomposed = createKalmanFilter();
+	auto full = createKalmanFilter();
+	full->SetDecomposition(false);
+	// Components: basesystem with sensor 0 and 2, sensor 1, sensor 3
+	auto components = decomposed->getComponents();
+	TEST_ASSERT_EQUAL_INT(3, components.size());
+	TEST_ASSERT_EQUAL_INT(3, components[0].size());
+	TEST_ASSERT_EQUAL_INT(1, components[1][0]);
+	TEST_ASSERT_EQUAL_INT(3, components[2][0]);
+	auto pool = std::make_shared<WorkStealingPool>(2);
+	decomposed->SetParallelComponents(pool, 0);
+	for (int k = 0; k < 10; k++) {
+		for (unsigned int id = 1; id <= 4; id++)
+			if ((k + id) % 2 == 0) {
+				Eigen::VectorXd y(1);
+				y << k * 0.1 + id;
+				DataMsg msg(id, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1));
+				decomposed->SaveDataMsg(msg);
+				full->SaveDataMsg(msg);
+			}
+		decomposed->Step(DTime(10000));
+		full->Step(DTime(10000));
+	}
+	for (int i = -1; i < 4; i++) {
+		DataMsg a = decomposed->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+		DataMsg b = full->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+		TEST_ASSERT((a.GetValue() - b.GetValue()).cwiseAbs().maxCoeff() < 1e-9);
+		TEST_ASSERT((a.GetVariance() - b.GetVariance()).cwiseAbs().maxCoeff() < 1e-9);
+	}
+}
+
+void removeSensorTest() {
+	auto filter = createKalmanFilter();
+	for (int k = 0; k < 3; k++) {
+		Eigen::VectorXd y(1);
+		y << k * 0.1;
+		filter->SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+		filter->Step(DTime(10000));
+	}
+	DataMsg before = filter->GetDataByIndex(2, STATE, FILTER_MEAS_UPDATE);
+	filter->RemoveSensor(2);
+	TEST_ASSERT_EQUAL_INT(3, filter->nSensors());
+	// Components: basesystem with sensor 0 and 1 (ID 3), sensor 2 (ID 4)
+	TEST_ASSERT_EQUAL_INT(2, filter->getComponents().size());
+	// The state of the remaining systems is kept
+	DataMsg after = filter->GetDataByIndex(1, STATE, FILTER_MEAS_UPDATE);
+	TEST_ASSERT_EQUAL_INT(3, after.GetSourceID());
+	TEST_ASSERT((before.GetValue() - after.GetValue()).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((before.GetVariance() - after.GetVariance()).cwiseAbs().maxCoeff() < 1e-12);
+	bool thrown = false;
+	try {
+		filter->RemoveSensor(2);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// Plug it in again and filter with it
+	SystemManager::SensorData sData(std::make_shared<TestSensor>(std::make_shared<TestBaseSystem>(), 2, false),
+		StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+		StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2) * 0.01));
+	filter->AddSensor(sData, StatisticValue(Eigen::VectorXd::Ones(2), Eigen::MatrixXd::Identity(2, 2)));
+	TEST_ASSERT_EQUAL_INT(4, filter->nSensors());
+	Eigen::VectorXd y(1);
+	y << 2;
+	filter->SaveDataMsg(DataMsg(2, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+	filter->Step(DTime(10000));
+	DataMsg added = filter->GetDataByIndex(3, STATE, FILTER_MEAS_UPDATE);
+	TEST_ASSERT_EQUAL_INT(2, added.GetSourceID());
+	TEST_ASSERT_EQUAL_INT(2, added.GetValue().size());
+}
+
+void statisticValueGrowthTest() {
+	Eigen::MatrixXd L = Eigen::MatrixXd::Random(4, 4);
+	StatisticValue value(Eigen::VectorXd::Random(4), L * L.transpose());
+	StatisticValue a(Eigen::VectorXd::Random(2), Eigen::MatrixXd::Identity(2, 2) * 2);
+	StatisticValue b(Eigen::VectorXd::Random(3), Eigen::MatrixXd::Identity(3, 3) * 3);
+	Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(9, 9);
+	expected.topLeftCorner(4, 4) = value.variance;
+	expected.block(4, 4, 2, 2) = a.variance;
+	expected.block(6, 6, 3, 3) = b.variance;
+	Eigen::VectorXd expectedVector(9);
+	expectedVector << value.vector, a.vector, b.vector;
+	// Appends are done in place after a geometric growth
+	value.Add(a);
+	TEST_ASSERT_EQUAL_INT(8, value.variance.Capacity());
+	value.Add(b);
+	TEST_ASSERT_EQUAL_INT(16, value.variance.Capacity());
+	TEST_ASSERT(value.variance == expected);
+	TEST_ASSERT(value.vector == expectedVector);
+	// Removal in place, the capacity is kept
+	const double* storage = value.variance.data();
+	Eigen::Index capacity = value.variance.Capacity();
+	value.Remove(4, 2);
+	TEST_ASSERT(value.variance.data() == storage);
+	TEST_ASSERT_EQUAL_INT(capacity, value.variance.Capacity());
+	TEST_ASSERT_EQUAL_INT(7, value.Length());
+	Eigen::MatrixXd removed(7, 7);
+	removed << expected.topLeftCorner(4, 4), expected.topRightCorner(4, 3),
+		expected.bottomLeftCorner(3, 4), expected.bottomRightCorner(3, 3);
+	TEST_ASSERT(value.variance == removed);
+	TEST_ASSERT(value.vector == (Eigen::VectorXd(7) << expectedVector.head(4), expectedVector.tail(3)).finished());
+	// Adding back fits into the capacity
+	value.Add(a);
+	TEST_ASSERT(value.variance.data() == storage);
+	TEST_ASSERT(value.variance.bottomRightCorner(2, 2) == a.variance);
+	TEST_ASSERT(value.variance.topRightCorner(7, 2).isZero(0));
+	// Copies get the values only, assignments keep the capacity
+	StatisticValue copy = value;
+	TEST_ASSERT_EQUAL_INT(9, copy.variance.Capacity());
+	TEST_ASSERT(copy.variance == value.variance);
+	StatisticValue zero(3);
+	value = zero;
+	TEST_ASSERT(value.variance.data() == storage);
+	TEST_ASSERT(value.variance.isZero(0) && value.variance.rows() == 3);
+}
+
+// Maximal difference of the filtered states of the two filters after a step with given jitter
+double speculativeStep(KalmanFilter::KalmanFilterPtr speculative, KalmanFilter::KalmanFilterPtr reference,
+	const Time& tNext, DTime jitter, bool changeDisturbance) {
+	speculative->PrepareStep(tNext);
+	std::vector<DataMsg> msgs;
+	Eigen::VectorXd y(1);
+	y << 0.3;
+	msgs.push_back(DataMsg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+	msgs.push_back(DataMsg(2, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+	if (changeDisturbance)
+		msgs.push_back(DataMsg(3, DISTURBANCE, SENSOR, StatisticValue(Eigen::VectorXd::Ones(2), Eigen::MatrixXd::Identity(2, 2))));
+	for (const DataMsg& msg : msgs) {
+		speculative->SaveDataMsg(msg);
+		reference->SaveDataMsg(msg);
+	}
+	speculative->SamplingTimeOver(tNext + jitter);
+	reference->SamplingTimeOver(tNext + jitter);
+	double diff = 0;
+	for (int i = -1; i < 4; i++) {
+		DataMsg a = speculative->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+		DataMsg b = reference->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+		diff = std::max(diff, (a.GetValue() - b.GetValue()).cwiseAbs().maxCoeff());
+		diff = std::max(diff, (a.GetVariance() - b.GetVariance()).cwiseAbs().maxCoeff());
+	}
+	return diff;
+}
+
+void speculativePredictionTest() {
+	auto speculative = createKalmanFilter();
+	auto reference = createKalmanFilter();
+	speculative->SetSpeculativePrediction(true);
+	Time t = Now();
+	DTime Ts(10000);
+	speculative->SamplingTimeOver(t);
+	reference->SamplingTimeOver(t);
+	// Exact sampling: same results
+	t += Ts;
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(0), false) < 1e-9);
+	// Jitter without tolerance: the state update is recomputed
+	t += Ts;
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(500), false) < 1e-9);
+	t += Ts;
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(-500), false) < 1e-9);
+	t += Ts;
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(0), false) < 1e-9);
+	// With tolerance: earlier step, too large jitter or changed disturbance - the state update is recomputed
+	speculative = createKalmanFilter();
+	reference = createKalmanFilter();
+	speculative->SetSpeculativePrediction(true, DTime(1000));
+	t = Now();
+	speculative->SamplingTimeOver(t);
+	reference->SamplingTimeOver(t);
+	t += Ts;
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(-500), false) < 1e-9);
+	t += Ts;
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(5000), false) < 1e-9);
+	t += Ts + DTime(5000);
+	TEST_ASSERT(speculativeStep(speculative, reference, t, DTime(500), true) < 1e-9);
+}
+
+class TsRecordingSensor : public TestSensor {
+public:
+	mutable std::vector<double> propagations; // the Ts of the state updates
+	TsRecordingSensor(BaseSystem::BaseSystemPtr ptr, unsigned int ID) : TestSensor(ptr, ID, false) {}
+	Eigen::MatrixXd getAs(double Ts) const {
+		propagations.push_back(Ts);
+		return TestSensor::getAs(Ts);
+	}
+};
+
+void speculativeDecimationTest() {
+	auto filter = createKalmanFilter();
+	auto sensor = std::make_shared<TsRecordingSensor>(std::make_shared<TestBaseSystem>(), 5);
+	filter->AddSensor(SystemManager::SensorData(sensor, StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+		StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2) * 0.01)),
+		StatisticValue(Eigen::VectorXd::Ones(2), Eigen::MatrixXd::Identity(2, 2)));
+	filter->SetSpeculativePrediction(true, DTime(1000));
+	filter->SetPropagationDecimation(5, 3);
+	sensor->propagations.clear();
+	// Late steps: the speculation propagates the held time and the step the remaining time only
+	Time t = Now();
+	DTime Ts(10000);
+	filter->SamplingTimeOver(t);
+	Time last = t;
+	for (int k = 0; k < 6; k++) {
+		t += Ts;
+		filter->PrepareStep(t);
+		last = t + DTime(500);
+		filter->SamplingTimeOver(last);
+	}
+	double propagated = 0;
+	for (double Tsi : sensor->propagations)
+		propagated += Tsi;
+	// propagated twice (speculated + remaining time), the time until the last propagation (5th step) is covered once
+	TEST_ASSERT_EQUAL_INT(4, sensor->propagations.size());
+	TEST_ASSERT(std::abs(sensor->propagations[1] - 0.0005) < 1e-12);
+	TEST_ASSERT(std::abs(sensor->propagations[3] - 0.0005) < 1e-12);
+	TEST_ASSERT(std::abs(propagated - 0.0505) < 1e-12);
+	// Changed decimation after the speculation: the state update is recomputed, so the sensor (ID 4) is held
+	t += Ts;
+	filter->PrepareStep(t);
+	DataMsg before = filter->GetDataByIndex(3, STATE, FILTER_MEAS_UPDATE);
+	filter->SetPropagationDecimation(4, 2);
+	filter->SamplingTimeOver(t + DTime(500));
+	DataMsg held = filter->GetDataByIndex(3, STATE, FILTER_MEAS_UPDATE);
+	TEST_ASSERT((held.GetValue() - before.GetValue()).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((held.GetVariance() - before.GetVariance()).cwiseAbs().maxCoeff() < 1e-15);
+	// Added sensor after the speculation: the state update is recomputed with it
+	t += Ts;
+	filter->PrepareStep(t);
+	sensor->propagations.clear();
+	filter->AddSensor(SystemManager::SensorData(std::make_shared<TestSensor>(std::make_shared<TestBaseSystem>(), 6, false),
+		StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+		StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2) * 0.01)),
+		StatisticValue(Eigen::VectorXd::Ones(2), Eigen::MatrixXd::Identity(2, 2)));
+	filter->SamplingTimeOver(t + DTime(500));
+	TEST_ASSERT_EQUAL_INT(6, filter->GetDataByIndex(5, STATE, FILTER_MEAS_UPDATE).GetSourceID());
+}
+
+void predictHorizonTest() {
+	auto filter = createKalmanFilter();
+	Eigen::VectorXd y(1);
+	y << 0.5;
+	filter->SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+	filter->Step(DTime(10000));
+	auto predictions = filter->PredictHorizon({ DTime(0), DTime(10000), DTime(30000) });
+	TEST_ASSERT_EQUAL_INT(3, predictions.size());
+	// Chained state updates from the filtered state
+	Eigen::MatrixXd sg1, sg2;
+	StatisticValue x = (*filter)(STATE);
+	StatisticValue w = (*filter)(DISTURBANCE);
+	std::vector<StatisticValue> expected;
+	expected.push_back(x);
+	expected.push_back(filter->Eval(STATE_UPDATE, 0.01, expected[0], w, sg1, sg2, true));
+	expected.push_back(filter->Eval(STATE_UPDATE, 0.02, expected[1], w, sg1, sg2, true));
+	for (size_t i = 0; i < expected.size(); i++) {
+		TEST_ASSERT((predictions[i].vector - expected[i].vector).cwiseAbs().maxCoeff() < 1e-12);
+		TEST_ASSERT((predictions[i].variance - expected[i].variance).cwiseAbs().maxCoeff() < 1e-12);
+	}
+	bool thrown = false;
+	try {
+		filter->PredictHorizon({ DTime(20000), DTime(10000) });
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// Concurrent use with the filter thread
+	std::atomic<bool> stop(false);
+	std::atomic<int> nWrong(0);
+	std::thread predictor([&filter, &stop, &nWrong]() {
+		while (!stop)
+			if (filter->PredictHorizon({ DTime(10000) })[0].Length() != 14)
+				nWrong++;
+	});
+	for (int k = 0; k < 100; k++)
+		filter->Step(DTime(10000));
+	stop = true;
+	predictor.join();
+	TEST_ASSERT_EQUAL_INT(0, nWrong);
+}
+
+void estimatorTest() {
+	// Running sum of the window equals to the mean of the last values
+	const unsigned int windowSize = 7;
+	MAWindow<Eigen::MatrixXd> matrixWindow(windowSize);
+	MAWindow<Eigen::VectorXd> vectorWindow(windowSize);
+	std::vector<Eigen::MatrixXd> values;
+	for (int k = 0; k < 50; k++) {
+		Eigen::MatrixXd r = Eigen::MatrixXd::Random(3, 3);
+		values.push_back(r * r.transpose());
+		matrixWindow.AddValue(values.back());
+		vectorWindow.AddValue(values.back().col(0));
+		Eigen::MatrixXd mean = Eigen::MatrixXd::Zero(3, 3);
+		for (unsigned int i = 0; i < windowSize; i++)
+			mean += values.size() > i ? values[values.size() - 1 - i] : values[0];
+		mean /= windowSize;
+		TEST_ASSERT((matrixWindow.Value() - mean).cwiseAbs().maxCoeff() < 1e-12);
+		TEST_ASSERT((vectorWindow.Value() - mean.col(0)).cwiseAbs().maxCoeff() < 1e-12);
+	}
+	// Exponential forgetting
+	ExpForgetting<Eigen::VectorXd> forgetting(0.5, Eigen::VectorXd::Zero(2));
+	forgetting.AddValue(Eigen::VectorXd::Ones(2));
+	forgetting.AddValue(Eigen::VectorXd::Ones(2));
+	TEST_ASSERT((forgetting.Value() - Eigen::VectorXd::Ones(2) * 0.75).cwiseAbs().maxCoeff() < 1e-12);
+	bool thrown = false;
+	try {
+		ExpForgetting<Eigen::MatrixXd> wrong(1.5);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+}
+
+class CachedTestSensor : public TestSensor {
+public:
+	mutable std::atomic<int> nEval;
+	CachedTestSensor(BaseSystem::BaseSystemPtr ptr) : TestSensor(ptr, 1, true), nEval(0) {}
+	Eigen::MatrixXd getAs(double Ts) const {
+		nEval++;
+		return TestSensor::getAs(Ts);
+	}
+	CachingPolicy getCachingPolicy() const override { return CACHE_BY_TS; }
+};
+
+void modelCacheTest() {
+	CachedTestSensor sensor(std::make_shared<TestBaseSystem>());
+	TEST_ASSERT((sensor.getMatrix(MATRIX_A, 0.01) - sensor.getAs(0.01)).cwiseAbs().maxCoeff() < 1e-15);
+	sensor.nEval = 0;
+	sensor.getMatrix(MATRIX_A, 0.01);
+	sensor.getMatrix(MATRIX_A, 0.0100000001); // same after quantisation
+	TEST_ASSERT_EQUAL_INT(0, sensor.nEval);
+	sensor.getMatrix(MATRIX_A, 0.02);
+	TEST_ASSERT_EQUAL_INT(1, sensor.nEval);
+	sensor.InvalidateCache();
+	sensor.getMatrix(MATRIX_A, 0.02);
+	TEST_ASSERT_EQUAL_INT(2, sensor.nEval);
+	// Pseudo-inverses are cached too
+	TEST_ASSERT((sensor.getMatrix(MATRIX_PINV_B, 0.01) - sensor.getPInvBs(0.01)).cwiseAbs().maxCoeff() < 1e-12);
+	// By default the jittered sampling times get their own entries, computed with the exact sampling time
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<int> jitter(-40, 40);
+	sensor.InvalidateCache();
+	sensor.nEval = 0;
+	for (int k = 0; k < 3; k++) {
+		double Ts = duration_cast_to_sec(DTime(10000 + 10 * k));
+		TEST_ASSERT((sensor.getMatrix(MATRIX_A, Ts) - sensor.TestSensor::getAs(Ts)).cwiseAbs().maxCoeff() < 1e-15);
+	}
+	TEST_ASSERT_EQUAL_INT(3, sensor.nEval);
+	// With coarse rounding (opt-in) they hit the entry of the nominal one
+	sensor.setCacheResolution(1e-4);
+	sensor.nEval = 0;
+	for (int k = 0; k < 1000; k++)
+		sensor.getMatrix(MATRIX_A, duration_cast_to_sec(DTime(10000 + jitter(generator))));
+	TEST_ASSERT_EQUAL_INT(1, sensor.nEval);
+	// Without caching the model is always evaluated
+	TestSensor uncached(std::make_shared<TestBaseSystem>(), 2, true);
+	TEST_ASSERT_EQUAL_INT(NO_CACHING, uncached.getCachingPolicy());
+}
+
+class StructuredTestSensor : public TestSensor {
+	bool coupled;
+public:
+	StructuredTestSensor(BaseSystem::BaseSystemPtr ptr, unsigned int ID, bool coupled_) : TestSensor(ptr, ID, coupled_), coupled(coupled_) {}
+	MatrixStructure getMatrixStructure(ModelMatrix matrix) const override {
+		switch (matrix) {
+		case MATRIX_A_BS:
+			return coupled ? DENSE : ZERO;
+		case MATRIX_B:
+			return DIAGONAL;
+		case MATRIX_C:
+			return SELECTION;
+		case MATRIX_D:
+			return IDENTITY;
+		case MATRIX_B_BS:
+		case MATRIX_C_BS:
+		case MATRIX_D_BS:
+			return ZERO;
+		default:
+			return DENSE;
+		}
+	}
+};
+
+void structuredMatrixTest() {
+	// Block matrix with every kind of blocks against its dense form
+	Eigen::MatrixXd diag = Eigen::MatrixXd::Zero(3, 2);
+	diag(0, 0) = 2;
+	diag(1, 1) = -3;
+	Eigen::MatrixXd sel = Eigen::MatrixXd::Zero(3, 4);
+	sel(0, 2) = 1;
+	sel(2, 0) = 1;
+	StructuredMatrix M(9, 8);
+	M.SetBlock(0, 0, DENSE, Eigen::MatrixXd::Random(3, 2));
+	M.SetBlock(0, 2, 3, 4, IDENTITY);
+	M.SetBlock(3, 0, DIAGONAL, diag);
+	M.SetBlock(3, 2, 3, 4, ZERO);
+	M.SetBlock(6, 4, SELECTION, sel);
+	Eigen::MatrixXd D = M.ToDense();
+	TEST_ASSERT(StructuredMatrix::HasStructure(D.block(0, 2, 3, 4), IDENTITY));
+	TEST_ASSERT(StructuredMatrix::HasStructure(D.block(3, 0, 3, 2), DIAGONAL));
+	TEST_ASSERT(StructuredMatrix::HasStructure(D.block(6, 4, 3, 4), SELECTION));
+	TEST_ASSERT(!StructuredMatrix::HasStructure(D.block(0, 0, 3, 2), DIAGONAL));
+	Eigen::MatrixXd X = Eigen::MatrixXd::Random(8, 5);
+	TEST_ASSERT(((M * X) - D * X).cwiseAbs().maxCoeff() < 1e-12);
+	Eigen::MatrixXd Y = Eigen::MatrixXd::Random(5, 8);
+	TEST_ASSERT((M.MultiplyTransposed(Y) - Y * D.transpose()).cwiseAbs().maxCoeff() < 1e-12);
+	// Products with block-wise covariance matrices: the zero cross variances are skipped
+	BlockStatisticValue S;
+	Eigen::MatrixXd L0 = Eigen::MatrixXd::Random(2, 2), L1 = Eigen::MatrixXd::Random(6, 6);
+	S.AddBlock(StatisticValue(Eigen::VectorXd::Zero(2), L0 * L0.transpose()));
+	S.AddBlock(StatisticValue(Eigen::VectorXd::Zero(6), L1 * L1.transpose()));
+	size_t nSkipped = 0;
+	TEST_ASSERT((M.MultiplyVariance(S, &nSkipped) - D * S.ToStatisticValue().variance).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT_EQUAL_INT(4, nSkipped);
+	S.SetCrossVariance(1, 0, Eigen::MatrixXd::Random(6, 2) * 0.1);
+	nSkipped = 0;
+	TEST_ASSERT((M.MultiplyVariance(S, &nSkipped) - D * S.ToStatisticValue().variance).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT_EQUAL_INT(0, nSkipped);
+	// The identity block spans two blocks: dense product
+	BlockStatisticValue S2;
+	S2.AddBlock(StatisticValue(Eigen::VectorXd::Zero(4), Eigen::MatrixXd::Identity(4, 4)));
+	S2.AddBlock(StatisticValue(Eigen::VectorXd::Zero(4), Eigen::MatrixXd::Identity(4, 4) * 2));
+	TEST_ASSERT((M.MultiplyVariance(S2) - D * S2.ToStatisticValue().variance).cwiseAbs().maxCoeff() < 1e-12);
+	// Evaluation of the models with declared structures against the dense path
+	auto baseSystem = std::make_shared<TestBaseSystem>();
+	StatisticValue in(Eigen::VectorXd::Zero(3), Eigen::MatrixXd::Identity(3, 3));
+	StatisticValue state(Eigen::VectorXd::Random(14), Eigen::MatrixXd::Identity(14, 14));
+	state.variance.block(6, 0, 8, 6) = Eigen::MatrixXd::Random(8, 6) * 0.1;
+	state.variance.block(0, 6, 6, 8) = state.variance.block(6, 0, 8, 6).transpose();
+	SystemManagerTester tester(SystemManager::BaseSystemData(baseSystem, StatisticValue(0), in),
+		StatisticValue(state.vector.segment(0, 6), state.variance.block(0, 0, 6, 6)));
+	for (unsigned int i = 0; i < 4; i++) {
+		auto sensor = std::make_shared<StructuredTestSensor>(baseSystem, i + 1, i % 2 == 0);
+		sensor->systemTest(); // checks the declarations
+		tester.AddSensor(SystemManager::SensorData(sensor, StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+			StatisticValue(Eigen::VectorXd::Random(2), Eigen::MatrixXd::Identity(2, 2) * 0.01)),
+			StatisticValue(state.vector.segment(6 + 2 * i, 2), state.variance.block(6 + 2 * i, 6 + 2 * i, 2, 2)));
+	}
+	Eigen::MatrixXd As, Bs, Ad, Bd;
+	tester.getMatrices(OUTPUT_UPDATE, 0.01, As, Bs, true);
+	StatisticValue noise = tester(NOISE, true);
+	Eigen::MatrixXd Sx1, Sin1, Sx2, Sin2;
+	StatisticValue y1 = tester.Eval(OUTPUT_UPDATE, 0.01, state, noise, Sx1, Sin1, true);
+	// Linear STATE_UPDATE of a sensor without basesystem
+	StatisticValue disturbance = tester(DISTURBANCE);
+	StatisticValue w(disturbance.vector.segment(5, 2), disturbance.variance.block(5, 5, 2, 2));
+	StatisticValue x(state.vector.segment(8, 2), state.variance.block(8, 8, 2, 2));
+	Eigen::MatrixXd Sxw1, Sinw1, Sxw2, Sinw2;
+	StatisticValue xs1 = tester.Eval({ 1 }, STATE_UPDATE, 0.01, x, w, Sxw1, Sinw1, true);
+	tester.SetStructuredEvaluation(false);
+	tester.getMatrices(OUTPUT_UPDATE, 0.01, Ad, Bd, true);
+	StatisticValue y2 = tester.Eval(OUTPUT_UPDATE, 0.01, state, noise, Sx2, Sin2, true);
+	StatisticValue xs2 = tester.Eval({ 1 }, STATE_UPDATE, 0.01, x, w, Sxw2, Sinw2, true);
+	TEST_ASSERT((As - Ad).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((Bs - Bd).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((y1.vector - y2.vector).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((y1.variance - y2.variance).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((Sx1 - Sx2).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((Sin1 - Sin2).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((xs1.vector - xs2.vector).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((xs1.variance - xs2.variance).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((Sxw1 - Sxw2).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((Sinw1 - Sinw2).cwiseAbs().maxCoeff() < 1e-12);
+}
+
+void blockStatisticValueTest() {
+	// Block-wise products against the dense covariance matrix
+	BlockStatisticValue value;
+	for (int i = 0; i < 3; i++) {
+		Eigen::MatrixXd L = Eigen::MatrixXd::Random(i + 1, i + 1);
+		value.AddBlock(StatisticValue(Eigen::VectorXd::Random(i + 1), L * L.transpose()));
+	}
+	value.AddBlock(StatisticValue(0));
+	value.SetCrossVariance(2, 0, Eigen::MatrixXd::Constant(3, 1, 0.1));
+	TEST_ASSERT_EQUAL_INT(6, value.Length());
+	TEST_ASSERT_EQUAL_INT(3, value.BlockStart(2));
+	StatisticValue dense = value.ToStatisticValue();
+	TEST_ASSERT(!dense.isIndependent);
+	TEST_ASSERT(std::abs(dense.variance(0, 3) - 0.1) < 1e-15);
+	TEST_ASSERT(std::abs(dense.variance(1, 3)) < 1e-15);
+	TEST_ASSERT((value.Vector() - dense.vector).cwiseAbs().maxCoeff() < 1e-15);
+	Eigen::MatrixXd M = Eigen::MatrixXd::Random(4, 6);
+	TEST_ASSERT((value.MultiplyVariance(M) - M * dense.variance).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((value.TransformVariance(M) - M * dense.variance * M.transpose()).cwiseAbs().maxCoeff() < 1e-12);
+	StatisticValue part = value.GetBlocks({ 2, 0 });
+	Eigen::VectorXi indices(4);
+	indices << 3, 4, 5, 0;
+	StatisticValue densePart = dense.GetPart(indices);
+	TEST_ASSERT((part.vector - densePart.vector).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((part.variance - densePart.variance).cwiseAbs().maxCoeff() < 1e-15);
+	// The values of the systems
+	auto filter = createKalmanFilter();
+	Eigen::VectorXd y(1);
+	y << 2;
+	filter->SaveDataMsg(DataMsg(3, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+	BlockStatisticValue v = filter->getBlockValue(NOISE);
+	TEST_ASSERT_EQUAL_INT(5, v.nBlocks());
+	TEST_ASSERT_EQUAL_INT(0, v.BlockLength(1));
+	TEST_ASSERT_EQUAL_INT(1, v.BlockLength(3));
+	BlockStatisticValue yBlocks = filter->getBlockValue(OUTPUT);
+	TEST_ASSERT_EQUAL_INT(1, yBlocks.Length());
+	TEST_ASSERT(std::abs(yBlocks.GetBlock(3).vector[0] - 2) < 1e-15);
+	TEST_ASSERT_EQUAL_INT(11, filter->getBlockValue(DISTURBANCE, true).Length());
+	TEST_ASSERT_EQUAL_INT(4, (*filter)(NOISE, true).Length());
+}
+
+class ViewTestBaseSystem : public TestBaseSystem {
+public:
+	// Same as TestBaseSystem::EvalStateUpdateNonlinearPart() without copying the inputs
+	Eigen::VectorXd EvalStateUpdateNonlinearPartView(double Ts,
+		const VectorView& state, const VectorView& disturbance) const override {
+		Eigen::VectorXd out(6);
+		out[0] = -disturbance[0];
+		out[1] = -disturbance[1];
+		out[2] = state[2];
+		out[3] = -state[2] + state[3];
+		out[4] = 0;
+		out[5] = state[5];
+		return out;
+	}
+};
+
+void viewEvaluationTest() {
+	// Evaluation on a segment of a longer vector
+	Eigen::VectorXd x = Eigen::VectorXd::Random(10), w = Eigen::VectorXd::Random(5);
+	TestBaseSystem legacy;
+	ViewTestBaseSystem view;
+	Eigen::VectorXd f1 = legacy.EvalNonlinearPart(STATE_UPDATE, 0.01, x.segment(2, 6), w.tail(3));
+	Eigen::VectorXd f2 = view.EvalNonlinearPart(STATE_UPDATE, 0.01, x.segment(2, 6), w.tail(3));
+	TEST_ASSERT((f1 - f2).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((legacy.EvalStateUpdate(0.01, x.segment(2, 6), w.tail(3)) - view.EvalStateUpdate(0.01, x.segment(2, 6), w.tail(3))).cwiseAbs().maxCoeff() < 1e-15);
+	// The same in the SystemManager, with and without the basesystem
+	StatisticValue in(Eigen::VectorXd::Zero(3), Eigen::MatrixXd::Identity(3, 3));
+	StatisticValue bsState(Eigen::VectorXd::Random(6), Eigen::MatrixXd::Identity(6, 6));
+	auto legacyPtr = std::make_shared<TestBaseSystem>();
+	auto viewPtr = std::make_shared<ViewTestBaseSystem>();
+	SystemManagerTester t1(SystemManager::BaseSystemData(legacyPtr, StatisticValue(0), in), bsState);
+	SystemManagerTester t2(SystemManager::BaseSystemData(viewPtr, StatisticValue(0), in), bsState);
+	for (unsigned int i = 0; i < 2; i++) {
+		StatisticValue vs(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1));
+		StatisticValue ws(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2));
+		StatisticValue xs(Eigen::VectorXd::Random(2), Eigen::MatrixXd::Identity(2, 2));
+		t1.AddSensor(SystemManager::SensorData(std::make_shared<TestSensor>(legacyPtr, i + 1, i == 0), vs, ws), xs);
+		t2.AddSensor(SystemManager::SensorData(std::make_shared<TestSensor>(viewPtr, i + 1, i == 0), vs, ws), xs);
+	}
+	Eigen::VectorXd state = Eigen::VectorXd::Random(10), dist = Eigen::VectorXd::Random(7);
+	TEST_ASSERT((t1.EvalNonLinPart(0.01, STATE_UPDATE, state, dist) - t2.EvalNonLinPart(0.01, STATE_UPDATE, state, dist)).cwiseAbs().maxCoeff() < 1e-15);
+	Eigen::VectorXd fs1 = t1.EvalNonLinPart({ 1 }, 0.01, STATE_UPDATE, state.tail(2), dist.tail(2));
+	Eigen::VectorXd fs2 = t1.EvalNonLinPart(0.01, STATE_UPDATE, state, dist);
+	TEST_ASSERT((fs1 - fs2.tail(2)).cwiseAbs().maxCoeff() < 1e-15);
+	// The const partitioning does not copy
+	const Eigen::VectorXd& cstate = state;
+	auto partitioner = t1.getPartitioner(true);
+	TEST_ASSERT(partitioner->PartValue(STATE, cstate, 1).data() == state.data() + 8);
+	const Eigen::MatrixXd S = Eigen::MatrixXd::Identity(10, 10);
+	TEST_ASSERT(&partitioner->PartVariance(STATE, S, 1, 1).coeffRef(0, 0) == S.data() + 8 * 10 + 8);
+}
+
+void lookupTest() {
+	auto baseSystem = std::make_shared<TestBaseSystem>();
+	StatisticValue in(Eigen::VectorXd::Zero(3), Eigen::MatrixXd::Identity(3, 3));
+	SystemManagerTester tester(SystemManager::BaseSystemData(baseSystem, StatisticValue(0), in),
+		StatisticValue(Eigen::VectorXd::Zero(6), Eigen::MatrixXd::Identity(6, 6)));
+	for (unsigned int ID : { 1, 300, 5 })
+		tester.AddSensor(SystemManager::SensorData(std::make_shared<TestSensor>(baseSystem, ID, true),
+			StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1)),
+			StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2))),
+			StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2)));
+	// IDs by table and (over 255) by search
+	TEST_ASSERT_EQUAL_INT(0, tester.SystemByID(0)->getPtr()->getID());
+	TEST_ASSERT_EQUAL_INT(300, tester.SystemByID(300)->getPtr()->getID());
+	TEST_ASSERT_EQUAL_INT(5, tester.SystemByID(5)->getPtr()->getID());
+	bool thrown = false;
+	try {
+		tester.SystemByID(7);
+	}
+	catch (std::exception&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// The tables are updated if a sensor is removed
+	tester.RemoveSensor(1);
+	TEST_ASSERT_EQUAL_INT(5, tester.Sensor(1).getPtr()->getID());
+	TEST_ASSERT(tester.SystemByID(5) == &tester.Sensor(1));
+	// The partitioners are cached by the measurement statuses
+	auto forced = tester.getPartitioner(true);
+	TEST_ASSERT(forced == tester.getPartitioner(true));
+	auto p1 = tester.getPartitioner();
+	TEST_ASSERT_EQUAL_INT(0, p1->offsets(OUTPUT).back());
+	Eigen::VectorXd y(1);
+	y << 1;
+	tester.SaveDataMsg(DataMsg(5, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1))));
+	auto p2 = tester.getPartitioner();
+	TEST_ASSERT(p1 != p2);
+	TEST_ASSERT_EQUAL_INT(1, p2->offsets(OUTPUT).back());
+	TEST_ASSERT_EQUAL_INT(8, p2->Offset(STATE, 1));
+	TEST_ASSERT(p2 == tester.getPartitioner());
+}
+
+void decimationTest() {
+	auto decimated = createKalmanFilter();
+	auto reference = createKalmanFilter();
+	decimated->Step(DTime(10000));
+	reference->Step(DTime(10000));
+	// Sensor 1 (ID 2) is decoupled: two decimated steps are one step with the double Ts
+	decimated->SetPropagationDecimation(2, 2);
+	DataMsg initial = decimated->GetDataByIndex(1, STATE, FILTER_MEAS_UPDATE);
+	decimated->Step(DTime(10000));
+	DataMsg held = decimated->GetDataByIndex(1, STATE, FILTER_MEAS_UPDATE);
+	TEST_ASSERT((held.GetValue() - initial.GetValue()).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((held.GetVariance() - initial.GetVariance()).cwiseAbs().maxCoeff() < 1e-15);
+	decimated->Step(DTime(10000));
+	reference->Step(DTime(20000));
+	DataMsg a = decimated->GetDataByIndex(1, STATE, FILTER_MEAS_UPDATE);
+	DataMsg b = reference->GetDataByIndex(1, STATE, FILTER_MEAS_UPDATE);
+	TEST_ASSERT((a.GetValue() - b.GetValue()).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((a.GetVariance() - b.GetVariance()).cwiseAbs().maxCoeff() < 1e-12);
+	// Coupled sensor (ID 1): the decomposed filter gives the same (the cross variances are consistent)
+	auto decomposed = createKalmanFilter();
+	auto full = createKalmanFilter();
+	full->SetDecomposition(false);
+	for (auto filter : { decomposed, full })
+		for (unsigned int ID : { 1, 2 })
+			filter->SetPropagationDecimation(ID, 3);
+	for (int k = 0; k < 7; k++) {
+		Eigen::VectorXd y(1);
+		y << k * 0.1;
+		DataMsg msg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1));
+		decomposed->SaveDataMsg(msg);
+		full->SaveDataMsg(msg);
+		decomposed->Step(DTime(10000));
+		full->Step(DTime(10000));
+	}
+	for (int i = -1; i < 4; i++) {
+		DataMsg c = decomposed->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+		DataMsg d = full->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+		TEST_ASSERT((c.GetValue() - d.GetValue()).cwiseAbs().maxCoeff() < 1e-9);
+		TEST_ASSERT((c.GetVariance() - d.GetVariance()).cwiseAbs().maxCoeff() < 1e-9);
+	}
+	bool thrown = false;
+	try {
+		full->SetPropagationDecimation(0, 2);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+}
+
+class LinearTestBaseSystem : public TestBaseSystem {
+public:
+	// Without the nonlinear parts: the state update uses the structured products
+	Eigen::VectorXi getStateUpdateNonlinXDep() const override { return Eigen::VectorXi::Zero(6); }
+
+	Eigen::VectorXi getStateUpdateNonlinWDep() const override { return Eigen::VectorXi::Zero(3); }
+};
+
+void sparsificationTest() {
+	auto sparse = createKalmanFilter(std::make_shared<LinearTestBaseSystem>());
+	auto dense = createKalmanFilter(std::make_shared<LinearTestBaseSystem>());
+	auto reference = createKalmanFilter(std::make_shared<LinearTestBaseSystem>());
+	sparse->SetCovarianceSparsification(true, 0.99);
+	reference->SetCovarianceSparsification(true, 0.99);
+	for (auto filter : { sparse, dense, reference }) {
+		Eigen::VectorXd y(1);
+		y << 0.5;
+		filter->SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+		filter->SaveDataMsg(DataMsg(3, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+		filter->Step(DTime(10000));
+	}
+	// Sensor 0 and 2 (ID 1 and 3) are correlated through the basesystem, the others are independent
+	const KalmanFilter::SparsificationStats& stats = sparse->getSparsificationStats();
+	TEST_ASSERT_EQUAL_INT(1, stats.nDroppedBlocks);
+	TEST_ASSERT(stats.maxDroppedCorrelation > 0 && stats.maxDroppedCorrelation < 0.99);
+	StatisticValue xs = (*sparse)(STATE), xd = (*dense)(STATE);
+	TEST_ASSERT((xs.vector - xd.vector).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT(xs.variance.block(6, 10, 2, 2).isZero(0));
+	// Consistent: the sparsified covariance matrix is not smaller
+	Eigen::MatrixXd diff = xs.variance - xd.variance;
+	TEST_ASSERT(Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(diff).eigenvalues().minCoeff() > -1e-12);
+	// Stored: the systems and the basesystem - sensor 0 and 2 cross variances (the previous step had no sparsified state)
+	TEST_ASSERT_EQUAL_INT(14 * 14, stats.nStoredDense);
+	TEST_ASSERT_EQUAL_INT(6 * 6 + 4 * 2 * 2 + 2 * 2 * 6 * 2, stats.nStoredSparse);
+	TEST_ASSERT_EQUAL_INT(0, stats.nSkippedBlockProducts);
+	// The next state update skips the products with the dropped block, and gives the same as the dense one
+	reference->SetCovarianceSparsification(true, 0.99); // drops the block-wise state: dense update
+	for (auto filter : { sparse, reference }) {
+		Eigen::VectorXd y(1);
+		y << 0.2;
+		filter->SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+		filter->Step(DTime(10000));
+	}
+	TEST_ASSERT(sparse->getSparsificationStats().nSkippedBlockProducts > 0);
+	TEST_ASSERT_EQUAL_INT(0, reference->getSparsificationStats().nSkippedBlockProducts);
+	StatisticValue xs2 = (*sparse)(STATE), xr2 = (*reference)(STATE);
+	TEST_ASSERT((xs2.vector - xr2.vector).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((xs2.variance - xr2.variance).cwiseAbs().maxCoeff() < 1e-12);
+	// Nothing is dropped with zero threshold
+	sparse->SetCovarianceSparsification(true, 0);
+	sparse->Step(DTime(10000));
+	TEST_ASSERT_EQUAL_INT(0, sparse->getSparsificationStats().nDroppedBlocks);
+}
+
+class RelativeTestSensor : public Sensor {
+public:
+	RelativeTestSensor(BaseSystem::BaseSystemPtr ptr, unsigned int ID) : Sensor(ptr, ID) {}
+
+	Eigen::MatrixXd getAs_bs(double Ts) const { return Eigen::MatrixXd(0, 12); }
+
+	Eigen::MatrixXd getAs(double Ts) const { return Eigen::MatrixXd(0, 0); }
+
+	Eigen::MatrixXd getBs_bs(double Ts) const { return Eigen::MatrixXd(0, 6); }
+
+	Eigen::MatrixXd getBs(double Ts) const { return Eigen::MatrixXd(0, 0); }
+
+	Eigen::MatrixXd getCs_bs(double Ts) const {
+		Eigen::MatrixXd out = Eigen::MatrixXd::Zero(1, 12);
+		out(0, 0) = -1;
+		out(0, 6) = 1;
+		return out;
+	}
+
+	Eigen::MatrixXd getCs(double Ts) const { return Eigen::MatrixXd(1, 0); }
+
+	Eigen::MatrixXd getDs_bs(double Ts) const { return Eigen::MatrixXd::Zero(1, 0); }
+
+	Eigen::MatrixXd getDs(double Ts) const { return Eigen::MatrixXd::Identity(1, 1); }
+
+	bool isCompatible(BaseSystem::BaseSystemPtr ptr) const { return _isCompatible<CompositeBaseSystem>(ptr); }
+
+	unsigned int getNumOfStates() const { return 0; }
+
+	unsigned int getNumOfDisturbances() const { return 0; }
+
+	unsigned int getNumOfOutputs() const { return 1; }
+
+	unsigned int getNumOfNoises() const { return 1; }
+};
+
+void compositeTest() {
+	// Two robots with their own sensors and a relative measurement between them
+	auto robot1 = std::make_shared<TestBaseSystem>();
+	auto robot2 = std::make_shared<TestBaseSystem>();
+	auto composite = std::make_shared<CompositeBaseSystem>(0, std::vector<BaseSystem::BaseSystemPtr>{ robot1, robot2 });
+	TEST_ASSERT_EQUAL_INT(12, composite->getNumOfStates());
+	TEST_ASSERT_EQUAL_INT(3, composite->Offset(DISTURBANCE, 1));
+	Eigen::MatrixXd A = composite->getA(0.01);
+	TEST_ASSERT(A.block(0, 6, 6, 6).isZero(0) && A.block(6, 0, 6, 6).isZero(0));
+	TEST_ASSERT((A.block(6, 6, 6, 6) - robot2->getA(0.01)).isZero(0));
+	StatisticValue in(Eigen::VectorXd::Zero(6), Eigen::MatrixXd::Identity(6, 6));
+	SystemManagerTester tester(SystemManager::BaseSystemData(composite, StatisticValue(0), in),
+		StatisticValue(Eigen::VectorXd::Random(12), Eigen::MatrixXd::Identity(12, 12)));
+	for (unsigned int k = 0; k < 2; k++) {
+		auto sensor = std::make_shared<PartSensor>(std::make_shared<TestSensor>(k ? robot2 : robot1, k + 1, true), composite, k);
+		sensor->systemTest();
+		tester.AddSensor(SystemManager::SensorData(sensor, StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+			StatisticValue(Eigen::VectorXd::Zero(2), Eigen::MatrixXd::Identity(2, 2) * 0.01)),
+			StatisticValue(Eigen::VectorXd::Random(2), Eigen::MatrixXd::Identity(2, 2)));
+	}
+	auto relative = std::make_shared<RelativeTestSensor>(composite, 3);
+	relative->systemTest();
+	tester.AddSensor(SystemManager::SensorData(relative, StatisticValue(Eigen::VectorXd::Zero(1), Eigen::MatrixXd::Identity(1, 1) * 0.1),
+		StatisticValue(0)), StatisticValue(0));
+	// The sensors are coupled only to their own robot
+	Eigen::MatrixXd As, Bs, Ad, Bd;
+	tester.getMatrices(STATE_UPDATE, 0.01, As, Bs);
+	TEST_ASSERT(As(12, 0) == 0.01 && As(14, 6) == 0.01);
+	TEST_ASSERT(As.block(12, 6, 2, 6).isZero(0) && As.block(14, 0, 2, 6).isZero(0));
+	// The relative measurement and the sensors of the robots
+	StatisticValue state = tester(STATE), noise = tester(NOISE, true);
+	Eigen::MatrixXd Sx1, Sin1, Sx2, Sin2;
+	StatisticValue y1 = tester.Eval(OUTPUT_UPDATE, 0.01, state, noise, Sx1, Sin1, true);
+	TEST_ASSERT_EQUAL_INT(3, y1.Length());
+	TEST_ASSERT(std::abs(y1.vector[1] - state.vector[14]) < 1e-12);
+	TEST_ASSERT(std::abs(y1.vector[2] - state.vector[6] + state.vector[0]) < 1e-12);
+	// Same as the dense evaluation
+	tester.SetStructuredEvaluation(false);
+	tester.getMatrices(STATE_UPDATE, 0.01, Ad, Bd);
+	StatisticValue y2 = tester.Eval(OUTPUT_UPDATE, 0.01, state, noise, Sx2, Sin2, true);
+	TEST_ASSERT((As - Ad).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((Bs - Bd).cwiseAbs().maxCoeff() < 1e-15);
+	TEST_ASSERT((y1.vector - y2.vector).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((y1.variance - y2.variance).cwiseAbs().maxCoeff() < 1e-12);
+	TEST_ASSERT((Sx1 - Sx2).cwiseAbs().maxCoeff() < 1e-12);
+	// The relative sensor can not be attached to a robot
+	bool thrown = false;
+	try {
+		PartSensor sensor(relative, composite, 0);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// The matrices are cached by the original sensor only, so its invalidation is enough
+	auto cached = std::make_shared<CachedTestSensor>(robot1);
+	PartSensor part(cached, composite, 0);
+	TEST_ASSERT_EQUAL_INT(NO_CACHING, part.getCachingPolicy());
+	part.getMatrix(MATRIX_A, 0.01);
+	cached->nEval = 0;
+	part.getMatrix(MATRIX_A, 0.01);
+	TEST_ASSERT_EQUAL_INT(0, cached->nEval);
+	cached->InvalidateCache();
+	part.getMatrix(MATRIX_A, 0.01);
+	TEST_ASSERT_EQUAL_INT(1, cached->nEval);
+}
+
+void dataMsgViewTest() {
+	// Packed upper triangle of a 3x3 covariance matrix
+	float packed[] = { 1.f, 2.f, 3.f, 4.f, 5.f, 6.f };
+	float value[] = { 0.5f, -1.f, 2.f };
+	DataMsgView view(1, OUTPUT, SENSOR, Time(), value, 3, packed, 6);
+	Eigen::MatrixXd expected(3, 3);
+	expected << 1, 2, 3, 2, 4, 5, 3, 5, 6;
+	Eigen::MatrixXd variance;
+	view.CopyVariance(variance);
+	TEST_ASSERT(variance == expected);
+	DataMsg data = view.ToDataMsg();
+	TEST_ASSERT(data.GetVariance() == expected);
+	TEST_ASSERT(data.GetValue() == Eigen::Vector3d(0.5, -1, 2));
+	bool thrown = false;
+	try {
+		DataMsgView(1, OUTPUT, SENSOR, Time(), value, 3, packed, 5);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// Saving the view is the same as saving the copied DataMsg
+	auto filterMsg = createKalmanFilter();
+	auto filterView = createKalmanFilter();
+	float y[] = { 0.5f };
+	float v[] = { 0.1f };
+	DataMsgView meas(1, OUTPUT, SENSOR, Time(), y, 1, v, 1);
+	TEST_ASSERT(filterMsg->SaveDataMsg(meas.ToDataMsg()));
+	TEST_ASSERT(filterView->SaveDataMsg(meas));
+	TEST_ASSERT(!filterView->SaveDataMsg(DataMsgView(99, OUTPUT, SENSOR, Time(), y, 1, v, 1)));
+	filterMsg->Step(DTime(10000));
+	filterView->Step(DTime(10000));
+	for (int i = -1; i < 4; i++) {
+		TEST_ASSERT(filterMsg->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE).GetValue() ==
+			filterView->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE).GetValue());
+		TEST_ASSERT(filterMsg->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE).GetVariance() ==
+			filterView->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE).GetVariance());
+	}
+}
+
+void snapshotTest() {
+	auto filter = createKalmanFilter();
+	// The initial state is published, there is no prediction yet
+	DataMsg initial = filter->GetDataByIndex(0, STATE, FILTER_MEAS_UPDATE);
+	TEST_ASSERT(initial.GetValue().isApprox(Eigen::VectorXd::Ones(2)));
+	bool thrown = false;
+	try {
+		filter->GetDataByIndex(0, STATE, FILTER_TIME_UPDATE);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// Observers
+	std::vector<DataMsg> results;
+	size_t handle = filter->AddCallback([&results](const DataMsg& data) { results.push_back(data); });
+	Eigen::VectorXd y(1);
+	y << 0.5;
+	filter->SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, StatisticValue(y, Eigen::MatrixXd::Identity(1, 1) * 0.1)));
+	filter->Step(DTime(10000));
+	// STATE of the 5 systems after the time update and the filtering, OUTPUT of the measured sensor
+	TEST_ASSERT_EQUAL_INT(11, results.size());
+	TEST_ASSERT_EQUAL_INT(OUTPUT, results[2].GetDataType());
+	TEST_ASSERT_EQUAL_INT(1, results[2].GetSourceID());
+	TEST_ASSERT_EQUAL_INT(FILTER_MEAS_UPDATE, results.back().GetDataSourceType());
+	TEST_ASSERT(results.back().GetValue() == filter->GetDataByIndex(3, STATE, FILTER_MEAS_UPDATE).GetValue());
+	filter->RemoveCallback(handle);
+	filter->Step(DTime(10000));
+	TEST_ASSERT_EQUAL_INT(11, results.size());
+	// Readers in other threads while the filter is running
+	std::atomic<bool> running(true);
+	std::atomic<int> nWrong(0);
+	std::thread reader([&]() {
+		while (running)
+			for (int i = -1; i < 4; i++) {
+				DataMsg data = filter->GetDataByIndex(i, STATE, FILTER_MEAS_UPDATE);
+				if (data.GetValue().size() != (i == -1 ? 6 : 2) || !data.GetValue().allFinite())
+					nWrong++;
+			}
+	});
+	for (int k = 0; k < 100; k++)
+		filter->Step(DTime(10000));
+	running = false;
+	reader.join();
+	TEST_ASSERT_EQUAL_INT(0, nWrong);
+}
+
 int main (void) {
 	UNITY_BEGIN();
 	RUN_TEST([]() { linearTest(); });
+	RUN_TEST([]() { decompositionTest(); });
+	RUN_TEST([]() { removeSensorTest(); });
+	RUN_TEST([]() { statisticValueGrowthTest(); });
+	RUN_TEST([]() { speculativePredictionTest(); });
+	RUN_TEST([]() { speculativeDecimationTest(); });
+	RUN_TEST([]() { predictHorizonTest(); });
+	RUN_TEST([]() { estimatorTest(); });
+	RUN_TEST([]() { modelCacheTest(); });
+	RUN_TEST([]() { structuredMatrixTest(); });
+	RUN_TEST([]() { blockStatisticValueTest(); });
+	RUN_TEST([]() { viewEvaluationTest(); });
+	RUN_TEST([]() { lookupTest(); });
+	RUN_TEST([]() { decimationTest(); });
+	RUN_TEST([]() { sparsificationTest(); });
+	RUN_TEST([]() { compositeTest(); });
+	RUN_TEST([]() { snapshotTest(); });
+	RUN_TEST([]() { dataMsgViewTest(); });
 	return UNITY_END();
 }
@@ -0,0 +1,121 @@
+#include "common/unity.h"
+void setUp() {}
+void tearDown() {}
+
+#include <thread>
+#include <iostream>
+#include <atomic>
+#include <future>
+#include"WorkStealingPool.h"
+
+using namespace SF;
+
+void allTasksExecutedTest() {
+	WorkStealingPool pool(4);
+	std::atomic<int> sum(0);
+	for (int i = 1; i <= 1000; i++)
+		pool.Submit([&sum, i]() { sum += i; });
+	pool.WaitAll();
+	TEST_ASSERT_EQUAL_INT(500500, sum);
+	// Reusable after WaitAll
+	for (int i = 0; i < 10; i++)
+		pool.Submit([&sum]() { sum--; });
+	pool.WaitAll();
+	TEST_ASSERT_EQUAL_INT(500490, sum);
+}
+
+void nestedTasksTest() {
+	WorkStealingPool pool(2);
+	std::atomic<int> n(0);
+	for (int i = 0; i < 8; i++)
+		pool.Submit([&pool, &n]() {
+			for (int j = 0; j < 8; j++)
+				pool.Submit([&n]() { n++; });
+			pool.WaitAll(); // must not deadlock from a worker
+		});
+	pool.WaitAll();
+	TEST_ASSERT_EQUAL_INT(64, n);
+}
+
+void stealingTest() {
+	// One task blocks a worker until the queued tasks are done: half of them are in its queue, they must be stolen by the other one
+	WorkStealingPool pool(2);
+	std::atomic<int> n(0);
+	std::promise<void> started, done;
+	std::shared_future<void> finished = done.get_future().share();
+	bool released = false;
+	pool.Submit([&]() {
+		started.set_value();
+		// the timeout only prevents a deadlock if the stealing is broken
+		released = finished.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+	});
+	started.get_future().wait();
+	for (int i = 0; i < 20; i++)
+		pool.Submit([&n, &done]() {
+			if (++n == 20)
+				done.set_value();
+		});
+	// not helping in WaitAll() before: the tasks must be executed by the free worker
+	finished.wait_for(std::chrono::seconds(10));
+	pool.WaitAll();
+	TEST_ASSERT(released);
+	TEST_ASSERT_EQUAL_INT(20, n);
+}
+
+void exceptionTest() {
+	WorkStealingPool pool(2);
+	pool.Submit([]() { throw std::runtime_error("test"); });
+	bool thrown = false;
+	try {
+		pool.WaitAll();
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	// The exception is not rethrown twice
+	pool.WaitAll();
+}
+
+void groupTest() {
+	// Waiting for a group does not wait for the other tasks of the pool
+	WorkStealingPool pool(2);
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	std::promise<void> started;
+	WorkStealingPool::TaskGroup blocked, group;
+	pool.Submit([&]() {
+		started.set_value();
+		released.wait();
+	}, blocked);
+	started.get_future().wait();
+	std::atomic<int> n(0);
+	for (int i = 0; i < 20; i++)
+		pool.Submit([&n]() { n++; }, group);
+	pool.Wait(group);
+	TEST_ASSERT_EQUAL_INT(20, n);
+	TEST_ASSERT(released.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+	release.set_value();
+	pool.Wait(blocked);
+	// The exception of a group is rethrown only by its Wait()
+	pool.Submit([]() { throw std::runtime_error("test"); }, group);
+	bool thrown = false;
+	try {
+		pool.Wait(group);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	pool.WaitAll();
+}
+
+int main (void) {
+	UNITY_BEGIN();
+	RUN_TEST([]() { allTasksExecutedTest(); });
+	RUN_TEST([]() { nestedTasksTest(); });
+	RUN_TEST([]() { stealingTest(); });
+	RUN_TEST([]() { exceptionTest(); });
+	RUN_TEST([]() { groupTest(); });
+	return UNITY_END();
+}
@@ -4,6 +4,7 @@ void tearDown() {}
 
 #include <thread>
 #include <iostream>
+#include <algorithm>
 #include"msgcontent2buf.h"
 #include "FilterCore.h"
 
@@ -26,7 +27,7 @@ void DataMsgContentSerialization(long N) {
 		}
 		else
 			printf("Error...");
-		delete buf;
+		delete[] buf;
 	}
 }
 #include "Forwarder.h"
@@ -48,6 +49,156 @@ class ZMQRecievingTest : public ZMQReciever {
 };
 
 
+// Random covariance matrix with elements exactly representable as floats (the wire format), so the msgs can be compared with ==
+Eigen::MatrixXd FloatExactVariance(int n) {
+	Eigen::MatrixXd A = (Eigen::MatrixXd::Random(n, n) * 64).array().round() / 64;
+	return A * A.transpose(); // multiples of 1/4096, not greater than n: 24 bits are enough
+}
+
+void DataMsgSerializerTest(long N) {
+	DataMsgSerializer serializer;
+	DataMsg d(5, OUTPUT, SENSOR, Now());
+	d.SetValueVector(Eigen::VectorXd::LinSpaced(10, 0, 9) / 8); // exact floats
+	d.SetVarianceMatrix(FloatExactVariance(10));
+	for (long i = 0; i < N; i++) {
+		DataMsgSerializer::Buffer* buf = serializer.Serialize(d);
+		void* data = const_cast<void*>(DataMsgSerializer::Data(buf));
+		TEST_ASSERT(VerifyDataMsgContent(data, (int)DataMsgSerializer::Size(buf)));
+		TEST_ASSERT(InitDataMsg(data, SENSOR, 5, OUTPUT) == d);
+		DataMsgSerializer::Release(data, buf);
+	}
+	// The released buffer is reused
+	TEST_ASSERT_EQUAL_INT(1, serializer.GetNumOfBuffers());
+}
+
+void DataMsgBatchTest() {
+	DataMsgSerializer serializer;
+	std::vector<DataMsg> msgs;
+	for (unsigned char ID = 0; ID < 5; ID++) {
+		DataMsg d(ID, STATE, FILTER_MEAS_UPDATE, Now());
+		d.SetValueVector(Eigen::VectorXd::Constant(ID + 1, ID));
+		if (ID % 2)
+			d.SetVarianceMatrix(Eigen::MatrixXd::Identity(ID + 1, ID + 1));
+		msgs.push_back(d);
+	}
+	DataMsgSerializer::Buffer* buf = serializer.SerializeBatch(msgs.begin(), msgs.end());
+	void* data = const_cast<void*>(DataMsgSerializer::Data(buf));
+	TEST_ASSERT(VerifyDataMsgBatch(data, (int)DataMsgSerializer::Size(buf)));
+	TEST_ASSERT_EQUAL_INT(msgs.size(), GetNumOfBatchRecords(data));
+	for (size_t k = 0; k < msgs.size(); k++) {
+		DataMsgView view = InitDataMsgViewFromBatch(data, k);
+		TEST_ASSERT_EQUAL_INT(FILTER_MEAS_UPDATE, view.GetDataSourceType());
+		TEST_ASSERT(view.ToDataMsg() == msgs[k]);
+	}
+	DataMsgSerializer::Release(data, buf);
+	// the upper bound of the size, also with the largest overhead (many small msgs)
+	for (int n = 0; n < 2; n++) {
+		if (n == 1)
+			msgs = std::vector<DataMsg>(100, DataMsg(1, STATE, FILTER_MEAS_UPDATE, Now()));
+		buf = serializer.SerializeBatch(msgs.begin(), msgs.end());
+		size_t maxSize = DataMsgSerializer::maxBatchOverhead;
+		for (const DataMsg& d : msgs)
+			maxSize += DataMsgSerializer::MaxBatchRecordSize(d);
+		TEST_ASSERT(DataMsgSerializer::Size(buf) <= maxSize);
+		DataMsgSerializer::Release(const_cast<void*>(DataMsgSerializer::Data(buf)), buf);
+	}
+}
+
+void DataMsgEncodingTest() {
+	DataMsgSerializer serializer;
+	DataMsgEncoding encoding;
+	encoding.diagonal = true;
+	encoding.referenceInterval = 3;
+	encoding.quantisationTolerance = 1e-3;
+	serializer.SetEncoding(encoding);
+	DataMsgDecoder decoder, lateDecoder;
+	DataMsg d(2, OUTPUT, SENSOR, Now());
+	d.SetValueVector(Eigen::VectorXd::LinSpaced(6, -1, 1));
+	d.SetVarianceMatrix(Eigen::VectorXd::LinSpaced(6, 1, 2).asDiagonal());
+	for (int i = 0; i < 7; i++) {
+		DataMsgSerializer::Buffer* buf = serializer.Serialize(d);
+		void* data = const_cast<void*>(DataMsgSerializer::Data(buf));
+		TEST_ASSERT(VerifyDataMsgContent(data, (int)DataMsgSerializer::Size(buf)));
+		DataMsg got = decoder.View(data, SENSOR, 2, OUTPUT).ToDataMsg();
+		// quantised within the tolerance
+		TEST_ASSERT((got.GetValue() - d.GetValue()).cwiseAbs().maxCoeff() <= encoding.quantisationTolerance);
+		TEST_ASSERT((got.GetVariance() - d.GetVariance()).cwiseAbs().maxCoeff() <= encoding.quantisationTolerance);
+		// the late decoder got no reference until it is sent again (in every 3rd msg)
+		if (i > 0)
+			TEST_ASSERT_EQUAL_INT(i >= 3, lateDecoder.View(data, SENSOR, 2, OUTPUT).HasVariance());
+		DataMsgSerializer::Release(data, buf);
+	}
+	// the full variance, that is not diagonal and must be precise (with float-exact values to compare them)
+	encoding.quantisationTolerance = 0;
+	serializer.SetEncoding(encoding);
+	d.SetValueVector(Eigen::VectorXd::LinSpaced(6, -5, 5) / 8);
+	d.SetVarianceMatrix(FloatExactVariance(6));
+	for (int i = 0; i < 2; i++) {
+		DataMsgSerializer::Buffer* buf = serializer.Serialize(d);
+		void* data = const_cast<void*>(DataMsgSerializer::Data(buf));
+		TEST_ASSERT(decoder.View(data, SENSOR, 2, OUTPUT).ToDataMsg() == d);
+		DataMsgSerializer::Release(data, buf);
+	}
+	// an empty variance is still present after the diagonal encoding
+	DataMsg e(3, OUTPUT, SENSOR, Now());
+	e.SetValueVector(Eigen::VectorXd());
+	e.SetVarianceMatrix(Eigen::MatrixXd());
+	DataMsgSerializer::Buffer* buf = serializer.Serialize(e);
+	void* data = const_cast<void*>(DataMsgSerializer::Data(buf));
+	TEST_ASSERT(decoder.View(data, SENSOR, 3, OUTPUT).HasVariance());
+	DataMsgSerializer::Release(data, buf);
+}
+
+#include <flatbuffers/flatbuffers.h>
+#include "msgcontent_generated.h"
+
+// View a msg of the ID-th sensor with the given sequence number
+void ViewNumbered(DataMsgDecoder& decoder, unsigned char ID, uint32_t sequence) {
+	flatbuffers::FlatBufferBuilder builder;
+	builder.Finish(DataMsgContentNameSpace::CreateMsg(builder, 0, 0, 0, 0, 0, 0.f, 0, 0.f, false, false, 0, sequence));
+	decoder.View(builder.GetBufferPointer(), SENSOR, ID, OUTPUT);
+}
+
+void LostMsgsTest() {
+	DataMsgDecoder decoder;
+	// The gaps are counted, not the first msg of a stream or a repeated number
+	for (uint32_t sequence : { 1, 2, 3, 6, 7, 7 })
+		ViewNumbered(decoder, 1, sequence);
+	TEST_ASSERT_EQUAL_INT(2, decoder.GetNumOfLostMsgs()); // 4, 5
+	// Every stream has its own sequence
+	for (uint32_t sequence : { 10, 12 })
+		ViewNumbered(decoder, 2, sequence);
+	TEST_ASSERT_EQUAL_INT(3, decoder.GetNumOfLostMsgs()); // 11
+	// The numbers skip 0 when they wrap around
+	for (uint32_t sequence : { 0xfffffffeu, 0xffffffffu, 1u })
+		ViewNumbered(decoder, 3, sequence);
+	TEST_ASSERT_EQUAL_INT(3, decoder.GetNumOfLostMsgs());
+	for (uint32_t sequence : { 0xfffffffdu, 2u })
+		ViewNumbered(decoder, 4, sequence);
+	TEST_ASSERT_EQUAL_INT(6, decoder.GetNumOfLostMsgs()); // 0xfffffffe, 0xffffffff, 1
+	// A restarted sender starts again from 1: the msgs before are not lost
+	for (uint32_t sequence : { 1, 2, 4 })
+		ViewNumbered(decoder, 1, sequence);
+	TEST_ASSERT_EQUAL_INT(7, decoder.GetNumOfLostMsgs()); // 3
+	// The msgs without number (e.g. from an old sender) are not counted
+	for (uint32_t sequence : { 0, 0, 6 })
+		ViewNumbered(decoder, 1, sequence);
+	TEST_ASSERT_EQUAL_INT(8, decoder.GetNumOfLostMsgs()); // 5
+	// The same with the serializers: a new one starts a new sequence
+	DataMsg d(5, OUTPUT, SENSOR, Now());
+	for (int n = 0; n < 2; n++) {
+		DataMsgSerializer serializer;
+		for (int i = 0; i < 3; i++) {
+			DataMsgSerializer::Buffer* buf = serializer.Serialize(d);
+			void* data = const_cast<void*>(DataMsgSerializer::Data(buf));
+			if (i != 1) // lost
+				decoder.View(data, SENSOR, 5, OUTPUT);
+			DataMsgSerializer::Release(data, buf);
+		}
+	}
+	TEST_ASSERT_EQUAL_INT(10, decoder.GetNumOfLostMsgs());
+}
+
 void SendAndRecieveDataMsgs(std::string senderaddress, std::string recvaddress, int N, int K, bool sendstring = false) {
 	DataMsg d(1, STATE, SENSOR, Now());
 	d.SetValueVector(Eigen::VectorXd::Ones(10));
@@ -194,10 +345,540 @@ void orderStrings(std::string senderaddress, std::string recvaddress, int N) {
 		TEST_ASSERT(0);
 }
 
+class ShardedRecievingTest : public ZMQRecievingTest {
+public:
+	ShardedRecievingTest(unsigned int nThreads) {
+		SetNumOfRecieverThreads(nThreads);
+	}
+};
+
+void shardedRecieveTest(std::string senderaddress, std::string recvaddress, int nPeripheries, unsigned int nThreads, int N) {
+	// More peripheries than the old limit (100), sharded across the reciever threads
+	DataMsg d(1, DataType::STATE, OperationType::SENSOR, Now());
+	d.SetValueVector(Eigen::VectorXd::Ones(3));
+	Forwarder a;
+	a.SetZMQOutput(senderaddress.c_str(), N);
+	ShardedRecievingTest r(nThreads);
+	r.SetRecieveBatchSize(4); // the bursts are drained in several rounds
+	for (int i = 0; i < nPeripheries / 2; i++)
+		r.AddPeriphery(ZMQRecievingTest::PeripheryProperties(recvaddress));
+	r.Start(DTime(1000));
+	// the sockets are registered incrementally while running
+	for (int i = nPeripheries / 2; i < nPeripheries; i++)
+		r.AddPeriphery(ZMQRecievingTest::PeripheryProperties(recvaddress));
+	std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+	for (int i = 0; i < N; i++)
+		a.ForwardDataMsg(d, Now());
+
+	auto start = Now();
+	for (int i = 0; i < nPeripheries; i++)
+		while (r.GetNumOfRecievedMsgs(i) != N && Now() - start < std::chrono::seconds(5))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	TEST_ASSERT(r.IsRunning());
+	for (int i = 0; i < nPeripheries; i++) {
+		TEST_ASSERT_EQUAL_INT(N, r.GetNumOfRecievedMsgs(i));
+		ZMQRecievingTest::PeripheryMetrics m = r.GetPeripheryMetrics(i);
+		TEST_ASSERT(m.nBytes > 0);
+		TEST_ASSERT_EQUAL_INT(0, m.nDropped);
+		TEST_ASSERT_EQUAL_INT(0, m.nVerificationFailures);
+		unsigned long long nIntervals = 0;
+		for (auto n : m.jitterHistogram)
+			nIntervals += n;
+		TEST_ASSERT(nIntervals <= static_cast<unsigned long long>(N));
+		TEST_ASSERT(m.lastMsgAge >= DTime(0));
+	}
+	r.Stop();
+}
+
+class OrderRecievingTest : public ZMQRecievingTest {
+	bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override {
+		IDs.push_back(msg.GetSourceID()); // only one reciever thread
+		return true;
+	}
+
+public:
+	std::vector<unsigned char> IDs; // in the order of recieving
+};
+
+void fairRecieveTest(int nFlood, int N) {
+	// A flooding periphery cannot starve the other one: both are read in every round up to the batch size
+	Forwarder flood, other;
+	flood.SetZMQOutput("tcp://*:1235", nFlood);
+	other.SetZMQOutput("tcp://*:1236", nFlood);
+	OrderRecievingTest r;
+	const unsigned int batchSize = 16;
+	r.SetRecieveBatchSize(batchSize);
+	r.AddPeriphery(ZMQRecievingTest::PeripheryProperties("tcp://localhost:1235"));
+	r.AddPeriphery(ZMQRecievingTest::PeripheryProperties("tcp://localhost:1236"));
+	r.Start(DTime(1000));
+	std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+	// every msg is waiting in the sockets when the recieving is resumed
+	r.Pause(true);
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	DataMsg d(1, DataType::STATE, OperationType::SENSOR, Now());
+	d.SetValueVector(Eigen::VectorXd::Ones(3));
+	for (int i = 0; i < nFlood; i++)
+		flood.ForwardDataMsg(d, Now());
+	d = DataMsg(2, DataType::STATE, OperationType::SENSOR, Now());
+	for (int i = 0; i < N; i++)
+		other.ForwardDataMsg(d, Now());
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	r.Pause(false);
+
+	auto start = Now();
+	while ((r.GetNumOfRecievedMsgs(0) != nFlood || r.GetNumOfRecievedMsgs(1) != N) && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	r.Stop();
+	TEST_ASSERT_EQUAL_INT(nFlood, r.GetNumOfRecievedMsgs(0));
+	TEST_ASSERT_EQUAL_INT(N, r.GetNumOfRecievedMsgs(1));
+	// the msgs of the other periphery are got in the first rounds, not after the flood
+	size_t last = std::find(r.IDs.rbegin(), r.IDs.rend(), 2).base() - r.IDs.begin();
+	TEST_ASSERT(last <= ((N + batchSize - 1) / batchSize + 1) * batchSize + N);
+}
+
+#include "FilterHost.h"
+
+class StepRecorder : public FilterCore {
+public:
+	std::vector<Time> steps;
+	std::vector<Time> preparedSteps;
+	std::vector<unsigned char> IDs;
+	int nQueueEmpty = 0;
+
+	size_t nSensors() const override { return 0; }
+
+	bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override {
+		IDs.push_back(msg.GetSourceID());
+		return true;
+	}
+
+	void SamplingTimeOver(const Time& currentTime) override { steps.push_back(currentTime); }
+
+	void MsgQueueEmpty(const Time& currentTime) override { nQueueEmpty++; }
+
+	void PrepareStep(const Time& nextStepTime) override { preparedSteps.push_back(nextStepTime); }
+
+	DataMsg GetDataByID(int systemID, DataType dataType, OperationType opType, Time t) override { return DataMsg(); }
+
+	DataMsg GetDataByIndex(int systemIndex, DataType dataType, OperationType opType, Time t) override { return DataMsg(); }
+};
+
+class FilterHostTest : public FilterHost {
+public:
+	FilterHostTest(unsigned int nThreads) : FilterHost(nThreads) {}
+	using FilterHost::SamplingTimeOver;
+	using FilterHost::SaveDataMsg;
+	using FilterHost::MsgQueueEmpty;
+	using FilterHost::Idle;
+};
+
+void filterHostSchedulingTest() {
+	FilterHostTest host(2);
+	auto fast = std::make_shared<StepRecorder>();
+	auto slow = std::make_shared<StepRecorder>();
+	auto all = std::make_shared<StepRecorder>();
+	TEST_ASSERT_EQUAL_INT(0, host.AddFilter(fast, DTime(10000), { 1 }));
+	TEST_ASSERT_EQUAL_INT(1, host.AddFilter(slow, DTime(30000), { 2, 3 }));
+	TEST_ASSERT_EQUAL_INT(2, host.AddFilter(all, DTime(20000)));
+	// in the future: the steps are never late in wall-clock time, only the skipped ticks are missed deadlines
+	Time t0 = Now() + std::chrono::hours(1);
+
+	// Routing by source ID
+	for (unsigned char ID = 1; ID <= 4; ID++)
+		host.SaveDataMsg(DataMsg(ID, OUTPUT, SENSOR, t0), t0);
+	host.MsgQueueEmpty(t0);
+	host.MsgQueueEmpty(t0); // without new DataMsgs the filters are not called
+	TEST_ASSERT(fast->IDs == std::vector<unsigned char>({ 1 }));
+	TEST_ASSERT(slow->IDs == std::vector<unsigned char>({ 2, 3 }));
+	TEST_ASSERT(all->IDs == std::vector<unsigned char>({ 1, 2, 3, 4 }));
+	TEST_ASSERT_EQUAL_INT(1, fast->nQueueEmpty);
+	TEST_ASSERT_EQUAL_INT(1, slow->nQueueEmpty);
+	TEST_ASSERT_EQUAL_INT(1, all->nQueueEmpty);
+
+	// Every filter is stepped at its own sampling instants
+	for (int k = 0; k <= 6; k++)
+		host.SamplingTimeOver(t0 + DTime(k * 10000));
+	TEST_ASSERT_EQUAL_INT(7, host.GetNumOfSteps(0));
+	TEST_ASSERT_EQUAL_INT(3, host.GetNumOfSteps(1));
+	TEST_ASSERT_EQUAL_INT(4, host.GetNumOfSteps(2));
+	TEST_ASSERT(slow->steps == std::vector<Time>({ t0, t0 + DTime(30000), t0 + DTime(60000) }));
+	TEST_ASSERT(all->steps == std::vector<Time>({ t0, t0 + DTime(20000), t0 + DTime(40000), t0 + DTime(60000) }));
+	for (size_t n = 0; n < 3; n++)
+		TEST_ASSERT_EQUAL_INT(0, host.GetNumOfMissedDeadlines(n));
+
+	// The next steps are prepared for the next sampling instants
+	host.Idle(t0 + DTime(70000));
+	TEST_ASSERT(fast->preparedSteps == std::vector<Time>({ t0 + DTime(70000) }));
+	TEST_ASSERT(slow->preparedSteps == std::vector<Time>({ t0 + DTime(90000) }));
+	TEST_ASSERT(all->preparedSteps == std::vector<Time>({ t0 + DTime(80000) }));
+
+	// After a stall every filter is stepped once, the skipped sampling instants are missed deadlines
+	host.SamplingTimeOver(t0 + DTime(120000));
+	TEST_ASSERT_EQUAL_INT(8, host.GetNumOfSteps(0));
+	TEST_ASSERT_EQUAL_INT(4, host.GetNumOfSteps(1));
+	TEST_ASSERT_EQUAL_INT(5, host.GetNumOfSteps(2));
+	TEST_ASSERT_EQUAL_INT(5, host.GetNumOfMissedDeadlines(0)); // 70, 80, 90, 100, 110 ms
+	TEST_ASSERT_EQUAL_INT(1, host.GetNumOfMissedDeadlines(1)); // 90 ms
+	TEST_ASSERT_EQUAL_INT(2, host.GetNumOfMissedDeadlines(2)); // 80, 100 ms
+	TEST_ASSERT(fast->steps.back() == t0 + DTime(120000));
+	TEST_ASSERT(slow->steps.back() == t0 + DTime(120000));
+	TEST_ASSERT(all->steps.back() == t0 + DTime(120000));
+}
+
+#include "Periphery.h"
+#include <mutex>
+
+class InprocRecievingTest : public ZMQReciever {
+	void SamplingTimeOver(const Time& currentTime) override {}
+
+	bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override {
+		std::lock_guard<std::mutex> lock(mutex);
+		saved.push_back(&msg);
+		values.push_back(msg.GetValue().data());
+		return true;
+	}
+
+	void MsgQueueEmpty(const Time& currentTime) override {}
+
+	void SaveString(const std::string& msg, const Time& currentTime) override {}
+
+public:
+	std::mutex mutex;
+	std::vector<const DataMsg*> saved; // the addresses of the got DataMsgs
+	std::vector<const double*> values; // the addresses of their values
+};
+
+void inprocTest(int N) {
+	// The reciever gets the DataMsgs of the Periphery themselves, with the subscription to the ID
+	Periphery p("inproc://sf_inproc_test", N);
+	InprocRecievingTest r;
+	r.AddPeriphery(ZMQReciever::PeripheryProperties(OperationType::SENSOR, 1, "inproc://sf_inproc_test"));
+	r.Start(DTime(1000));
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	std::vector<std::shared_ptr<DataMsg>> sent;
+	for (int i = 0; i < N; i++) {
+		sent.push_back(std::make_shared<DataMsg>(i % 2 + 1, OUTPUT, SENSOR, Now()));
+		sent.back()->SetValueVector(Eigen::VectorXd::Constant(3, i));
+		p.SendDataMsg(sent.back());
+	}
+	auto start = Now();
+	while (r.GetNumOfRecievedMsgs(0) != N / 2 && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	// The msgs forwarded as rvalues are moved to the reciever, their values are not copied
+	std::vector<DataMsg> moved(2, DataMsg(1, OUTPUT, SENSOR, Now()));
+	std::vector<const double*> values;
+	for (DataMsg& msg : moved) {
+		msg.SetValueVector(Eigen::VectorXd::Constant(3, 1));
+		values.push_back(msg.GetValue().data());
+	}
+	p.SendDataMsgs(std::move(moved));
+	start = Now();
+	while (r.GetNumOfRecievedMsgs(0) != N / 2 + 2 && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	r.Stop();
+	TEST_ASSERT_EQUAL_INT(N / 2 + 2, r.GetNumOfRecievedMsgs(0));
+	for (int i = 0; i < N / 2; i++)
+		TEST_ASSERT(r.saved[i] == sent[2 * i].get());
+	TEST_ASSERT(r.values[N / 2] == values[0] && r.values[N / 2 + 1] == values[1]);
+}
+
+#include "PipelinedFilter.h"
+#include <future>
+
+class PipelineCore : public FilterCore {
+public:
+	std::vector<unsigned char> IDs; // only for the filter thread until the pipeline is destroyed
+	int nSteps = 0;
+	std::promise<void> blocked;
+	std::shared_future<void> release;
+
+	size_t nSensors() const override { return 1; }
+
+	bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override {
+		IDs.push_back(msg.GetSourceID());
+		if (msg.GetSourceID() == 7) { // stalls the filter thread until it is released
+			blocked.set_value();
+			release.wait();
+		}
+		return msg.GetSourceID() != 9; // unknown ID
+	}
+
+	void SamplingTimeOver(const Time& currentTime) override { nSteps++; }
+
+	void MsgQueueEmpty(const Time& currentTime) override {}
+
+	DataMsg GetDataByID(int systemID, DataType dataType, OperationType opType, Time t) override { return DataMsg(); }
+
+	DataMsg GetDataByIndex(int systemIndex, DataType dataType, OperationType opType, Time t) override {
+		DataMsg d(systemIndex + 1, dataType, opType, t);
+		d.SetValueVector(Eigen::VectorXd::Constant(2, nSteps));
+		return d;
+	}
+};
+
+class PipelinedFilterTest : public PipelinedFilter {
+public:
+	PipelinedFilterTest(FilterCore::FilterCorePtr core, size_t queueCapacity) : PipelinedFilter(core, queueCapacity) {}
+	using PipelinedFilter::SaveDataMsg;
+	using PipelinedFilter::SamplingTimeOver;
+};
+
+class CollectingReciever : public ZMQReciever {
+	void SamplingTimeOver(const Time& currentTime) override {}
+
+	bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) override {
+		std::lock_guard<std::mutex> lock(mutex);
+		got.push_back(msg);
+		return true;
+	}
+
+	void MsgQueueEmpty(const Time& currentTime) override {}
+
+	void SaveString(const std::string& msg, const Time& currentTime) override {}
+
+public:
+	std::mutex mutex;
+	std::vector<DataMsg> got;
+
+	size_t Size() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return got.size();
+	}
+};
+
+template<class Predicate>
+bool WaitFor(Predicate done) {
+	auto start = Now();
+	while (!done() && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	return done();
+}
+
+void pipelinedFilterTest() {
+	auto core = std::make_shared<PipelineCore>();
+	std::promise<void> release;
+	core->release = release.get_future().share();
+	std::future<void> blocked = core->blocked.get_future();
+	CollectingReciever r;
+	{
+		PipelinedFilterTest p(core, 8);
+		p.SetZMQOutput("inproc://sf_pipeline_test", 100);
+		r.AddPeriphery(ZMQReciever::PeripheryProperties("inproc://sf_pipeline_test"));
+		r.Start(DTime(1000));
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		typedef PipelinedFilter::Stage Stage;
+		auto processed = [&p](Stage stage, unsigned long long n) { return [&p, stage, n]() { return p.GetStageStatistics(stage).nProcessed == n; }; };
+
+		// The recieved msgs are saved and forwarded, then the filtered states of the step
+		Time t1 = Now();
+		for (unsigned char ID : { 1, 2, 9 })
+			TEST_ASSERT(p.SaveDataMsg(DataMsg(ID, OUTPUT, SENSOR, t1), t1));
+		p.SamplingTimeOver(t1);
+		TEST_ASSERT(WaitFor([&r]() { return r.Size() == 5; }));
+		TEST_ASSERT(WaitFor(processed(PipelinedFilter::FORWARDING, 6))); // with the event closing the step
+		for (int i = 0; i < 3; i++)
+			TEST_ASSERT(r.got[i] == DataMsg(i < 2 ? i + 1 : 9, OUTPUT, SENSOR, t1));
+		for (int i = 0; i < 2; i++) {
+			TEST_ASSERT_EQUAL_INT(i, r.got[3 + i].GetSourceID());
+			TEST_ASSERT(r.got[3 + i].GetDataSourceType() == OperationType::FILTER_MEAS_UPDATE);
+			TEST_ASSERT(r.got[3 + i].GetValue() == Eigen::VectorXd::Constant(2, 1));
+		}
+		PipelinedFilter::StageStatistics s = p.GetStageStatistics(PipelinedFilter::RECIEVING);
+		TEST_ASSERT_EQUAL_INT(3, s.nProcessed);
+		s = p.GetStageStatistics(PipelinedFilter::FILTERING);
+		TEST_ASSERT_EQUAL_INT(4, s.nProcessed);
+		TEST_ASSERT_EQUAL_INT(0, s.nDropped);
+		TEST_ASSERT_EQUAL_INT(1, s.nUnknownIDs); // rejected by the FilterCore, but not dropped
+		TEST_ASSERT_EQUAL_INT(0, s.queueSize);
+		TEST_ASSERT_EQUAL_INT(8, s.queueCapacity);
+
+		// While the filter thread is stalled the input queue is filled (the stalling msg keeps its slot), the rest is dropped
+		p.SaveDataMsg(DataMsg(7, OUTPUT, SENSOR, t1), t1);
+		TEST_ASSERT(blocked.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+		for (int i = 0; i < 10; i++)
+			TEST_ASSERT(p.SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, t1), t1)); // queued or dropped, it is not an unknown ID
+		s = p.GetStageStatistics(PipelinedFilter::FILTERING);
+		TEST_ASSERT_EQUAL_INT(8, s.queueSize);
+		TEST_ASSERT_EQUAL_INT(3, s.nDropped);
+		release.set_value();
+		TEST_ASSERT(WaitFor(processed(PipelinedFilter::FILTERING, 4 + 8)));
+		s = p.GetStageStatistics(PipelinedFilter::FILTERING);
+		TEST_ASSERT_EQUAL_INT(0, s.queueSize);
+		TEST_ASSERT_EQUAL_INT(7, s.maxQueueSize); // seen after the stalling msg was processed
+		TEST_ASSERT_EQUAL_INT(1, s.nUnknownIDs);
+		TEST_ASSERT_EQUAL_INT(3 + 1 + 10, p.GetStageStatistics(PipelinedFilter::RECIEVING).nProcessed);
+		// every saved msg is forwarded, unless the output queue is full
+		TEST_ASSERT(WaitFor([&p]() {
+			PipelinedFilter::StageStatistics f = p.GetStageStatistics(PipelinedFilter::FORWARDING);
+			return f.nProcessed + f.nDropped == 6 + 8 && f.queueSize == 0;
+		}));
+	}
+	r.Stop();
+	TEST_ASSERT(core->IDs == std::vector<unsigned char>({ 1, 2, 9, 7, 1, 1, 1, 1, 1, 1, 1 }));
+	TEST_ASSERT_EQUAL_INT(1, core->nSteps);
+}
+
+void filterHostOffsetTest() {
+	// Two filters with the same sensor IDs (e.g. two robots) told apart by the ID offsets
+	auto robotA = std::make_shared<PipelineCore>();
+	auto robotB = std::make_shared<PipelineCore>();
+	CollectingReciever r;
+	{
+		FilterHostTest host(2);
+		TEST_ASSERT_EQUAL_INT(0, host.AddFilter(robotA, DTime(10000), { 1, 2 }));
+		TEST_ASSERT_EQUAL_INT(1, host.AddFilter(robotB, DTime(10000), { 1, 2 }, 100));
+		host.SetZMQOutput("inproc://sf_host_offset_test", 100);
+		r.AddPeriphery(ZMQReciever::PeripheryProperties("inproc://sf_host_offset_test"));
+		r.Start(DTime(1000));
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+		// The inputs are routed by (filter, ID) and relabelled, they are forwarded unchanged
+		Time t0 = Now();
+		host.SaveDataMsg(DataMsg(1, OUTPUT, SENSOR, t0), t0);
+		host.SaveDataMsg(DataMsg(101, OUTPUT, SENSOR, t0), t0);
+		host.SaveDataMsg(DataMsgView(102, OUTPUT, SENSOR, t0, nullptr, 0, nullptr, 0), t0);
+		host.SaveDataMsg(DataMsg(3, OUTPUT, SENSOR, t0), t0);
+		host.MsgQueueEmpty(t0);
+		TEST_ASSERT(robotA->IDs == std::vector<unsigned char>({ 1 }));
+		TEST_ASSERT(robotB->IDs == std::vector<unsigned char>({ 1, 2 }));
+
+		// The results of the second filter are forwarded with the shifted IDs
+		host.SamplingTimeOver(t0);
+		TEST_ASSERT(WaitFor([&r]() { return r.Size() == 4 + 4; }));
+		std::vector<unsigned char> IDs;
+		for (const DataMsg& msg : r.got)
+			IDs.push_back(msg.GetSourceID());
+		TEST_ASSERT(IDs == std::vector<unsigned char>({ 1, 101, 102, 3, 0, 1, 100, 101 }));
+		for (int i = 4; i < 8; i++)
+			TEST_ASSERT(r.got[i].GetDataSourceType() == OperationType::FILTER_MEAS_UPDATE);
+	}
+	r.Stop();
+
+	auto other = std::make_shared<PipelineCore>();
+	FilterHostTest host(1);
+	bool thrown = false;
+	try { host.AddFilter(other, DTime(10000), {}, 100); }
+	catch (std::runtime_error&) { thrown = true; }
+	TEST_ASSERT(thrown);
+	thrown = false;
+	try { host.AddFilter(other, DTime(10000), { 200 }, 100); }
+	catch (std::runtime_error&) { thrown = true; }
+	TEST_ASSERT(thrown);
+}
+
+void shmRingTest() {
+	// A reader attached before the writer gets the msgs written after the ring was created, an overrun is counted
+	ShmRingReader early("shm://sf_ring_test");
+	ShmRingWriter writer("shm://sf_ring_test", 8, 64);
+	ShmRingReader late("shm://sf_ring_test");
+	zmq::message_t topic, msg;
+	TEST_ASSERT(!late.Read(topic, msg));
+	for (int i = 0; i < 20; i++)
+		writer.Write("d", 1, &i, sizeof(i));
+	int n = 0;
+	while (late.Read(topic, msg)) {
+		TEST_ASSERT_EQUAL_INT(12 + n, *static_cast<int*>(msg.data()));
+		n++;
+	}
+	TEST_ASSERT_EQUAL_INT(8, n);
+	TEST_ASSERT_EQUAL_INT(12, late.GetNumOfLostMsgs());
+	while (early.Read(topic, msg)); // it attaches now
+	writer.Write("i", 1, "x", 1);
+	TEST_ASSERT(early.Read(topic, msg));
+	TEST_ASSERT_EQUAL_INT('i', *static_cast<char*>(topic.data()));
+	// the attached readers detach from the removed ring, and wait for a new one as the new readers do
+	ShmRingWriter::Unlink("shm://sf_ring_test");
+	ShmRingReader removed("shm://sf_ring_test");
+	TEST_ASSERT(!removed.IsAttached());
+	writer.Write("i", 1, "y", 1);
+	TEST_ASSERT(!early.Read(topic, msg));
+	TEST_ASSERT(!early.IsAttached());
+	ShmRingWriter renewed("shm://sf_ring_test", 8, 64);
+	TEST_ASSERT(!early.Read(topic, msg)); // it attaches now
+	renewed.Write("i", 1, "z", 1);
+	TEST_ASSERT(early.Read(topic, msg));
+	TEST_ASSERT_EQUAL_INT('z', *static_cast<char*>(msg.data()));
+	ShmRingWriter::Unlink("shm://sf_ring_test");
+}
+
+void shmOverrunTest() {
+	// The msgs overwritten in the ring before the reciever read them are counted as dropped
+	ZMQRecievingTest r;
+	r.AddPeriphery(ZMQReciever::PeripheryProperties(OperationType::SENSOR, 1, "shm://sf_shm_overrun_test"));
+	r.Start(DTime(1000));
+	Periphery p("shm://sf_shm_overrun_test", 4);
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	r.Pause(true);
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	for (int i = 0; i < 20; i++)
+		p.SendValue(1, Eigen::VectorXd::Ones(3), OUTPUT);
+	r.Pause(false);
+	auto start = Now();
+	while (r.GetNumOfRecievedMsgs(0) != 4 && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	r.Stop();
+	TEST_ASSERT_EQUAL_INT(4, r.GetNumOfRecievedMsgs(0));
+	TEST_ASSERT_EQUAL_INT(16, r.GetPeripheryMetrics(0).nDropped);
+	ShmRingWriter::Unlink("shm://sf_shm_overrun_test");
+}
+
+void shmRecieveTest(int N) {
+	// The reciever is started before the Periphery creates the ring
+	ZMQRecievingTest r;
+	r.AddPeriphery(ZMQReciever::PeripheryProperties(OperationType::SENSOR, 1, "shm://sf_shm_test"));
+	r.Start(DTime(1000));
+	Periphery p("shm://sf_shm_test", 4 * N); // the ring holds every msg: none is overwritten before it is read
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	for (int i = 0; i < N; i++) {
+		p.SendValue(i % 2 + 1, Eigen::VectorXd::Ones(3), OUTPUT);
+		p.ForwardString("not subscribed", Now());
+	}
+	auto start = Now();
+	while (r.GetNumOfRecievedMsgs(0) != N / 2 && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	r.Stop();
+	TEST_ASSERT_EQUAL_INT(N / 2, r.GetNumOfRecievedMsgs(0));
+	TEST_ASSERT_EQUAL_INT(0, r.GetPeripheryMetrics(0).nDropped);
+	ShmRingWriter::Unlink("shm://sf_shm_test");
+}
+
+void shmBatchTest(int N) {
+	// The batches are split to fit into the slots
+	ZMQRecievingTest r;
+	r.AddPeriphery(ZMQReciever::PeripheryProperties(OperationType::SENSOR, "shm://sf_shm_batch_test"));
+	r.Start(DTime(1000));
+	Periphery p("shm://sf_shm_batch_test", 4 * N, 1024);
+	p.SetBatchOutput(true);
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	std::vector<DataMsg> msgs;
+	for (int i = 0; i < N; i++) {
+		msgs.push_back(DataMsg(1, OUTPUT, SENSOR, Now()));
+		msgs.back().SetValueVector(Eigen::VectorXd::Constant(3, i));
+		msgs.back().SetVarianceMatrix(Eigen::MatrixXd::Identity(3, 3));
+	}
+	TEST_ASSERT(N * DataMsgSerializer::MaxBatchRecordSize(msgs[0]) > 1024);
+	p.SendDataMsgs(msgs);
+	auto start = Now();
+	while (r.GetNumOfRecievedMsgs(0) * 3 < static_cast<unsigned long long>(N) && Now() - start < std::chrono::seconds(5))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	r.Stop();
+	// the number of the recieved (batch) msgs: 3 DataMsgs surely fit into a slot
+	TEST_ASSERT_EQUAL_INT((N + 2) / 3, r.GetNumOfRecievedMsgs(0));
+	TEST_ASSERT_EQUAL_INT(0, r.GetPeripheryMetrics(0).nDropped);
+	ShmRingWriter::Unlink("shm://sf_shm_batch_test");
+}
+
 int main (void) {
 	UNITY_BEGIN();
 	RUN_TEST([]() { orderDataMsg("tcp://*:1234", "tcp://localhost:1234", 100); });
 	RUN_TEST([]() { orderStrings("tcp://*:1234", "tcp://localhost:1234", 100); });
+	RUN_TEST([]() { shardedRecieveTest("tcp://*:1234", "tcp://localhost:1234", 150, 3, 100); });
+	RUN_TEST([]() { fairRecieveTest(2000, 40); });
+	RUN_TEST([]() { inprocTest(100); });
+	RUN_TEST([]() { pipelinedFilterTest(); });
+	RUN_TEST([]() { filterHostSchedulingTest(); });
+	RUN_TEST([]() { filterHostOffsetTest(); });
 	RUN_TEST([]() {
 		printf("TCP: 1000x5 datamsg\n");
 		SendAndRecieveDataMsgs("tcp://*:1234", "tcp://localhost:1234", 1000, 5);
@@ -211,6 +892,16 @@ int main (void) {
 	RUN_TEST([]() {	hwmtest("tcp://*:1234", "tcp://localhost:1234", 10, 10); });
 	RUN_TEST([]() {	hwmtest("tcp://*:1234", "tcp://localhost:1234", 10, 100); });
 	RUN_TEST([]() {	DataMsgContentSerialization(100000); });
+	RUN_TEST([]() {	DataMsgSerializerTest(1000); });
+	RUN_TEST([]() {	DataMsgBatchTest(); });
+	RUN_TEST([]() {	DataMsgEncodingTest(); });
+	RUN_TEST([]() {	LostMsgsTest(); });
+#ifndef _WIN32
+	RUN_TEST([]() { shmRingTest(); });
+	RUN_TEST([]() { shmRecieveTest(100); });
+	RUN_TEST([]() { shmOverrunTest(); });
+	RUN_TEST([]() { shmBatchTest(20); });
+#endif
 	
 #ifdef UNIX
 	//ipc, inproc...
@@ -0,0 +1,138 @@
+#include "BlockStatisticValue.h"
+#include <algorithm>
+
+using namespace SF;
+
+SF::BlockStatisticValue::BlockStatisticValue() : starts(1, 0) {}
+
+size_t SF::BlockStatisticValue::nBlocks() const { return blocks.size(); }
+
+Eigen::Index SF::BlockStatisticValue::Length() const { return starts.back(); }
+
+Eigen::Index SF::BlockStatisticValue::BlockStart(size_t i) const { return starts.at(i); }
+
+Eigen::Index SF::BlockStatisticValue::BlockLength(size_t i) const { return blocks.at(i).Length(); }
+
+void SF::BlockStatisticValue::AddBlock(const StatisticValue & value) {
+	blocks.push_back(value);
+	starts.push_back(starts.back() + value.Length());
+}
+
+const StatisticValue & SF::BlockStatisticValue::GetBlock(size_t i) const { return blocks.at(i); }
+
+void SF::BlockStatisticValue::SetCrossVariance(size_t i, size_t j, const Eigen::MatrixXd & value) {
+	if (i == j || i >= nBlocks() || j >= nBlocks())
+		throw std::runtime_error(std::string("BlockStatisticValue::SetCrossVariance(): Wrong block indices!"));
+	if (value.rows() != BlockLength(i) || value.cols() != BlockLength(j))
+		throw std::runtime_error(std::string("BlockStatisticValue::SetCrossVariance(): Wrong argument size!"));
+	if (i < j)
+		crossVariances[std::make_pair(i, j)] = value;
+	else
+		crossVariances[std::make_pair(j, i)] = value.transpose();
+}
+
+Eigen::MatrixXd SF::BlockStatisticValue::GetCrossVariance(size_t i, size_t j) const {
+	if (i == j)
+		return blocks.at(i).variance;
+	auto it = crossVariances.find(std::make_pair(std::min(i, j), std::max(i, j)));
+	if (it == crossVariances.end())
+		return Eigen::MatrixXd::Zero(BlockLength(i), BlockLength(j));
+	if (i < j)
+		return it->second;
+	return it->second.transpose();
+}
+
+const Eigen::MatrixXd * SF::BlockStatisticValue::FindCrossVariance(size_t i, size_t j) const {
+	auto it = crossVariances.find(std::make_pair(i, j));
+	return it == crossVariances.end() ? NULL : &it->second;
+}
+
+Eigen::Index SF::BlockStatisticValue::nStoredVariances() const {
+	Eigen::Index out = 0;
+	for (const StatisticValue& block : blocks)
+		out += block.variance.size();
+	for (const auto& cross : crossVariances)
+		out += 2 * cross.second.size();
+	return out;
+}
+
+BlockStatisticValue SF::BlockStatisticValue::GetSubValue(const std::vector<size_t>& indices) const {
+	BlockStatisticValue out;
+	for (size_t i : indices)
+		out.AddBlock(blocks.at(i));
+	for (size_t k = 0; k < indices.size(); k++)
+		for (size_t l = 0; l < indices.size(); l++) {
+			const Eigen::MatrixXd* cross = indices[k] < indices[l] ? FindCrossVariance(indices[k], indices[l]) : NULL;
+			if (cross)
+				out.SetCrossVariance(k, l, *cross);
+		}
+	return out;
+}
+
+StatisticValue SF::BlockStatisticValue::GetBlocks(const std::vector<size_t>& indices) const {
+	std::vector<Eigen::Index> offsets(1, 0);
+	for (size_t i : indices)
+		offsets.push_back(offsets.back() + BlockLength(i));
+	StatisticValue out(Eigen::VectorXd(offsets.back()), Eigen::MatrixXd::Zero(offsets.back(), offsets.back()), true);
+	for (size_t k = 0; k < indices.size(); k++) {
+		const StatisticValue& block = blocks[indices[k]];
+		out.vector.segment(offsets[k], block.Length()) = block.vector;
+		out.variance.block(offsets[k], offsets[k], block.Length(), block.Length()) = block.variance;
+		out.isIndependent = out.isIndependent && block.isIndependent;
+	}
+	for (const auto& cross : crossVariances) {
+		auto i = std::find(indices.begin(), indices.end(), cross.first.first);
+		auto j = std::find(indices.begin(), indices.end(), cross.first.second);
+		if (i == indices.end() || j == indices.end())
+			continue;
+		Eigen::Index oi = offsets[i - indices.begin()], oj = offsets[j - indices.begin()];
+		out.variance.block(oi, oj, cross.second.rows(), cross.second.cols()) = cross.second;
+		out.variance.block(oj, oi, cross.second.cols(), cross.second.rows()) = cross.second.transpose();
+		out.isIndependent = false;
+	}
+	return out;
+}
+
+StatisticValue SF::BlockStatisticValue::ToStatisticValue() const {
+	std::vector<size_t> indices(nBlocks());
+	for (size_t i = 0; i < indices.size(); i++)
+		indices[i] = i;
+	return GetBlocks(indices);
+}
+
+Eigen::VectorXd SF::BlockStatisticValue::Vector() const {
+	Eigen::VectorXd out(Length());
+	for (size_t i = 0; i < nBlocks(); i++)
+		out.segment(starts[i], BlockLength(i)) = blocks[i].vector;
+	return out;
+}
+
+Eigen::MatrixXd SF::BlockStatisticValue::MultiplyVariance(const Eigen::MatrixXd & M) const {
+	if (M.cols() != Length())
+		throw std::runtime_error(std::string("BlockStatisticValue::MultiplyVariance(): Wrong argument size!"));
+	Eigen::MatrixXd out(M.rows(), Length());
+	for (size_t i = 0; i < nBlocks(); i++)
+		out.middleCols(starts[i], BlockLength(i)).noalias() = M.middleCols(starts[i], BlockLength(i)) * blocks[i].variance;
+	for (const auto& cross : crossVariances) {
+		size_t i = cross.first.first, j = cross.first.second;
+		out.middleCols(starts[j], BlockLength(j)).noalias() += M.middleCols(starts[i], BlockLength(i)) * cross.second;
+		out.middleCols(starts[i], BlockLength(i)).noalias() += M.middleCols(starts[j], BlockLength(j)) * cross.second.transpose();
+	}
+	return out;
+}
+
+Eigen::MatrixXd SF::BlockStatisticValue::TransformVariance(const Eigen::MatrixXd & M) const {
+	if (M.cols() != Length())
+		throw std::runtime_error(std::string("BlockStatisticValue::TransformVariance(): Wrong argument size!"));
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(M.rows(), M.rows());
+	for (size_t i = 0; i < nBlocks(); i++) {
+		auto Mi = M.middleCols(starts[i], BlockLength(i));
+		out.noalias() += Mi * blocks[i].variance * Mi.transpose();
+	}
+	for (const auto& cross : crossVariances) {
+		size_t i = cross.first.first, j = cross.first.second;
+		Eigen::MatrixXd temp = M.middleCols(starts[i], BlockLength(i)) * cross.second * M.middleCols(starts[j], BlockLength(j)).transpose();
+		out += temp + temp.transpose();
+	}
+	return out;
+}
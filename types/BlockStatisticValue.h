@@ -0,0 +1,57 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include "StatisticValue.h"
+
+namespace SF {
+
+	/*! \brief Statistic value stored as blocks (e.g. the values of the systems) and the nonzero cross variances between them
+	*
+	* The cross variances that are not set are zero, so the block diagonal covariance matrices (e.g. the noises and the
+	* disturbances of the systems) are stored without the zero padding. The products with the covariance matrix are
+	* computed block-wise.
+	*/
+	class BlockStatisticValue {
+	public:
+		BlockStatisticValue(); //!< Constructor without blocks
+
+		size_t nBlocks() const; //!< Number of blocks
+
+		Eigen::Index Length() const; //!< Returns the number of variables
+
+		Eigen::Index BlockStart(size_t i) const; //!< Index of the first variable of the block
+
+		Eigen::Index BlockLength(size_t i) const; //!< Number of variables in the block
+
+		void AddBlock(const StatisticValue& value); //!< Append a block (zero cross variances with the others)
+
+		const StatisticValue& GetBlock(size_t i) const; //!< Get a block
+
+		void SetCrossVariance(size_t i, size_t j, const Eigen::MatrixXd& value); //!< Set the cross variance of block i and j (i != j)
+
+		Eigen::MatrixXd GetCrossVariance(size_t i, size_t j) const; //!< Get the cross variance of block i and j (zero if not set)
+
+		const Eigen::MatrixXd* FindCrossVariance(size_t i, size_t j) const; //!< The stored cross variance of block i and j (i < j) or NULL if it is zero
+
+		Eigen::Index nStoredVariances() const; //!< Number of the stored covariance elements (the cross variances counted twice as in the dense matrix)
+
+		BlockStatisticValue GetSubValue(const std::vector<size_t>& indices) const; //!< Returns the listed blocks with their cross variances (still block-wise)
+
+		StatisticValue GetBlocks(const std::vector<size_t>& indices) const; //!< Returns the listed blocks as a dense statistic value
+
+		StatisticValue ToStatisticValue() const; //!< Returns the dense statistic value
+
+		Eigen::VectorXd Vector() const; //!< Returns the concatenated vector
+
+		Eigen::MatrixXd MultiplyVariance(const Eigen::MatrixXd& M) const; //!< Returns M * S computed block-wise
+
+		Eigen::MatrixXd TransformVariance(const Eigen::MatrixXd& M) const; //!< Returns M * S * M^T computed block-wise
+
+	private:
+		std::vector<StatisticValue> blocks;
+		std::vector<Eigen::Index> starts; // the first index of the blocks and the length at the end
+		std::map<std::pair<size_t, size_t>, Eigen::MatrixXd> crossVariances; // for i < j
+	};
+
+}
@@ -17,12 +17,14 @@ void DataMsg::ClearValue() { hasValue = false; }
 
 void DataMsg::ClearVariance() { hasVariance = false; }
 
-Eigen::VectorXd DataMsg::GetValue() const { return value; }
+const Eigen::VectorXd& DataMsg::GetValue() const { return value; }
 
-Eigen::MatrixXd DataMsg::GetVariance() const { return variance; }
+const Eigen::MatrixXd& DataMsg::GetVariance() const { return variance; }
 
 unsigned char DataMsg::GetSourceID() const { return sourceID; }
 
+void DataMsg::SetSourceID(unsigned char ID) { sourceID = ID; }
+
 DataType DataMsg::GetDataType() const { return dataType; }
 
 OperationType DataMsg::GetDataSourceType() const { return dataSource; }
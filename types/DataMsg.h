@@ -21,6 +21,8 @@ namespace SF {
 		bool hasVariance;
 		Time time;
 
+		friend class DataMsgView; // to copy into the storage of a reused DataMsg
+
 	public:
 		Time GetTime() const; /*!< Timestamp getter */
 
@@ -41,9 +43,9 @@ namespace SF {
 
 		void ClearVariance();  /*!< To remove the stored variance vector */
 
-		Eigen::VectorXd GetValue() const;  /*!< To get the stored value vector */
+		const Eigen::VectorXd& GetValue() const;  /*!< To get the stored value vector */
 
-		Eigen::MatrixXd GetVariance() const; /*!< To get the stored variance vector */
+		const Eigen::MatrixXd& GetVariance() const; /*!< To get the stored variance vector */
 
 		unsigned char GetSourceID() const; /*!< To get source ID */
 
@@ -59,6 +61,8 @@ namespace SF {
 
 		void SetValue(const StatisticValue& v); /*!< To set the value vector and the covariance matrix */
 
+		void SetSourceID(unsigned char ID); /*!< To set source ID (e.g. to relabel the msg of a hosted filter) */
+
 		typedef std::shared_ptr<DataMsg> DataMsgPtr; /*!< std::shared_ptr for class DataMsg */
 
 		typedef std::vector<DataMsgPtr> DataMsgPtrList; /*!< std::vector for instances of std::shared_ptr<DataMsg> */
@@ -0,0 +1,101 @@
+#include "DataMsgView.h"
+#include <cmath>
+
+using namespace SF;
+
+SF::DataMsgView::DataMsgView(unsigned char ID, DataType type, OperationType source, const Time & time_,
+	const float * value_, size_t valueLength_, const float * packedVariance_, size_t packedVarianceLength_,
+	std::shared_ptr<const void> keepalive_) : sourceID(ID), dataType(type), dataSource(source), time(time_),
+	value(value_), valueLength(valueLength_), valueKeepalive(keepalive_) {
+	SetVariance(packedVariance_, packedVarianceLength_, keepalive_);
+}
+
+Time SF::DataMsgView::GetTime() const { return time; }
+
+unsigned char SF::DataMsgView::GetSourceID() const { return sourceID; }
+
+void SF::DataMsgView::SetSourceID(unsigned char ID) { sourceID = ID; }
+
+DataType SF::DataMsgView::GetDataType() const { return dataType; }
+
+OperationType SF::DataMsgView::GetDataSourceType() const { return dataSource; }
+
+bool SF::DataMsgView::HasValue() const { return value != nullptr; }
+
+bool SF::DataMsgView::HasVariance() const { return packedVariance != nullptr; }
+
+void SF::DataMsgView::ClearValue() {
+	value = nullptr;
+	valueLength = 0;
+}
+
+void SF::DataMsgView::ClearVariance() {
+	packedVariance = nullptr;
+	packedVarianceLength = 0;
+	varianceSize = 0;
+}
+
+void SF::DataMsgView::SetValue(const float * value_, size_t length, std::shared_ptr<const void> keepalive) {
+	value = value_;
+	valueLength = length;
+	valueKeepalive = keepalive;
+}
+
+void SF::DataMsgView::SetVariance(const float * packedVariance_, size_t length, std::shared_ptr<const void> keepalive) {
+	varianceSize = static_cast<Eigen::Index>((std::sqrt(8. * length + 1) - 1) / 2 + 0.5);
+	if (static_cast<size_t>(varianceSize * (varianceSize + 1) / 2) != length)
+		throw std::runtime_error(std::string("DataMsgView::SetVariance(): Wrong length of the packed variance!"));
+	packedVariance = packedVariance_;
+	packedVarianceLength = length;
+	varianceKeepalive = keepalive;
+}
+
+DataMsgView::FloatMap SF::DataMsgView::Value() const { return FloatMap(value, valueLength); }
+
+DataMsgView::FloatMap SF::DataMsgView::PackedVariance() const { return FloatMap(packedVariance, packedVarianceLength); }
+
+Eigen::Index SF::DataMsgView::VarianceSize() const { return varianceSize; }
+
+void SF::DataMsgView::CopyValue(Eigen::VectorXd & out) const {
+	out = Value().cast<double>();
+}
+
+template<class Matrix>
+static void _Unpack(const float* packedVariance, Eigen::Index varianceSize, Matrix& out) {
+	out.resize(varianceSize, varianceSize);
+	const float* v = packedVariance;
+	for (Eigen::Index i = 0; i < varianceSize; i++) {
+		// row i of the upper triangle is contiguous
+		Eigen::Index n = varianceSize - i;
+		out.row(i).tail(n) = DataMsgView::FloatMap(v, n).cast<double>().transpose();
+		out.col(i).tail(n - 1) = out.row(i).tail(n - 1).transpose();
+		v += n;
+	}
+}
+
+void SF::DataMsgView::CopyVariance(Eigen::MatrixXd & out) const {
+	_Unpack(packedVariance, varianceSize, out);
+}
+
+void SF::DataMsgView::CopyVariance(ReservedMatrix & out) const {
+	_Unpack(packedVariance, varianceSize, out);
+}
+
+DataMsg SF::DataMsgView::ToDataMsg() const {
+	DataMsg data;
+	CopyTo(data);
+	return data;
+}
+
+void SF::DataMsgView::CopyTo(DataMsg & out) const {
+	out.sourceID = sourceID;
+	out.dataType = dataType;
+	out.dataSource = dataSource;
+	out.time = time;
+	out.hasValue = HasValue();
+	if (out.hasValue)
+		CopyValue(out.value);
+	out.hasVariance = HasVariance();
+	if (out.hasVariance)
+		CopyVariance(out.variance);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "DataMsg.h"
+
+namespace SF {
+
+	/*! \brief Read-only view of a recieved DataMsg: the value and the variance are read in place from the recieved buffer
+	*
+	* The values are stored as floats, the variance is packed: the upper triangle row by row (n*(n+1)/2 values).
+	* They are accessed through Eigen::Map-s, and converted only when they are copied into their final place (see CopyValue(),
+	* CopyVariance()). The buffers are owned by the keepalive pointers (e.g. the recieved zmq msg), so the view can be stored.
+	*/
+	class DataMsgView {
+	public:
+		typedef Eigen::Map<const Eigen::VectorXf> FloatMap; /*!< View of the stored floats */
+
+		/*! \brief Constructor: nullptr (or zero length) if the value/variance is not present */
+		DataMsgView(unsigned char ID, DataType type, OperationType source, const Time& time,
+			const float* value, size_t valueLength, const float* packedVariance, size_t packedVarianceLength,
+			std::shared_ptr<const void> keepalive = nullptr);
+
+		Time GetTime() const; /*!< Timestamp getter */
+
+		unsigned char GetSourceID() const; /*!< To get source ID */
+
+		void SetSourceID(unsigned char ID); /*!< To set source ID - the viewed data is not touched */
+
+		DataType GetDataType() const; /*!< To get DataType */
+
+		OperationType GetDataSourceType() const; /*!< To get the type of the source as an OperationType */
+
+		bool HasValue() const; /*!< To check if the value vector is present */
+
+		bool HasVariance() const; /*!< To check if the covariance matrix is present */
+
+		void ClearValue(); /*!< To ignore the value vector */
+
+		void ClearVariance(); /*!< To ignore the covariance matrix */
+
+		void SetValue(const float* value, size_t length, std::shared_ptr<const void> keepalive); /*!< To view a value vector stored elsewhere (e.g. decoded) */
+
+		void SetVariance(const float* packedVariance, size_t length, std::shared_ptr<const void> keepalive); /*!< To view a packed covariance matrix stored elsewhere */
+
+		FloatMap Value() const; /*!< The value vector in place */
+
+		FloatMap PackedVariance() const; /*!< The packed covariance matrix in place */
+
+		Eigen::Index VarianceSize() const; /*!< Number of rows (and cols) of the covariance matrix */
+
+		void CopyValue(Eigen::VectorXd& out) const; /*!< Convert the value vector into out (no allocation if its size is right) */
+
+		void CopyVariance(Eigen::MatrixXd& out) const; /*!< Unpack the covariance matrix into out (no allocation if its size is right) */
+
+		void CopyVariance(ReservedMatrix& out) const; /*!< Unpack the covariance matrix into out (no allocation if it fits) */
+
+		DataMsg ToDataMsg() const; /*!< Copy the content into a DataMsg */
+
+		void CopyTo(DataMsg& out) const; /*!< Copy the content into out (no allocation if its sizes are right, e.g. a reused DataMsg) */
+
+	private:
+		unsigned char sourceID;
+		DataType dataType;
+		OperationType dataSource;
+		Time time;
+		const float* value;
+		size_t valueLength;
+		const float* packedVariance;
+		size_t packedVarianceLength;
+		Eigen::Index varianceSize;
+		std::shared_ptr<const void> valueKeepalive, varianceKeepalive;
+	};
+
+}
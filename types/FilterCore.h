@@ -1,6 +1,7 @@
 #pragma once
 
 #include"DataMsg.h"
+#include"DataMsgView.h"
 #include"defs.h"
 
 namespace SF {
@@ -16,10 +17,23 @@ namespace SF {
 
 		virtual bool SaveDataMsg(const DataMsg& msg, const Time& currentTime) = 0; /*!< Must called if new DataMsg recieved */
 
+		/*! \brief Same as SaveDataMsg(const DataMsg&, const Time&) for a recieved msg read in place
+		*
+		* By default it copies the view into a DataMsg. Override it to copy the content directly into its final place.
+		*/
+		virtual bool SaveDataMsg(const DataMsgView& msg, const Time& currentTime) { return SaveDataMsg(msg.ToDataMsg(), currentTime); }
+
 		virtual void SamplingTimeOver(const Time& currentTime) = 0; /*!< Is called in each sampling time - input: time */
 
 		virtual void MsgQueueEmpty(const Time& currentTime) = 0; /*!< Is called if the DataMsgs in the queue were read */
 
+		/*! \brief Is called if the reciever is idle before the next sampling time - input: the next sampling time
+		*
+		* The filters can compute the parts of the next step not depending on the measurements in advance.
+		* It is called from the same thread as the other functions (by default it does nothing).
+		*/
+		virtual void PrepareStep(const Time& nextStepTime) {}
+
 		virtual DataMsg GetDataByID(int systemID, DataType dataType, OperationType opType, Time currentTime) = 0; //!< To get predicted/filtered state/output/.. values
 
 		virtual DataMsg GetDataByIndex(int systemIndex, DataType dataType, OperationType opType, Time currentTime) = 0; //!< To get predicted/filtered state/output/.. values
@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace SF {
+
+	namespace LockFreeQueueDetail {
+		inline size_t RoundUpToPowerOf2(size_t n) {
+			size_t c = 2;
+			while (c < n)
+				c <<= 1;
+			return c;
+		}
+
+		struct PaddedIndex {
+			std::atomic<size_t> index;
+			char pad[64 - sizeof(std::atomic<size_t>)]; // the indices are 64 bytes apart: not in the same cache line
+			PaddedIndex() : index(0) {}
+		};
+	}
+
+	/*! \brief Bounded lock-free queue with a single producer and a single consumer thread
+	*
+	* The slots are allocated once and reused: the producer writes into the free slot in place (TryWrite()), the consumer
+	* reads the front slot in place (Front()) and releases it with Pop(). So the slots work as a pool of T-s, e.g. the
+	* Eigen storage of a DataMsg assigned into a slot is reused if the size is the same.
+	*
+	* The capacity is rounded up to a power of 2.
+	*/
+	template<class T>
+	class SPSCQueue {
+	public:
+		SPSCQueue(size_t capacity) : mask(LockFreeQueueDetail::RoundUpToPowerOf2(capacity) - 1),
+			slots(new T[mask + 1]) {} //!< Constructor
+
+		SPSCQueue(const SPSCQueue&) = delete;
+
+		SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+		/*! \brief Call write(T&) on the free slot and push it (producer) - returns false without calling it if the queue is full */
+		template<class Writer>
+		bool TryWrite(Writer write) {
+			size_t t = tail.index.load(std::memory_order_relaxed);
+			if (t - head.index.load(std::memory_order_acquire) > mask)
+				return false;
+			write(slots[t & mask]);
+			tail.index.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool TryPush(const T& x) { return TryWrite([&x](T& slot) { slot = x; }); } //!< Copy x into the free slot (producer)
+
+		/*! \brief The oldest element in place or nullptr if the queue is empty (consumer) */
+		T* Front() {
+			size_t h = head.index.load(std::memory_order_relaxed);
+			if (h == tail.index.load(std::memory_order_acquire))
+				return nullptr;
+			return &slots[h & mask];
+		}
+
+		/*! \brief Release the slot got by Front() (consumer) */
+		void Pop() {
+			head.index.store(head.index.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		size_t Size() const { //!< Number of the elements in the queue (from any thread, it may be outdated already)
+			size_t h = head.index.load(std::memory_order_acquire);
+			return tail.index.load(std::memory_order_acquire) - h;
+		}
+
+		size_t Capacity() const { return mask + 1; } //!< Maximal number of the elements
+
+	private:
+		size_t mask;
+		std::unique_ptr<T[]> slots;
+		LockFreeQueueDetail::PaddedIndex head; // next to read - written by the consumer
+		LockFreeQueueDetail::PaddedIndex tail; // next to write - written by the producer
+	};
+
+	/*! \brief Bounded lock-free queue with several producer threads and a single consumer thread
+	*
+	* The producers reserve the slots with a CAS on the shared tail index, every slot has a sequence number that tells
+	* if it was written/read already (bounded MPMC queue of D. Vyukov, with a single consumer).
+	* The slots are reused in place as in SPSCQueue.
+	*/
+	template<class T>
+	class MPSCQueue {
+	public:
+		MPSCQueue(size_t capacity) : mask(LockFreeQueueDetail::RoundUpToPowerOf2(capacity) - 1),
+			cells(new Cell[mask + 1]) { //!< Constructor
+			for (size_t i = 0; i <= mask; i++)
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		MPSCQueue(const MPSCQueue&) = delete;
+
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+		/*! \brief Call write(T&) on a free slot and push it (producers) - returns false without calling it if the queue is full */
+		template<class Writer>
+		bool TryWrite(Writer write) {
+			Cell* cell;
+			size_t t = tail.index.load(std::memory_order_relaxed);
+			for (;;) {
+				cell = &cells[t & mask];
+				std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(cell->sequence.load(std::memory_order_acquire))
+					- static_cast<std::ptrdiff_t>(t);
+				if (diff == 0) {
+					if (tail.index.compare_exchange_weak(t, t + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false; // the slot was not read since the last round: full
+				else
+					t = tail.index.load(std::memory_order_relaxed);
+			}
+			write(cell->data);
+			cell->sequence.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool TryPush(const T& x) { return TryWrite([&x](T& slot) { slot = x; }); } //!< Copy x into a free slot (producers)
+
+		/*! \brief The oldest element in place or nullptr if the queue is empty (consumer) */
+		T* Front() {
+			size_t h = head.index.load(std::memory_order_relaxed);
+			Cell& cell = cells[h & mask];
+			if (cell.sequence.load(std::memory_order_acquire) != h + 1)
+				return nullptr; // not written yet
+			return &cell.data;
+		}
+
+		/*! \brief Release the slot got by Front() (consumer) */
+		void Pop() {
+			size_t h = head.index.load(std::memory_order_relaxed);
+			cells[h & mask].sequence.store(h + mask + 1, std::memory_order_release);
+			head.index.store(h + 1, std::memory_order_release);
+		}
+
+		size_t Size() const { //!< Number of the reserved elements in the queue (from any thread, it may be outdated already)
+			size_t h = head.index.load(std::memory_order_acquire);
+			size_t t = tail.index.load(std::memory_order_acquire);
+			return t > h ? t - h : 0;
+		}
+
+		size_t Capacity() const { return mask + 1; } //!< Maximal number of the elements
+
+	private:
+		struct Cell {
+			std::atomic<size_t> sequence;
+			T data;
+		};
+
+		size_t mask;
+		std::unique_ptr<Cell[]> cells;
+		LockFreeQueueDetail::PaddedIndex head; // next to read - written by the consumer
+		LockFreeQueueDetail::PaddedIndex tail; // next to reserve - written by the producers
+	};
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include "Eigen/Dense"
+
+namespace SF {
+
+	typedef Eigen::Map<Eigen::MatrixXd, Eigen::Unaligned, Eigen::OuterStride<>> MatrixXdMap; /*!< Strided view of a dense matrix */
+
+	/*! \brief Dynamic size matrix with reserved capacity
+	*
+	* It is a view of the top left corner of its storage, so it can be resized up to the capacity without reallocation
+	* and the top left corner is kept. It can be used as an Eigen::MatrixXd in expressions. Where an Eigen::MatrixXd
+	* reference is required it is copied, so the functions returning views of their inputs must get the view itself
+	* (see View()).
+	*/
+	class ReservedMatrix : public MatrixXdMap {
+		Eigen::MatrixXd storage;
+
+		void _Remap(Eigen::Index rows, Eigen::Index cols) {
+			new (static_cast<MatrixXdMap*>(this)) MatrixXdMap(storage.data(), rows, cols, Eigen::OuterStride<>(std::max<Eigen::Index>(storage.rows(), 1)));
+		}
+
+		template<typename Derived>
+		void _Assign(const Eigen::MatrixBase<Derived>& other) {
+			if (other.rows() == rows() && other.cols() == cols())
+				MatrixXdMap::operator=(other);
+			else if (other.rows() <= storage.rows() && other.cols() <= storage.cols()) {
+				// Evaluated first: the expression may use this matrix
+				Eigen::MatrixXd value = other;
+				_Remap(value.rows(), value.cols());
+				MatrixXdMap::operator=(value);
+			}
+			else {
+				Eigen::MatrixXd value = other;
+				storage.swap(value);
+				_Remap(storage.rows(), storage.cols());
+			}
+		}
+
+	public:
+		ReservedMatrix() : MatrixXdMap(nullptr, 0, 0, Eigen::OuterStride<>(1)) {} /*!< Constructor of an empty matrix */
+
+		ReservedMatrix(Eigen::Index rows, Eigen::Index cols) : MatrixXdMap(nullptr, 0, 0, Eigen::OuterStride<>(1)), storage(rows, cols) {
+			_Remap(rows, cols);
+		} /*!< Constructor of an uninitialized matrix without spare capacity */
+
+		template<typename Derived>
+		ReservedMatrix(const Eigen::MatrixBase<Derived>& other) : MatrixXdMap(nullptr, 0, 0, Eigen::OuterStride<>(1)), storage(other) {
+			_Remap(storage.rows(), storage.cols());
+		} /*!< Constructor from an Eigen expression */
+
+		ReservedMatrix(const ReservedMatrix& other) : MatrixXdMap(nullptr, 0, 0, Eigen::OuterStride<>(1)), storage(other) {
+			_Remap(storage.rows(), storage.cols());
+		} /*!< Copy constructor - the capacity is not copied */
+
+		ReservedMatrix(ReservedMatrix&& other) noexcept : MatrixXdMap(nullptr, 0, 0, Eigen::OuterStride<>(1)) {
+			storage.swap(other.storage);
+			_Remap(other.rows(), other.cols());
+			other._Remap(0, 0);
+		} /*!< Move constructor - the capacity is moved */
+
+		ReservedMatrix& operator=(const ReservedMatrix& other) {
+			if (this != &other)
+				_Assign(other);
+			return *this;
+		} /*!< Copy assignment - the capacity is kept, it reallocates only if the value does not fit */
+
+		ReservedMatrix& operator=(ReservedMatrix&& other) noexcept {
+			if (this != &other) {
+				Eigen::Index rows = other.rows(), cols = other.cols();
+				storage.swap(other.storage);
+				_Remap(rows, cols);
+				other._Remap(0, 0);
+			}
+			return *this;
+		} /*!< Move assignment - the capacity is moved */
+
+		template<typename Derived>
+		ReservedMatrix& operator=(const Eigen::MatrixBase<Derived>& other) {
+			_Assign(other);
+			return *this;
+		} /*!< Assignment from an Eigen expression - the capacity is kept, it reallocates only if the value does not fit */
+
+		Eigen::Index Capacity() const { return std::min(storage.rows(), storage.cols()); } /*!< The size of the largest square matrix that fits */
+
+		/*! \brief Resize without reallocation up to the capacity, the top left corner is kept
+		*
+		* Beyond the capacity the storage is reallocated and copied with at least twice the capacity, so a series of
+		* appends copies the stored values amortized constant times.
+		*/
+		void conservativeResize(Eigen::Index rows, Eigen::Index cols) {
+			if (rows > storage.rows() || cols > storage.cols()) {
+				Eigen::Index rowsKept = std::min(rows, this->rows()), colsKept = std::min(cols, this->cols());
+				Eigen::MatrixXd newStorage(std::max(rows, 2 * storage.rows()), std::max(cols, 2 * storage.cols()));
+				newStorage.topLeftCorner(rowsKept, colsKept) = topLeftCorner(rowsKept, colsKept);
+				storage.swap(newStorage);
+			}
+			_Remap(rows, cols);
+		}
+
+		void resize(Eigen::Index rows, Eigen::Index cols) {
+			if (rows > storage.rows() || cols > storage.cols())
+				storage.resize(rows, cols);
+			_Remap(rows, cols);
+		} /*!< Resize without reallocation up to the capacity, the values are not kept */
+
+		void Reserve(Eigen::Index capacity) {
+			if (capacity > Capacity()) {
+				Eigen::Index rows = this->rows(), cols = this->cols();
+				Eigen::MatrixXd newStorage(std::max(capacity, storage.rows()), std::max(capacity, storage.cols()));
+				newStorage.topLeftCorner(rows, cols) = *this;
+				storage.swap(newStorage);
+				_Remap(rows, cols);
+			}
+		} /*!< Reserve capacity for a capacity x capacity matrix, the value is kept */
+
+		MatrixXdMap& View() { return *this; } /*!< The matrix as a view (e.g. to get a block view of it) */
+
+		const MatrixXdMap& View() const { return *this; } /*!< The matrix as a view (e.g. to get a block view of it) */
+	};
+}
@@ -1,4 +1,5 @@
 #include "StatisticValue.h"
+#include <algorithm>
 
 using namespace SF;
 
@@ -21,31 +22,68 @@ StatisticValue::StatisticValue(size_t n) :
 Eigen::Index StatisticValue::Length() const { return vector.size(); }
 
 void StatisticValue::Insert(Eigen::Index StartIndex, const StatisticValue& value) {
-	for (Eigen::Index i = 0; i < value.Length(); i++) {
-		vector(StartIndex + i) = value.vector(i);
-		for (Eigen::Index j = 0; j < value.vector.size(); j++)
-			variance(StartIndex + i, StartIndex + j) = value.variance(i, j);
-		for (Eigen::Index j = 0; j < StartIndex; j++) {
-			variance(j, StartIndex + i) = 0;
-			variance(StartIndex + i, j) = 0;
-		}
-		for (Eigen::Index j = StartIndex + value.Length(); j < Length(); j++) {
-			variance(j, StartIndex + i) = 0;
-			variance(StartIndex + i, j) = 0;
-		}
-	}
+	Eigen::Index n = value.Length();
+	Eigen::Index nTail = Length() - StartIndex - n;
+	vector.segment(StartIndex, n) = value.vector;
+	variance.block(StartIndex, StartIndex, n, n) = value.variance;
+	// Zero cross variances
+	variance.block(StartIndex, 0, n, StartIndex).setZero();
+	variance.block(0, StartIndex, StartIndex, n).setZero();
+	variance.block(StartIndex, StartIndex + n, n, nTail).setZero();
+	variance.block(StartIndex + n, StartIndex, nTail, n).setZero();
 }
 
 StatisticValue StatisticValue::GetPart(Eigen::Index StartIndex, Eigen::Index Length) const {
 	return StatisticValue(vector.segment(StartIndex, Length), variance.block(StartIndex, StartIndex, Length, Length));
 }
 
+StatisticValue StatisticValue::GetPart(const Eigen::VectorXi& indices) const {
+	Eigen::Index n = indices.size();
+	StatisticValue out(Eigen::VectorXd(n), Eigen::MatrixXd(n, n), isIndependent);
+	for (Eigen::Index i = 0; i < n; i++) {
+		out.vector(i) = vector(indices(i));
+		for (Eigen::Index j = 0; j < n; j++)
+			out.variance(i, j) = variance(indices(i), indices(j));
+	}
+	return out;
+}
+
+void StatisticValue::SetPart(const Eigen::VectorXi& indices, const StatisticValue& value) {
+	if (indices.size() != value.Length())
+		throw std::runtime_error(std::string("StatisticValue::SetPart Not consistent indices and value!"));
+	for (Eigen::Index i = 0; i < indices.size(); i++) {
+		vector(indices(i)) = value.vector(i);
+		for (Eigen::Index j = 0; j < indices.size(); j++)
+			variance(indices(i), indices(j)) = value.variance(i, j);
+	}
+	isIndependent = isIndependent && value.isIndependent;
+}
+
 void StatisticValue::Add(const StatisticValue& value) {
 	Eigen::Index n0 = Length();
 	Eigen::Index dn = value.Length();
+	// The stored covariances are kept in place, the capacity grows geometrically
 	vector.conservativeResize(n0 + dn);
 	variance.conservativeResize(n0 + dn, n0 + dn);
 	Insert(n0, value);
+	isIndependent = isIndependent && value.isIndependent;
+}
+
+void StatisticValue::Remove(Eigen::Index StartIndex, Eigen::Index Length) {
+	Eigen::Index n = this->Length() - Length;
+	Eigen::Index nTail = n - StartIndex;
+	if (StartIndex < 0 || nTail < 0 || Length < 0)
+		throw std::runtime_error(std::string("StatisticValue::Remove Wrong block to be removed!"));
+	// In place: the tail rows of the kept columns are moved up, then the tail columns are moved left
+	Eigen::Index N = this->Length();
+	std::copy(vector.data() + StartIndex + Length, vector.data() + N, vector.data() + StartIndex);
+	for (Eigen::Index j = 0; j < N; j++)
+		if (j < StartIndex || j >= StartIndex + Length)
+			std::copy(&variance(0, j) + StartIndex + Length, &variance(0, j) + N, &variance(0, j) + StartIndex);
+	for (Eigen::Index j = StartIndex; j < n; j++)
+		variance.col(j).head(n) = variance.col(j + Length).head(n);
+	vector.conservativeResize(n);
+	variance.conservativeResize(n, n);
 }
 
 std::ostream &operator<<(std::ostream &os, StatisticValue const &m) {
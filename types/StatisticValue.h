@@ -2,6 +2,7 @@
 
 #include "Eigen/Dense"
 #include <iostream>
+#include "ReservedMatrix.h"
 
 namespace SF {
 
@@ -11,7 +12,7 @@ namespace SF {
 	struct StatisticValue {
 		Eigen::VectorXd vector; /*!< The vector containing the value */
 
-		Eigen::MatrixXd variance; /*!< Covariance matrix  */
+		ReservedMatrix variance; /*!< Covariance matrix (with reserved capacity for Add()) */
 
 		bool isIndependent; /*!< Describes if the varince matrix is diagonal, then the variables are independent */
 
@@ -30,7 +31,13 @@ namespace SF {
 
 		StatisticValue GetPart(Eigen::Index StartIndex, Eigen::Index Length) const; /*!< Returns a block*/
 
-		void Add(const StatisticValue& value); /*!< Concatenate statistic variables setting zero cross variances */
+		StatisticValue GetPart(const Eigen::VectorXi& indices) const; /*!< Returns the elements with the given indices */
+
+		void SetPart(const Eigen::VectorXi& indices, const StatisticValue& value); /*!< Sets the elements with the given indices, the cross variances with the other elements are not modified */
+
+		void Add(const StatisticValue& value); /*!< Concatenate statistic variables setting zero cross variances - only the new rows and columns are written (amortized) */
+
+		void Remove(Eigen::Index StartIndex, Eigen::Index Length); /*!< Remove a block with its cross variances in place - the capacity is kept */
 	};
 
 }
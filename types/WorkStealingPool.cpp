@@ -0,0 +1,195 @@
+#include "WorkStealingPool.h"
+
+using namespace SF;
+
+namespace {
+	thread_local const WorkStealingPool* currentPool = nullptr; // pool of the calling worker thread
+	thread_local int currentIndex = -1; // index of the calling worker thread in its pool
+	thread_local int taskDepth = 0; // number of tasks being executed on the calling thread
+}
+
+SF::WorkStealingPool::WorkStealingPool(unsigned int nThreads) : nQueued(0), nPending(0), nWaitingTasks(0), nextQueue(0), toStop(false) {
+	if (nThreads == 0)
+		nThreads = std::thread::hardware_concurrency();
+	if (nThreads == 0)
+		nThreads = 1;
+	for (unsigned int i = 0; i < nThreads; i++)
+		queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+	for (unsigned int i = 0; i < nThreads; i++)
+		threads.push_back(std::thread([this, i]() { _Run(i); }));
+}
+
+SF::WorkStealingPool::~WorkStealingPool() {
+	try {
+		WaitAll();
+	}
+	catch (...) {} // the exceptions of the tasks must not leave the destructor
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		toStop = true;
+	}
+	workAvailable.notify_all();
+	for (auto& t : threads)
+		if (t.joinable())
+			t.join();
+}
+
+void SF::WorkStealingPool::Submit(Task task) {
+	nPending++;
+	int index = _GetWorkerIndex();
+	size_t queueIndex = index >= 0 ? static_cast<size_t>(index) : nextQueue++ % queues.size();
+	{
+		// Incremented before the task can be popped (so it cannot underflow) and under the lock so that a worker cannot
+		// miss the notification: a worker woken before the push finds the task in the next round
+		std::lock_guard<std::mutex> lock(stateMutex);
+		nQueued++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+		queues[queueIndex]->tasks.push_back(std::move(task));
+	}
+	workAvailable.notify_one();
+}
+
+void SF::WorkStealingPool::WaitAll() {
+	int index = _GetWorkerIndex();
+	size_t startIndex = index >= 0 ? static_cast<size_t>(index) : 0;
+	// A waiting task is pending itself: it is done if only the waiting tasks are pending
+	bool inTask = taskDepth > 0;
+	if (inTask)
+		nWaitingTasks++;
+	auto done = [this, inTask]() { return inTask ? nPending <= nWaitingTasks : nPending == 0; };
+	while (!done()) {
+		// Help while there is something to execute
+		Task task;
+		if (_PopOrSteal(startIndex, task)) {
+			_Execute(task);
+			continue;
+		}
+		// The remaining tasks are being executed by the workers
+		std::unique_lock<std::mutex> lock(stateMutex);
+		allDone.wait(lock, [this, &done]() { return done() || nQueued > 0; });
+	}
+	if (inTask) {
+		std::lock_guard<std::mutex> lock(stateMutex);
+		nWaitingTasks--;
+	}
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lock(exceptionMutex);
+		e = firstException;
+		firstException = nullptr;
+	}
+	if (e)
+		std::rethrow_exception(e);
+}
+
+void SF::WorkStealingPool::Submit(Task task, TaskGroup & group) {
+	group.nPending++;
+	Submit([this, task, &group]() {
+		try {
+			task();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(group.exceptionMutex);
+			if (!group.firstException)
+				group.firstException = std::current_exception();
+		}
+		if (--group.nPending == 0) {
+			std::lock_guard<std::mutex> lock(stateMutex);
+			allDone.notify_all();
+		}
+	});
+}
+
+void SF::WorkStealingPool::Wait(TaskGroup & group) {
+	int index = _GetWorkerIndex();
+	size_t startIndex = index >= 0 ? static_cast<size_t>(index) : 0;
+	while (group.nPending > 0) {
+		// Help while there is something to execute (the tasks of the others too, it cannot block on them)
+		Task task;
+		if (_PopOrSteal(startIndex, task)) {
+			_Execute(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(stateMutex);
+		allDone.wait(lock, [this, &group]() { return group.nPending == 0 || nQueued > 0; });
+	}
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lock(group.exceptionMutex);
+		e = group.firstException;
+		group.firstException = nullptr;
+	}
+	if (e)
+		std::rethrow_exception(e);
+}
+
+unsigned int SF::WorkStealingPool::GetNumOfThreads() const {
+	return static_cast<unsigned int>(threads.size());
+}
+
+int SF::WorkStealingPool::_GetWorkerIndex() const {
+	return currentPool == this ? currentIndex : -1;
+}
+
+bool SF::WorkStealingPool::_PopOrSteal(size_t index, Task& task) {
+	if (nQueued == 0)
+		return false;
+	// Own queue from the back
+	{
+		WorkQueue& q = *queues[index];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (!q.tasks.empty()) {
+			task = std::move(q.tasks.back());
+			q.tasks.pop_back();
+			nQueued--;
+			return true;
+		}
+	}
+	// Steal from the front of the others
+	for (size_t i = 1; i < queues.size(); i++) {
+		WorkQueue& q = *queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (!q.tasks.empty()) {
+			task = std::move(q.tasks.front());
+			q.tasks.pop_front();
+			nQueued--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void SF::WorkStealingPool::_Execute(Task& task) {
+	taskDepth++;
+	try {
+		task();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(exceptionMutex);
+		if (!firstException)
+			firstException = std::current_exception();
+	}
+	taskDepth--;
+	if (--nPending <= nWaitingTasks) {
+		std::lock_guard<std::mutex> lock(stateMutex);
+		allDone.notify_all();
+	}
+}
+
+void SF::WorkStealingPool::_Run(size_t index) {
+	currentPool = this;
+	currentIndex = static_cast<int>(index);
+	while (true) {
+		Task task;
+		if (_PopOrSteal(index, task)) {
+			_Execute(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(stateMutex);
+		workAvailable.wait(lock, [this]() { return toStop || nQueued > 0; });
+		if (toStop && nQueued == 0)
+			return;
+	}
+}
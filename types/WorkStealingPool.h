@@ -0,0 +1,89 @@
+#pragma once
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+namespace SF {
+
+	/*! \brief Thread pool with per-worker task queues and work stealing
+	*
+	* Every worker owns a deque: it pops its own tasks from the back (LIFO, cache friendly) and steals from the front
+	* of the other workers' deques if it runs out of work. Tasks submitted from outside of the pool are distributed
+	* round-robin, tasks submitted from a worker go to its own deque.
+	*
+	* WaitAll() blocks until every submitted task has been executed. The waiting thread executes tasks too. WaitAll() can be
+	* called from a task as well: then it returns if only the tasks blocked in WaitAll() are pending.
+	* The first exception thrown by a task is rethrown by WaitAll().
+	*
+	* To wait only for some of the tasks (e.g. if the pool is shared by several users), they can be submitted into a TaskGroup
+	* and waited for by Wait(): it executes tasks too while waiting, so it can be called from a task as well.
+	*/
+	class WorkStealingPool {
+	public:
+		typedef std::function<void()> Task; //!< Type of the executed tasks
+
+		typedef std::shared_ptr<WorkStealingPool> WorkStealingPoolPtr; //!< Shared pointer type of the class
+
+		/*! \brief Tasks submitted together to be waited for by Wait() - it must outlive them */
+		class TaskGroup {
+			friend class WorkStealingPool;
+			std::atomic<size_t> nPending{ 0 }; // tasks submitted but not finished
+			std::mutex exceptionMutex;
+			std::exception_ptr firstException;
+		};
+
+		WorkStealingPool(unsigned int nThreads = 0); //!< Constructor - with 0 the number of hardware threads is used
+
+		~WorkStealingPool(); //!< Destructor - waits for the submitted tasks and joins the workers
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		void Submit(Task task); //!< Add a task to be executed
+
+		void WaitAll(); //!< Execute/wait until every submitted task is finished (rethrows the first exception of the tasks)
+
+		void Submit(Task task, TaskGroup& group); //!< Add a task of the group to be executed (its exception is rethrown by Wait() only)
+
+		void Wait(TaskGroup& group); //!< Execute/wait until the tasks of the group are finished (rethrows the first exception of them)
+
+		unsigned int GetNumOfThreads() const; //!< Number of worker threads
+
+	private:
+		struct WorkQueue {
+			std::deque<Task> tasks;
+			std::mutex mutex;
+		};
+
+		std::vector<std::unique_ptr<WorkQueue>> queues; // one per worker
+		std::vector<std::thread> threads;
+
+		std::atomic<size_t> nQueued; // tasks waiting in the queues
+		std::atomic<size_t> nPending; // tasks submitted but not finished
+		std::atomic<size_t> nWaitingTasks; // tasks blocked in WaitAll()
+		std::atomic<unsigned int> nextQueue; // for round-robin distribution
+
+		std::mutex stateMutex;
+		std::condition_variable workAvailable;
+		std::condition_variable allDone;
+		bool toStop;
+
+		std::mutex exceptionMutex;
+		std::exception_ptr firstException;
+
+		int _GetWorkerIndex() const; // index of the calling worker or -1 if it is not a worker of this pool
+
+		bool _PopOrSteal(size_t index, Task& task);
+
+		void _Execute(Task& task);
+
+		void _Run(size_t index);
+	};
+}